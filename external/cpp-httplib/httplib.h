@@ -178,6 +178,10 @@ struct Response {
     Headers     headers;
     std::string body;
     std::function<std::string (uint64_t offset)> streamcb;
+    // Like streamcb, but the chunk is written to the argument, and returning
+    // false aborts the response. The connection is then closed without
+    // ending the body, so the client can tell it is incomplete.
+    std::function<bool (uint64_t offset, std::string &chunk)> chunked_content_provider;
 
     bool has_header(const std::string &key) const;
     std::string get_header_value(const std::string &key) const;
@@ -283,7 +287,7 @@ private:
     bool dispatch_request(Request& req, Response& res, Handlers& handlers);
 
     bool parse_request_line(const char* s, Request& req);
-    void write_response(Stream& strm, bool last_connection, const Request& req, Response& res);
+    bool write_response(Stream& strm, bool last_connection, const Request& req, Response& res);
 
     virtual bool read_socket(socket_t sock);
 
@@ -1880,7 +1884,7 @@ inline bool Server::parse_request_line(const char* s, Request& req)
     return false;
 }
 
-inline void Server::write_response(Stream& strm, bool last_connection, const Request& req, Response& res)
+inline bool Server::write_response(Stream& strm, bool last_connection, const Request& req, Response& res)
 {
     assert(res.status != -1);
 
@@ -1906,7 +1910,7 @@ inline void Server::write_response(Stream& strm, bool last_connection, const Req
 
     if (res.body.empty()) {
         if (!res.has_header("Content-Length")) {
-            if (res.streamcb) {
+            if (res.streamcb || res.chunked_content_provider) {
                 // Streamed response
                 res.set_header("Transfer-Encoding", "chunked");
             } else {
@@ -1938,12 +1942,18 @@ inline void Server::write_response(Stream& strm, bool last_connection, const Req
     if (req.method != "HEAD") {
         if (!res.body.empty()) {
             strm.write(res.body.c_str(), res.body.size());
-        } else if (res.streamcb) {
+        } else if (res.streamcb || res.chunked_content_provider) {
             bool chunked_response = !res.has_header("Content-Length");
             uint64_t offset = 0;
             bool data_available = true;
             while (data_available) {
-                std::string chunk = res.streamcb(offset);
+                std::string chunk;
+                if (res.chunked_content_provider) {
+                    if (!res.chunked_content_provider(offset, chunk))
+                        return false;  // Aborted, don't reuse the connection
+                } else {
+                    chunk = res.streamcb(offset);
+                }
                 offset += chunk.size();
                 data_available = !chunk.empty();
                 // Emit chunked response header and footer for each chunk
@@ -1959,6 +1969,8 @@ inline void Server::write_response(Stream& strm, bool last_connection, const Req
     if (logger_) {
         logger_(req, res);
     }
+
+    return true;
 }
 
 inline bool Server::handle_file_request(Request& req, Response& res)
@@ -2346,8 +2358,7 @@ inline bool Server::process_request(Stream& strm, bool last_connection, bool& co
         res.status = 404;
     }
 
-    write_response(strm, last_connection, req, res);
-    return true;
+    return write_response(strm, last_connection, req, res);
 }
 
 inline bool Server::is_valid() const
@@ -13,6 +13,7 @@
 #include <limits>
 #include <serialization/BinaryInputStreamSerializer.h>
 #include <serialization/BinaryOutputStreamSerializer.h>
+#include <serialization/BinarySizeSerializer.h>
 #include <serialization/CryptoNoteSerialization.h>
 #include <serialization/SerializationTools.h>
 
@@ -22,16 +23,21 @@ namespace CryptoNote
 
     Crypto::Hash getBinaryArrayHash(const BinaryArray &binaryArray);
 
+    /* Counts the bytes serializing object would produce, without producing them */
     template<class T> bool getObjectBinarySize(const T &object, size_t &size)
     {
-        BinaryArray ba;
-        if (!toBinaryArray(object, ba))
+        try
+        {
+            BinarySizeSerializer serializer;
+            serialize(const_cast<T &>(object), serializer);
+            size = serializer.size();
+        }
+        catch (std::exception &)
         {
             size = (std::numeric_limits<size_t>::max)();
             return false;
         }
 
-        size = ba.size();
         return true;
     }
 
@@ -0,0 +1,274 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "Metrics.h"
+
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace Metrics
+{
+    namespace
+    {
+        /* The labels of a sample, with an extra label on the end if given */
+        std::string formatLabels(const std::string &labels, const std::string &extra = "")
+        {
+            if (labels.empty() && extra.empty())
+            {
+                return "";
+            }
+
+            if (labels.empty() || extra.empty())
+            {
+                return "{" + labels + extra + "}";
+            }
+
+            return "{" + labels + "," + extra + "}";
+        }
+    } // namespace
+
+    const std::vector<double> LATENCY_BUCKETS =
+        {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+
+    void Counter::render(std::ostream &stream, const std::string &name, const std::string &labels) const
+    {
+        stream << name << formatLabels(labels) << " " << value() << "\n";
+    }
+
+    void Gauge::render(std::ostream &stream, const std::string &name, const std::string &labels) const
+    {
+        stream << name << formatLabels(labels) << " " << value() << "\n";
+    }
+
+    Histogram::Histogram(const std::vector<double> &bounds):
+        m_bounds(bounds),
+        m_buckets(new std::atomic<uint64_t>[bounds.size() + 1])
+    {
+        if (!std::is_sorted(m_bounds.begin(), m_bounds.end()))
+        {
+            throw std::invalid_argument("Histogram bucket bounds must be sorted");
+        }
+
+        for (size_t i = 0; i <= m_bounds.size(); i++)
+        {
+            m_buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void Histogram::observe(const double value)
+    {
+        const size_t bucket = std::lower_bound(m_bounds.begin(), m_bounds.end(), value) - m_bounds.begin();
+
+        m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+
+        double sum = m_sum.load(std::memory_order_relaxed);
+
+        while (!m_sum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    uint64_t Histogram::count() const
+    {
+        uint64_t count = 0;
+
+        for (size_t i = 0; i <= m_bounds.size(); i++)
+        {
+            count += m_buckets[i].load(std::memory_order_relaxed);
+        }
+
+        return count;
+    }
+
+    std::chrono::steady_clock::time_point Histogram::observeSince(const std::chrono::steady_clock::time_point start)
+    {
+        const auto now = std::chrono::steady_clock::now();
+
+        observe(std::chrono::duration<double>(now - start).count());
+
+        return now;
+    }
+
+    void Histogram::render(std::ostream &stream, const std::string &name, const std::string &labels) const
+    {
+        /* Buckets are exposed cumulatively */
+        uint64_t cumulative = 0;
+
+        for (size_t i = 0; i < m_bounds.size(); i++)
+        {
+            cumulative += m_buckets[i].load(std::memory_order_relaxed);
+
+            std::ostringstream bound;
+            bound << m_bounds[i];
+
+            stream << name << "_bucket" << formatLabels(labels, "le=\"" + bound.str() + "\"") << " " << cumulative
+                   << "\n";
+        }
+
+        cumulative += m_buckets[m_bounds.size()].load(std::memory_order_relaxed);
+
+        stream << name << "_bucket" << formatLabels(labels, "le=\"+Inf\"") << " " << cumulative << "\n";
+        stream << name << "_sum" << formatLabels(labels) << " " << m_sum.load(std::memory_order_relaxed) << "\n";
+        stream << name << "_count" << formatLabels(labels) << " " << cumulative << "\n";
+    }
+
+    ScopedTimer::ScopedTimer(Histogram &histogram):
+        m_histogram(&histogram),
+        m_start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ScopedTimer::~ScopedTimer()
+    {
+        stop();
+    }
+
+    void ScopedTimer::stop()
+    {
+        if (m_histogram != nullptr)
+        {
+            m_histogram->observeSince(m_start);
+            m_histogram = nullptr;
+        }
+    }
+
+    std::string label(const std::string &key, const std::string &value)
+    {
+        std::string result = key + "=\"";
+
+        for (const char c : value)
+        {
+            switch (c)
+            {
+                case '\\':
+                    result += "\\\\";
+                    break;
+                case '"':
+                    result += "\\\"";
+                    break;
+                case '\n':
+                    result += "\\n";
+                    break;
+                default:
+                    result += c;
+            }
+        }
+
+        return result + "\"";
+    }
+
+    const char *Registry::typeName(const Type type)
+    {
+        switch (type)
+        {
+            case COUNTER:
+                return "counter";
+            case GAUGE:
+                return "gauge";
+            case HISTOGRAM:
+                return "histogram";
+        }
+
+        return "untyped";
+    }
+
+    Registry &Registry::instance()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    template<typename T, typename Create>
+    T &Registry::getOrCreate(
+        const std::string &name,
+        const std::string &help,
+        const Type type,
+        const std::string &labels,
+        Create create)
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+            const auto family = m_families.find(name);
+
+            if (family != m_families.end() && family->second.type == type)
+            {
+                const auto metric = family->second.metrics.find(labels);
+
+                if (metric != family->second.metrics.end())
+                {
+                    return static_cast<T &>(*metric->second);
+                }
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        auto family = m_families.find(name);
+
+        if (family == m_families.end())
+        {
+            family = m_families.emplace(name, Family {help, type, {}}).first;
+        }
+        else if (family->second.type != type)
+        {
+            throw std::invalid_argument("Metric " + name + " is already registered as a " + typeName(family->second.type));
+        }
+
+        auto &metric = family->second.metrics[labels];
+
+        /* May have been made while we waited for the lock */
+        if (!metric)
+        {
+            metric = create();
+        }
+
+        return static_cast<T &>(*metric);
+    }
+
+    Counter &Registry::counter(const std::string &name, const std::string &help, const std::string &labels)
+    {
+        return getOrCreate<Counter>(name, help, COUNTER, labels, [] { return std::make_unique<Counter>(); });
+    }
+
+    Gauge &Registry::gauge(const std::string &name, const std::string &help, const std::string &labels)
+    {
+        return getOrCreate<Gauge>(name, help, GAUGE, labels, [] { return std::make_unique<Gauge>(); });
+    }
+
+    Histogram &Registry::histogram(
+        const std::string &name,
+        const std::string &help,
+        const std::string &labels,
+        const std::vector<double> &bounds)
+    {
+        return getOrCreate<Histogram>(
+            name, help, HISTOGRAM, labels, [&bounds] { return std::make_unique<Histogram>(bounds); });
+    }
+
+    std::string Registry::render() const
+    {
+        std::ostringstream stream;
+
+        stream.precision(12);
+
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        for (const auto &[name, family] : m_families)
+        {
+            stream << "# HELP " << name << " " << family.help << "\n";
+            stream << "# TYPE " << name << " " << typeName(family.type) << "\n";
+
+            for (const auto &[labels, metric] : family.metrics)
+            {
+                metric->render(stream, name, labels);
+            }
+        }
+
+        return stream.str();
+    }
+
+} // namespace Metrics
@@ -0,0 +1,183 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace Metrics
+{
+    /* Upper bounds, in seconds, of the buckets latency histograms use unless
+       told otherwise. Spans a tenth of a millisecond to ten seconds. */
+    extern const std::vector<double> LATENCY_BUCKETS;
+
+    class Metric
+    {
+      public:
+        virtual ~Metric() {};
+
+        /* Writes the samples of this metric in the Prometheus text format */
+        virtual void render(std::ostream &stream, const std::string &name, const std::string &labels) const = 0;
+    };
+
+    /* A value that only ever goes up */
+    class Counter : public Metric
+    {
+      public:
+        void increment(const uint64_t amount = 1)
+        {
+            m_value.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        uint64_t value() const
+        {
+            return m_value.load(std::memory_order_relaxed);
+        }
+
+        virtual void render(std::ostream &stream, const std::string &name, const std::string &labels) const override;
+
+      private:
+        std::atomic<uint64_t> m_value {0};
+    };
+
+    /* A value that can go up and down */
+    class Gauge : public Metric
+    {
+      public:
+        void set(const int64_t value)
+        {
+            m_value.store(value, std::memory_order_relaxed);
+        }
+
+        void add(const int64_t amount)
+        {
+            m_value.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        int64_t value() const
+        {
+            return m_value.load(std::memory_order_relaxed);
+        }
+
+        virtual void render(std::ostream &stream, const std::string &name, const std::string &labels) const override;
+
+      private:
+        std::atomic<int64_t> m_value {0};
+    };
+
+    /* Counts observations into buckets fixed at construction, so observing a
+       value is a handful of relaxed atomic adds */
+    class Histogram : public Metric
+    {
+      public:
+        explicit Histogram(const std::vector<double> &bounds);
+
+        void observe(const double value);
+
+        /* Observes the seconds elapsed since start, and returns now, so the
+           stages of an operation can be timed back to back */
+        std::chrono::steady_clock::time_point observeSince(const std::chrono::steady_clock::time_point start);
+
+        uint64_t count() const;
+
+        virtual void render(std::ostream &stream, const std::string &name, const std::string &labels) const override;
+
+      private:
+        const std::vector<double> m_bounds;
+
+        /* One per bound, plus one for everything above the last */
+        std::unique_ptr<std::atomic<uint64_t>[]> m_buckets;
+
+        std::atomic<double> m_sum {0};
+    };
+
+    /* Observes how long it lived into a histogram, unless stopped early */
+    class ScopedTimer
+    {
+      public:
+        explicit ScopedTimer(Histogram &histogram);
+
+        ~ScopedTimer();
+
+        ScopedTimer(const ScopedTimer &) = delete;
+
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+        /* Observes the time so far, and nothing more when destroyed */
+        void stop();
+
+      private:
+        Histogram *m_histogram;
+
+        const std::chrono::steady_clock::time_point m_start;
+    };
+
+    /* Formats a single label pair, such as route="/info", escaping the value */
+    std::string label(const std::string &key, const std::string &value);
+
+    /* Owns every metric. Looking a metric up takes a shared lock, so hot
+       paths should look their metrics up once and keep the reference, which
+       stays valid for the life of the program. */
+    class Registry
+    {
+      public:
+        static Registry &instance();
+
+        /* Each of these returns the metric with the given name and labels,
+           creating it if it doesn't exist yet. Throws if the name is already
+           in use by a different kind of metric. */
+        Counter &counter(const std::string &name, const std::string &help, const std::string &labels = "");
+
+        Gauge &gauge(const std::string &name, const std::string &help, const std::string &labels = "");
+
+        Histogram &histogram(
+            const std::string &name,
+            const std::string &help,
+            const std::string &labels = "",
+            const std::vector<double> &bounds = LATENCY_BUCKETS);
+
+        /* Every metric, in the Prometheus text exposition format */
+        std::string render() const;
+
+      private:
+        enum Type
+        {
+            COUNTER,
+            GAUGE,
+            HISTOGRAM,
+        };
+
+        struct Family
+        {
+            std::string help;
+
+            Type type;
+
+            /* Keyed by the formatted labels */
+            std::map<std::string, std::unique_ptr<Metric>> metrics;
+        };
+
+        static const char *typeName(const Type type);
+
+        template<typename T, typename Create>
+        T &getOrCreate(
+            const std::string &name,
+            const std::string &help,
+            const Type type,
+            const std::string &labels,
+            Create create);
+
+        std::map<std::string, Family> m_families;
+
+        mutable std::shared_mutex m_mutex;
+    };
+
+} // namespace Metrics
@@ -88,4 +88,18 @@ namespace Tools
 
         return output;
     }
+
+    /* The amount of bytes the value takes up when varint encoded */
+    inline size_t getVarintSize(uint64_t i)
+    {
+        size_t size = 1;
+
+        while (i >= 0x80)
+        {
+            i >>= 7;
+            size++;
+        }
+
+        return size;
+    }
 } // namespace Tools
@@ -13,6 +13,16 @@ namespace Config
            coinbase transactions in the wallet. Most wallets have not received
            coinbase transactions. */
         bool skipCoinbaseTransactions = true;
+
+        /* Whether wallets in this process using the same daemon should share
+           one connection to it, and the blocks downloaded through it. Used
+           when running many wallets in one process. */
+        bool shareDaemonConnections = false;
+
+        /* Whether we send our private view key to the daemon and let it scan
+           blocks for our transactions, instead of downloading every block.
+           Only for use with a daemon you run yourself, on the same machine. */
+        bool daemonSideScanning = false;
     };
 
     class DaemonConfig
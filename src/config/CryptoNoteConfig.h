@@ -385,6 +385,8 @@ namespace CryptoNote
 
         const char P2P_NET_DATA_FILENAME[] = "p2pstate.wrkz.bin";
 
+        const char BLOCK_HASH_INDEX_FILENAME[] = "blockhashes.wrkz.bin";
+
         const char MINER_CONFIG_FILE_NAME[] = "miner_conf.wrkz.json";
         
         /* Maximum allowable blocks to rewind from existing chain */
@@ -426,6 +428,14 @@ namespace CryptoNote
     const uint64_t BLOCKS_SYNCHRONIZING_DEFAULT_COUNT = 100; // by default, blocks count in blocks downloading
     const size_t COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT = 1000;
 
+    /* Longest a long polling RPC request will wait for something to happen,
+       kept under the 30 second read timeout of our HTTP clients */
+    const uint64_t RPC_MAX_LONG_POLL_SECONDS = 20;
+
+    /* How many RPC requests of each kind may wait for a worker before we
+       start turning them away */
+    const uint32_t RPC_DEFAULT_MAX_QUEUED_REQUESTS = 64;
+
     const int P2P_DEFAULT_PORT = 17855;
 
     const int RPC_DEFAULT_PORT = 17856;
@@ -438,13 +448,38 @@ namespace CryptoNote
 
     // P2P Network Configuration Section - This defines our current P2P network version
     // and the minimum version for communication between nodes
-    const uint8_t P2P_CURRENT_VERSION = 17;
+    const uint8_t P2P_CURRENT_VERSION = 19;
 
     const uint8_t P2P_MINIMUM_VERSION = 16;
 
     // This defines the minimum P2P version required for lite blocks propogation
     const uint8_t P2P_LITE_BLOCKS_PROPOGATION_VERSION = 4;
 
+    // This defines the minimum P2P version required for transaction hash announcements,
+    // peers below it are still sent the full transaction blobs
+    const uint8_t P2P_TX_ANNOUNCE_VERSION = 18;
+
+    // This defines the minimum P2P version required for compact blocks, peers below it
+    // are sent lite blocks instead
+    const uint8_t P2P_COMPACT_BLOCKS_VERSION = 19;
+
+    // How long relayed transactions are held so their hashes can be announced in one batch
+    const uint32_t P2P_TX_ANNOUNCE_INTERVAL_MILLISECONDS = 250;
+
+    // Maximum number of transaction hashes in a single announcement
+    const size_t P2P_TX_ANNOUNCE_MAX_HASHES = 1000;
+
+    // How long we wait on a peer to deliver an announced transaction before
+    // requesting it from another peer which announces it
+    const uint32_t P2P_TX_REQUEST_TIMEOUT_SECONDS = 10;
+
+    // Messages at least this large are decoded on the large message decode threads rather
+    // than the P2P thread, so it isn't stalled by large block responses. Smaller messages,
+    // and all socket I/O, stay on the P2P thread.
+    const size_t P2P_DECODE_OFFLOAD_THRESHOLD = 64 * 1024; // 64 KB
+
+    const uint32_t P2P_DEFAULT_LARGE_MESSAGE_DECODE_THREADS = 2;
+
     // This defines the number of versions ahead we must see peers before we start displaying
     // warning messages that we need to upgrade our software.
     const uint8_t P2P_UPGRADE_WINDOW = 2;
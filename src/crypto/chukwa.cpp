@@ -0,0 +1,239 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "chukwa.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <new>
+
+#if defined(_MSC_VER) || defined(__MINGW32__)
+#include <malloc.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace Crypto
+{
+    namespace
+    {
+        /* Cache line alignment for the fallback allocation. Argon2 blocks are
+           1 KiB, so this also keeps every block within whole cache lines. */
+        const size_t CHUKWA_MEMORY_ALIGNMENT = 64;
+
+        const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+        std::once_flag argon2ImplSelected;
+
+        uint8_t *allocateHugePages(const size_t size)
+        {
+#if defined(_MSC_VER) || defined(__MINGW32__)
+            void *memory = VirtualAlloc(NULL, size, MEM_LARGE_PAGES | MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+
+            return static_cast<uint8_t *>(memory);
+#elif defined(MAP_HUGETLB)
+            void *memory = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+            return memory == MAP_FAILED ? nullptr : static_cast<uint8_t *>(memory);
+#else
+            return nullptr;
+#endif
+        }
+
+        void freeHugePages(uint8_t *memory, const size_t size)
+        {
+#if defined(_MSC_VER) || defined(__MINGW32__)
+            VirtualFree(memory, 0, MEM_RELEASE);
+#else
+            munmap(memory, size);
+#endif
+        }
+
+        uint8_t *allocateAligned(const size_t size)
+        {
+#if defined(_MSC_VER) || defined(__MINGW32__)
+            return static_cast<uint8_t *>(_aligned_malloc(size, CHUKWA_MEMORY_ALIGNMENT));
+#else
+            /* size is a multiple of the Argon2 block size, so also a multiple
+               of the alignment, as aligned_alloc requires */
+            return static_cast<uint8_t *>(std::aligned_alloc(CHUKWA_MEMORY_ALIGNMENT, size));
+#endif
+        }
+
+        void freeAligned(uint8_t *memory)
+        {
+#if defined(_MSC_VER) || defined(__MINGW32__)
+            _aligned_free(memory);
+#else
+            std::free(memory);
+#endif
+        }
+    } // namespace
+
+    ChukwaContext::ChukwaContext(const bool useHugePages):
+        m_memorySize(argon2_memory_size(CHUKWA_MEMORY, CHUKWA_THREADS))
+    {
+        /* The first time any context is made we need to have the Argon2
+           library check to see if any of the available CPU instruction sets
+           are going to help us out */
+        std::call_once(argon2ImplSelected, []() { argon2_select_impl(NULL, NULL); });
+
+        if (useHugePages)
+        {
+            m_allocatedSize = ((m_memorySize + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE;
+            m_memory = allocateHugePages(m_allocatedSize);
+            m_hugePages = m_memory != nullptr;
+        }
+
+        if (m_memory == nullptr)
+        {
+            m_allocatedSize = m_memorySize;
+            m_memory = allocateAligned(m_allocatedSize);
+        }
+
+        if (m_memory == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+    }
+
+    ChukwaContext::~ChukwaContext()
+    {
+        if (m_hugePages)
+        {
+            freeHugePages(m_memory, m_allocatedSize);
+        }
+        else
+        {
+            freeAligned(m_memory);
+        }
+    }
+
+    bool ChukwaContext::hash(const void *data, size_t length, Hash &hash)
+    {
+        uint8_t salt[CHUKWA_SALTLEN];
+        std::memcpy(salt, data, sizeof(salt));
+
+        /* Same parameters argon2id_hash_raw() would use, but with our memory */
+        argon2_context context = {};
+
+        context.out = hash.data;
+        context.outlen = CHUKWA_HASHLEN;
+        context.pwd = const_cast<uint8_t *>(static_cast<const uint8_t *>(data));
+        context.pwdlen = static_cast<uint32_t>(length);
+        context.salt = salt;
+        context.saltlen = CHUKWA_SALTLEN;
+        context.t_cost = CHUKWA_ITERS;
+        context.m_cost = CHUKWA_MEMORY;
+        context.lanes = CHUKWA_THREADS;
+        context.threads = CHUKWA_THREADS;
+        context.flags = ARGON2_DEFAULT_FLAGS;
+        context.version = ARGON2_VERSION_NUMBER;
+
+        return argon2_ctx_mem(&context, Argon2_id, m_memory, m_memorySize) == ARGON2_OK;
+    }
+
+    bool ChukwaContext::hugePages() const
+    {
+        return m_hugePages;
+    }
+
+    ChukwaContext &ChukwaContext::threadContext()
+    {
+        /* Like slow_hash_allocate_state(), try for a huge page and fall back
+           to regular memory if we can't get one */
+        static thread_local ChukwaContext context(true);
+
+        return context;
+    }
+
+    void chukwa_slow_hash(const void *data, size_t length, Hash &hash)
+    {
+        /* This is called through the block hashing table, which doesn't
+           expect exceptions, so don't let any out */
+        try
+        {
+            if (ChukwaContext::threadContext().hash(data, length, hash))
+            {
+                return;
+            }
+        }
+        /* Can't get the memory for this thread's context */
+        catch (const std::bad_alloc &)
+        {
+        }
+
+        /* Have Argon2 find its own memory instead */
+        uint8_t salt[CHUKWA_SALTLEN];
+        std::memcpy(salt, data, sizeof(salt));
+
+        const int result = argon2id_hash_raw(
+            CHUKWA_ITERS, CHUKWA_MEMORY, CHUKWA_THREADS, data, length, salt, CHUKWA_SALTLEN, hash.data, CHUKWA_HASHLEN);
+
+        if (result != ARGON2_OK)
+        {
+            /* The largest hash there is, which fails any real difficulty
+               check, so the block is rejected rather than accepted on
+               whatever was left in hash */
+            std::memset(hash.data, 0xff, sizeof(hash.data));
+        }
+    }
+
+    bool chukwa_slow_hash_batch(
+        const std::vector<ChukwaInput> &inputs,
+        std::vector<Hash> &hashes,
+        const ChukwaExecutor &executor,
+        const size_t threadCount)
+    {
+        hashes.resize(inputs.size());
+
+        /* A few jobs per thread, so one slow thread doesn't hold up the batch */
+        const size_t jobCount = std::min<size_t>(inputs.size(), std::max<size_t>(1, threadCount * 4));
+
+        std::vector<std::future<bool>> jobs;
+
+        for (size_t job = 0; job < jobCount; job++)
+        {
+            const size_t begin = inputs.size() * job / jobCount;
+            const size_t end = inputs.size() * (job + 1) / jobCount;
+
+            jobs.push_back(executor([&inputs, &hashes, begin, end]() {
+                try
+                {
+                    ChukwaContext &context = ChukwaContext::threadContext();
+
+                    for (size_t i = begin; i < end; i++)
+                    {
+                        if (!context.hash(inputs[i].data, inputs[i].length, hashes[i]))
+                        {
+                            return false;
+                        }
+                    }
+
+                    return true;
+                }
+                /* Can't get the memory for this thread's context */
+                catch (const std::bad_alloc &)
+                {
+                    return false;
+                }
+            }));
+        }
+
+        /* Wait for every job, even after a failure, since they all refer to
+           inputs and hashes */
+        bool success = true;
+
+        for (auto &job : jobs)
+        {
+            success = job.get() && success;
+        }
+
+        return success;
+    }
+} // namespace Crypto
@@ -0,0 +1,76 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "hash.h"
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <vector>
+
+namespace Crypto
+{
+    /* Owns the Argon2 working memory needed to compute a Chukwa hash, so it
+       can be reused across hashes rather than allocated and freed for each
+       one. The memory is aligned, and backed by a huge page if requested and
+       the OS can provide one. A context must only be used by one thread at
+       a time. */
+    class ChukwaContext
+    {
+      public:
+        explicit ChukwaContext(const bool useHugePages = false);
+
+        ~ChukwaContext();
+
+        ChukwaContext(const ChukwaContext &) = delete;
+
+        ChukwaContext &operator=(const ChukwaContext &) = delete;
+
+        /* Returns false if Argon2 failed, in which case hash is not valid */
+        bool hash(const void *data, size_t length, Hash &hash);
+
+        bool hugePages() const;
+
+        /* The context belonging to the calling thread, created on first use.
+           This is what chukwa_slow_hash() uses. */
+        static ChukwaContext &threadContext();
+
+      private:
+        uint8_t *m_memory = nullptr;
+
+        size_t m_memorySize = 0;
+
+        size_t m_allocatedSize = 0;
+
+        bool m_hugePages = false;
+    };
+
+    /* A single input to chukwa_slow_hash_batch() */
+    struct ChukwaInput
+    {
+        const void *data;
+
+        size_t length;
+    };
+
+    /* Runs a job on another thread, returning a future for its result. Given
+       to chukwa_slow_hash_batch() so it can run on whatever pool the caller
+       already has. */
+    typedef std::function<std::future<bool>(std::function<bool()> job)> ChukwaExecutor;
+
+    /* Hashes several independent inputs using executor, split into a few
+       jobs per thread the executor runs on. Each thread uses its own thread
+       context, which lives as long as the thread, so keep the threads around
+       between batches rather than making new ones per call. hashes is resized
+       to the number of inputs, with hashes[i] being the hash of inputs[i].
+       Returns false if any of the hashes failed, in which case none of them
+       should be trusted. */
+    bool chukwa_slow_hash_batch(
+        const std::vector<ChukwaInput> &inputs,
+        std::vector<Hash> &hashes,
+        const ChukwaExecutor &executor,
+        const size_t threadCount);
+} // namespace Crypto
@@ -0,0 +1,85 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "siphash.h"
+
+namespace Crypto
+{
+    namespace
+    {
+        inline uint64_t rotl(const uint64_t x, const int b)
+        {
+            return (x << b) | (x >> (64 - b));
+        }
+
+        inline void sipRound(uint64_t &v0, uint64_t &v1, uint64_t &v2, uint64_t &v3)
+        {
+            v0 += v1;
+            v1 = rotl(v1, 13);
+            v1 ^= v0;
+            v0 = rotl(v0, 32);
+            v2 += v3;
+            v3 = rotl(v3, 16);
+            v3 ^= v2;
+            v0 += v3;
+            v3 = rotl(v3, 21);
+            v3 ^= v0;
+            v2 += v1;
+            v1 = rotl(v1, 17);
+            v1 ^= v2;
+            v2 = rotl(v2, 32);
+        }
+
+        inline uint64_t readLittleEndian(const uint8_t *p, const size_t length)
+        {
+            uint64_t value = 0;
+
+            for (size_t i = 0; i < length; i++)
+            {
+                value |= static_cast<uint64_t>(p[i]) << (8 * i);
+            }
+
+            return value;
+        }
+    } // namespace
+
+    uint64_t siphash24(const void *data, size_t length, uint64_t k0, uint64_t k1)
+    {
+        const uint8_t *in = static_cast<const uint8_t *>(data);
+
+        uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+        uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+        uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+        uint64_t v3 = 0x7465646279746573ULL ^ k1;
+
+        const size_t blocks = length / 8;
+
+        for (size_t i = 0; i < blocks; i++)
+        {
+            const uint64_t m = readLittleEndian(in + i * 8, 8);
+
+            v3 ^= m;
+            sipRound(v0, v1, v2, v3);
+            sipRound(v0, v1, v2, v3);
+            v0 ^= m;
+        }
+
+        /* The remaining bytes, with the length in the top byte */
+        const uint64_t last = (static_cast<uint64_t>(length) << 56) | readLittleEndian(in + blocks * 8, length % 8);
+
+        v3 ^= last;
+        sipRound(v0, v1, v2, v3);
+        sipRound(v0, v1, v2, v3);
+        v0 ^= last;
+
+        v2 ^= 0xff;
+
+        for (int i = 0; i < 4; i++)
+        {
+            sipRound(v0, v1, v2, v3);
+        }
+
+        return v0 ^ v1 ^ v2 ^ v3;
+    }
+} // namespace Crypto
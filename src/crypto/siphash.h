@@ -0,0 +1,17 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Crypto
+{
+    /* SipHash-2-4 of data, keyed with k0 and k1. It's fast and keyed, so is
+       good for short identifiers which an attacker shouldn't be able to
+       choose collisions for without knowing the key. It is not a
+       cryptographic hash in the sense of cn_fast_hash(). */
+    uint64_t siphash24(const void *data, size_t length, uint64_t k0, uint64_t k1);
+} // namespace Crypto
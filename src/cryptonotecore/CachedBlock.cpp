@@ -65,13 +65,16 @@ const Crypto::Hash &CachedBlock::getBlockLongHash() const
                                                       ? getBlockHashingBinaryArray()
                                                       : getParentBlockHashingBinaryArray(true);
 
-    blockLongHash = Hash();
-
     try
     {
         const auto hashingAlgorithm = CryptoNote::HASHING_ALGORITHMS_BY_BLOCK_VERSION.at(block.majorVersion);
 
-        hashingAlgorithm(rawHashingBlock.data(), rawHashingBlock.size(), blockLongHash.get());
+        /* Only memoise the hash once it's actually been computed */
+        Hash hash;
+
+        hashingAlgorithm(rawHashingBlock.data(), rawHashingBlock.size(), hash);
+
+        blockLongHash = hash;
 
         return blockLongHash.get();
     }
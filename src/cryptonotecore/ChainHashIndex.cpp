@@ -0,0 +1,294 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "ChainHashIndex.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+
+namespace CryptoNote
+{
+    namespace
+    {
+        const char SNAPSHOT_MAGIC[8] = {'W', 'R', 'K', 'Z', 'B', 'H', 'I', '1'};
+
+        /* Magic, then the number of hashes */
+        const size_t SNAPSHOT_HEADER_SIZE = sizeof(SNAPSHOT_MAGIC) + sizeof(uint64_t);
+
+        const size_t MIN_CAPACITY = 1024;
+    } // namespace
+
+    ChainHashIndex::ChainHashIndex()
+    {
+        clearUnlocked();
+    }
+
+    void ChainHashIndex::push(const Crypto::Hash &hash)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        /* Keep the table at most half full, so probes stay short */
+        if ((m_hashes.size() + 1) * 2 > m_slots.size())
+        {
+            rehash(m_slots.size() * 2);
+        }
+
+        m_hashes.push_back(hash);
+
+        insertSlot(static_cast<uint32_t>(m_hashes.size() - 1));
+    }
+
+    void ChainHashIndex::truncate(const uint32_t count)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        truncateUnlocked(count);
+    }
+
+    void ChainHashIndex::clear()
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        clearUnlocked();
+    }
+
+    std::optional<uint32_t> ChainHashIndex::find(const Crypto::Hash &hash) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        const uint32_t hashTag = tag(hash);
+
+        for (size_t position = homeSlot(hash); m_slots[position].index != 0; position = (position + 1) & m_mask)
+        {
+            const Slot &slot = m_slots[position];
+
+            if (slot.tag == hashTag && m_hashes[slot.index - 1] == hash)
+            {
+                return slot.index - 1;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    Crypto::Hash ChainHashIndex::getHash(const uint32_t index) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        return m_hashes.at(index);
+    }
+
+    std::vector<Crypto::Hash> ChainHashIndex::getHashes(const uint32_t startIndex, const uint32_t count) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        if (startIndex >= m_hashes.size())
+        {
+            return {};
+        }
+
+        const size_t end = std::min<size_t>(m_hashes.size(), static_cast<size_t>(startIndex) + count);
+
+        return std::vector<Crypto::Hash>(m_hashes.begin() + startIndex, m_hashes.begin() + end);
+    }
+
+    uint32_t ChainHashIndex::size() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        return static_cast<uint32_t>(m_hashes.size());
+    }
+
+    bool ChainHashIndex::load(const std::string &filename)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        clearUnlocked();
+
+        std::ifstream file(filename, std::ios::binary);
+
+        if (!file)
+        {
+            return false;
+        }
+
+        char magic[sizeof(SNAPSHOT_MAGIC)];
+        uint64_t count;
+
+        file.read(magic, sizeof(magic));
+        file.read(reinterpret_cast<char *>(&count), sizeof(count));
+
+        if (!file || std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+        {
+            return false;
+        }
+
+        file.seekg(0, std::ios::end);
+
+        const uint64_t size = static_cast<uint64_t>(file.tellg());
+
+        if (size != SNAPSHOT_HEADER_SIZE + count * sizeof(Crypto::Hash))
+        {
+            return false;
+        }
+
+        file.seekg(SNAPSHOT_HEADER_SIZE, std::ios::beg);
+
+        try
+        {
+            m_hashes.resize(count);
+        }
+        catch (const std::exception &)
+        {
+            clearUnlocked();
+            return false;
+        }
+
+        file.read(reinterpret_cast<char *>(m_hashes.data()), count * sizeof(Crypto::Hash));
+
+        if (!file)
+        {
+            clearUnlocked();
+            return false;
+        }
+
+        size_t capacity = MIN_CAPACITY;
+
+        while (capacity < count * 2)
+        {
+            capacity *= 2;
+        }
+
+        rehash(capacity);
+
+        return true;
+    }
+
+    bool ChainHashIndex::save(const std::string &filename) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        const std::string temporaryFilename = filename + ".tmp";
+
+        {
+            std::ofstream file(temporaryFilename, std::ios::binary | std::ios::trunc);
+
+            const uint64_t count = m_hashes.size();
+
+            file.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+            file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+            file.write(reinterpret_cast<const char *>(m_hashes.data()), count * sizeof(Crypto::Hash));
+
+            if (!file)
+            {
+                return false;
+            }
+        }
+
+        std::remove(filename.c_str());
+
+        return std::rename(temporaryFilename.c_str(), filename.c_str()) == 0;
+    }
+
+    void ChainHashIndex::clearUnlocked()
+    {
+        m_hashes.clear();
+        m_slots.assign(MIN_CAPACITY, Slot {0, 0});
+        m_mask = MIN_CAPACITY - 1;
+    }
+
+    void ChainHashIndex::truncateUnlocked(const uint32_t count)
+    {
+        while (m_hashes.size() > count)
+        {
+            const uint32_t index = static_cast<uint32_t>(m_hashes.size() - 1);
+
+            size_t position = homeSlot(m_hashes[index]);
+
+            while (m_slots[position].index != index + 1)
+            {
+                position = (position + 1) & m_mask;
+            }
+
+            eraseSlot(position);
+
+            m_hashes.pop_back();
+        }
+    }
+
+    size_t ChainHashIndex::homeSlot(const Crypto::Hash &hash) const
+    {
+        /* Block hashes are already uniformly distributed */
+        uint64_t value;
+        std::memcpy(&value, hash.data, sizeof(value));
+
+        return static_cast<size_t>(value) & m_mask;
+    }
+
+    uint32_t ChainHashIndex::tag(const Crypto::Hash &hash)
+    {
+        uint32_t value;
+        std::memcpy(&value, hash.data + sizeof(uint64_t), sizeof(value));
+
+        return value;
+    }
+
+    void ChainHashIndex::insertSlot(const uint32_t index)
+    {
+        size_t position = homeSlot(m_hashes[index]);
+
+        while (m_slots[position].index != 0)
+        {
+            position = (position + 1) & m_mask;
+        }
+
+        m_slots[position] = Slot {tag(m_hashes[index]), index + 1};
+    }
+
+    void ChainHashIndex::eraseSlot(size_t position)
+    {
+        /* Shift back any following entries which would no longer be
+           reachable from their home slot, rather than leaving a tombstone */
+        size_t next = position;
+
+        while (true)
+        {
+            next = (next + 1) & m_mask;
+
+            if (m_slots[next].index == 0)
+            {
+                break;
+            }
+
+            const size_t home = homeSlot(m_hashes[m_slots[next].index - 1]);
+
+            /* The entry can stay if its home lies cyclically in (position, next] */
+            const bool reachable =
+                position <= next ? (position < home && home <= next) : (position < home || home <= next);
+
+            if (!reachable)
+            {
+                m_slots[position] = m_slots[next];
+                position = next;
+            }
+        }
+
+        m_slots[position] = Slot {0, 0};
+    }
+
+    void ChainHashIndex::rehash(const size_t capacity)
+    {
+        m_slots.assign(capacity, Slot {0, 0});
+        m_mask = capacity - 1;
+
+        for (uint32_t i = 0; i < m_hashes.size(); i++)
+        {
+            insertSlot(i);
+        }
+    }
+} // namespace CryptoNote
@@ -0,0 +1,89 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <CryptoTypes.h>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace CryptoNote
+{
+    /* An in memory index of the main chain's block hashes, by height and by
+       hash, so looking either up never touches the database.
+
+       Hashes are kept in height order, and an open addressing table maps
+       each hash to its height. Table slots hold only a 4 byte tag from the
+       hash and the height, so a match on the tag is checked against the
+       full hash before it's trusted. Blocks are only ever added to or
+       removed from the top, like the chain itself.
+
+       The index is updated by the core as blocks are added or removed while
+       RPC threads read it, so every public method takes the lock itself. */
+    class ChainHashIndex
+    {
+      public:
+        ChainHashIndex();
+
+        /* Adds the hash of the block at height size() */
+        void push(const Crypto::Hash &hash);
+
+        /* Removes every block at count and above */
+        void truncate(uint32_t count);
+
+        void clear();
+
+        std::optional<uint32_t> find(const Crypto::Hash &hash) const;
+
+        /* Returned by value, as a push may reallocate the storage under a
+           reference once the lock is released */
+        Crypto::Hash getHash(uint32_t index) const;
+
+        /* Up to count hashes starting at startIndex, under a single lock */
+        std::vector<Crypto::Hash> getHashes(uint32_t startIndex, uint32_t count) const;
+
+        uint32_t size() const;
+
+        /* Replaces the contents with a snapshot written by save(). Returns
+           false if there is no valid snapshot. */
+        bool load(const std::string &filename);
+
+        /* Writes the hashes to filename, via a temporary file so a failed
+           write doesn't leave a broken snapshot behind */
+        bool save(const std::string &filename) const;
+
+      private:
+        struct Slot
+        {
+            uint32_t tag;
+
+            /* Height + 1, 0 if the slot is empty */
+            uint32_t index;
+        };
+
+        void clearUnlocked();
+
+        void truncateUnlocked(uint32_t count);
+
+        size_t homeSlot(const Crypto::Hash &hash) const;
+
+        static uint32_t tag(const Crypto::Hash &hash);
+
+        void insertSlot(uint32_t index);
+
+        void eraseSlot(size_t position);
+
+        void rehash(size_t capacity);
+
+        std::vector<Crypto::Hash> m_hashes;
+
+        std::vector<Slot> m_slots;
+
+        size_t m_mask;
+
+        mutable std::shared_mutex m_mutex;
+    };
+} // namespace CryptoNote
@@ -12,6 +12,7 @@
 #include <common/FileSystemShim.h>
 #include <common/Math.h>
 #include <common/MemoryInputStream.h>
+#include <common/Metrics.h>
 #include <common/ShuffleGenerator.h>
 #include <common/TransactionExtra.h>
 #include <config/Constants.h>
@@ -200,6 +201,34 @@ namespace CryptoNote
 
         const std::chrono::seconds OUTDATED_TRANSACTION_POLLING_INTERVAL = std::chrono::seconds(60);
 
+        /* Prints as "index (hash)", but only when a message it is part of
+           actually gets logged */
+        struct BlockDescription
+        {
+            uint32_t index;
+
+            const Crypto::Hash &hash;
+        };
+
+        Metrics::Histogram &addBlockStageSeconds(const std::string &stage)
+        {
+            return Metrics::Registry::instance().histogram(
+                "wrkzd_add_block_stage_seconds",
+                "Time taken by each stage of adding a block",
+                Metrics::label("stage", stage));
+        }
+
+        std::ostream &operator<<(std::ostream &os, const BlockDescription &block)
+        {
+            /* The hash is hexified before the stream gets a chance to skip it */
+            if (!os)
+            {
+                return os;
+            }
+
+            return os << block.index << " (" << block.hash << ")";
+        }
+
     } // namespace
 
     Core::Core(
@@ -321,6 +350,11 @@ namespace CryptoNote
         return findSegmentContainingBlock(blockHash) != nullptr;
     }
 
+    bool Core::isInCheckpointZone(const uint32_t blockIndex) const
+    {
+        return checkpoints.isInCheckpointZone(blockIndex);
+    }
+
     BlockTemplate Core::getBlockByIndex(uint32_t index) const
     {
         assert(!chainsStorage.empty());
@@ -1128,14 +1162,12 @@ namespace CryptoNote
         throwIfNotInitialized();
         uint32_t blockIndex = cachedBlock.getBlockIndex();
         Crypto::Hash blockHash = cachedBlock.getBlockHash();
-        std::ostringstream os;
-        os << blockIndex << " (" << blockHash << ")";
-        std::string blockStr = os.str();
+        const BlockDescription blockDescription {blockIndex, blockHash};
 
-        logger(Logging::DEBUGGING) << "Request to add block " << blockStr;
+        logger(Logging::DEBUGGING) << "Request to add block " << blockDescription;
         if (hasBlock(cachedBlock.getBlockHash()))
         {
-            logger(Logging::DEBUGGING) << "Block " << blockStr << " already exists";
+            logger(Logging::DEBUGGING) << "Block " << blockDescription << " already exists";
             return error::AddBlockErrorCode::ALREADY_EXISTS;
         }
 
@@ -1147,18 +1179,29 @@ namespace CryptoNote
         auto cache = findSegmentContainingBlock(previousBlockHash);
         if (cache == nullptr)
         {
-            logger(Logging::DEBUGGING) << "Block " << blockStr << " rejected as orphaned";
+            logger(Logging::DEBUGGING) << "Block " << blockDescription << " rejected as orphaned";
             return error::AddBlockErrorCode::REJECTED_AS_ORPHANED;
         }
 
+        static auto &deserializeSeconds = addBlockStageSeconds("deserialize");
+        static auto &validateSeconds = addBlockStageSeconds("validate");
+        static auto &storeSeconds = addBlockStageSeconds("store");
+
+        const auto deserializeStart = std::chrono::steady_clock::now();
+
         std::vector<CachedTransaction> transactions;
         uint64_t cumulativeSize = 0;
         if (!extractTransactions(rawBlock.transactions, transactions, cumulativeSize))
         {
-            logger(Logging::DEBUGGING) << "Couldn't deserialize raw block transactions in block " << blockStr;
+            logger(Logging::DEBUGGING) << "Couldn't deserialize raw block transactions in block " << blockDescription;
             return error::AddBlockErrorCode::DESERIALIZATION_FAILED;
         }
 
+        deserializeSeconds.observeSince(deserializeStart);
+
+        /* Observed however validation ends */
+        Metrics::ScopedTimer validateTimer(validateSeconds);
+
         auto coinbaseTransactionSize = getObjectBinarySize(blockTemplate.baseTransaction);
         assert(coinbaseTransactionSize < std::numeric_limits<decltype(coinbaseTransactionSize)>::max());
         auto cumulativeBlockSize = coinbaseTransactionSize + cumulativeSize;
@@ -1170,7 +1213,7 @@ namespace CryptoNote
         auto maxBlockCumulativeSize = currency.maxBlockCumulativeSize(previousBlockIndex + 1);
         if (cumulativeBlockSize > maxBlockCumulativeSize)
         {
-            logger(Logging::DEBUGGING) << "Block " << blockStr << " has too big cumulative size";
+            logger(Logging::DEBUGGING) << "Block " << blockDescription << " has too big cumulative size";
             return error::BlockValidationError::CUMULATIVE_BLOCK_SIZE_TOO_BIG;
         }
 
@@ -1178,7 +1221,7 @@ namespace CryptoNote
         auto blockValidationResult = validateBlock(cachedBlock, cache, minerReward);
         if (blockValidationResult)
         {
-            logger(Logging::DEBUGGING) << "Failed to validate block " << blockStr << ": "
+            logger(Logging::DEBUGGING) << "Failed to validate block " << blockDescription << ": "
                                        << blockValidationResult.message();
             return blockValidationResult;
         }
@@ -1186,7 +1229,7 @@ namespace CryptoNote
         auto currentDifficulty = cache->getDifficultyForNextBlock(previousBlockIndex);
         if (currentDifficulty == 0)
         {
-            logger(Logging::DEBUGGING) << "Block " << blockStr << " has difficulty overhead";
+            logger(Logging::DEBUGGING) << "Block " << blockDescription << " has difficulty overhead";
             return error::BlockValidationError::DIFFICULTY_OVERHEAD;
         }
 
@@ -1281,13 +1324,13 @@ namespace CryptoNote
                 reward,
                 emissionChange))
         {
-            logger(Logging::DEBUGGING) << "Block " << blockStr << " has too big cumulative size";
+            logger(Logging::DEBUGGING) << "Block " << blockDescription << " has too big cumulative size";
             return error::BlockValidationError::CUMULATIVE_BLOCK_SIZE_TOO_BIG;
         }
 
         if (minerReward != reward)
         {
-            logger(Logging::DEBUGGING) << "Block reward mismatch for block " << blockStr
+            logger(Logging::DEBUGGING) << "Block reward mismatch for block " << blockDescription
                                        << ". Expected reward: " << reward << ", got reward: " << minerReward;
             return error::BlockValidationError::BLOCK_REWARD_MISMATCH;
         }
@@ -1296,16 +1339,20 @@ namespace CryptoNote
         {
             if (!checkpoints.checkBlock(cachedBlock.getBlockIndex(), cachedBlock.getBlockHash()))
             {
-                logger(Logging::WARNING) << "Checkpoint block hash mismatch for block " << blockStr;
+                logger(Logging::WARNING) << "Checkpoint block hash mismatch for block " << blockDescription;
                 return error::BlockValidationError::CHECKPOINT_BLOCK_HASH_MISMATCH;
             }
         }
         else if (!currency.checkProofOfWork(cachedBlock, currentDifficulty))
         {
-            logger(Logging::DEBUGGING) << "Proof of work too weak for block " << blockStr;
+            logger(Logging::DEBUGGING) << "Proof of work too weak for block " << blockDescription;
             return error::BlockValidationError::PROOF_OF_WORK_TOO_WEAK;
         }
 
+        validateTimer.stop();
+
+        Metrics::ScopedTimer storeTimer(storeSeconds);
+
         auto ret = error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE;
 
         if (addOnTop)
@@ -1335,10 +1382,10 @@ namespace CryptoNote
                     checkAndRemoveInvalidPoolTransactions(validatorState);
 
                     ret = error::AddBlockErrorCode::ADDED_TO_MAIN;
-                    logger(Logging::DEBUGGING) << "Block " << blockStr << " added to main chain.";
+                    logger(Logging::DEBUGGING) << "Block " << blockDescription << " added to main chain.";
                     if ((previousBlockIndex + 1) % 100 == 0)
                     {
-                        logger(Logging::INFO) << "Block " << blockStr << " added to main chain";
+                        logger(Logging::INFO) << "Block " << blockDescription << " added to main chain";
                     }
 
                     notifyObservers(
@@ -1354,7 +1401,7 @@ namespace CryptoNote
                         emissionChange,
                         currentDifficulty,
                         std::move(rawBlock));
-                    logger(Logging::DEBUGGING) << "Block " << blockStr << " added to alternative chain.";
+                    logger(Logging::DEBUGGING) << "Block " << blockDescription << " added to alternative chain.";
 
                     auto mainChainCache = chainsLeaves[0];
                     if (cache->getCurrentCumulativeDifficulty() > mainChainCache->getCurrentCumulativeDifficulty())
@@ -1377,7 +1424,7 @@ namespace CryptoNote
 
                         ret = error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE_AND_SWITCHED;
 
-                        logger(Logging::INFO) << "Resolved: " << blockStr
+                        logger(Logging::INFO) << "Resolved: " << blockDescription
                                               << ", Previous: " << chainsLeaves[endpointIndex]->getTopBlockIndex()
                                               << " (" << chainsLeaves[endpointIndex]->getTopBlockHash() << ")";
                     }
@@ -1394,7 +1441,7 @@ namespace CryptoNote
                 chainsStorage.emplace_back(std::move(newCache));
                 chainsLeaves.push_back(newlyForkedChainPtr);
 
-                logger(Logging::DEBUGGING) << "Resolving: " << blockStr;
+                logger(Logging::DEBUGGING) << "Resolving: " << blockDescription;
 
                 newlyForkedChainPtr->pushBlock(
                     cachedBlock,
@@ -1411,7 +1458,7 @@ namespace CryptoNote
         }
         else
         {
-            logger(Logging::DEBUGGING) << "Resolving: " << blockStr;
+            logger(Logging::DEBUGGING) << "Resolving: " << blockDescription;
 
             auto upperSegment = cache->split(previousBlockIndex + 1);
             //[cache] is lower segment now
@@ -1450,7 +1497,9 @@ namespace CryptoNote
             updateMainChainSet();
         }
 
-        logger(Logging::DEBUGGING) << "Block: " << blockStr << " successfully added";
+        storeTimer.stop();
+
+        logger(Logging::DEBUGGING) << "Block: " << blockDescription << " successfully added";
         notifyOnSuccess(ret, previousBlockIndex, cachedBlock, *cache);
 
         return ret;
@@ -60,6 +60,8 @@ namespace CryptoNote
 
         virtual bool hasBlock(const Crypto::Hash &blockHash) const override;
 
+        virtual bool isInCheckpointZone(const uint32_t blockIndex) const override;
+
         virtual BlockTemplate getBlockByIndex(uint32_t index) const override;
 
         virtual BlockTemplate getBlockByHash(const Crypto::Hash &blockHash) const override;
@@ -39,7 +39,18 @@ namespace CryptoNote
             return false;
         }
 
-        r = derive_public_key(recv_derivation, real_output_index, ack.address.spendPublicKey, in_ephemeral.publicKey);
+        return generate_key_image_helper(ack, recv_derivation, real_output_index, in_ephemeral, ki);
+    }
+
+    bool generate_key_image_helper(
+        const AccountKeys &ack,
+        const KeyDerivation &recv_derivation,
+        size_t real_output_index,
+        KeyPair &in_ephemeral,
+        KeyImage &ki)
+    {
+        bool r =
+            derive_public_key(recv_derivation, real_output_index, ack.address.spendPublicKey, in_ephemeral.publicKey);
 
         assert(r && "key image helper: failed to derive_public_key");
 
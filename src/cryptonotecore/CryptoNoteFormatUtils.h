@@ -49,6 +49,15 @@ namespace CryptoNote
         KeyPair &in_ephemeral,
         Crypto::KeyImage &ki);
 
+    /* As above, with the derivation of the transaction key already computed,
+       for when it's needed for several outputs of the same transaction */
+    bool generate_key_image_helper(
+        const AccountKeys &ack,
+        const Crypto::KeyDerivation &recv_derivation,
+        size_t real_output_index,
+        KeyPair &in_ephemeral,
+        Crypto::KeyImage &ki);
+
     bool checkInputTypesSupported(const TransactionPrefix &tx);
 
     bool checkOutsValid(const TransactionPrefix &tx, std::string *error = nullptr);
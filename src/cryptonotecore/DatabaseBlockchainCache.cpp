@@ -548,11 +548,13 @@ namespace CryptoNote
         const Currency &curr,
         IDataBase &dataBase,
         IBlockchainCacheFactory &blockchainCacheFactory,
-        std::shared_ptr<Logging::ILogger> _logger):
+        std::shared_ptr<Logging::ILogger> _logger,
+        const std::string &blockHashIndexFile):
         currency(curr),
         database(dataBase),
         blockchainCacheFactory(blockchainCacheFactory),
-        logger(_logger, "DatabaseBlockchainCache")
+        logger(_logger, "DatabaseBlockchainCache"),
+        blockHashIndexFile(blockHashIndexFile)
     {
         DatabaseVersionReadBatch readBatch;
         auto ec = database.read(readBatch);
@@ -734,6 +736,11 @@ namespace CryptoNote
 
         cutTail(unitsCache, currentTop + 1 - splitBlockIndex);
 
+        if (blockHashIndexLoaded)
+        {
+            blockHashIndex.truncate(splitBlockIndex);
+        }
+
         children.push_back(cache.get());
         logger(Logging::TRACE) << "Delete successfull";
 
@@ -755,6 +762,8 @@ namespace CryptoNote
         {
             logger(Logging::TRACE) << "DatabaseBlockchainCache::rewind height=" << std::to_string(height) << " calling database.recreate()";
             database.recreate();
+            blockHashIndex.clear();
+            blockHashIndexLoaded = false;
             return;
         }
 
@@ -866,6 +875,12 @@ namespace CryptoNote
 
         /* Remove cached blocks */
         cutTail(unitsCache, currentTop + 1 - height);
+
+        if (blockHashIndexLoaded)
+        {
+            blockHashIndex.truncate(static_cast<uint32_t>(height));
+        }
+
         children.push_back(cache.get());
         logger(Logging::TRACE) << "Delete successful";
 
@@ -1301,6 +1316,11 @@ namespace CryptoNote
         topBlockHash = cachedBlock.getBlockHash();
         logger(Logging::DEBUGGING) << "push block " << cachedBlock.getBlockHash() << " completed";
 
+        if (blockHashIndexLoaded)
+        {
+            blockHashIndex.push(cachedBlock.getBlockHash());
+        }
+
         unitsCache.push_back(blockInfo);
         if (unitsCache.size() > unitsCacheSize)
         {
@@ -1511,6 +1531,11 @@ namespace CryptoNote
 
     bool DatabaseBlockchainCache::hasBlock(const Crypto::Hash &blockHash) const
     {
+        if (blockHashIndexLoaded)
+        {
+            return blockHashIndex.find(blockHash).has_value();
+        }
+
         auto batch = BlockchainReadBatch().requestBlockIndexByBlockHash(blockHash);
         auto result = database.read(batch);
         return !result && batch.extractResult().getBlockIndexesByBlockHashes().count(blockHash);
@@ -1523,6 +1548,18 @@ namespace CryptoNote
             return getTopBlockIndex();
         }
 
+        if (blockHashIndexLoaded)
+        {
+            const auto index = blockHashIndex.find(blockHash);
+
+            if (!index)
+            {
+                throw std::out_of_range("Block hash not found in the main chain");
+            }
+
+            return *index;
+        }
+
         auto batch = BlockchainReadBatch().requestBlockIndexByBlockHash(blockHash);
         auto result = readDatabase(batch);
         return result.getBlockIndexesByBlockHashes().at(blockHash);
@@ -1766,6 +1803,11 @@ namespace CryptoNote
             return getTopBlockHash();
         }
 
+        if (blockHashIndexLoaded)
+        {
+            return blockHashIndex.getHash(blockIndex);
+        }
+
         auto batch = BlockchainReadBatch().requestCachedBlock(blockIndex);
         auto result = readDatabase(batch);
         return result.getCachedBlocks().at(blockIndex).blockHash;
@@ -1782,6 +1824,11 @@ namespace CryptoNote
             return {};
         }
 
+        if (blockHashIndexLoaded)
+        {
+            return blockHashIndex.getHashes(startIndex, count);
+        }
+
         BlockchainReadBatch request;
         auto index = startIndex;
         try {
@@ -1937,9 +1984,75 @@ namespace CryptoNote
         return children.size();
     }
 
-    void DatabaseBlockchainCache::save() {}
+    void DatabaseBlockchainCache::save()
+    {
+        if (blockHashIndexLoaded && !blockHashIndexFile.empty())
+        {
+            if (!blockHashIndex.save(blockHashIndexFile))
+            {
+                logger(Logging::WARNING) << "Failed to save block hash index to " << blockHashIndexFile;
+            }
+        }
+    }
+
+    void DatabaseBlockchainCache::load()
+    {
+        loadBlockHashIndex();
+    }
+
+    void DatabaseBlockchainCache::loadBlockHashIndex()
+    {
+        blockHashIndexLoaded = false;
+
+        const uint32_t blockCount = getBlockCount();
+
+        if (blockHashIndexFile.empty() || !blockHashIndex.load(blockHashIndexFile))
+        {
+            blockHashIndex.clear();
+        }
+
+        blockHashIndex.truncate(blockCount);
+
+        /* Each block commits to the hash of the one before it, so if the top
+           of the snapshot matches the database, everything below does too */
+        if (blockHashIndex.size() != 0)
+        {
+            const uint32_t top = blockHashIndex.size() - 1;
+
+            auto batch = BlockchainReadBatch().requestCachedBlock(top);
+            auto result = readDatabase(batch);
+
+            if (result.getCachedBlocks().at(top).blockHash != blockHashIndex.getHash(top))
+            {
+                logger(Logging::INFO) << "Block hash index snapshot doesn't match the database, rebuilding it";
+                blockHashIndex.clear();
+            }
+        }
+
+        if (blockHashIndex.size() < blockCount)
+        {
+            logger(Logging::INFO) << "Indexing block hashes from height " << blockHashIndex.size() << "...";
+        }
+
+        const uint32_t batchSize = 10000;
+
+        while (blockHashIndex.size() < blockCount)
+        {
+            const auto hashes = getBlockHashes(blockHashIndex.size(), batchSize);
+
+            if (hashes.empty())
+            {
+                throw std::runtime_error("Failed to read block hashes while building the block hash index");
+            }
+
+            for (const auto &hash : hashes)
+            {
+                blockHashIndex.push(hash);
+            }
+        }
 
-    void DatabaseBlockchainCache::load() {}
+        blockHashIndexLoaded = true;
+    }
 
     std::vector<BinaryArray> DatabaseBlockchainCache::getRawTransactions(
         const std::vector<Crypto::Hash> &transactions,
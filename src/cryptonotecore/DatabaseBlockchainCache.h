@@ -23,6 +23,8 @@
 #include "cryptonotecore/UpgradeManager.h"
 
 #include <IDataBase.h>
+#include <atomic>
+#include <cryptonotecore/ChainHashIndex.h>
 #include <cryptonotecore/BlockchainReadBatch.h>
 #include <cryptonotecore/BlockchainWriteBatch.h>
 #include <cryptonotecore/DatabaseCacheData.h>
@@ -51,7 +53,8 @@ namespace CryptoNote
             const Currency &currency,
             IDataBase &dataBase,
             IBlockchainCacheFactory &blockchainCacheFactory,
-            std::shared_ptr<Logging::ILogger> logger);
+            std::shared_ptr<Logging::ILogger> logger,
+            const std::string &blockHashIndexFile = "");
 
         static bool checkDBSchemeVersion(IDataBase &dataBase, std::shared_ptr<Logging::ILogger> logger);
 
@@ -260,6 +263,18 @@ namespace CryptoNote
 
         const size_t unitsCacheSize = 1000;
 
+        /* Every main chain block hash, once load() has built it. Until then
+           lookups by hash or height go to the database. */
+        ChainHashIndex blockHashIndex;
+
+        /* Read by RPC threads without the core's lock */
+        std::atomic<bool> blockHashIndexLoaded {false};
+
+        /* Where the index is snapshotted on save(), empty to not snapshot */
+        const std::string blockHashIndexFile;
+
+        void loadBlockHashIndex();
+
         struct ExtendedPushedBlockInfo;
 
         ExtendedPushedBlockInfo getExtendedPushedBlockInfo(uint32_t blockIndex) const;
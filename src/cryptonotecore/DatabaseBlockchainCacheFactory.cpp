@@ -13,9 +13,11 @@ namespace CryptoNote
 {
     DatabaseBlockchainCacheFactory::DatabaseBlockchainCacheFactory(
         IDataBase &database,
-        std::shared_ptr<Logging::ILogger> logger):
+        std::shared_ptr<Logging::ILogger> logger,
+        const std::string &blockHashIndexFile):
         database(database),
-        logger(logger)
+        logger(logger),
+        blockHashIndexFile(blockHashIndexFile)
     {
     }
 
@@ -24,7 +26,7 @@ namespace CryptoNote
     std::unique_ptr<IBlockchainCache>
         DatabaseBlockchainCacheFactory::createRootBlockchainCache(const Currency &currency)
     {
-        return std::unique_ptr<IBlockchainCache>(new DatabaseBlockchainCache(currency, database, *this, logger));
+        return std::unique_ptr<IBlockchainCache>(new DatabaseBlockchainCache(currency, database, *this, logger, blockHashIndexFile));
     }
 
     std::unique_ptr<IBlockchainCache> DatabaseBlockchainCacheFactory::createBlockchainCache(
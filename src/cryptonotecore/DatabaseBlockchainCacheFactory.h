@@ -16,7 +16,12 @@ namespace CryptoNote
     class DatabaseBlockchainCacheFactory : public IBlockchainCacheFactory
     {
       public:
-        explicit DatabaseBlockchainCacheFactory(IDataBase &database, std::shared_ptr<Logging::ILogger> logger);
+        /* blockHashIndexFile is where the root cache snapshots its block hash
+           index, see DatabaseBlockchainCache */
+        DatabaseBlockchainCacheFactory(
+            IDataBase &database,
+            std::shared_ptr<Logging::ILogger> logger,
+            const std::string &blockHashIndexFile = "");
 
         virtual ~DatabaseBlockchainCacheFactory();
 
@@ -29,6 +34,8 @@ namespace CryptoNote
         IDataBase &database;
 
         std::shared_ptr<Logging::ILogger> logger;
+
+        const std::string blockHashIndexFile;
     };
 
 } // namespace CryptoNote
@@ -49,6 +49,10 @@ namespace CryptoNote
 
         virtual bool hasBlock(const Crypto::Hash &blockHash) const = 0;
 
+        /* Blocks in the checkpoint zone are verified against the checkpoint
+           hash, rather than having their proof of work checked */
+        virtual bool isInCheckpointZone(const uint32_t blockIndex) const = 0;
+
         virtual BlockTemplate getBlockByIndex(uint32_t index) const = 0;
 
         virtual BlockTemplate getBlockByHash(const Crypto::Hash &blockHash) const = 0;
@@ -7,6 +7,7 @@
 #include "LevelDBWrapper.h"
 
 #include "DataBaseErrors.h"
+#include "common/Metrics.h"
 #include "leveldb/cache.h"
 #include "leveldb/db.h"
 #include "leveldb/table.h"
@@ -18,7 +19,13 @@ using namespace Logging;
 namespace
 {
     const std::string DB_NAME = "LevelDB";
-}
+
+    Metrics::Histogram &databaseSeconds(const std::string &operation)
+    {
+        return Metrics::Registry::instance().histogram(
+            "wrkzd_database_seconds", "Time taken by database reads and writes", Metrics::label("operation", operation));
+    }
+} // namespace
 
 LevelDBWrapper::LevelDBWrapper(
     std::shared_ptr<Logging::ILogger> logger,
@@ -131,6 +138,10 @@ std::error_code LevelDBWrapper::write(IWriteBatch &batch)
 
 std::error_code LevelDBWrapper::write(IWriteBatch &batch, bool sync)
 {
+    static auto &writeSeconds = databaseSeconds("write");
+
+    Metrics::ScopedTimer timer(writeSeconds);
+
     leveldb::WriteOptions writeOptions;
     writeOptions.sync = sync;
 
@@ -167,6 +178,10 @@ std::error_code LevelDBWrapper::read(IReadBatch &batch)
         throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::NOT_INITIALIZED));
     }
 
+    static auto &readSeconds = databaseSeconds("read");
+
+    Metrics::ScopedTimer timer(readSeconds);
+
     leveldb::ReadOptions readOptions;
 
     std::vector<std::string> rawKeys(batch.getRawKeys());
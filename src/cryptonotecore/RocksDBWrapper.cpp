@@ -7,6 +7,7 @@
 #include "RocksDBWrapper.h"
 
 #include "DataBaseErrors.h"
+#include "common/Metrics.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/db.h"
 #include "rocksdb/table.h"
@@ -18,7 +19,13 @@ using namespace Logging;
 namespace
 {
     const std::string DB_NAME = "DB";
-}
+
+    Metrics::Histogram &databaseSeconds(const std::string &operation)
+    {
+        return Metrics::Registry::instance().histogram(
+            "wrkzd_database_seconds", "Time taken by database reads and writes", Metrics::label("operation", operation));
+    }
+} // namespace
 
 RocksDBWrapper::RocksDBWrapper(
     std::shared_ptr<Logging::ILogger> logger,
@@ -127,6 +134,10 @@ std::error_code RocksDBWrapper::write(IWriteBatch &batch)
 
 std::error_code RocksDBWrapper::write(IWriteBatch &batch, bool sync)
 {
+    static auto &writeSeconds = databaseSeconds("write");
+
+    Metrics::ScopedTimer timer(writeSeconds);
+
     rocksdb::WriteOptions writeOptions;
     writeOptions.sync = sync;
 
@@ -163,6 +174,10 @@ std::error_code RocksDBWrapper::read(IReadBatch &batch)
         throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::NOT_INITIALIZED));
     }
 
+    static auto &readSeconds = databaseSeconds("read");
+
+    Metrics::ScopedTimer timer(readSeconds);
+
     rocksdb::ReadOptions readOptions;
 
     std::vector<std::string> rawKeys(batch.getRawKeys());
@@ -206,6 +221,10 @@ std::error_code RocksDBWrapper::readThreadSafe(IReadBatch &batch)
         throw std::runtime_error("Not initialized.");
     }
 
+    static auto &readSeconds = databaseSeconds("read");
+
+    Metrics::ScopedTimer timer(readSeconds);
+
     rocksdb::ReadOptions readOptions;
 
     std::vector<std::string> rawKeys(batch.getRawKeys());
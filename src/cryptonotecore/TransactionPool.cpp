@@ -6,11 +6,33 @@
 #include "TransactionPool.h"
 
 #include "CryptoNoteBasicImpl.h"
+#include "common/Metrics.h"
 #include "common/TransactionExtra.h"
 #include "common/int-util.h"
 
 namespace CryptoNote
 {
+    namespace
+    {
+        struct PoolMetrics
+        {
+            Metrics::Gauge &size = Metrics::Registry::instance().gauge(
+                "wrkzd_pool_transactions", "Number of transactions in the pool");
+
+            Metrics::Counter &added = Metrics::Registry::instance().counter(
+                "wrkzd_pool_transactions_added_total", "Transactions added to the pool");
+
+            Metrics::Counter &removed = Metrics::Registry::instance().counter(
+                "wrkzd_pool_transactions_removed_total", "Transactions removed from the pool");
+        };
+
+        PoolMetrics &poolMetrics()
+        {
+            static PoolMetrics metrics;
+            return metrics;
+        }
+    } // namespace
+
     /* Is the left hand side preferred over the right hand side? */
     bool TransactionPool::TransactionPriorityComparator::
         operator()(const PendingTransactionInfo &lhs, const PendingTransactionInfo &rhs) const
@@ -159,7 +181,15 @@ namespace CryptoNote
 
         logger(Logging::DEBUGGING) << "pushed transaction " << pendingTx.getTransactionHash() << " to pool";
 
-        return transactionHashIndex.insert(std::move(pendingTx)).second;
+        const bool inserted = transactionHashIndex.insert(std::move(pendingTx)).second;
+
+        if (inserted)
+        {
+            poolMetrics().added.increment();
+            poolMetrics().size.set(transactionHashIndex.size());
+        }
+
+        return inserted;
     }
 
     const std::optional<CachedTransaction> TransactionPool::tryGetTransaction(const Crypto::Hash &hash) const
@@ -200,6 +230,9 @@ namespace CryptoNote
         excludeFromState(poolState, it->cachedTransaction);
         transactionHashIndex.erase(it);
 
+        poolMetrics().removed.increment();
+        poolMetrics().size.set(transactionHashIndex.size());
+
         logger(Logging::DEBUGGING) << "transaction " << hash << " removed from pool";
         return true;
     }
@@ -8,6 +8,7 @@
 
 #include <config/CryptoNoteConfig.h>
 #include <common/CheckDifficulty.h>
+#include <common/Metrics.h>
 #include <cryptonotecore/Mixins.h>
 #include <cryptonotecore/TransactionValidationErrors.h>
 #include <cryptonotecore/ValidateTransaction.h>
@@ -39,8 +40,24 @@ ValidateTransaction::ValidateTransaction(
 {
 }
 
+namespace
+{
+    Metrics::Histogram &validationSeconds(const std::string &source)
+    {
+        return Metrics::Registry::instance().histogram(
+            "wrkzd_transaction_validation_seconds",
+            "Time taken to validate a transaction, by where it came from",
+            Metrics::label("source", source));
+    }
+} // namespace
+
 TransactionValidationResult ValidateTransaction::validate()
 {
+    static auto &blockSeconds = validationSeconds("block");
+    static auto &poolSeconds = validationSeconds("pool");
+
+    Metrics::ScopedTimer timer(m_isPoolTransaction ? poolSeconds : blockSeconds);
+
     /* Validate transaction isn't too big */
     if (!validateTransactionSize())
     {
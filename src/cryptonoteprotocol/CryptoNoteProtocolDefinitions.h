@@ -207,4 +207,81 @@ namespace CryptoNote
         const static int ID = BC_COMMANDS_POOL_BASE + 10;
         typedef NOTIFY_MISSING_TXS_request request;
     };
+
+    /************************************************************************/
+    /*                                                                      */
+    /************************************************************************/
+    /* Announces transactions by hash only. The receiver fetches the ones it
+       doesn't have with a NOTIFY_MISSING_TXS carrying a null block hash, and
+       the blobs come back in a NOTIFY_NEW_TRANSACTIONS. */
+    struct NOTIFY_NEW_TRANSACTION_HASHES_request
+    {
+        std::vector<Crypto::Hash> txs;
+
+        void serialize(ISerializer &s)
+        {
+            serializeAsBinary(txs, "txs", s);
+        }
+    };
+
+    struct NOTIFY_NEW_TRANSACTION_HASHES
+    {
+        const static int ID = BC_COMMANDS_POOL_BASE + 11;
+        typedef NOTIFY_NEW_TRANSACTION_HASHES_request request;
+    };
+
+    /************************************************************************/
+    /*                                                                      */
+    /************************************************************************/
+    /* A block whose transactions are given by short ids rather than hashes.
+       The template's transaction hashes are left out, and each transaction
+       is instead identified by the low 6 bytes of a SipHash of its hash,
+       keyed from the block hash and nonce so ids differ from block to block.
+       Transactions at prefilledIndexes are sent in full (the receiver is
+       unlikely to have them), and shortIds covers the rest, in order. The
+       miner transaction is part of the template, so always comes along. */
+    struct NOTIFY_NEW_COMPACT_BLOCK_request
+    {
+        BinaryArray blockTemplate;
+        Crypto::Hash blockHash;
+        uint64_t nonce;
+        std::vector<uint64_t> shortIds;
+        std::vector<uint32_t> prefilledIndexes;
+        std::vector<BinaryArray> prefilledTransactions;
+        uint32_t current_blockchain_height;
+        uint32_t hop;
+    };
+
+    struct NOTIFY_NEW_COMPACT_BLOCK
+    {
+        const static int ID = BC_COMMANDS_POOL_BASE + 12;
+        typedef NOTIFY_NEW_COMPACT_BLOCK_request request;
+    };
+
+    /* Requests the transactions at the given indexes of a compact block we
+       couldn't fill from our pool, all in one go */
+    struct NOTIFY_REQUEST_COMPACT_BLOCK_TXS_request
+    {
+        Crypto::Hash blockHash;
+        std::vector<uint32_t> indexes;
+    };
+
+    struct NOTIFY_REQUEST_COMPACT_BLOCK_TXS
+    {
+        const static int ID = BC_COMMANDS_POOL_BASE + 13;
+        typedef NOTIFY_REQUEST_COMPACT_BLOCK_TXS_request request;
+    };
+
+    /* The requested transactions, in the order they were requested */
+    struct NOTIFY_RESPONSE_COMPACT_BLOCK_TXS_request
+    {
+        Crypto::Hash blockHash;
+        std::vector<BinaryArray> txs;
+    };
+
+    struct NOTIFY_RESPONSE_COMPACT_BLOCK_TXS
+    {
+        const static int ID = BC_COMMANDS_POOL_BASE + 14;
+        typedef NOTIFY_RESPONSE_COMPACT_BLOCK_TXS_request request;
+    };
 } // namespace CryptoNote
@@ -7,19 +7,29 @@
 #include "CryptoNoteProtocolHandler.h"
 
 #include "common/CryptoNoteTools.h"
+#include "common/Metrics.h"
 #include "cryptonotecore/CryptoNoteBasicImpl.h"
 #include "cryptonotecore/CryptoNoteFormatUtils.h"
 #include "cryptonotecore/Currency.h"
+#include "crypto/random.h"
+#include "crypto/siphash.h"
 #include "p2p/LevinProtocol.h"
 
+#include <algorithm>
+#include <boost/functional/hash.hpp>
 #include <boost/scope_exit.hpp>
 #include <boost/uuid/uuid_io.hpp>
+#include <chrono>
 #include <config/Ascii.h>
 #include <config/CryptoNoteConfig.h>
 #include <config/WalletConfig.h>
+#include <cstring>
 #include <future>
 #include <serialization/SerializationTools.h>
 #include <system/Dispatcher.h>
+#include <system/Event.h>
+#include <system/InterruptedException.h>
+#include <unordered_set>
 #include <utilities/FormatTools.h>
 
 using namespace Logging;
@@ -73,6 +83,72 @@ namespace CryptoNote
             return rawBlocks;
         }
 
+        /* Short ids are the low 6 bytes of the SipHash */
+        const size_t SHORT_ID_SIZE = 6;
+
+        const uint64_t SHORT_ID_MASK = (uint64_t(1) << (SHORT_ID_SIZE * 8)) - 1;
+
+        struct ShortIdKey
+        {
+            uint64_t k0;
+            uint64_t k1;
+        };
+
+        ShortIdKey getShortIdKey(const Crypto::Hash &blockHash, const uint64_t nonce)
+        {
+            uint8_t data[sizeof(blockHash.data) + sizeof(nonce)];
+            std::memcpy(data, blockHash.data, sizeof(blockHash.data));
+            std::memcpy(data + sizeof(blockHash.data), &nonce, sizeof(nonce));
+
+            const Crypto::Hash keyHash = Crypto::cn_fast_hash(data, sizeof(data));
+
+            ShortIdKey key;
+            std::memcpy(&key.k0, keyHash.data, sizeof(key.k0));
+            std::memcpy(&key.k1, keyHash.data + sizeof(key.k0), sizeof(key.k1));
+
+            return key;
+        }
+
+        uint64_t getShortId(const ShortIdKey &key, const Crypto::Hash &transactionHash)
+        {
+            return Crypto::siphash24(transactionHash.data, sizeof(transactionHash.data), key.k0, key.k1)
+                   & SHORT_ID_MASK;
+        }
+
+        std::string packShortIds(const std::vector<uint64_t> &shortIds)
+        {
+            std::string packed;
+            packed.reserve(shortIds.size() * SHORT_ID_SIZE);
+
+            for (const uint64_t shortId : shortIds)
+            {
+                for (size_t i = 0; i < SHORT_ID_SIZE; i++)
+                {
+                    packed.push_back(static_cast<char>(shortId >> (i * 8)));
+                }
+            }
+
+            return packed;
+        }
+
+        std::vector<uint64_t> unpackShortIds(const std::string &packed)
+        {
+            if (packed.size() % SHORT_ID_SIZE != 0)
+            {
+                throw std::runtime_error("Invalid short id list size");
+            }
+
+            std::vector<uint64_t> shortIds(packed.size() / SHORT_ID_SIZE, 0);
+
+            for (size_t i = 0; i < packed.size(); i++)
+            {
+                shortIds[i / SHORT_ID_SIZE] |= static_cast<uint64_t>(static_cast<uint8_t>(packed[i]))
+                                               << ((i % SHORT_ID_SIZE) * 8);
+            }
+
+            return shortIds;
+        }
+
     } // namespace
 
     // unpack to strings to maintain protocol compatibility with older versions
@@ -116,29 +192,36 @@ namespace CryptoNote
     }
 
     // unpack to strings to maintain protocol compatibility with older versions
-    static inline void serialize(NOTIFY_NEW_TRANSACTIONS_request &request, ISerializer &s)
+    static inline void serializeTransactionBlobs(
+        std::vector<BinaryArray> &txs,
+        Common::StringView name,
+        ISerializer &s)
     {
         std::vector<std::string> transactions;
         if (s.type() == ISerializer::INPUT)
         {
-            s(transactions, "txs");
-            request.txs.reserve(transactions.size());
+            s(transactions, name);
+            txs.reserve(transactions.size());
             std::transform(
-                transactions.begin(), transactions.end(), std::back_inserter(request.txs), [](const std::string &s) {
+                transactions.begin(), transactions.end(), std::back_inserter(txs), [](const std::string &s) {
                     return BinaryArray(s.begin(), s.end());
                 });
         }
         else
         {
-            transactions.reserve(request.txs.size());
-            std::transform(
-                request.txs.begin(), request.txs.end(), std::back_inserter(transactions), [](const BinaryArray &s) {
-                    return std::string(s.begin(), s.end());
-                });
-            s(transactions, "txs");
+            transactions.reserve(txs.size());
+            std::transform(txs.begin(), txs.end(), std::back_inserter(transactions), [](const BinaryArray &s) {
+                return std::string(s.begin(), s.end());
+            });
+            s(transactions, name);
         }
     }
 
+    static inline void serialize(NOTIFY_NEW_TRANSACTIONS_request &request, ISerializer &s)
+    {
+        serializeTransactionBlobs(request.txs, "txs", s);
+    }
+
     static inline void serialize(NOTIFY_RESPONSE_GET_OBJECTS_request &request, ISerializer &s)
     {
         s(request.txs, "txs");
@@ -175,18 +258,60 @@ namespace CryptoNote
         serializeAsBinary(request.missing_txs, "missing_txs", s);
     }
 
+    static inline void serialize(NOTIFY_NEW_COMPACT_BLOCK_request &request, ISerializer &s)
+    {
+        std::string blockTemplate;
+        std::string shortIds;
+
+        if (s.type() == ISerializer::OUTPUT)
+        {
+            blockTemplate.assign(request.blockTemplate.begin(), request.blockTemplate.end());
+            shortIds = packShortIds(request.shortIds);
+        }
+
+        s(request.current_blockchain_height, "current_blockchain_height");
+        s(request.hop, "hop");
+        s(blockTemplate, "blockTemplate");
+        s(request.blockHash, "blockHash");
+        s(request.nonce, "nonce");
+        s.binary(shortIds, "shortIds");
+        serializeAsBinary(request.prefilledIndexes, "prefilledIndexes", s);
+        serializeTransactionBlobs(request.prefilledTransactions, "prefilledTransactions", s);
+
+        if (s.type() == ISerializer::INPUT)
+        {
+            request.blockTemplate.assign(blockTemplate.begin(), blockTemplate.end());
+            request.shortIds = unpackShortIds(shortIds);
+        }
+    }
+
+    static inline void serialize(NOTIFY_REQUEST_COMPACT_BLOCK_TXS_request &request, ISerializer &s)
+    {
+        s(request.blockHash, "blockHash");
+        serializeAsBinary(request.indexes, "indexes", s);
+    }
+
+    static inline void serialize(NOTIFY_RESPONSE_COMPACT_BLOCK_TXS_request &request, ISerializer &s)
+    {
+        s(request.blockHash, "blockHash");
+        serializeTransactionBlobs(request.txs, "txs", s);
+    }
+
     CryptoNoteProtocolHandler::CryptoNoteProtocolHandler(
         const Currency &currency,
         System::Dispatcher &dispatcher,
         ICore &rcore,
         IP2pEndpoint *p_net_layout,
-        std::shared_ptr<Logging::ILogger> log):
+        std::shared_ptr<Logging::ILogger> log,
+        const uint32_t powVerificationThreads,
+        const uint32_t largeMessageDecodeThreads):
         m_dispatcher(dispatcher),
         m_currency(currency),
         m_core(rcore),
         m_p2p(p_net_layout),
         m_synchronized(false),
         m_stop(false),
+        m_powVerificationThreads(powVerificationThreads),
         m_observedHeight(0),
         m_blockchainHeight(0),
         m_peersCount(0),
@@ -196,6 +321,16 @@ namespace CryptoNote
         {
             m_p2p = &m_p2p_stub;
         }
+
+        if (m_powVerificationThreads > 0)
+        {
+            m_powVerificationThreadPool = std::make_unique<Utilities::ThreadPool<bool>>(m_powVerificationThreads);
+        }
+
+        if (largeMessageDecodeThreads > 0)
+        {
+            m_largeMessageDecodeThreadPool = std::make_unique<Utilities::ThreadPool<bool>>(largeMessageDecodeThreads);
+        }
     }
 
     size_t CryptoNoteProtocolHandler::getPeerCount() const
@@ -395,14 +530,60 @@ namespace CryptoNote
         return true;
     }
 
+    template<typename Request>
+    bool CryptoNoteProtocolHandler::decodeRequest(const BinaryArray &buffer, Request &request)
+    {
+        if (!m_largeMessageDecodeThreadPool || buffer.size() < P2P_DECODE_OFFLOAD_THRESHOLD)
+        {
+            return LevinProtocol::decode(buffer, request);
+        }
+
+        System::Event decoded(m_dispatcher);
+        bool success = false;
+
+        /* The worker hands back to the dispatcher thread with remoteSpawn(),
+           so the event is only ever touched from the dispatcher */
+        m_largeMessageDecodeThreadPool->addJob([&]() {
+            success = LevinProtocol::decode(buffer, request);
+            m_dispatcher.remoteSpawn([&decoded]() { decoded.set(); });
+            return true;
+        });
+
+        /* The worker references our locals, so we can't leave before it's
+           done, even if interrupted - like System::RemoteContext */
+        bool interrupted = false;
+
+        while (!decoded.get())
+        {
+            try
+            {
+                decoded.wait();
+            }
+            catch (System::InterruptedException &)
+            {
+                interrupted = true;
+            }
+        }
+
+        if (interrupted)
+        {
+            m_dispatcher.interrupt();
+        }
+
+        return success;
+    }
+
     template<typename Command, typename Handler>
-    int notifyAdaptor(const BinaryArray &reqBuf, CryptoNoteConnectionContext &ctx, Handler handler)
+    int CryptoNoteProtocolHandler::notifyAdaptor(
+        const BinaryArray &reqBuf,
+        CryptoNoteConnectionContext &ctx,
+        Handler handler)
     {
         typedef typename Command::request Request;
         int command = Command::ID;
 
         Request req = boost::value_initialized<Request>();
-        if (!LevinProtocol::decode(reqBuf, req))
+        if (!decodeRequest(reqBuf, req))
         {
             throw std::runtime_error("Failed to load_from_binary in command " + std::to_string(command));
         }
@@ -442,6 +623,10 @@ namespace CryptoNote
             HANDLE_NOTIFY(NOTIFY_REQUEST_TX_POOL, handleRequestTxPool)
             HANDLE_NOTIFY(NOTIFY_NEW_LITE_BLOCK, handle_notify_new_lite_block)
             HANDLE_NOTIFY(NOTIFY_MISSING_TXS, handle_notify_missing_txs)
+            HANDLE_NOTIFY(NOTIFY_NEW_TRANSACTION_HASHES, handle_notify_new_transaction_hashes)
+            HANDLE_NOTIFY(NOTIFY_NEW_COMPACT_BLOCK, handle_notify_new_compact_block)
+            HANDLE_NOTIFY(NOTIFY_REQUEST_COMPACT_BLOCK_TXS, handle_request_compact_block_txs)
+            HANDLE_NOTIFY(NOTIFY_RESPONSE_COMPACT_BLOCK_TXS, handle_response_compact_block_txs)
 
             default:
                 handled = false;
@@ -522,7 +707,26 @@ namespace CryptoNote
             return 1;
         }
 
-        if (context.m_pending_lite_block.has_value())
+        {
+            std::scoped_lock lock(m_txAnnouncementsMutex);
+
+            for (const auto &tx : arg.txs)
+            {
+                m_requestedTransactions.erase(getBinaryArrayHash(tx));
+            }
+        }
+
+        /* The peer may also be answering a fetch of announced transactions,
+           so only treat this as the lite block response if it contains one
+           of the transactions the lite block is waiting on */
+        const bool isLiteBlockResponse = context.m_pending_lite_block.has_value()
+                                         && std::any_of(arg.txs.begin(), arg.txs.end(), [&context](const auto &tx) {
+                                                return context.m_pending_lite_block->missed_transactions.count(
+                                                           getBinaryArrayHash(tx))
+                                                       > 0;
+                                            });
+
+        if (isLiteBlockResponse)
         {
             logger(Logging::TRACE)
                 << context
@@ -549,8 +753,7 @@ namespace CryptoNote
 
             if (arg.txs.size() > 0)
             {
-                // TODO: add announce usage here
-                relay_post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, arg, &context.m_connection_id);
+                queueTransactionAnnouncements(arg.txs, context.m_connection_id);
             }
         }
 
@@ -671,6 +874,8 @@ namespace CryptoNote
             return 1;
         }
 
+        verifyProofOfWork(cachedBlocks);
+
         {
             int result = processObjects(context, std::move(rawBlocks), cachedBlocks);
             if (result != 0)
@@ -688,6 +893,74 @@ namespace CryptoNote
         return 1;
     }
 
+    void CryptoNoteProtocolHandler::verifyProofOfWork(const std::vector<CachedBlock> &cachedBlocks)
+    {
+        if (!m_powVerificationThreadPool)
+        {
+            return;
+        }
+
+        std::vector<const CachedBlock *> blocks;
+
+        for (const auto &cachedBlock : cachedBlocks)
+        {
+            if (!m_core.isInCheckpointZone(cachedBlock.getBlockIndex()))
+            {
+                blocks.push_back(&cachedBlock);
+            }
+        }
+
+        if (blocks.empty())
+        {
+            return;
+        }
+
+        const auto startTime = std::chrono::steady_clock::now();
+
+        /* Block the dispatcher on the workers rather than yielding it. Other
+           connections' handlers must not add blocks underneath this batch,
+           and the connection context has to outlive the wait. */
+        std::vector<std::future<bool>> results;
+
+        for (const auto block : blocks)
+        {
+            results.push_back(m_powVerificationThreadPool->addJob([block]() {
+                try
+                {
+                    block->getBlockLongHash();
+                    return true;
+                }
+                /* Leave it to Core::addBlock to reject the block */
+                catch (const std::exception &)
+                {
+                    return false;
+                }
+            }));
+        }
+
+        for (auto &result : results)
+        {
+            result.get();
+        }
+
+        const uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - startTime).count();
+
+        static auto &batchSeconds = Metrics::Registry::instance().histogram(
+            "wrkzd_pow_verification_batch_seconds", "Time taken to hash a batch of synced blocks in parallel");
+
+        static auto &hashedBlocks = Metrics::Registry::instance().counter(
+            "wrkzd_pow_verification_blocks_total", "Blocks hashed in parallel ahead of being added");
+
+        batchSeconds.observe(elapsed / 1000000.0);
+        hashedBlocks.increment(blocks.size());
+
+        logger(Logging::DEBUGGING) << "Computed proof of work for " << blocks.size() << " blocks in "
+                                   << elapsed / 1000 << " ms on " << m_powVerificationThreads << " threads ("
+                                   << (elapsed > 0 ? blocks.size() * 1000000 / elapsed : blocks.size())
+                                   << " blocks/s)";
+    }
+
     int CryptoNoteProtocolHandler::processObjects(
         CryptoNoteConnectionContext &context,
         std::vector<RawBlock> &&rawBlocks,
@@ -813,48 +1086,21 @@ namespace CryptoNote
         if (need_txs.empty())
         {
             context.m_pending_lite_block = std::nullopt;
-            auto result = m_core.addBlock(RawBlock {arg.blockTemplate, have_txs});
-            if (result == error::AddBlockErrorCondition::BLOCK_ADDED)
-            {
-                if (result == error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE_AND_SWITCHED)
-                {
-                    ++arg.hop;
-                    // TODO: Add here announce protocol usage
-                    relay_post_notify<NOTIFY_NEW_LITE_BLOCK>(*m_p2p, arg, &context.m_connection_id);
-                    // relay_block(arg, context);
-                    requestMissingPoolTransactions(context);
-                }
-                else if (result == error::AddBlockErrorCode::ADDED_TO_MAIN)
-                {
-                    ++arg.hop;
-                    // TODO: Add here announce protocol usage
-                    relay_post_notify<NOTIFY_NEW_LITE_BLOCK>(*m_p2p, arg, &context.m_connection_id);
-                    // relay_block(arg, context);
-                }
-                else if (result == error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE)
-                {
-                    logger(Logging::TRACE) << context << "Block added as alternative";
-                }
-                else
-                {
-                    logger(Logging::TRACE) << context << "Block already exists";
-                }
-            }
-            else if (result == error::AddBlockErrorCondition::BLOCK_REJECTED)
-            {
-                context.m_state = CryptoNoteConnectionContext::state_synchronizing;
-                NOTIFY_REQUEST_CHAIN::request r = boost::value_initialized<NOTIFY_REQUEST_CHAIN::request>();
-                r.block_ids = m_core.buildSparseChain();
-                logger(Logging::TRACE) << context
-                                       << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
-                post_notify<NOTIFY_REQUEST_CHAIN>(*m_p2p, r, context);
-            }
-            else
+
+            std::unordered_set<Crypto::Hash> unpooledTransactions;
+
+            for (const auto &providedTx : provided_txs)
             {
-                logger(Logging::DEBUGGING)
-                    << context << "Block verification failed, dropping connection: " << result.message();
-                context.m_state = CryptoNoteConnectionContext::state_shutdown;
+                unpooledTransactions.insert(providedTx.first);
             }
+
+            addRelayedBlock(
+                context,
+                std::move(arg.blockTemplate),
+                std::move(have_txs),
+                arg.current_blockchain_height,
+                arg.hop,
+                unpooledTransactions);
         }
         else
         {
@@ -887,77 +1133,416 @@ namespace CryptoNote
         return 1;
     }
 
-    int CryptoNoteProtocolHandler::handle_request_chain(
+    void CryptoNoteProtocolHandler::addRelayedBlock(
+        CryptoNoteConnectionContext &context,
+        BinaryArray blockTemplate,
+        std::vector<BinaryArray> transactions,
+        const uint32_t currentBlockchainHeight,
+        const uint32_t hop,
+        const std::unordered_set<Crypto::Hash> &unpooledTransactions)
+    {
+        /* Kept so the block can be relayed to peers which need it in full */
+        std::vector<BinaryArray> relayTransactions = transactions;
+        BinaryArray relayTemplate = blockTemplate;
+
+        auto result = m_core.addBlock(RawBlock {std::move(blockTemplate), std::move(transactions)});
+        if (result == error::AddBlockErrorCondition::BLOCK_ADDED)
+        {
+            if (result == error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE_AND_SWITCHED)
+            {
+                relayNewBlock(
+                    relayTemplate,
+                    relayTransactions,
+                    currentBlockchainHeight,
+                    hop + 1,
+                    unpooledTransactions,
+                    &context.m_connection_id);
+                requestMissingPoolTransactions(context);
+            }
+            else if (result == error::AddBlockErrorCode::ADDED_TO_MAIN)
+            {
+                relayNewBlock(
+                    relayTemplate,
+                    relayTransactions,
+                    currentBlockchainHeight,
+                    hop + 1,
+                    unpooledTransactions,
+                    &context.m_connection_id);
+            }
+            else if (result == error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE)
+            {
+                logger(Logging::TRACE) << context << "Block added as alternative";
+            }
+            else
+            {
+                logger(Logging::TRACE) << context << "Block already exists";
+            }
+        }
+        else if (result == error::AddBlockErrorCondition::BLOCK_REJECTED)
+        {
+            context.m_state = CryptoNoteConnectionContext::state_synchronizing;
+            NOTIFY_REQUEST_CHAIN::request r = boost::value_initialized<NOTIFY_REQUEST_CHAIN::request>();
+            r.block_ids = m_core.buildSparseChain();
+            logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
+            post_notify<NOTIFY_REQUEST_CHAIN>(*m_p2p, r, context);
+        }
+        else
+        {
+            logger(Logging::DEBUGGING) << context
+                                       << "Block verification failed, dropping connection: " << result.message();
+            context.m_state = CryptoNoteConnectionContext::state_shutdown;
+        }
+    }
+
+    int CryptoNoteProtocolHandler::handle_notify_new_compact_block(
         int command,
-        NOTIFY_REQUEST_CHAIN::request &arg,
+        NOTIFY_NEW_COMPACT_BLOCK::request &arg,
         CryptoNoteConnectionContext &context)
     {
-        logger(Logging::TRACE) << context << "NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << arg.block_ids.size();
+        logger(Logging::TRACE) << context << "NOTIFY_NEW_COMPACT_BLOCK (hop " << arg.hop << ")";
+        updateObservedHeight(arg.current_blockchain_height, context);
+        context.m_remote_blockchain_height = arg.current_blockchain_height;
+        if (context.m_state != CryptoNoteConnectionContext::state_normal)
+        {
+            return 1;
+        }
 
-        if (arg.block_ids.empty())
+        if (m_core.hasBlock(arg.blockHash))
         {
-            logger(Logging::DEBUGGING, Logging::BRIGHT_RED)
-                << context << "Failed to handle NOTIFY_REQUEST_CHAIN. block_ids is empty";
-            context.m_state = CryptoNoteConnectionContext::state_shutdown;
+            logger(Logging::TRACE) << context << "Block already exists";
             return 1;
         }
 
-        if (arg.block_ids.back() != m_core.getBlockHashByIndex(0))
+        const size_t transactionCount = arg.shortIds.size() + arg.prefilledIndexes.size();
+
+        bool valid = arg.prefilledIndexes.size() == arg.prefilledTransactions.size();
+
+        /* Prefilled indexes must be in order, and within the block */
+        for (size_t i = 0; valid && i < arg.prefilledIndexes.size(); i++)
         {
-            logger(Logging::DEBUGGING)
-                << context << "Failed to handle NOTIFY_REQUEST_CHAIN. block_ids doesn't end with genesis block ID";
+            valid = arg.prefilledIndexes[i] < transactionCount
+                    && (i == 0 || arg.prefilledIndexes[i] > arg.prefilledIndexes[i - 1]);
+        }
+
+        BlockTemplate block;
+
+        if (!valid || !fromBinaryArray(block, arg.blockTemplate) || !block.transactionHashes.empty())
+        {
+            logger(Logging::DEBUGGING) << context << "Invalid compact block, dropping connection";
             context.m_state = CryptoNoteConnectionContext::state_shutdown;
             return 1;
         }
 
-        NOTIFY_RESPONSE_CHAIN_ENTRY::request r;
-        r.m_block_ids = m_core.findBlockchainSupplement(
-            arg.block_ids, BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT, r.total_height, r.start_height);
+        PendingCompactBlock pending;
+        pending.transactionHashes.resize(transactionCount);
+        pending.transactions.resize(transactionCount);
+        pending.requestedAll = false;
 
-        logger(Logging::TRACE) << context << "-->>NOTIFY_RESPONSE_CHAIN_ENTRY: m_start_height=" << r.start_height
-                               << ", m_total_height=" << r.total_height
-                               << ", m_block_ids.size()=" << r.m_block_ids.size();
-        post_notify<NOTIFY_RESPONSE_CHAIN_ENTRY>(*m_p2p, r, context);
-        return 1;
-    }
+        std::vector<bool> prefilled(transactionCount, false);
 
-    bool CryptoNoteProtocolHandler::request_missing_objects(
-        CryptoNoteConnectionContext &context,
-        bool check_having_blocks)
-    {
-        if (context.m_needed_objects.size())
+        for (size_t i = 0; i < arg.prefilledIndexes.size(); i++)
         {
-            // we know objects that we need, request this objects
-            NOTIFY_REQUEST_GET_OBJECTS::request req;
-            size_t count = 0;
-            auto it = context.m_needed_objects.begin();
+            const uint32_t index = arg.prefilledIndexes[i];
 
-            while (it != context.m_needed_objects.end() && count < BLOCKS_SYNCHRONIZING_DEFAULT_COUNT)
+            pending.transactionHashes[index] = getBinaryArrayHash(arg.prefilledTransactions[i]);
+            pending.transactions[index] = std::move(arg.prefilledTransactions[i]);
+            pending.unpooledTransactions.insert(pending.transactionHashes[index]);
+            prefilled[index] = true;
+        }
+
+        if (!arg.shortIds.empty())
+        {
+            const ShortIdKey key = getShortIdKey(arg.blockHash, arg.nonce);
+
+            /* Ids are salted per block, so the pool has to be indexed afresh
+               for each one. Ids shared by more than one pool transaction map
+               to a null hash, and are fetched from the peer. */
+            std::unordered_map<uint64_t, Crypto::Hash> poolShortIds;
+
+            for (const auto &hash : m_core.getPoolTransactionHashes())
             {
-                if (!(check_having_blocks && m_core.hasBlock(*it)))
+                const auto [it, inserted] = poolShortIds.emplace(getShortId(key, hash), hash);
+
+                if (!inserted)
                 {
-                    req.blocks.push_back(*it);
-                    ++count;
-                    context.m_requested_objects.insert(*it);
+                    it->second = Constants::NULL_HASH;
                 }
-                it = context.m_needed_objects.erase(it);
             }
-            logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_GET_OBJECTS: blocks.size()=" << req.blocks.size()
-                                   << ", txs.size()=" << req.txs.size();
-            post_notify<NOTIFY_REQUEST_GET_OBJECTS>(*m_p2p, req, context);
-        }
-        else if (context.m_last_response_height < context.m_remote_blockchain_height - 1)
-        { // we have to fetch more objects ids, request blockchain entry
 
-            NOTIFY_REQUEST_CHAIN::request r = boost::value_initialized<NOTIFY_REQUEST_CHAIN::request>();
-            r.block_ids = m_core.buildSparseChain();
-            logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
-            post_notify<NOTIFY_REQUEST_CHAIN>(*m_p2p, r, context);
-        }
-        else
-        {
-            if (!(context.m_last_response_height == context.m_remote_blockchain_height - 1
-                  && !context.m_needed_objects.size() && !context.m_requested_objects.size()))
+            auto shortId = arg.shortIds.begin();
+
+            for (uint32_t index = 0; index < transactionCount; index++)
+            {
+                if (prefilled[index])
+                {
+                    continue;
+                }
+
+                const auto it = poolShortIds.find(*shortId++);
+
+                std::optional<BinaryArray> transaction;
+
+                if (it != poolShortIds.end() && it->second != Constants::NULL_HASH)
+                {
+                    transaction = m_core.getTransaction(it->second);
+                }
+
+                if (transaction.has_value())
+                {
+                    pending.transactionHashes[index] = it->second;
+                    pending.transactions[index] = std::move(*transaction);
+                }
+                else
+                {
+                    pending.missingIndexes.push_back(index);
+                }
+            }
+        }
+
+        pending.request = std::move(arg);
+        context.m_pending_compact_block = std::move(pending);
+
+        return processCompactBlock(context);
+    }
+
+    int CryptoNoteProtocolHandler::handle_request_compact_block_txs(
+        int command,
+        NOTIFY_REQUEST_COMPACT_BLOCK_TXS::request &arg,
+        CryptoNoteConnectionContext &context)
+    {
+        logger(Logging::TRACE) << context << "NOTIFY_REQUEST_COMPACT_BLOCK_TXS: indexes.size() = " << arg.indexes.size();
+
+        BlockTemplate block;
+
+        try
+        {
+            block = m_core.getBlockByHash(arg.blockHash);
+        }
+        catch (const std::exception &)
+        {
+            logger(Logging::DEBUGGING) << context << "Peer requested transactions of a compact block we don't have";
+            return 1;
+        }
+
+        NOTIFY_RESPONSE_COMPACT_BLOCK_TXS::request rsp;
+        rsp.blockHash = arg.blockHash;
+        rsp.txs.reserve(arg.indexes.size());
+
+        for (const uint32_t index : arg.indexes)
+        {
+            if (index >= block.transactionHashes.size())
+            {
+                logger(Logging::DEBUGGING) << context
+                                           << "Peer requested a compact block transaction which doesn't exist, "
+                                              "dropping connection";
+                context.m_state = CryptoNoteConnectionContext::state_shutdown;
+                return 1;
+            }
+
+            auto transaction = m_core.getTransaction(block.transactionHashes[index]);
+
+            if (!transaction.has_value())
+            {
+                logger(Logging::DEBUGGING) << context << "Unable to retrieve requested compact block transaction";
+                return 1;
+            }
+
+            rsp.txs.push_back(std::move(*transaction));
+        }
+
+        logger(Logging::TRACE) << context << "--> NOTIFY_RESPONSE_COMPACT_BLOCK_TXS: txs.size() = " << rsp.txs.size();
+
+        post_notify<NOTIFY_RESPONSE_COMPACT_BLOCK_TXS>(*m_p2p, rsp, context);
+
+        return 1;
+    }
+
+    int CryptoNoteProtocolHandler::handle_response_compact_block_txs(
+        int command,
+        NOTIFY_RESPONSE_COMPACT_BLOCK_TXS::request &arg,
+        CryptoNoteConnectionContext &context)
+    {
+        logger(Logging::TRACE) << context << "NOTIFY_RESPONSE_COMPACT_BLOCK_TXS: txs.size() = " << arg.txs.size();
+
+        if (!context.m_pending_compact_block.has_value()
+            || context.m_pending_compact_block->request.blockHash != arg.blockHash)
+        {
+            logger(Logging::DEBUGGING) << context << "Received transactions for a compact block we aren't waiting on";
+            return 1;
+        }
+
+        auto &pending = *context.m_pending_compact_block;
+
+        if (arg.txs.size() != pending.missingIndexes.size())
+        {
+            logger(Logging::DEBUGGING) << context
+                                       << "Peer didn't provide the requested compact block transactions, "
+                                          "dropping connection.";
+            context.m_pending_compact_block = std::nullopt;
+            context.m_state = CryptoNoteConnectionContext::state_shutdown;
+            return 1;
+        }
+
+        for (size_t i = 0; i < arg.txs.size(); i++)
+        {
+            const uint32_t index = pending.missingIndexes[i];
+
+            pending.transactionHashes[index] = getBinaryArrayHash(arg.txs[i]);
+            pending.transactions[index] = std::move(arg.txs[i]);
+            pending.unpooledTransactions.insert(pending.transactionHashes[index]);
+        }
+
+        pending.missingIndexes.clear();
+
+        return processCompactBlock(context);
+    }
+
+    int CryptoNoteProtocolHandler::processCompactBlock(CryptoNoteConnectionContext &context)
+    {
+        auto &pending = *context.m_pending_compact_block;
+
+        /* Fetch everything we're missing in one round trip */
+        if (!pending.missingIndexes.empty())
+        {
+            NOTIFY_REQUEST_COMPACT_BLOCK_TXS::request req;
+            req.blockHash = pending.request.blockHash;
+            req.indexes = pending.missingIndexes;
+
+            logger(Logging::TRACE) << context << "--> NOTIFY_REQUEST_COMPACT_BLOCK_TXS: "
+                                   << "indexes.size() = " << req.indexes.size();
+
+            if (!post_notify<NOTIFY_REQUEST_COMPACT_BLOCK_TXS>(*m_p2p, req, context))
+            {
+                logger(Logging::DEBUGGING) << context
+                                           << "Compact block is missing transactions but the publisher is not "
+                                              "reachable, dropping connection.";
+                context.m_pending_compact_block = std::nullopt;
+                context.m_state = CryptoNoteConnectionContext::state_shutdown;
+            }
+
+            return 1;
+        }
+
+        BlockTemplate block;
+        fromBinaryArray(block, pending.request.blockTemplate);
+        block.transactionHashes = pending.transactionHashes;
+
+        if (CachedBlock(block).getBlockHash() != pending.request.blockHash)
+        {
+            if (pending.requestedAll)
+            {
+                logger(Logging::DEBUGGING) << context
+                                           << "Compact block doesn't match its announced hash, dropping connection.";
+                context.m_pending_compact_block = std::nullopt;
+                context.m_state = CryptoNoteConnectionContext::state_shutdown;
+                return 1;
+            }
+
+            /* A short id matched the wrong pool transaction. Rare, so rather
+               than work out which, just fetch every one we didn't get sent */
+            logger(Logging::DEBUGGING) << context << "Compact block reconstruction failed, requesting all transactions";
+
+            const std::unordered_set<uint32_t> prefilled(
+                pending.request.prefilledIndexes.begin(), pending.request.prefilledIndexes.end());
+
+            for (uint32_t index = 0; index < pending.transactionHashes.size(); index++)
+            {
+                if (prefilled.count(index) == 0)
+                {
+                    pending.missingIndexes.push_back(index);
+                }
+            }
+
+            pending.requestedAll = true;
+
+            return processCompactBlock(context);
+        }
+
+        PendingCompactBlock complete = std::move(pending);
+        context.m_pending_compact_block = std::nullopt;
+
+        addRelayedBlock(
+            context,
+            toBinaryArray(block),
+            std::move(complete.transactions),
+            complete.request.current_blockchain_height,
+            complete.request.hop,
+            complete.unpooledTransactions);
+
+        return 1;
+    }
+
+    int CryptoNoteProtocolHandler::handle_request_chain(
+        int command,
+        NOTIFY_REQUEST_CHAIN::request &arg,
+        CryptoNoteConnectionContext &context)
+    {
+        logger(Logging::TRACE) << context << "NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << arg.block_ids.size();
+
+        if (arg.block_ids.empty())
+        {
+            logger(Logging::DEBUGGING, Logging::BRIGHT_RED)
+                << context << "Failed to handle NOTIFY_REQUEST_CHAIN. block_ids is empty";
+            context.m_state = CryptoNoteConnectionContext::state_shutdown;
+            return 1;
+        }
+
+        if (arg.block_ids.back() != m_core.getBlockHashByIndex(0))
+        {
+            logger(Logging::DEBUGGING)
+                << context << "Failed to handle NOTIFY_REQUEST_CHAIN. block_ids doesn't end with genesis block ID";
+            context.m_state = CryptoNoteConnectionContext::state_shutdown;
+            return 1;
+        }
+
+        NOTIFY_RESPONSE_CHAIN_ENTRY::request r;
+        r.m_block_ids = m_core.findBlockchainSupplement(
+            arg.block_ids, BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT, r.total_height, r.start_height);
+
+        logger(Logging::TRACE) << context << "-->>NOTIFY_RESPONSE_CHAIN_ENTRY: m_start_height=" << r.start_height
+                               << ", m_total_height=" << r.total_height
+                               << ", m_block_ids.size()=" << r.m_block_ids.size();
+        post_notify<NOTIFY_RESPONSE_CHAIN_ENTRY>(*m_p2p, r, context);
+        return 1;
+    }
+
+    bool CryptoNoteProtocolHandler::request_missing_objects(
+        CryptoNoteConnectionContext &context,
+        bool check_having_blocks)
+    {
+        if (context.m_needed_objects.size())
+        {
+            // we know objects that we need, request this objects
+            NOTIFY_REQUEST_GET_OBJECTS::request req;
+            size_t count = 0;
+            auto it = context.m_needed_objects.begin();
+
+            while (it != context.m_needed_objects.end() && count < BLOCKS_SYNCHRONIZING_DEFAULT_COUNT)
+            {
+                if (!(check_having_blocks && m_core.hasBlock(*it)))
+                {
+                    req.blocks.push_back(*it);
+                    ++count;
+                    context.m_requested_objects.insert(*it);
+                }
+                it = context.m_needed_objects.erase(it);
+            }
+            logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_GET_OBJECTS: blocks.size()=" << req.blocks.size()
+                                   << ", txs.size()=" << req.txs.size();
+            post_notify<NOTIFY_REQUEST_GET_OBJECTS>(*m_p2p, req, context);
+        }
+        else if (context.m_last_response_height < context.m_remote_blockchain_height - 1)
+        { // we have to fetch more objects ids, request blockchain entry
+
+            NOTIFY_REQUEST_CHAIN::request r = boost::value_initialized<NOTIFY_REQUEST_CHAIN::request>();
+            r.block_ids = m_core.buildSparseChain();
+            logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
+            post_notify<NOTIFY_REQUEST_CHAIN>(*m_p2p, r, context);
+        }
+        else
+        {
+            if (!(context.m_last_response_height == context.m_remote_blockchain_height - 1
+                  && !context.m_needed_objects.size() && !context.m_requested_objects.size()))
             {
                 logger(Logging::ERROR, Logging::BRIGHT_RED)
                     << "request_missing_blocks final condition failed!"
@@ -1112,6 +1697,38 @@ namespace CryptoNote
 
         std::vector<BinaryArray> txs;
         std::vector<Crypto::Hash> missedHashes;
+
+        /* A null block hash means the peer is fetching transactions we
+           announced, rather than the ones missing from a lite block */
+        if (arg.blockHash == Constants::NULL_HASH)
+        {
+            if (arg.missing_txs.size() > P2P_TX_ANNOUNCE_MAX_HASHES)
+            {
+                logger(Logging::DEBUGGING) << context << "Peer requested too many announced transactions, "
+                                                         "dropping connection";
+                context.m_state = CryptoNoteConnectionContext::state_shutdown;
+                return 1;
+            }
+
+            m_core.getTransactions(arg.missing_txs, txs, missedHashes);
+
+            /* They may have been mined or dropped from the pool since we
+               announced them, so just send what we still have */
+            if (txs.empty())
+            {
+                return 1;
+            }
+
+            req.txs = std::move(txs);
+
+            logger(Logging::TRACE) << context << "--> NOTIFY_NEW_TRANSACTIONS (announced): "
+                                   << "txs.size() = " << req.txs.size();
+
+            post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, req, context);
+
+            return 1;
+        }
+
         m_core.getTransactions(arg.missing_txs, txs, missedHashes);
         if (!missedHashes.empty())
         {
@@ -1140,56 +1757,345 @@ namespace CryptoNote
         return 1;
     }
 
-    void CryptoNoteProtocolHandler::relayBlock(NOTIFY_NEW_BLOCK::request &arg)
+    int CryptoNoteProtocolHandler::handle_notify_new_transaction_hashes(
+        int command,
+        NOTIFY_NEW_TRANSACTION_HASHES::request &arg,
+        CryptoNoteConnectionContext &context)
     {
-        // generate a lite block request from the received normal block.
-        NOTIFY_NEW_LITE_BLOCK::request lite_arg;
-        lite_arg.current_blockchain_height = arg.current_blockchain_height;
-        lite_arg.blockTemplate = arg.block.blockTemplate;
-        lite_arg.hop = arg.hop;
+        logger(Logging::TRACE) << context << "NOTIFY_NEW_TRANSACTION_HASHES: txs.size() = " << arg.txs.size();
+
+        if (context.m_state != CryptoNoteConnectionContext::state_normal)
+        {
+            return 1;
+        }
+
+        if (arg.txs.size() > P2P_TX_ANNOUNCE_MAX_HASHES)
+        {
+            logger(Logging::DEBUGGING) << context << "Peer announced too many transactions, dropping connection";
+            context.m_state = CryptoNoteConnectionContext::state_shutdown;
+            return 1;
+        }
+
+        NOTIFY_MISSING_TXS::request req;
+        req.blockHash = Constants::NULL_HASH;
+        req.current_blockchain_height = m_core.getTopBlockIndex() + 1;
 
-        // encoding the request for sending the blocks to peers.
-        auto buf = LevinProtocol::encode(arg);
-        auto lite_buf = LevinProtocol::encode(lite_arg);
+        {
+            std::scoped_lock lock(m_txAnnouncementsMutex);
 
-        // logging the msg size to see the difference in payload size.
-        logger(Logging::DEBUGGING) << "NOTIFY_NEW_BLOCK - MSG_SIZE = " << buf.size();
-        logger(Logging::DEBUGGING) << "NOTIFY_NEW_LITE_BLOCK - MSG_SIZE = " << lite_buf.size();
+            const auto now = std::chrono::steady_clock::now();
 
-        std::list<boost::uuids::uuid> liteBlockConnections, normalBlockConnections;
+            for (const auto &hash : arg.txs)
+            {
+                if (m_core.hasTransaction(hash))
+                {
+                    continue;
+                }
+
+                /* Skip it if another peer is already sending it to us */
+                if (m_requestedTransactions.emplace(hash, now).second)
+                {
+                    req.missing_txs.push_back(hash);
+                }
+            }
+        }
+
+        if (req.missing_txs.empty())
+        {
+            return 1;
+        }
+
+        logger(Logging::TRACE) << context << "--> NOTIFY_MISSING_TXS (announced): "
+                               << "missing_txs.size() = " << req.missing_txs.size();
+
+        if (!post_notify<NOTIFY_MISSING_TXS>(*m_p2p, req, context))
+        {
+            std::scoped_lock lock(m_txAnnouncementsMutex);
+
+            for (const auto &hash : req.missing_txs)
+            {
+                m_requestedTransactions.erase(hash);
+            }
+        }
+
+        return 1;
+    }
+
+    void CryptoNoteProtocolHandler::relayBlock(NOTIFY_NEW_BLOCK::request &arg)
+    {
+        relayNewBlock(
+            arg.block.blockTemplate, arg.block.transactions, arg.current_blockchain_height, arg.hop, {}, nullptr);
+    }
+
+    void CryptoNoteProtocolHandler::relayNewBlock(
+        const BinaryArray &blockTemplate,
+        const std::vector<BinaryArray> &transactions,
+        const uint32_t currentBlockchainHeight,
+        const uint32_t hop,
+        const std::unordered_set<Crypto::Hash> &unpooledTransactions,
+        const boost::uuids::uuid *excludeConnection)
+    {
+        std::list<boost::uuids::uuid> compactBlockConnections, liteBlockConnections, normalBlockConnections;
 
         // sort the peers into their support categories.
-        m_p2p->for_each_connection([this, &liteBlockConnections, &normalBlockConnections](
-                                       const CryptoNoteConnectionContext &ctx, uint64_t peerId) {
-            if (ctx.version >= P2P_LITE_BLOCKS_PROPOGATION_VERSION)
+        m_p2p->for_each_connection([&](const CryptoNoteConnectionContext &ctx, uint64_t peerId) {
+            if (excludeConnection != nullptr && ctx.m_connection_id == *excludeConnection)
+            {
+                return;
+            }
+
+            if (ctx.version >= P2P_COMPACT_BLOCKS_VERSION)
+            {
+                compactBlockConnections.push_back(ctx.m_connection_id);
+            }
+            else if (ctx.version >= P2P_LITE_BLOCKS_PROPOGATION_VERSION)
             {
-                logger(Logging::DEBUGGING) << ctx << "Peer supports lite-blocks... adding peer to lite block list";
                 liteBlockConnections.push_back(ctx.m_connection_id);
             }
             else
             {
-                logger(Logging::DEBUGGING)
-                    << ctx << "Peer doesn't support lite-blocks... adding peer to normal block list";
                 normalBlockConnections.push_back(ctx.m_connection_id);
             }
         });
 
-        // first send lite one's.. coz they are faster
+        // first send compact ones.. coz they are the smallest
+        if (!compactBlockConnections.empty())
+        {
+            BlockTemplate block;
+
+            if (fromBinaryArray(block, blockTemplate))
+            {
+                NOTIFY_NEW_COMPACT_BLOCK::request compact_arg;
+                compact_arg.current_blockchain_height = currentBlockchainHeight;
+                compact_arg.hop = hop;
+                compact_arg.blockHash = CachedBlock(block).getBlockHash();
+                compact_arg.nonce = Random::randomValue<uint64_t>();
+
+                const ShortIdKey key = getShortIdKey(compact_arg.blockHash, compact_arg.nonce);
+
+                /* Transactions we didn't have in our pool likely aren't in
+                   our peers' pools either, so save them the round trip */
+                const bool canPrefill = transactions.size() == block.transactionHashes.size();
+
+                for (uint32_t i = 0; i < block.transactionHashes.size(); i++)
+                {
+                    const auto &hash = block.transactionHashes[i];
+
+                    if (canPrefill && unpooledTransactions.count(hash) > 0)
+                    {
+                        compact_arg.prefilledIndexes.push_back(i);
+                        compact_arg.prefilledTransactions.push_back(transactions[i]);
+                    }
+                    else
+                    {
+                        compact_arg.shortIds.push_back(getShortId(key, hash));
+                    }
+                }
+
+                block.transactionHashes.clear();
+                compact_arg.blockTemplate = toBinaryArray(block);
+
+                auto compact_buf = LevinProtocol::encode(compact_arg);
+
+                logger(Logging::DEBUGGING) << "NOTIFY_NEW_COMPACT_BLOCK - MSG_SIZE = " << compact_buf.size();
+
+                m_p2p->externalRelayNotifyToList(NOTIFY_NEW_COMPACT_BLOCK::ID, compact_buf, compactBlockConnections);
+            }
+            else
+            {
+                logger(Logging::WARNING) << "Deserialization of Block Template failed, not relaying compact block";
+            }
+        }
+
         if (!liteBlockConnections.empty())
         {
+            NOTIFY_NEW_LITE_BLOCK::request lite_arg;
+            lite_arg.current_blockchain_height = currentBlockchainHeight;
+            lite_arg.blockTemplate = blockTemplate;
+            lite_arg.hop = hop;
+
+            auto lite_buf = LevinProtocol::encode(lite_arg);
+
+            logger(Logging::DEBUGGING) << "NOTIFY_NEW_LITE_BLOCK - MSG_SIZE = " << lite_buf.size();
+
             m_p2p->externalRelayNotifyToList(NOTIFY_NEW_LITE_BLOCK::ID, lite_buf, liteBlockConnections);
         }
 
         if (!normalBlockConnections.empty())
         {
+            NOTIFY_NEW_BLOCK::request arg;
+            arg.block = RawBlockLegacy(blockTemplate, transactions);
+            arg.current_blockchain_height = currentBlockchainHeight;
+            arg.hop = hop;
+
+            auto buf = LevinProtocol::encode(arg);
+
+            logger(Logging::DEBUGGING) << "NOTIFY_NEW_BLOCK - MSG_SIZE = " << buf.size();
+
             m_p2p->externalRelayNotifyToList(NOTIFY_NEW_BLOCK::ID, buf, normalBlockConnections);
         }
     }
 
     void CryptoNoteProtocolHandler::relayTransactions(const std::vector<BinaryArray> &transactions)
     {
-        auto buf = LevinProtocol::encode(NOTIFY_NEW_TRANSACTIONS::request {transactions});
-        m_p2p->externalRelayNotifyToAll(NOTIFY_NEW_TRANSACTIONS::ID, buf, nullptr);
+        queueTransactionAnnouncements(transactions, std::nullopt);
+    }
+
+    void CryptoNoteProtocolHandler::queueTransactionAnnouncements(
+        const std::vector<BinaryArray> &transactions,
+        const std::optional<boost::uuids::uuid> &source)
+    {
+        std::scoped_lock lock(m_txAnnouncementsMutex);
+
+        for (const auto &transaction : transactions)
+        {
+            m_pendingTxAnnouncements.push_back({getBinaryArrayHash(transaction), transaction, source});
+        }
+    }
+
+    void CryptoNoteProtocolHandler::flushTransactionAnnouncements()
+    {
+        std::vector<PendingTransactionAnnouncement> announcements;
+
+        {
+            std::scoped_lock lock(m_txAnnouncementsMutex);
+
+            announcements.swap(m_pendingTxAnnouncements);
+
+            /* Forget requests which were never answered, so the transaction
+               can be fetched from the next peer which announces it */
+            const auto now = std::chrono::steady_clock::now();
+
+            for (auto it = m_requestedTransactions.begin(); it != m_requestedTransactions.end();)
+            {
+                if (now - it->second > std::chrono::seconds(P2P_TX_REQUEST_TIMEOUT_SECONDS))
+                {
+                    it = m_requestedTransactions.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        if (announcements.empty())
+        {
+            return;
+        }
+
+        std::unordered_set<boost::uuids::uuid, boost::hash<boost::uuids::uuid>> sources;
+
+        for (const auto &announcement : announcements)
+        {
+            if (announcement.source)
+            {
+                sources.insert(*announcement.source);
+            }
+        }
+
+        /* Builds the messages for a peer, leaving out anything it sent us */
+        const auto makeHashes = [&announcements](const boost::uuids::uuid *exclude) {
+            std::vector<NOTIFY_NEW_TRANSACTION_HASHES::request> batches;
+
+            for (const auto &announcement : announcements)
+            {
+                if (exclude && announcement.source == *exclude)
+                {
+                    continue;
+                }
+
+                if (batches.empty() || batches.back().txs.size() >= P2P_TX_ANNOUNCE_MAX_HASHES)
+                {
+                    batches.emplace_back();
+                }
+
+                batches.back().txs.push_back(announcement.hash);
+            }
+
+            return batches;
+        };
+
+        const auto makeBlobs = [&announcements](const boost::uuids::uuid *exclude) {
+            NOTIFY_NEW_TRANSACTIONS::request request;
+
+            for (const auto &announcement : announcements)
+            {
+                if (!exclude || announcement.source != *exclude)
+                {
+                    request.txs.push_back(announcement.transaction);
+                }
+            }
+
+            return request;
+        };
+
+        /* Most peers get everything, so only encode that once */
+        std::vector<BinaryArray> allHashes;
+        std::optional<BinaryArray> allBlobs;
+
+        for (const auto &batch : makeHashes(nullptr))
+        {
+            allHashes.push_back(LevinProtocol::encode(batch));
+        }
+
+        size_t announced = 0, flooded = 0;
+
+        m_p2p->for_each_connection([&](const CryptoNoteConnectionContext &ctx, uint64_t peerId) {
+            if (ctx.m_state != CryptoNoteConnectionContext::state_normal
+                && ctx.m_state != CryptoNoteConnectionContext::state_synchronizing)
+            {
+                return;
+            }
+
+            const bool isSource = sources.count(ctx.m_connection_id) > 0;
+
+            if (ctx.version >= P2P_TX_ANNOUNCE_VERSION)
+            {
+                announced++;
+
+                if (!isSource)
+                {
+                    for (const auto &buffer : allHashes)
+                    {
+                        m_p2p->invoke_notify_to_peer(NOTIFY_NEW_TRANSACTION_HASHES::ID, buffer, ctx);
+                    }
+
+                    return;
+                }
+
+                for (auto &batch : makeHashes(&ctx.m_connection_id))
+                {
+                    post_notify<NOTIFY_NEW_TRANSACTION_HASHES>(*m_p2p, batch, ctx);
+                }
+            }
+            else
+            {
+                flooded++;
+
+                if (!isSource)
+                {
+                    if (!allBlobs)
+                    {
+                        allBlobs = LevinProtocol::encode(makeBlobs(nullptr));
+                    }
+
+                    m_p2p->invoke_notify_to_peer(NOTIFY_NEW_TRANSACTIONS::ID, *allBlobs, ctx);
+
+                    return;
+                }
+
+                auto request = makeBlobs(&ctx.m_connection_id);
+
+                if (!request.txs.empty())
+                {
+                    post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, request, ctx);
+                }
+            }
+        });
+
+        logger(Logging::TRACE) << "Relayed " << announcements.size() << " transactions, announced to " << announced
+                               << " peers, sent in full to " << flooded << " peers";
     }
 
     void CryptoNoteProtocolHandler::requestMissingPoolTransactions(const CryptoNoteConnectionContext &context)
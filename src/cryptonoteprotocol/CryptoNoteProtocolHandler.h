@@ -16,8 +16,16 @@
 #include "p2p/P2pProtocolDefinitions.h"
 
 #include <atomic>
+#include <boost/uuid/uuid.hpp>
+#include <chrono>
 #include <common/ObserverManager.h>
 #include <logging/LoggerRef.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utilities/ThreadPool.h>
 
 namespace System
 {
@@ -36,7 +44,9 @@ namespace CryptoNote
             System::Dispatcher &dispatcher,
             ICore &rcore,
             IP2pEndpoint *p_net_layout,
-            std::shared_ptr<Logging::ILogger> log);
+            std::shared_ptr<Logging::ILogger> log,
+            const uint32_t powVerificationThreads,
+            const uint32_t largeMessageDecodeThreads);
 
         virtual ~CryptoNoteProtocolHandler() override {};
 
@@ -86,6 +96,13 @@ namespace CryptoNote
 
         void requestMissingPoolTransactions(const CryptoNoteConnectionContext &context);
 
+        /* Sends the transactions queued since the last call to every peer
+           which didn't give them to us - as hashes to peers which support
+           announcements, and as full blobs to older peers. Must be called
+           from the P2P dispatcher, which does so every
+           P2P_TX_ANNOUNCE_INTERVAL_MILLISECONDS. */
+        void flushTransactionAnnouncements();
+
       private:
         //----------------- commands handlers ----------------------------------------------
         int handle_notify_new_block(int command, NOTIFY_NEW_BLOCK::request &arg, CryptoNoteConnectionContext &context);
@@ -127,6 +144,34 @@ namespace CryptoNote
             NOTIFY_MISSING_TXS::request &arg,
             CryptoNoteConnectionContext &context);
 
+        int handle_notify_new_transaction_hashes(
+            int command,
+            NOTIFY_NEW_TRANSACTION_HASHES::request &arg,
+            CryptoNoteConnectionContext &context);
+
+        int handle_notify_new_compact_block(
+            int command,
+            NOTIFY_NEW_COMPACT_BLOCK::request &arg,
+            CryptoNoteConnectionContext &context);
+
+        int handle_request_compact_block_txs(
+            int command,
+            NOTIFY_REQUEST_COMPACT_BLOCK_TXS::request &arg,
+            CryptoNoteConnectionContext &context);
+
+        int handle_response_compact_block_txs(
+            int command,
+            NOTIFY_RESPONSE_COMPACT_BLOCK_TXS::request &arg,
+            CryptoNoteConnectionContext &context);
+
+        template<typename Command, typename Handler>
+        int notifyAdaptor(const BinaryArray &reqBuf, CryptoNoteConnectionContext &ctx, Handler handler);
+
+        /* Decodes a request, handing it to the large message decode threads
+           if it is large enough to be worth it. The calling context waits for
+           the result, while the dispatcher carries on running the others. */
+        template<typename Request> bool decodeRequest(const BinaryArray &buffer, Request &request);
+
         //----------------- i_cryptonote_protocol ----------------------------------
         virtual void relayBlock(NOTIFY_NEW_BLOCK::request &arg) override;
 
@@ -148,6 +193,17 @@ namespace CryptoNote
             std::vector<RawBlock> &&rawBlocks,
             const std::vector<CachedBlock> &cachedBlocks);
 
+        /* Computes the long hash of every block above the checkpoint zone on
+           the PoW verification threads, so the memoised value in each
+           CachedBlock is already filled in when Core::addBlock checks it */
+        void verifyProofOfWork(const std::vector<CachedBlock> &cachedBlocks);
+
+        /* Queues transactions to be relayed on the next flush. source is the
+           connection they came from, if any, which they won't be sent back to */
+        void queueTransactionAnnouncements(
+            const std::vector<BinaryArray> &transactions,
+            const std::optional<boost::uuids::uuid> &source);
+
         Logging::LoggerRef logger;
 
       private:
@@ -156,6 +212,41 @@ namespace CryptoNote
             CryptoNoteConnectionContext &context,
             std::vector<BinaryArray> missingTxs);
 
+        /* Requests the transactions the pending compact block is missing if
+           there are any, otherwise adds it */
+        int processCompactBlock(CryptoNoteConnectionContext &context);
+
+        /* Adds a block a peer relayed to us, and relays it on if it extends
+           our main chain */
+        void addRelayedBlock(
+            CryptoNoteConnectionContext &context,
+            BinaryArray blockTemplate,
+            std::vector<BinaryArray> transactions,
+            const uint32_t currentBlockchainHeight,
+            const uint32_t hop,
+            const std::unordered_set<Crypto::Hash> &unpooledTransactions);
+
+        /* Relays a block as a compact block, lite block or full block,
+           depending on what each peer supports. unpooledTransactions are
+           sent in full in the compact block. */
+        void relayNewBlock(
+            const BinaryArray &blockTemplate,
+            const std::vector<BinaryArray> &transactions,
+            const uint32_t currentBlockchainHeight,
+            const uint32_t hop,
+            const std::unordered_set<Crypto::Hash> &unpooledTransactions,
+            const boost::uuids::uuid *excludeConnection);
+
+      private:
+        struct PendingTransactionAnnouncement
+        {
+            Crypto::Hash hash;
+
+            BinaryArray transaction;
+
+            std::optional<boost::uuids::uuid> source;
+        };
+
       private:
         System::Dispatcher &m_dispatcher;
 
@@ -171,6 +262,26 @@ namespace CryptoNote
 
         std::atomic<bool> m_stop;
 
+        /* Null if PoW verification is disabled (0 threads), in which case
+           the hashes are computed serially in Core::addBlock */
+        std::unique_ptr<Utilities::ThreadPool<bool>> m_powVerificationThreadPool;
+
+        uint32_t m_powVerificationThreads;
+
+        /* Decodes messages of at least P2P_DECODE_OFFLOAD_THRESHOLD bytes. Null if
+           decoding on other threads is disabled (0 threads). */
+        std::unique_ptr<Utilities::ThreadPool<bool>> m_largeMessageDecodeThreadPool;
+
+        /* Guards m_pendingTxAnnouncements and m_requestedTransactions, since
+           relayTransactions() can be called from outside the dispatcher */
+        std::mutex m_txAnnouncementsMutex;
+
+        std::vector<PendingTransactionAnnouncement> m_pendingTxAnnouncements;
+
+        /* Announced transactions we've asked a peer for, and when. While an
+           entry is here we don't ask any other peer which announces it. */
+        std::unordered_map<Crypto::Hash, std::chrono::steady_clock::time_point> m_requestedTransactions;
+
         mutable std::mutex m_observedHeightMutex;
 
         uint32_t m_observedHeight;
@@ -7,14 +7,26 @@
 #include "CryptoNote.h"
 #include "CryptoTypes.h"
 #include "common/StringTools.h"
+#include "crypto/chukwa.h"
 #include "crypto/crypto.h"
 #include "crypto/multisig.h"
+#include "crypto/siphash.h"
 
 #include <assert.h>
 #include <chrono>
+#include <cmath>
+#include <common/CryptoNoteTools.h>
+#include <common/TransactionExtra.h>
 #include <config/CliHeader.h>
 #include <cxxopts.hpp>
+#include <fstream>
 #include <iostream>
+#include <random>
+#include <system/ContextGroup.h>
+#include <system/Dispatcher.h>
+#include <system/Event.h>
+#include <thread>
+#include <utilities/ThreadPool.h>
 
 #define PERFORMANCE_ITERATIONS 1000
 #define PERFORMANCE_ITERATIONS_LONG_MULTIPLIER 10
@@ -277,6 +289,521 @@ void benchmarkGenerateKeyDerivation()
     std::cout << "Time to perform generateKeyDerivation: " << timePerDerivation / 1000.0 << " ms" << std::endl;
 }
 
+/* The vectors from the SipHash reference implementation. The key is the
+   bytes 0 to 15, and message i is the bytes 0 to i - 1. */
+void testSipHash()
+{
+    const uint64_t expected[64] = {
+        0x726fdb47dd0e0e31, 0x74f839c593dc67fd,
+        0x0d6c8009d9a94f5a, 0x85676696d7fb7e2d,
+        0xcf2794e0277187b7, 0x18765564cd99a68d,
+        0xcbc9466e58fee3ce, 0xab0200f58b01d137,
+        0x93f5f5799a932462, 0x9e0082df0ba9e4b0,
+        0x7a5dbbc594ddb9f3, 0xf4b32f46226bada7,
+        0x751e8fbc860ee5fb, 0x14ea5627c0843d90,
+        0xf723ca908e7af2ee, 0xa129ca6149be45e5,
+        0x3f2acc7f57c29bdb, 0x699ae9f52cbe4794,
+        0x4bc1b3f0968dd39c, 0xbb6dc91da77961bd,
+        0xbed65cf21aa2ee98, 0xd0f2cbb02e3b67c7,
+        0x93536795e3a33e88, 0xa80c038ccd5ccec8,
+        0xb8ad50c6f649af94, 0xbce192de8a85b8ea,
+        0x17d835b85bbb15f3, 0x2f2e6163076bcfad,
+        0xde4daaaca71dc9a5, 0xa6a2506687956571,
+        0xad87a3535c49ef28, 0x32d892fad841c342,
+        0x7127512f72f27cce, 0xa7f32346f95978e3,
+        0x12e0b01abb051238, 0x15e034d40fa197ae,
+        0x314dffbe0815a3b4, 0x027990f029623981,
+        0xcadcd4e59ef40c4d, 0x9abfd8766a33735c,
+        0x0e3ea96b5304a7d0, 0xad0c42d6fc585992,
+        0x187306c89bc215a9, 0xd4a60abcf3792b95,
+        0xf935451de4f21df2, 0xa9538f0419755787,
+        0xdb9acddff56ca510, 0xd06c98cd5c0975eb,
+        0xe612a3cb9ecba951, 0xc766e62cfcadaf96,
+        0xee64435a9752fe72, 0xa192d576b245165a,
+        0x0a8787bf8ecb74b2, 0x81b3e73d20b49b6f,
+        0x7fa8220ba3b2ecea, 0x245731c13ca42499,
+        0xb78dbfaf3a8d83bd, 0xea1ad565322a1a0b,
+        0x60e61c23a3795013, 0x6606d7e446282b93,
+        0x6ca4ecb15c5f91e1, 0x9f626da15c9625f3,
+        0xe51b38608ef25f57, 0x958a324ceb064572
+    };
+
+    uint8_t data[64];
+
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+        data[i] = static_cast<uint8_t>(i);
+    }
+
+    const uint64_t k0 = 0x0706050403020100;
+    const uint64_t k1 = 0x0f0e0d0c0b0a0908;
+
+    for (size_t length = 0; length < 64; length++)
+    {
+        const uint64_t hash = Crypto::siphash24(data, length, k0, k1);
+
+        if (hash != expected[length])
+        {
+            std::cout << "siphash24 of " << length << " bytes is not equal!\n"
+                      << "Expected: " << std::hex << expected[length] << "\nActual: " << hash << "\nTerminating.";
+
+            exit(1);
+        }
+    }
+
+    std::cout << "siphash24: 64 reference vectors verified" << std::endl;
+}
+
+Crypto::ChukwaExecutor poolExecutor(Utilities::ThreadPool<bool> &pool)
+{
+    return [&pool](std::function<bool()> job) { return pool.addJob(std::move(job)); };
+}
+
+void testChukwaBatch()
+{
+    const BinaryArray &rawData = Common::fromHex(INPUT_DATA);
+
+    const std::vector<Crypto::ChukwaInput> inputs(16, {rawData.data(), rawData.size()});
+
+    std::vector<Hash> hashes;
+
+    Utilities::ThreadPool<bool> pool;
+
+    if (!Crypto::chukwa_slow_hash_batch(inputs, hashes, poolExecutor(pool), pool.threadCount()))
+    {
+        std::cout << "Batched chukwa hashing failed!\nTerminating.";
+
+        exit(1);
+    }
+
+    for (const auto &hash : hashes)
+    {
+        if (!CompareHashes(hash, CHUKWA_LITE))
+        {
+            std::cout << "Batched chukwa hashes are not equal!\n"
+                      << "Expected: " << CHUKWA_LITE << "\nActual: " << hash << "\nTerminating.";
+
+            exit(1);
+        }
+    }
+
+    std::cout << "chukwa_slow_hash_batch: " << hashes.size() << " hashes verified" << std::endl;
+}
+
+/* Compare allocating the Argon2 memory for every hash against reusing a
+   ChukwaContext, with and without huge pages */
+void benchmarkChukwaContext(const uint64_t iterations)
+{
+    const BinaryArray &rawData = Common::fromHex(INPUT_DATA);
+
+    Hash hash = Hash();
+
+    const auto run = [&](const std::string &name, const auto &hashFunction) {
+        auto startTimer = std::chrono::high_resolution_clock::now();
+
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            hashFunction(rawData.data(), rawData.size(), hash);
+        }
+
+        const std::chrono::duration<double> elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+        std::cout << name << ": " << static_cast<uint64_t>(iterations / elapsedTime.count()) << " H/s\n";
+    };
+
+    run("chukwa_slow_hash (argon2id_hash_raw)", [](const void *data, size_t length, Hash &hash) {
+        argon2id_hash_raw(
+            CHUKWA_ITERS, CHUKWA_MEMORY, CHUKWA_THREADS, data, length, data, CHUKWA_SALTLEN, hash.data, CHUKWA_HASHLEN);
+    });
+
+    Crypto::ChukwaContext context;
+
+    run("chukwa_slow_hash (ChukwaContext)", [&](const void *data, size_t length, Hash &hash) {
+        context.hash(data, length, hash);
+    });
+
+    Crypto::ChukwaContext hugePageContext(true);
+
+    if (hugePageContext.hugePages())
+    {
+        run("chukwa_slow_hash (ChukwaContext, huge pages)", [&](const void *data, size_t length, Hash &hash) {
+            hugePageContext.hash(data, length, hash);
+        });
+    }
+}
+
+void benchmarkChukwaBatch(const uint64_t iterations)
+{
+    const BinaryArray &rawData = Common::fromHex(INPUT_DATA);
+
+    const std::vector<Crypto::ChukwaInput> inputs(iterations, {rawData.data(), rawData.size()});
+
+    std::vector<Hash> hashes;
+
+    for (size_t threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2)
+    {
+        /* Started and given a first batch outside the timer, as callers
+           keep their pool and its thread contexts between batches */
+        Utilities::ThreadPool<bool> pool(threads);
+
+        Crypto::chukwa_slow_hash_batch(
+            std::vector<Crypto::ChukwaInput>(inputs.begin(), inputs.begin() + std::min<size_t>(threads, inputs.size())),
+            hashes,
+            poolExecutor(pool),
+            pool.threadCount());
+
+        auto startTimer = std::chrono::high_resolution_clock::now();
+
+        Crypto::chukwa_slow_hash_batch(inputs, hashes, poolExecutor(pool), pool.threadCount());
+
+        const std::chrono::duration<double> elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+        std::cout << "chukwa_slow_hash_batch (" << threads << " threads): "
+                  << static_cast<uint64_t>(iterations / elapsedTime.count()) << " H/s\n";
+    }
+}
+
+/* Throughput of the System::Dispatcher operations every P2P message and
+   timer goes through */
+void benchmarkDispatcher(const uint64_t iterations)
+{
+    System::Dispatcher dispatcher;
+
+    const auto report = [&](const std::string &name, const auto &startTimer) {
+        const std::chrono::duration<double> elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+        std::cout << name << ": " << static_cast<uint64_t>(iterations / elapsedTime.count()) << " ops/s\n";
+    };
+
+    {
+        System::ContextGroup contextGroup(dispatcher);
+
+        auto startTimer = std::chrono::high_resolution_clock::now();
+
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            contextGroup.spawn([] {});
+        }
+
+        contextGroup.wait();
+
+        report("System::ContextGroup::spawn", startTimer);
+    }
+
+    {
+        System::ContextGroup contextGroup(dispatcher);
+
+        auto startTimer = std::chrono::high_resolution_clock::now();
+
+        /* Two contexts yielding back and forth, one switch per yield */
+        for (int i = 0; i < 2; i++)
+        {
+            contextGroup.spawn([&dispatcher, iterations] {
+                for (uint64_t j = 0; j < iterations / 2; j++)
+                {
+                    dispatcher.yield();
+                }
+            });
+        }
+
+        contextGroup.wait();
+
+        report("System::Dispatcher::yield", startTimer);
+    }
+
+    {
+        System::Event done(dispatcher);
+
+        uint64_t completed = 0;
+
+        auto startTimer = std::chrono::high_resolution_clock::now();
+
+        std::thread producer([&] {
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                dispatcher.remoteSpawn([&] {
+                    if (++completed == iterations)
+                    {
+                        done.set();
+                    }
+                });
+            }
+        });
+
+        done.wait();
+
+        producer.join();
+
+        report("System::Dispatcher::remoteSpawn", startTimer);
+    }
+}
+
+/* Mainnet shaped blocks for benchmarkBlockSerialization() when no export is
+   given: a merge mined header, a coinbase, and a handful of transactions
+   with ring size 4 inputs and a payment ID */
+std::vector<RawBlock> generateBlocks(const size_t count)
+{
+    std::mt19937_64 gen(0);
+
+    const auto randomPod = [&gen](auto &pod) {
+        uint8_t *bytes = reinterpret_cast<uint8_t *>(&pod);
+
+        for (size_t i = 0; i < sizeof(pod); i++)
+        {
+            bytes[i] = static_cast<uint8_t>(gen());
+        }
+    };
+
+    const auto makeExtra = [&]() {
+        std::vector<uint8_t> extra;
+
+        Crypto::PublicKey publicKey;
+        randomPod(publicKey);
+        addTransactionPublicKeyToExtra(extra, publicKey);
+
+        return extra;
+    };
+
+    const auto makeOutputs = [&](const size_t outputCount) {
+        std::vector<TransactionOutput> outputs(outputCount);
+
+        for (auto &output : outputs)
+        {
+            KeyOutput key;
+            randomPod(key.key);
+
+            output.amount = (gen() % 9 + 1) * static_cast<uint64_t>(std::pow(10, gen() % 12));
+            output.target = key;
+        }
+
+        return outputs;
+    };
+
+    std::vector<RawBlock> blocks;
+
+    for (size_t height = 1; height <= count; height++)
+    {
+        BlockTemplate block;
+        block.majorVersion = BLOCK_MAJOR_VERSION_7;
+        block.minorVersion = 0;
+        block.timestamp = 1'550'000'000 + height * 30;
+        randomPod(block.previousBlockHash);
+        randomPod(block.nonce);
+
+        block.parentBlock.majorVersion = BLOCK_MAJOR_VERSION_1;
+        block.parentBlock.minorVersion = 0;
+        block.parentBlock.transactionCount = 1;
+        block.parentBlock.baseTransaction.version = TRANSACTION_VERSION_1;
+        block.parentBlock.baseTransaction.unlockTime = 0;
+        appendMergeMiningTagToExtra(block.parentBlock.baseTransaction.extra, TransactionExtraMergeMiningTag {0, {}});
+
+        block.baseTransaction.version = TRANSACTION_VERSION_1;
+        block.baseTransaction.unlockTime = height + 40;
+        block.baseTransaction.inputs.push_back(BaseInput {static_cast<uint32_t>(height)});
+        block.baseTransaction.outputs = makeOutputs(gen() % 4 + 3);
+        block.baseTransaction.extra = makeExtra();
+
+        RawBlock rawBlock;
+
+        for (size_t t = gen() % 8; t > 0; t--)
+        {
+            Transaction transaction;
+            transaction.version = TRANSACTION_VERSION_1;
+            transaction.unlockTime = 0;
+
+            for (size_t i = gen() % 3 + 1; i > 0; i--)
+            {
+                KeyInput input;
+                input.amount = (gen() % 9 + 1) * static_cast<uint64_t>(std::pow(10, gen() % 12));
+                randomPod(input.keyImage);
+
+                for (int ring = 0; ring < 4; ring++)
+                {
+                    input.outputIndexes.push_back(static_cast<uint32_t>(gen() % 1'000'000));
+                }
+
+                std::vector<Crypto::Signature> signatures(input.outputIndexes.size());
+
+                for (auto &signature : signatures)
+                {
+                    randomPod(signature);
+                }
+
+                transaction.inputs.push_back(input);
+                transaction.signatures.push_back(signatures);
+            }
+
+            transaction.outputs = makeOutputs(gen() % 8 + 2);
+            transaction.extra = makeExtra();
+
+            Crypto::Hash paymentId;
+            randomPod(paymentId);
+
+            BinaryArray nonce;
+            setPaymentIdToTransactionExtraNonce(nonce, paymentId);
+            addExtraNonceToTransactionExtra(transaction.extra, nonce);
+
+            rawBlock.transactions.push_back(toBinaryArray(transaction));
+            block.transactionHashes.push_back(getObjectHash(transaction));
+        }
+
+        rawBlock.block = toBinaryArray(block);
+
+        blocks.push_back(rawBlock);
+    }
+
+    return blocks;
+}
+
+/* Reads the blocks written by wrkzd --export-blockchain. Each one is stored
+   as its height and size as text, then the serialized RawBlock. */
+std::vector<RawBlock> readBlocks(const std::string &filename, const size_t count)
+{
+    std::ifstream file(filename, std::ios::binary);
+
+    std::vector<RawBlock> blocks;
+
+    uint64_t height;
+    uint64_t size;
+
+    while (blocks.size() < count && file >> height >> size)
+    {
+        /* Skip the separating space */
+        file.get();
+
+        BinaryArray blob(size);
+
+        if (!file.read(reinterpret_cast<char *>(blob.data()), size))
+        {
+            break;
+        }
+
+        blocks.push_back(fromBinaryArray<RawBlock>(blob));
+    }
+
+    return blocks;
+}
+
+/* Parses, sizes and re-serializes every block and transaction, first with
+   the stream based serializers and then with the buffer based ones */
+void benchmarkBlockSerialization(const std::string &blocksFile, const size_t blockCount)
+{
+    const std::vector<RawBlock> blocks =
+        blocksFile.empty() ? generateBlocks(blockCount) : readBlocks(blocksFile, blockCount);
+
+    if (blocks.empty())
+    {
+        std::cout << "No blocks to benchmark serialization with\n";
+        return;
+    }
+
+    size_t transactionCount = 0;
+
+    for (const auto &block : blocks)
+    {
+        transactionCount += block.transactions.size();
+    }
+
+    const auto run = [&](const std::string &name, const auto &parse, const auto &store) {
+        uint64_t checksum = 0;
+
+        auto startTimer = std::chrono::high_resolution_clock::now();
+
+        for (const auto &rawBlock : blocks)
+        {
+            BlockTemplate block;
+            parse(rawBlock.block, block);
+            checksum += store(block).size();
+
+            for (const auto &rawTransaction : rawBlock.transactions)
+            {
+                Transaction transaction;
+                parse(rawTransaction, transaction);
+                checksum += store(transaction).size();
+            }
+        }
+
+        const std::chrono::duration<double> elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+        std::cout << name << ": " << static_cast<uint64_t>(blocks.size() / elapsedTime.count()) << " blocks/s, "
+                  << static_cast<uint64_t>(transactionCount / elapsedTime.count()) << " transactions/s"
+                  << " (" << checksum << " bytes)\n";
+    };
+
+    std::cout << "Serializing " << blocks.size() << " blocks with " << transactionCount << " transactions\n";
+
+    run(
+        "BinaryInputStreamSerializer + BinaryOutputStreamSerializer",
+        [](const BinaryArray &blob, auto &object) {
+            Common::MemoryInputStream stream(blob.data(), blob.size());
+            BinaryInputStreamSerializer serializer(stream);
+            serialize(object, serializer);
+        },
+        [](auto &object) {
+            BinaryArray blob;
+            Common::VectorOutputStream stream(blob);
+            BinaryOutputStreamSerializer serializer(stream);
+            serialize(object, serializer);
+            return blob;
+        });
+
+    run(
+        "BinaryInputBufferSerializer + BinaryOutputBufferSerializer",
+        [](const BinaryArray &blob, auto &object) {
+            BinaryInputBufferSerializer serializer(blob.data(), blob.size());
+            serialize(object, serializer);
+        },
+        [](auto &object) {
+            BinaryArray blob;
+            BinaryOutputBufferSerializer serializer(blob);
+            serialize(object, serializer);
+            return blob;
+        });
+
+    uint64_t blobSizes = 0;
+    uint64_t countedSizes = 0;
+
+    std::vector<Transaction> transactions;
+
+    for (const auto &rawBlock : blocks)
+    {
+        for (const auto &rawTransaction : rawBlock.transactions)
+        {
+            transactions.push_back(fromBinaryArray<Transaction>(rawTransaction));
+        }
+    }
+
+    auto startTimer = std::chrono::high_resolution_clock::now();
+
+    for (const auto &transaction : transactions)
+    {
+        blobSizes += toBinaryArray(transaction).size();
+    }
+
+    const std::chrono::duration<double> blobTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    startTimer = std::chrono::high_resolution_clock::now();
+
+    for (const auto &transaction : transactions)
+    {
+        countedSizes += getObjectBinarySize(transaction);
+    }
+
+    const std::chrono::duration<double> countTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    if (blobSizes != countedSizes)
+    {
+        std::cout << "BinarySizeSerializer size mismatch: " << countedSizes << " != " << blobSizes << "\n";
+        return;
+    }
+
+    std::cout << "Transaction size via toBinaryArray: " << static_cast<uint64_t>(transactions.size() / blobTime.count())
+              << " transactions/s\n";
+
+    std::cout << "Transaction size via BinarySizeSerializer: "
+              << static_cast<uint64_t>(transactions.size() / countTime.count()) << " transactions/s\n";
+}
+
 void TestDeterministicSubwalletCreation(
     const std::string baseSpendKey,
     const uint64_t subWalletIndex,
@@ -316,6 +843,7 @@ int main(int argc, char **argv)
 {
     bool o_help, o_version, o_benchmark;
     int o_iterations;
+    std::string o_blocks;
 
     cxxopts::Options options(argv[0], getProjectCLIHeader());
 
@@ -332,7 +860,12 @@ int main(int argc, char **argv)
         "i,iterations",
         "The number of iterations for the benchmark test. Minimum of 1,000 iterations required.",
         cxxopts::value<int>(o_iterations)->default_value(std::to_string(PERFORMANCE_ITERATIONS)),
-        "#");
+        "#")(
+        "blocks",
+        "A blockchain export (see wrkzd --export-blockchain) to benchmark block serialization with. Generated "
+        "blocks are used if not given.",
+        cxxopts::value<std::string>(o_blocks)->default_value(""),
+        "<file>");
 
     try
     {
@@ -661,6 +1194,12 @@ int main(int argc, char **argv)
             std::cout << "passed" << std::endl;
         }
 
+        /* These don't depend on any of the hash function checks below, so
+           don't let a mismatch in one of those stop them running */
+        testSipHash();
+
+        testChukwaBatch();
+
         std::cout << std::endl << "Input: " << INPUT_DATA << std::endl << std::endl;
 
         TEST_HASH_FUNCTION(cn_slow_hash_v0, CN_SLOW_HASH_V0);
@@ -758,6 +1297,13 @@ int main(int argc, char **argv)
             BENCHMARK(cn_turtle_lite_slow_hash_v2, o_iterations_long);
 
             BENCHMARK(chukwa_slow_hash, o_iterations_long);
+
+            benchmarkChukwaContext(o_iterations_long);
+            benchmarkChukwaBatch(o_iterations_long);
+
+            benchmarkDispatcher(o_iterations * 1000);
+
+            benchmarkBlockSerialization(o_blocks, o_iterations * 4);
         }
     }
     catch (std::exception &e)
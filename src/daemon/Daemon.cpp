@@ -182,6 +182,7 @@ int main(int argc, char *argv[])
 
         std::vector<fs::path> removablePaths = {
             fs::path(config.dataDirectory) / CryptoNote::parameters::P2P_NET_DATA_FILENAME,
+            fs::path(config.dataDirectory) / CryptoNote::parameters::BLOCK_HASH_INDEX_FILENAME,
             fs::path(config.dataDirectory) / "DB"
         };
 
@@ -238,7 +239,8 @@ int main(int argc, char *argv[])
         // configure logging
         logManager->configure(buildLoggerConfiguration(cfgLogLevel, cfgLogFile.string()));
 
-        Logger::logger.setLogLevel(Logger::DEBUG);
+        /* Anything the log manager would drop isn't worth formatting */
+        Logger::logger.setLogLevel(Logger::fromLoggingLevel(cfgLogLevel));
 
         /* New logger, for now just passing through messages to old logger */
         Logger::logger.setLogCallback([&logger](
@@ -384,7 +386,10 @@ int main(int argc, char *argv[])
             logManager,
             std::move(checkpoints),
             dispatcher,
-            std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(*database, logger.getLogger())),
+            std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(
+                *database,
+                logger.getLogger(),
+                (fs::path(config.dataDirectory) / CryptoNote::parameters::BLOCK_HASH_INDEX_FILENAME).string())),
             config.transactionValidationThreads
         );
 
@@ -453,7 +458,9 @@ int main(int argc, char *argv[])
             dispatcher,
             *ccore,
             nullptr,
-            logManager
+            logManager,
+            config.powVerificationThreads,
+            config.p2pLargeMessageDecodeThreads
         );
 
         const auto p2psrv = std::make_shared<CryptoNote::NodeServer>(
@@ -484,9 +491,13 @@ int main(int argc, char *argv[])
             config.feeAddress,
             config.feeAmount,
             rpcMode,
+            config.enableViewKeyScanning,
+            config.rpcThreads,
+            config.rpcMaxQueuedRequests,
             ccore,
             p2psrv,
-            cprotocol
+            cprotocol,
+            dispatcher
         );
 
         cprotocol->set_p2p_endpoint(&(*p2psrv));
@@ -14,6 +14,7 @@
 #include <cryptonoteprotocol/CryptoNoteProtocolHandler.h>
 #include <ctime>
 #include <daemon/DaemonCommandsHandler.h>
+#include <logger/Logger.h>
 #include <p2p/NetNode.h>
 #include <rpc/JsonRpc.h>
 #include <serialization/SerializationTools.h>
@@ -135,6 +136,7 @@ bool DaemonCommandsHandler::exit(const std::vector<std::string> &args)
     /* Set log to max when exiting. Sometimes this takes a while, and it helps
        to let users know the daemon is still doing stuff */
     m_logManager->setMaxLevel(Logging::TRACE);
+    Logger::logger.setLogLevel(Logger::fromLoggingLevel(Logging::TRACE));
     m_consoleHandler.requestStop();
     m_srv.sendStopSignal();
     return true;
@@ -186,6 +188,7 @@ bool DaemonCommandsHandler::set_log(const std::vector<std::string> &args)
     }
 
     m_logManager->setMaxLevel(static_cast<Logging::Level>(l));
+    Logger::logger.setLogLevel(Logger::fromLoggingLevel(static_cast<Logging::Level>(l)));
     return true;
 }
 
@@ -106,6 +106,10 @@ namespace DaemonConfig
             "enable-mining",
             "Enable Mining RPC",
             cxxopts::value<bool>()->default_value("false")->implicit_value("true"))(
+            "enable-view-key-scanning",
+            "Enable the view key scanning RPC, which lets wallets on this machine have the daemon scan for their "
+            "outputs. Only accepts requests from localhost",
+            cxxopts::value<bool>()->default_value("false")->implicit_value("true"))(
             "enable-cors",
             "Adds header 'Access-Control-Allow-Origin' to the RPC responses using the <domain>. Uses the value "
             "specified as the domain. Use * for all.",
@@ -142,6 +146,12 @@ namespace DaemonConfig
             "p2p-reset-peerstate",
             "Generate a new peer ID and remove known peers saved previously",
             cxxopts::value<bool>()->default_value("false")->implicit_value("true"))(
+            "p2p-large-message-decode-threads",
+            "Number of threads to decode P2P messages of 64KB or more on, such as synced block batches, so the P2P "
+            "thread can keep serving other peers. All other P2P work stays on the P2P thread. 0 decodes every "
+            "message on the P2P thread",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(config.p2pLargeMessageDecodeThreads)),
+            "#")(
             "rpc-bind-ip",
             "Interface IP address for the RPC service",
             cxxopts::value<std::string>()->default_value(config.rpcInterface),
@@ -149,6 +159,15 @@ namespace DaemonConfig
             "rpc-bind-port",
             "TCP port for the RPC service",
             cxxopts::value<int>()->default_value(std::to_string(config.rpcPort)),
+            "#")(
+            "rpc-threads",
+            "Number of RPC requests to handle at once. A share of them is kept for mining and sending transactions, "
+            "so wallet and explorer load can't hold those up",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(config.rpcThreads)),
+            "#")(
+            "rpc-max-queued-requests",
+            "Number of RPC requests of each kind that may wait to be handled. Any more are rejected with a 503",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(config.rpcMaxQueuedRequests)),
             "#");
 
         options.add_options("Peer")(
@@ -216,6 +235,11 @@ namespace DaemonConfig
             "transaction-validation-threads",
             "Number of threads to use to validate a transaction's inputs in parallel",
             cxxopts::value<uint32_t>()->default_value(std::to_string(config.transactionValidationThreads)),
+            "#")(
+            "pow-verification-threads",
+            "Number of threads to use to verify the proof of work of synced blocks above the last checkpoint in "
+            "parallel. 0 verifies them one at a time as they are added",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(config.powVerificationThreads)),
             "#");
 
         try
@@ -388,6 +412,11 @@ namespace DaemonConfig
                 config.p2pExternalPort = cli["p2p-external-port"].as<int>();
             }
 
+            if (cli.count("p2p-large-message-decode-threads") > 0)
+            {
+                config.p2pLargeMessageDecodeThreads = cli["p2p-large-message-decode-threads"].as<uint32_t>();
+            }
+
             if (cli.count("p2p-reset-peerstate") > 0)
             {
                 config.p2pResetPeerstate = cli["p2p-reset-peerstate"].as<bool>();
@@ -403,6 +432,16 @@ namespace DaemonConfig
                 config.rpcPort = cli["rpc-bind-port"].as<int>();
             }
 
+            if (cli.count("rpc-threads") > 0)
+            {
+                config.rpcThreads = cli["rpc-threads"].as<uint32_t>();
+            }
+
+            if (cli.count("rpc-max-queued-requests") > 0)
+            {
+                config.rpcMaxQueuedRequests = cli["rpc-max-queued-requests"].as<uint32_t>();
+            }
+
             if (cli.count("add-exclusive-node") > 0)
             {
                 config.exclusiveNodes = cli["add-exclusive-node"].as<std::vector<std::string>>();
@@ -438,6 +477,11 @@ namespace DaemonConfig
                 config.enableMining = cli["enable-mining"].as<bool>();
             }
 
+            if (cli.count("enable-view-key-scanning") > 0)
+            {
+                config.enableViewKeyScanning = cli["enable-view-key-scanning"].as<bool>();
+            }
+
             if (cli.count("enable-cors") > 0)
             {
                 config.enableCors = cli["enable-cors"].as<std::string>();
@@ -458,6 +502,11 @@ namespace DaemonConfig
                 config.transactionValidationThreads = cli["transaction-validation-threads"].as<uint32_t>();
             }
 
+            if (cli.count("pow-verification-threads") > 0)
+            {
+                config.powVerificationThreads = cli["pow-verification-threads"].as<uint32_t>();
+            }
+
             if (config.help) // Do we want to display the help message?
             {
                 std::cout << options.help({}) << std::endl;
@@ -663,6 +712,42 @@ namespace DaemonConfig
                         throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey);
                     }
                 }
+                else if (cfgKey.compare("rpc-threads") == 0)
+                {
+                    try
+                    {
+                        config.rpcThreads = std::stoi(cfgValue);
+                        updated = true;
+                    }
+                    catch (std::exception &e)
+                    {
+                        throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey);
+                    }
+                }
+                else if (cfgKey.compare("rpc-max-queued-requests") == 0)
+                {
+                    try
+                    {
+                        config.rpcMaxQueuedRequests = std::stoi(cfgValue);
+                        updated = true;
+                    }
+                    catch (std::exception &e)
+                    {
+                        throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey);
+                    }
+                }
+                else if (cfgKey.compare("p2p-large-message-decode-threads") == 0)
+                {
+                    try
+                    {
+                        config.p2pLargeMessageDecodeThreads = std::stoi(cfgValue);
+                        updated = true;
+                    }
+                    catch (std::exception &e)
+                    {
+                        throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey);
+                    }
+                }
                 else if (cfgKey.compare("p2p-reset-peerstate") == 0)
                 {
                     config.p2pResetPeerstate = cfgValue.at(0) == '1' ? true : false;
@@ -707,6 +792,11 @@ namespace DaemonConfig
                     config.enableMining = cfgValue.at(0) == '1';
                     updated = true;
                 }
+                else if (cfgKey.compare("enable-view-key-scanning") == 0)
+                {
+                    config.enableViewKeyScanning = cfgValue.at(0) == '1';
+                    updated = true;
+                }
                 else if (cfgKey.compare("enable-cors") == 0)
                 {
                     cors = cfgValue;
@@ -742,6 +832,18 @@ namespace DaemonConfig
                         throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey);
                     }
                 }
+                else if (cfgKey.compare("pow-verification-threads") == 0)
+                {
+                    try
+                    {
+                        config.powVerificationThreads = std::stoi(cfgValue);
+                        updated = true;
+                    }
+                    catch (std::exception &e)
+                    {
+                        throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey);
+                    }
+                }
                 else
                 {
                     for (auto c : cfgKey)
@@ -887,6 +989,11 @@ namespace DaemonConfig
             config.p2pExternalPort = j["p2p-external-port"].GetInt();
         }
 
+        if (j.HasMember("p2p-large-message-decode-threads"))
+        {
+            config.p2pLargeMessageDecodeThreads = j["p2p-large-message-decode-threads"].GetInt();
+        }
+
         if (j.HasMember("p2p-reset-peerstate"))
         {
             config.p2pResetPeerstate = j["p2p-reset-peerstate"].GetBool();
@@ -902,6 +1009,16 @@ namespace DaemonConfig
             config.rpcPort = j["rpc-bind-port"].GetInt();
         }
 
+        if (j.HasMember("rpc-threads"))
+        {
+            config.rpcThreads = j["rpc-threads"].GetInt();
+        }
+
+        if (j.HasMember("rpc-max-queued-requests"))
+        {
+            config.rpcMaxQueuedRequests = j["rpc-max-queued-requests"].GetInt();
+        }
+
         if (j.HasMember("add-exclusive-node"))
         {
             const Value &va = j["add-exclusive-node"];
@@ -953,6 +1070,11 @@ namespace DaemonConfig
             config.enableMining = j["enable-mining"].GetBool();
         }
 
+        if (j.HasMember("enable-view-key-scanning"))
+        {
+            config.enableViewKeyScanning = j["enable-view-key-scanning"].GetBool();
+        }
+
         if (j.HasMember("enable-cors"))
         {
             config.enableCors = j["enable-cors"].GetString();
@@ -972,6 +1094,11 @@ namespace DaemonConfig
         {
             config.transactionValidationThreads = j["transaction-validation-threads"].GetInt();
         }
+
+        if (j.HasMember("pow-verification-threads"))
+        {
+            config.powVerificationThreads = j["pow-verification-threads"].GetInt();
+        }
     }
 
     Document asJSON(const DaemonConfiguration &config)
@@ -997,9 +1124,12 @@ namespace DaemonConfig
         j.AddMember("p2p-bind-ip", config.p2pInterface, alloc);
         j.AddMember("p2p-bind-port", config.p2pPort, alloc);
         j.AddMember("p2p-external-port", config.p2pExternalPort, alloc);
+        j.AddMember("p2p-large-message-decode-threads", config.p2pLargeMessageDecodeThreads, alloc);
         j.AddMember("p2p-reset-peerstate", config.p2pResetPeerstate, alloc);
         j.AddMember("rpc-bind-ip", config.rpcInterface, alloc);
         j.AddMember("rpc-bind-port", config.rpcPort, alloc);
+        j.AddMember("rpc-threads", config.rpcThreads, alloc);
+        j.AddMember("rpc-max-queued-requests", config.rpcMaxQueuedRequests, alloc);
 
         {
             Value arr(rapidjson::kArrayType);
@@ -1041,9 +1171,11 @@ namespace DaemonConfig
         j.AddMember("enable-blockexplorer", config.enableBlockExplorer, alloc);
         j.AddMember("enable-blockexplorer-detailed", config.enableBlockExplorerDetailed, alloc);
         j.AddMember("enable-mining", config.enableMining, alloc);
+        j.AddMember("enable-view-key-scanning", config.enableViewKeyScanning, alloc);
         j.AddMember("fee-address", config.feeAddress, alloc);
         j.AddMember("fee-amount", config.feeAmount, alloc);
         j.AddMember("transaction-validation-threads", config.transactionValidationThreads, alloc);
+        j.AddMember("pow-verification-threads", config.powVerificationThreads, alloc);
 
         return j;
     }
@@ -33,13 +33,18 @@ namespace DaemonConfig
             p2pInterface = "0.0.0.0";
             p2pPort = CryptoNote::P2P_DEFAULT_PORT;
             p2pExternalPort = 0;
+            p2pLargeMessageDecodeThreads = CryptoNote::P2P_DEFAULT_LARGE_MESSAGE_DECODE_THREADS;
             transactionValidationThreads = std::thread::hardware_concurrency();
+            powVerificationThreads = std::thread::hardware_concurrency();
             rpcInterface = "127.0.0.1";
             rpcPort = CryptoNote::RPC_DEFAULT_PORT;
+            rpcThreads = std::thread::hardware_concurrency();
+            rpcMaxQueuedRequests = CryptoNote::RPC_DEFAULT_MAX_QUEUED_REQUESTS;
             noConsole = false;
             enableBlockExplorer = false;
             enableBlockExplorerDetailed = false;
             enableMining = false;
+            enableViewKeyScanning = false;
             localIp = false;
             hideMyPort = false;
             p2pResetPeerstate = false;
@@ -88,8 +93,16 @@ namespace DaemonConfig
 
         int p2pExternalPort;
 
+        uint32_t p2pLargeMessageDecodeThreads;
+
         uint32_t transactionValidationThreads;
 
+        uint32_t powVerificationThreads;
+
+        uint32_t rpcThreads;
+
+        uint32_t rpcMaxQueuedRequests;
+
         uint64_t dbThreads;
 
         uint64_t dbMaxOpenFiles;
@@ -110,6 +123,8 @@ namespace DaemonConfig
 
         bool enableMining;
 
+        bool enableViewKeyScanning;
+
         bool localIp;
 
         bool hideMyPort;
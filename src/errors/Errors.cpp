@@ -325,6 +325,12 @@ std::string Error::getErrorMessage() const
         {
             return "Unlock time is too small";
         }
+        case INVALID_TRANSACTION_CURSOR:
+        {
+            return "The transaction cursor given was not found. It may have "
+                   "been removed by a fork. Please restart the query from "
+                   "the beginning.";
+        }
         /* No default case so the compiler warns us if we missed one */
     }
 
@@ -240,6 +240,10 @@ enum ErrorCode
 
     /* Unlock time does not meet the required minimum locked blocks */
     UNLOCK_TIME_TOO_SMALL = 60,
+
+    /* The transaction cursor given does not refer to a transaction in the
+     * requested range, for example because it was removed by a fork */
+    INVALID_TRANSACTION_CURSOR = 61,
 };
 
 class Error
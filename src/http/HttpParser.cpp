@@ -117,7 +117,13 @@ namespace CryptoNote
         }
 
         std::string body;
-        if (length)
+
+        it = headers.find("transfer-encoding");
+        if (it != headers.end() && it->second == "chunked")
+        {
+            readChunkedBody(stream, body);
+        }
+        else if (length)
         {
             readBody(stream, body, length);
         }
@@ -253,4 +259,69 @@ namespace CryptoNote
         throwIfNotGood(stream);
     }
 
+    void HttpParser::readChunkedBody(std::istream &stream, std::string &body)
+    {
+        while (true)
+        {
+            std::string sizeLine;
+            readLine(stream, sizeLine);
+
+            size_t chunkSize = 0;
+
+            try
+            {
+                /* Ignores any chunk extensions after the size */
+                chunkSize = std::stoul(sizeLine, nullptr, 16);
+            }
+            catch (const std::exception &)
+            {
+                throw std::system_error(make_error_code(CryptoNote::error::HttpParserErrorCodes::UNEXPECTED_SYMBOL));
+            }
+
+            if (chunkSize == 0)
+            {
+                break;
+            }
+
+            readBody(stream, body, chunkSize);
+
+            std::string chunkEnd;
+            readLine(stream, chunkEnd);
+
+            if (!chunkEnd.empty())
+            {
+                throw std::system_error(make_error_code(CryptoNote::error::HttpParserErrorCodes::UNEXPECTED_SYMBOL));
+            }
+        }
+
+        /* Skip any trailers, up to the blank line ending the message */
+        std::string trailer;
+
+        do
+        {
+            trailer.clear();
+            readLine(stream, trailer);
+        } while (!trailer.empty());
+    }
+
+    void HttpParser::readLine(std::istream &stream, std::string &line)
+    {
+        char c;
+
+        stream.get(c);
+        while (stream.good() && c != '\r')
+        {
+            line += c;
+            stream.get(c);
+        }
+
+        throwIfNotGood(stream);
+
+        stream.get(c);
+        if (c != '\n')
+        {
+            throw std::system_error(make_error_code(CryptoNote::error::HttpParserErrorCodes::UNEXPECTED_SYMBOL));
+        }
+    }
+
 } // namespace CryptoNote
@@ -37,6 +37,10 @@ namespace CryptoNote
         static size_t getBodyLen(const HttpRequest::Headers &headers);
 
         static void readBody(std::istream &stream, std::string &body, const size_t bodyLen);
+
+        static void readChunkedBody(std::istream &stream, std::string &body);
+
+        static void readLine(std::istream &stream, std::string &line);
     };
 
 } // namespace CryptoNote
@@ -17,7 +17,11 @@ namespace CryptoNote
             STREAM_NOT_GOOD = 1,
             END_OF_STREAM,
             UNEXPECTED_SYMBOL,
-            EMPTY_HEADER
+            EMPTY_HEADER,
+            HEADER_TOO_LARGE,
+            BODY_TOO_LARGE,
+            INVALID_CONTENT_LENGTH,
+            UNSUPPORTED_TRANSFER_ENCODING
         };
 
         // custom category:
@@ -48,6 +52,14 @@ namespace CryptoNote
                         return "Unexpected symbol";
                     case EMPTY_HEADER:
                         return "The header name is empty";
+                    case HEADER_TOO_LARGE:
+                        return "The request line and headers are too large";
+                    case BODY_TOO_LARGE:
+                        return "The body is too large";
+                    case INVALID_CONTENT_LENGTH:
+                        return "The content length is not a valid number";
+                    case UNSUPPORTED_TRANSFER_ENCODING:
+                        return "The transfer encoding is not supported";
                     default:
                         return "Unknown error";
                 }
@@ -35,6 +35,8 @@ namespace CryptoNote
       private:
         friend class HttpParser;
 
+        friend class HttpRequestParser;
+
         std::string method = "POST";
 
         std::string url;
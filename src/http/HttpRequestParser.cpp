@@ -0,0 +1,230 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "HttpRequestParser.h"
+
+#include "HttpParserErrorCodes.h"
+
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+
+namespace
+{
+    /* Largest request line plus headers we'll buffer */
+    const size_t MAX_HEAD_SIZE = 64 * 1024;
+
+    const size_t MAX_BODY_SIZE = 64 * 1024 * 1024;
+
+    const std::string_view HEAD_TERMINATOR = "\r\n\r\n";
+
+    void throwError(const CryptoNote::error::HttpParserErrorCodes code)
+    {
+        throw std::system_error(make_error_code(code));
+    }
+
+    std::string_view trim(std::string_view str)
+    {
+        while (!str.empty() && (str.front() == ' ' || str.front() == '\t'))
+        {
+            str.remove_prefix(1);
+        }
+
+        while (!str.empty() && (str.back() == ' ' || str.back() == '\t'))
+        {
+            str.remove_suffix(1);
+        }
+
+        return str;
+    }
+
+    bool equalsIgnoreCase(const std::string_view a, const std::string_view b)
+    {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const char x, const char y) {
+                   return ::tolower(static_cast<unsigned char>(x)) == ::tolower(static_cast<unsigned char>(y));
+               });
+    }
+
+} // namespace
+
+namespace CryptoNote
+{
+    void HttpRequestParser::feed(const char *data, size_t size)
+    {
+        /* Drop the requests already taken once they're most of the buffer, so
+           a long lived connection doesn't grow it forever */
+        if (m_position != 0 && m_position >= m_buffer.size() / 2)
+        {
+            m_buffer.erase(0, m_position);
+            m_searchedUpTo -= std::min(m_searchedUpTo, m_position);
+            m_position = 0;
+        }
+
+        m_buffer.append(data, size);
+    }
+
+    bool HttpRequestParser::next(HttpRequest &request)
+    {
+        if (!m_pending)
+        {
+            /* Clients may send a stray CRLF after a request body */
+            while (m_buffer.size() - m_position >= 2 && m_buffer[m_position] == '\r'
+                   && m_buffer[m_position + 1] == '\n')
+            {
+                m_position += 2;
+            }
+
+            /* Back up a little, the terminator may straddle the last read */
+            const size_t searchFrom =
+                std::max(m_position, std::max(m_searchedUpTo, HEAD_TERMINATOR.size()) - HEAD_TERMINATOR.size());
+
+            const size_t headEnd = m_buffer.find(HEAD_TERMINATOR.data(), searchFrom, HEAD_TERMINATOR.size());
+
+            if (headEnd == std::string::npos)
+            {
+                m_searchedUpTo = m_buffer.size();
+
+                if (m_buffer.size() - m_position > MAX_HEAD_SIZE)
+                {
+                    throwError(error::HttpParserErrorCodes::HEADER_TOO_LARGE);
+                }
+
+                return false;
+            }
+
+            if (headEnd - m_position > MAX_HEAD_SIZE)
+            {
+                throwError(error::HttpParserErrorCodes::HEADER_TOO_LARGE);
+            }
+
+            parseHead(headEnd);
+        }
+
+        if (m_buffer.size() - m_position < m_bodyLength)
+        {
+            return false;
+        }
+
+        request = std::move(*m_pending);
+        m_pending.reset();
+
+        request.body.assign(m_buffer, m_position, m_bodyLength);
+
+        m_position += m_bodyLength;
+        m_searchedUpTo = m_position;
+        m_keepAlive = m_pendingKeepAlive;
+
+        if (m_position == m_buffer.size())
+        {
+            m_buffer.clear();
+            m_position = 0;
+            m_searchedUpTo = 0;
+        }
+
+        return true;
+    }
+
+    void HttpRequestParser::parseHead(const size_t headEnd)
+    {
+        /* Include the CRLF ending the last header, so every line ends in one */
+        std::string_view head(m_buffer.data() + m_position, headEnd - m_position + 2);
+
+        const size_t requestLineEnd = head.find("\r\n");
+
+        const std::string_view requestLine = head.substr(0, requestLineEnd);
+
+        head.remove_prefix(requestLineEnd + 2);
+
+        const size_t methodEnd = requestLine.find(' ');
+        const size_t urlEnd = requestLine.find(' ', methodEnd + 1);
+
+        if (methodEnd == 0 || methodEnd == std::string_view::npos || urlEnd == std::string_view::npos
+            || urlEnd == methodEnd + 1)
+        {
+            throwError(error::HttpParserErrorCodes::UNEXPECTED_SYMBOL);
+        }
+
+        const std::string_view version = requestLine.substr(urlEnd + 1);
+
+        if (version.substr(0, 7) != "HTTP/1.")
+        {
+            throwError(error::HttpParserErrorCodes::UNEXPECTED_SYMBOL);
+        }
+
+        HttpRequest request;
+
+        request.method = std::string(requestLine.substr(0, methodEnd));
+        request.url = std::string(requestLine.substr(methodEnd + 1, urlEnd - methodEnd - 1));
+
+        /* Persistent by default from 1.1 on */
+        bool keepAlive = version != "HTTP/1.0";
+
+        size_t bodyLength = 0;
+
+        while (!head.empty())
+        {
+            const size_t lineEnd = head.find("\r\n");
+
+            const std::string_view line = head.substr(0, lineEnd);
+
+            head.remove_prefix(lineEnd + 2);
+
+            const size_t colon = line.find(':');
+
+            if (colon == std::string_view::npos)
+            {
+                throwError(error::HttpParserErrorCodes::UNEXPECTED_SYMBOL);
+            }
+
+            const std::string_view name = trim(line.substr(0, colon));
+            const std::string_view value = trim(line.substr(colon + 1));
+
+            if (name.empty())
+            {
+                throwError(error::HttpParserErrorCodes::EMPTY_HEADER);
+            }
+
+            std::string lowerName(name);
+            std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+
+            if (lowerName == "content-length")
+            {
+                const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), bodyLength);
+
+                if (ec != std::errc() || end != value.data() + value.size() || value.empty())
+                {
+                    throwError(error::HttpParserErrorCodes::INVALID_CONTENT_LENGTH);
+                }
+
+                if (bodyLength > MAX_BODY_SIZE)
+                {
+                    throwError(error::HttpParserErrorCodes::BODY_TOO_LARGE);
+                }
+            }
+            else if (lowerName == "transfer-encoding" && !equalsIgnoreCase(value, "identity"))
+            {
+                throwError(error::HttpParserErrorCodes::UNSUPPORTED_TRANSFER_ENCODING);
+            }
+            else if (lowerName == "connection")
+            {
+                if (equalsIgnoreCase(value, "close"))
+                {
+                    keepAlive = false;
+                }
+                else if (equalsIgnoreCase(value, "keep-alive"))
+                {
+                    keepAlive = true;
+                }
+            }
+
+            request.headers[lowerName] = std::string(value);
+        }
+
+        m_pending = std::move(request);
+        m_bodyLength = bodyLength;
+        m_pendingKeepAlive = keepAlive;
+        m_position = headEnd + HEAD_TERMINATOR.size();
+    }
+
+} // namespace CryptoNote
@@ -0,0 +1,59 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "HttpRequest.h"
+
+#include <optional>
+#include <string>
+
+namespace CryptoNote
+{
+    /* Non blocking HTTP/1.1 request parser. Bytes are fed in as they arrive
+       off the socket, in whatever sized pieces, and complete requests are
+       taken out of the front. Several requests may arrive in one read when
+       a client pipelines them, so keep calling next() until it returns
+       false. Malformed requests throw a std::system_error with one of the
+       HttpParserErrorCodes, after which the connection should be dropped. */
+    class HttpRequestParser
+    {
+      public:
+        void feed(const char *data, size_t size);
+
+        /* Takes the next complete request, returns false if more bytes are
+           needed first */
+        bool next(HttpRequest &request);
+
+        /* Whether the client wants the connection kept open after the last
+           request taken */
+        bool keepAlive() const
+        {
+            return m_keepAlive;
+        }
+
+      private:
+        /* Parses the request line and headers ending at headEnd */
+        void parseHead(size_t headEnd);
+
+        std::string m_buffer;
+
+        /* Where the next request starts in m_buffer */
+        size_t m_position = 0;
+
+        /* How far we've already looked for the end of the headers, so a
+           slowly arriving head isn't scanned from the start on every read */
+        size_t m_searchedUpTo = 0;
+
+        /* A request whose head has been parsed, waiting on its body */
+        std::optional<HttpRequest> m_pending;
+
+        size_t m_bodyLength = 0;
+
+        bool m_pendingKeepAlive = true;
+
+        bool m_keepAlive = true;
+    };
+
+} // namespace CryptoNote
@@ -77,22 +77,30 @@ namespace CryptoNote
         }
     }
 
-    std::ostream &HttpResponse::printHttpResponse(std::ostream &os) const
+    void HttpResponse::appendTo(std::string &buffer) const
     {
-        os << "HTTP/1.1 " << getStatusString(status) << "\r\n";
+        buffer += "HTTP/1.1 ";
+        buffer += getStatusString(status);
+        buffer += "\r\n";
 
-        for (auto pair : headers)
+        for (const auto &[name, value] : headers)
         {
-            os << pair.first << ": " << pair.second << "\r\n";
+            buffer += name;
+            buffer += ": ";
+            buffer += value;
+            buffer += "\r\n";
         }
-        os << "\r\n";
 
-        if (!body.empty())
-        {
-            os << body;
-        }
+        buffer += "\r\n";
+        buffer += body;
+    }
+
+    std::ostream &HttpResponse::printHttpResponse(std::ostream &os) const
+    {
+        std::string buffer;
+        appendTo(buffer);
 
-        return os;
+        return os << buffer;
     }
 
 } // namespace CryptoNote
@@ -44,6 +44,9 @@ namespace CryptoNote
             return body;
         }
 
+        /* Appends the response as it goes on the wire */
+        void appendTo(std::string &buffer) const;
+
       private:
         friend std::ostream &operator<<(std::ostream &os, const HttpResponse &resp);
 
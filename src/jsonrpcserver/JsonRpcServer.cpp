@@ -5,26 +5,59 @@
 
 #include "JsonRpcServer.h"
 
-#include "common/JsonValue.h"
-#include "http/HttpParser.h"
-#include "http/HttpParserErrorCodes.h"
+#include "http/HttpRequest.h"
 #include "http/HttpResponse.h"
 #include "rpc/JsonRpc.h"
-#include "serialization/JsonInputValueSerializer.h"
-#include "serialization/JsonOutputStreamSerializer.h"
-
-#include <fstream>
-#include <future>
-#include <memory>
-#include <sstream>
-#include <system/Ipv4Address.h>
-#include <system/TcpConnection.h>
-#include <system/TcpListener.h>
-#include <system/TcpStream.h>
+
 #include <system_error>
 
 namespace CryptoNote
 {
+    namespace
+    {
+        /* Starts the response object, copying the id from the request */
+        void startResponse(const rapidjson::Value &req, JsonWriter &resp)
+        {
+            resp.StartObject();
+
+            resp.Key("jsonrpc");
+            resp.String("2.0");
+
+            const auto id = req.FindMember("id");
+
+            if (id != req.MemberEnd())
+            {
+                resp.Key("id");
+                id->value.Accept(resp);
+            }
+        }
+
+        /* Writes a whole response to a request we couldn't read an id from */
+        void makeStandaloneErrorResponse(JsonWriter &resp, const int code, const char *message)
+        {
+            resp.StartObject();
+
+            resp.Key("jsonrpc");
+            resp.String("2.0");
+
+            resp.Key("id");
+            resp.Null();
+
+            resp.Key("error");
+            resp.StartObject();
+
+            resp.Key("code");
+            resp.Int64(code);
+
+            resp.Key("message");
+            resp.String(message);
+
+            resp.EndObject();
+
+            resp.EndObject();
+        }
+    } // namespace
+
     JsonRpcServer::JsonRpcServer(
         System::Dispatcher &sys,
         System::Event &stopEvent,
@@ -52,27 +85,29 @@ namespace CryptoNote
 
             if (req.getUrl() == "/json_rpc")
             {
-                std::istringstream jsonInputStream(req.getBody());
-                Common::JsonValue jsonRpcRequest;
-                Common::JsonValue jsonRpcResponse(Common::JsonValue::OBJECT);
+                rapidjson::Document jsonRpcRequest;
 
-                try
-                {
-                    jsonInputStream >> jsonRpcRequest;
-                }
-                catch (std::runtime_error &)
+                rapidjson::StringBuffer buffer;
+
+                if (jsonRpcRequest.Parse(req.getBody().data(), req.getBody().size()).HasParseError()
+                    || !(jsonRpcRequest.IsObject() || jsonRpcRequest.IsArray()))
                 {
                     logger(Logging::DEBUGGING) << "Couldn't parse request: \"" << req.getBody() << "\"";
-                    makeJsonParsingErrorResponse(jsonRpcResponse);
+                    JsonWriter writer(buffer);
+                    makeJsonParsingErrorResponse(writer);
                     resp.setStatus(CryptoNote::HttpResponse::STATUS_200);
-                    resp.setBody(jsonRpcResponse.toString());
+                    resp.setBody(std::string(buffer.GetString(), buffer.GetSize()));
                     return;
                 }
 
-                processJsonRpcRequest(jsonRpcRequest, jsonRpcResponse);
-
-                std::ostringstream jsonOutputStream;
-                jsonOutputStream << jsonRpcResponse;
+                if (jsonRpcRequest.IsObject())
+                {
+                    processRequestObject(jsonRpcRequest, buffer);
+                }
+                else
+                {
+                    processBatch(jsonRpcRequest, buffer);
+                }
 
                 if (config.serviceConfig.corsHeader != "")
                 {
@@ -80,7 +115,7 @@ namespace CryptoNote
                 }
 
                 resp.setStatus(CryptoNote::HttpResponse::STATUS_200);
-                resp.setBody(jsonOutputStream.str());
+                resp.setBody(std::string(buffer.GetString(), buffer.GetSize()));
             }
             else
             {
@@ -96,132 +131,135 @@ namespace CryptoNote
         }
     }
 
-    void JsonRpcServer::prepareJsonResponse(const Common::JsonValue &req, Common::JsonValue &resp)
+    void JsonRpcServer::processRequestObject(const rapidjson::Value &req, rapidjson::StringBuffer &buffer)
     {
-        using Common::JsonValue;
+        JsonWriter writer(buffer);
 
-        if (req.contains("id"))
+        try
         {
-            resp.insert("id", req("id"));
+            startResponse(req, writer);
+            processJsonRpcRequest(req, writer);
+            writer.EndObject();
         }
+        catch (const std::exception &e)
+        {
+            logger(Logging::WARNING) << "Error occurred while processing JsonRpc request: " << e.what();
+
+            /* We may have thrown half way through the result */
+            buffer.Clear();
+            writer.Reset(buffer);
 
-        resp.insert("jsonrpc", "2.0");
+            startResponse(req, writer);
+            makeGenericErrorReponse(writer, e.what());
+            writer.EndObject();
+        }
     }
 
-    void JsonRpcServer::makeErrorResponse(const std::error_code &ec, Common::JsonValue &resp)
+    void JsonRpcServer::processBatch(const rapidjson::Value &batch, rapidjson::StringBuffer &buffer)
     {
-        using Common::JsonValue;
-
-        JsonValue error(JsonValue::OBJECT);
-
-        JsonValue code;
-        code = static_cast<int64_t>(CryptoNote::JsonRpc::errParseError); // Application specific error code
-
-        JsonValue message;
-        message = ec.message();
-
-        JsonValue data(JsonValue::OBJECT);
-        JsonValue appCode;
-        appCode = static_cast<int64_t>(ec.value());
-        data.insert("application_code", appCode);
+        JsonWriter writer(buffer);
 
-        error.insert("code", code);
-        error.insert("message", message);
-        error.insert("data", data);
+        if (batch.Empty())
+        {
+            makeInvalidRequestResponse(writer);
+            return;
+        }
 
-        resp.insert("error", error);
-    }
+        logger(Logging::DEBUGGING) << "Batch of " << batch.Size() << " requests came";
 
-    void JsonRpcServer::makeGenericErrorReponse(Common::JsonValue &resp, const char *what, int errorCode)
-    {
-        using Common::JsonValue;
+        writer.StartArray();
 
-        JsonValue error(JsonValue::OBJECT);
+        /* Each request gets a buffer of its own, so one that fails half way
+           through can be thrown away without touching the rest */
+        rapidjson::StringBuffer requestBuffer;
 
-        JsonValue code;
-        code = static_cast<int64_t>(errorCode);
-
-        std::string msg;
-        if (what)
-        {
-            msg = what;
-        }
-        else
+        for (const auto &request : batch.GetArray())
         {
-            msg = "Unknown application error";
-        }
+            if (!request.IsObject())
+            {
+                makeInvalidRequestResponse(writer);
+                continue;
+            }
 
-        JsonValue message;
-        message = msg;
+            requestBuffer.Clear();
+            processRequestObject(request, requestBuffer);
 
-        error.insert("code", code);
-        error.insert("message", message);
+            writer.RawValue(requestBuffer.GetString(), requestBuffer.GetSize(), rapidjson::kObjectType);
+        }
 
-        resp.insert("error", error);
+        writer.EndArray();
     }
 
-    void JsonRpcServer::makeMethodNotFoundResponse(Common::JsonValue &resp)
+    void JsonRpcServer::makeErrorResponse(const std::error_code &ec, JsonWriter &resp)
     {
-        using Common::JsonValue;
+        resp.Key("error");
+        resp.StartObject();
 
-        JsonValue error(JsonValue::OBJECT);
+        resp.Key("code");
+        resp.Int64(CryptoNote::JsonRpc::errParseError); // Application specific error code
 
-        JsonValue code;
-        code = static_cast<int64_t>(
-            CryptoNote::JsonRpc::errMethodNotFound); // ambigous declaration of JsonValue::operator= (between int and
-                                                     // JsonValue)
+        resp.Key("message");
+        resp.String(ec.message());
 
-        JsonValue message;
-        message = "Method not found";
+        resp.Key("data");
+        resp.StartObject();
+        resp.Key("application_code");
+        resp.Int64(ec.value());
+        resp.EndObject();
 
-        error.insert("code", code);
-        error.insert("message", message);
-
-        resp.insert("error", error);
+        resp.EndObject();
     }
 
-    void JsonRpcServer::makeInvalidPasswordResponse(Common::JsonValue &resp)
+    void JsonRpcServer::makeGenericErrorReponse(JsonWriter &resp, const char *what, int errorCode)
     {
-        using Common::JsonValue;
-
-        JsonValue error(JsonValue::OBJECT);
-
-        JsonValue code;
-        code = static_cast<int64_t>(CryptoNote::JsonRpc::errInvalidPassword);
+        resp.Key("error");
+        resp.StartObject();
 
-        JsonValue message;
-        message = "Invalid or no rpc password";
+        resp.Key("code");
+        resp.Int64(errorCode);
 
-        error.insert("code", code);
-        error.insert("message", message);
+        resp.Key("message");
+        resp.String(what ? what : "Unknown application error");
 
-        resp.insert("error", error);
+        resp.EndObject();
     }
 
-    void JsonRpcServer::fillJsonResponse(const Common::JsonValue &v, Common::JsonValue &resp)
+    void JsonRpcServer::makeMethodNotFoundResponse(JsonWriter &resp)
     {
-        resp.insert("result", v);
+        resp.Key("error");
+        resp.StartObject();
+
+        resp.Key("code");
+        resp.Int64(CryptoNote::JsonRpc::errMethodNotFound);
+
+        resp.Key("message");
+        resp.String("Method not found");
+
+        resp.EndObject();
     }
 
-    void JsonRpcServer::makeJsonParsingErrorResponse(Common::JsonValue &resp)
+    void JsonRpcServer::makeInvalidPasswordResponse(JsonWriter &resp)
     {
-        using Common::JsonValue;
+        resp.Key("error");
+        resp.StartObject();
 
-        resp = JsonValue(JsonValue::OBJECT);
-        resp.insert("jsonrpc", "2.0");
-        resp.insert("id", nullptr);
+        resp.Key("code");
+        resp.Int64(CryptoNote::JsonRpc::errInvalidPassword);
 
-        JsonValue error(JsonValue::OBJECT);
-        JsonValue code;
-        code = static_cast<int64_t>(CryptoNote::JsonRpc::errParseError); // ambigous declaration of JsonValue::operator=
-                                                                         // (between int and JsonValue)
+        resp.Key("message");
+        resp.String("Invalid or no rpc password");
 
-        JsonValue message = "Parse error";
+        resp.EndObject();
+    }
 
-        error.insert("code", code);
-        error.insert("message", message);
+    void JsonRpcServer::makeJsonParsingErrorResponse(JsonWriter &resp)
+    {
+        makeStandaloneErrorResponse(resp, CryptoNote::JsonRpc::errParseError, "Parse error");
+    }
 
-        resp.insert("error", error);
+    void JsonRpcServer::makeInvalidRequestResponse(JsonWriter &resp)
+    {
+        makeStandaloneErrorResponse(resp, CryptoNote::JsonRpc::errInvalidRequest, "Invalid Request");
     }
 
 } // namespace CryptoNote
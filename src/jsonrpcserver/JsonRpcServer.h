@@ -8,8 +8,10 @@
 #include "logging/ILogger.h"
 #include "logging/LoggerRef.h"
 #include "rpc/HttpServer.h"
+#include "serialization/RapidJsonOutputSerializer.h"
 #include "walletservice/ConfigurationManager.h"
 
+#include <rapidjson/document.h>
 #include <system/Dispatcher.h>
 #include <system/Event.h>
 #include <system_error>
@@ -21,11 +23,6 @@ namespace CryptoNote
     class HttpRequest;
 } // namespace CryptoNote
 
-namespace Common
-{
-    class JsonValue;
-}
-
 namespace System
 {
     class TcpConnection;
@@ -47,21 +44,28 @@ namespace CryptoNote
         void start(const std::string &bindAddress, uint16_t bindPort);
 
       protected:
-        static void makeErrorResponse(const std::error_code &ec, Common::JsonValue &resp);
+        /* Each of these writes the "error" member of a response, into an
+           object the caller has already started */
+        static void makeErrorResponse(const std::error_code &ec, JsonWriter &resp);
 
-        static void makeMethodNotFoundResponse(Common::JsonValue &resp);
+        static void makeMethodNotFoundResponse(JsonWriter &resp);
 
-        static void makeInvalidPasswordResponse(Common::JsonValue &resp);
+        static void makeInvalidPasswordResponse(JsonWriter &resp);
 
-        static void makeGenericErrorReponse(Common::JsonValue &resp, const char *what, int errorCode = -32001);
+        static void makeGenericErrorReponse(JsonWriter &resp, const char *what, int errorCode = -32001);
 
-        static void fillJsonResponse(const Common::JsonValue &v, Common::JsonValue &resp);
+        /* Writes a whole response for a request that isn't valid json */
+        static void makeJsonParsingErrorResponse(JsonWriter &resp);
 
-        static void prepareJsonResponse(const Common::JsonValue &req, Common::JsonValue &resp);
+        /* Writes a whole response for a batch entry that isn't an object, or
+           an empty batch */
+        static void makeInvalidRequestResponse(JsonWriter &resp);
 
-        static void makeJsonParsingErrorResponse(Common::JsonValue &resp);
-
-        virtual void processJsonRpcRequest(const Common::JsonValue &req, Common::JsonValue &resp) = 0;
+        /* Handles a parsed request. resp is inside the response object, which
+           already has its "jsonrpc" and "id" members, and this should add a
+           "result" or an "error" member. If this throws, whatever was written
+           is thrown away and replaced with an error. */
+        virtual void processJsonRpcRequest(const rapidjson::Value &req, JsonWriter &resp) = 0;
 
         PaymentService::ConfigurationManager &config;
 
@@ -70,6 +74,13 @@ namespace CryptoNote
         virtual void
             processRequest(const CryptoNote::HttpRequest &request, CryptoNote::HttpResponse &response) override;
 
+        /* Writes the response to a single request object */
+        void processRequestObject(const rapidjson::Value &req, rapidjson::StringBuffer &buffer);
+
+        /* Writes an array holding the response to each request in a batch,
+           in the order they came */
+        void processBatch(const rapidjson::Value &batch, rapidjson::StringBuffer &buffer);
+
         System::Event &stopEvent;
 
         Logging::LoggerRef logger;
@@ -10,10 +10,46 @@
 #include <ctime>
 #include <iomanip>
 #include <iostream>
+#include <logging/AsyncLogWriter.h>
 #include <sstream>
 
 namespace Logger
 {
+    namespace
+    {
+        /* Where messages go when no callback is set */
+        class ConsoleSink : public Logging::ILogSink
+        {
+          public:
+            ConsoleSink()
+            {
+                /* Constructs the writer before us, so it's destroyed after us */
+                Logging::AsyncLogWriter::instance();
+            }
+
+            ~ConsoleSink()
+            {
+                Logging::AsyncLogWriter::instance().flush();
+            }
+
+            virtual void writeLog(const std::string &message) override
+            {
+                std::cout << message << '\n';
+            }
+
+            virtual void flushLog() override
+            {
+                std::cout.flush();
+            }
+        };
+
+        ConsoleSink &consoleSink()
+        {
+            static ConsoleSink sink;
+            return sink;
+        }
+    } // namespace
+
     Logger logger;
 
     std::string logLevelToString(const LogLevel level)
@@ -118,9 +154,36 @@ namespace Logger
         throw std::invalid_argument("Invalid log category given");
     }
 
+    LogLevel fromLoggingLevel(const Logging::Level level)
+    {
+        switch (level)
+        {
+            case Logging::FATAL:
+            case Logging::ERROR:
+            {
+                return FATAL;
+            }
+            case Logging::WARNING:
+            {
+                return WARNING;
+            }
+            case Logging::INFO:
+            {
+                return INFO;
+            }
+            case Logging::DEBUGGING:
+            case Logging::TRACE:
+            {
+                return DEBUG;
+            }
+        }
+
+        throw std::invalid_argument("Invalid log level given");
+    }
+
     void Logger::log(const std::string message, const LogLevel level, const std::vector<LogCategory> categories) const
     {
-        if (level == DISABLED)
+        if (!isEnabled(level))
         {
             return;
         }
@@ -133,16 +196,19 @@ namespace Logger
             output << " [" << logCategoryToString(category) << "]";
         }
         output << ": " << message;
-        if (level <= m_logLevel)
+
+        /* If the user provides a callback, log to that instead */
+        if (m_callback)
         {
-            /* If the user provides a callback, log to that instead */
-            if (m_callback)
-            {
-                m_callback(output.str(), message, level, categories);
-            }
-            else
+            m_callback(output.str(), message, level, categories);
+        }
+        else
+        {
+            Logging::AsyncLogWriter::instance().write(consoleSink(), output.str());
+
+            if (level == FATAL)
             {
-                std::cout << output.str() << std::endl;
+                Logging::AsyncLogWriter::instance().flush();
             }
         }
     }
@@ -152,6 +218,11 @@ namespace Logger
         m_logLevel = level;
     }
 
+    bool Logger::isEnabled(const LogLevel level) const
+    {
+        return level != DISABLED && level <= m_logLevel;
+    }
+
     void Logger::setLogCallback(std::function<void(
                                     const std::string prettyMessage,
                                     const std::string message,
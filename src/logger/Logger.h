@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
+#include <logging/ILogger.h>
 #include <string>
 #include <vector>
 
@@ -37,6 +39,9 @@ namespace Logger
 
     std::string logCategoryToString(const LogCategory category);
 
+    /* The closest level to one of the Logging:: ones */
+    LogLevel fromLoggingLevel(const Logging::Level level);
+
     class Logger
     {
       public:
@@ -46,6 +51,9 @@ namespace Logger
 
         void setLogLevel(const LogLevel level);
 
+        /* Lets callers skip building messages that won't be logged */
+        bool isEnabled(const LogLevel level) const;
+
         void setLogCallback(std::function<void(
                                 const std::string prettyMessage,
                                 const std::string message,
@@ -54,7 +62,7 @@ namespace Logger
 
       private:
         /* Logging disabled by default */
-        LogLevel m_logLevel = DISABLED;
+        std::atomic<LogLevel> m_logLevel {DISABLED};
 
         std::function<void(
             const std::string prettyMessage,
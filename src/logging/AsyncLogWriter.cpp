@@ -0,0 +1,216 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "AsyncLogWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace Logging
+{
+    namespace
+    {
+        /* Must be a power of 2 */
+        const size_t LOG_QUEUE_SIZE = 8192;
+
+        /* Most lines to write before flushing the sinks written to */
+        const size_t MAX_BATCH_SIZE = 1024;
+    } // namespace
+
+    AsyncLogWriter::AsyncLogWriter(const size_t capacity):
+        m_cells(new Cell[capacity]),
+        m_mask(capacity - 1),
+        m_enqueuePosition(0),
+        m_sleeping(false),
+        m_stop(false)
+    {
+        for (size_t i = 0; i < capacity; i++)
+        {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        m_thread = std::thread(&AsyncLogWriter::writerLoop, this);
+    }
+
+    AsyncLogWriter::~AsyncLogWriter()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+
+        m_haveLines.notify_one();
+
+        /* The writer drains the queue before it exits */
+        m_thread.join();
+    }
+
+    AsyncLogWriter &AsyncLogWriter::instance()
+    {
+        static AsyncLogWriter writer(LOG_QUEUE_SIZE);
+
+        return writer;
+    }
+
+    void AsyncLogWriter::write(ILogSink &sink, std::string message)
+    {
+        while (!tryPush(sink, message))
+        {
+            /* Full, let the writer catch up */
+            m_haveLines.notify_one();
+            std::this_thread::yield();
+        }
+
+        /* Pairs with the fence in writerLoop(), so either we see the writer
+           is asleep, or it sees our line before it goes to sleep */
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (m_sleeping.load(std::memory_order_relaxed))
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_haveLines.notify_one();
+        }
+    }
+
+    void AsyncLogWriter::flush()
+    {
+        /* Would wait on itself */
+        if (std::this_thread::get_id() == m_thread.get_id())
+        {
+            return;
+        }
+
+        const size_t target = m_enqueuePosition.load(std::memory_order_acquire);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_haveLines.notify_one();
+
+        m_wroteLines.wait(lock, [&] { return m_written >= target; });
+    }
+
+    /* A bounded multi producer queue: each cell's sequence says whether it is
+       free to be written at a given position, or holds the line for it */
+    bool AsyncLogWriter::tryPush(ILogSink &sink, std::string &message)
+    {
+        size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            Cell &cell = m_cells[position & m_mask];
+
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+
+            const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+            if (difference == 0)
+            {
+                if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.sink = &sink;
+                    cell.message = std::move(message);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+
+                    return true;
+                }
+            }
+            /* The writer hasn't taken the line a lap ago from this cell yet */
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = m_enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool AsyncLogWriter::tryPop(ILogSink *&sink, std::string &message)
+    {
+        Cell &cell = m_cells[m_dequeuePosition & m_mask];
+
+        if (cell.sequence.load(std::memory_order_acquire) != m_dequeuePosition + 1)
+        {
+            return false;
+        }
+
+        sink = cell.sink;
+        message = std::move(cell.message);
+
+        cell.sequence.store(m_dequeuePosition + m_mask + 1, std::memory_order_release);
+
+        m_dequeuePosition++;
+
+        return true;
+    }
+
+    void AsyncLogWriter::writerLoop()
+    {
+        std::vector<ILogSink *> written;
+
+        ILogSink *sink;
+
+        std::string message;
+
+        while (true)
+        {
+            size_t count = 0;
+
+            while (count < MAX_BATCH_SIZE && tryPop(sink, message))
+            {
+                sink->writeLog(message);
+
+                if (std::find(written.begin(), written.end(), sink) == written.end())
+                {
+                    written.push_back(sink);
+                }
+
+                count++;
+            }
+
+            if (count != 0)
+            {
+                for (auto *writtenSink : written)
+                {
+                    writtenSink->flushLog();
+                }
+
+                written.clear();
+
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_written += count;
+                }
+
+                m_wroteLines.notify_all();
+
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_sleeping.store(true, std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            const bool empty =
+                m_cells[m_dequeuePosition & m_mask].sequence.load(std::memory_order_acquire) != m_dequeuePosition + 1;
+
+            if (empty)
+            {
+                if (m_stop)
+                {
+                    break;
+                }
+
+                m_haveLines.wait_for(lock, std::chrono::milliseconds(100));
+            }
+
+            m_sleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+
+} // namespace Logging
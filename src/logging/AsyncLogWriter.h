@@ -0,0 +1,99 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Logging
+{
+    /* Somewhere formatted log lines end up. Only ever called from the
+       AsyncLogWriter thread, so implementations need no locking of their own. */
+    class ILogSink
+    {
+      public:
+        virtual ~ILogSink() {};
+
+        virtual void writeLog(const std::string &message) = 0;
+
+        /* Called once after each batch of writes */
+        virtual void flushLog() = 0;
+    };
+
+    /* Takes formatted log lines from any thread and writes them to their sink
+       on a single background thread, so logging never waits on the console
+       or disk. Lines are queued in a fixed size lock free ring buffer; if it
+       fills up, the logging thread waits for room rather than dropping
+       lines. The writer drains everything queued before flushing each sink
+       once, instead of once per line. */
+    class AsyncLogWriter
+    {
+      public:
+        explicit AsyncLogWriter(size_t capacity);
+
+        ~AsyncLogWriter();
+
+        AsyncLogWriter(const AsyncLogWriter &) = delete;
+
+        AsyncLogWriter &operator=(const AsyncLogWriter &) = delete;
+
+        /* The writer shared by every logger. Sinks must call this before
+           they are first used, so that it outlives them. */
+        static AsyncLogWriter &instance();
+
+        void write(ILogSink &sink, std::string message);
+
+        /* Blocks until everything queued so far has been written and
+           flushed. A sink must call this before it is destroyed. */
+        void flush();
+
+      private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+
+            ILogSink *sink;
+
+            std::string message;
+        };
+
+        bool tryPush(ILogSink &sink, std::string &message);
+
+        bool tryPop(ILogSink *&sink, std::string &message);
+
+        void writerLoop();
+
+        std::unique_ptr<Cell[]> m_cells;
+
+        const size_t m_mask;
+
+        alignas(64) std::atomic<size_t> m_enqueuePosition;
+
+        /* Only touched by the writer thread */
+        alignas(64) size_t m_dequeuePosition = 0;
+
+        /* How many lines have been written and flushed, guarded by m_mutex */
+        size_t m_written = 0;
+
+        std::atomic<bool> m_sleeping;
+
+        std::atomic<bool> m_stop;
+
+        std::mutex m_mutex;
+
+        /* Wakes the writer when it is sleeping on an empty queue */
+        std::condition_variable m_haveLines;
+
+        /* Wakes flush() callers once their lines are written */
+        std::condition_variable m_wroteLines;
+
+        std::thread m_thread;
+    };
+
+} // namespace Logging
@@ -75,9 +75,20 @@ namespace Logging
             }
 
             doLogString(body2);
+
+            /* Make sure it's out before we go down */
+            if (level == FATAL)
+            {
+                AsyncLogWriter::instance().flush();
+            }
         }
     }
 
+    Level CommonLogger::getMaxLevel() const
+    {
+        return logLevel;
+    }
+
     void CommonLogger::setPattern(const std::string &pattern)
     {
         this->pattern = pattern;
@@ -93,8 +104,19 @@ namespace Logging
         logLevel = level;
     }
 
-    CommonLogger::CommonLogger(Level level): logLevel(level), pattern("%D %T %L [%C] ") {}
+    CommonLogger::CommonLogger(Level level): logLevel(level), pattern("%D %T %L [%C] ")
+    {
+        /* Constructs the writer before us, so it's destroyed after us */
+        AsyncLogWriter::instance();
+    }
+
+    void CommonLogger::doLogString(const std::string &message)
+    {
+        AsyncLogWriter::instance().write(*this, message);
+    }
+
+    void CommonLogger::writeLog(const std::string &message) {}
 
-    void CommonLogger::doLogString(const std::string &message) {}
+    void CommonLogger::flushLog() {}
 
 } // namespace Logging
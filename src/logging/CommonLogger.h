@@ -5,13 +5,15 @@
 
 #pragma once
 
+#include "AsyncLogWriter.h"
 #include "ILogger.h"
 
+#include <atomic>
 #include <set>
 
 namespace Logging
 {
-    class CommonLogger : public ILogger
+    class CommonLogger : public ILogger, public ILogSink
     {
       public:
         virtual ~CommonLogger() {};
@@ -20,21 +22,29 @@ namespace Logging
             operator()(const std::string &category, Level level, boost::posix_time::ptime time, const std::string &body)
                 override;
 
+        virtual Level getMaxLevel() const override;
+
         virtual void disableCategory(const std::string &category);
 
         virtual void setMaxLevel(Level level);
 
         void setPattern(const std::string &pattern);
 
+        virtual void writeLog(const std::string &message) override;
+
+        virtual void flushLog() override;
+
       protected:
         std::set<std::string> disabledCategories;
 
-        Level logLevel;
+        std::atomic<Level> logLevel;
 
         std::string pattern;
 
         CommonLogger(Level level);
 
+        /* Hands the formatted message to the AsyncLogWriter, which later
+           calls writeLog() with it on its own thread */
         virtual void doLogString(const std::string &message);
     };
 
@@ -15,9 +15,13 @@ namespace Logging
 
     ConsoleLogger::ConsoleLogger(Level level): CommonLogger(level) {}
 
-    void ConsoleLogger::doLogString(const std::string &message)
+    ConsoleLogger::~ConsoleLogger()
+    {
+        AsyncLogWriter::instance().flush();
+    }
+
+    void ConsoleLogger::writeLog(const std::string &message)
     {
-        std::lock_guard<std::mutex> lock(mutex);
         bool readingText = true;
         bool changedColor = false;
         std::string color = "";
@@ -70,4 +74,9 @@ namespace Logging
         }
     }
 
+    void ConsoleLogger::flushLog()
+    {
+        std::cout.flush();
+    }
+
 } // namespace Logging
@@ -7,8 +7,6 @@
 
 #include "CommonLogger.h"
 
-#include <mutex>
-
 namespace Logging
 {
     class ConsoleLogger : public CommonLogger
@@ -16,11 +14,11 @@ namespace Logging
       public:
         ConsoleLogger(Level level = DEBUGGING);
 
-      protected:
-        virtual void doLogString(const std::string &message) override;
+        virtual ~ConsoleLogger();
+
+        virtual void writeLog(const std::string &message) override;
 
-      private:
-        std::mutex mutex;
+        virtual void flushLog() override;
     };
 
 } // namespace Logging
@@ -9,6 +9,12 @@ namespace Logging
 {
     FileLogger::FileLogger(Level level): StreamLogger(level) {}
 
+    FileLogger::~FileLogger()
+    {
+        /* fileStream is gone by the time ~StreamLogger() flushes */
+        AsyncLogWriter::instance().flush();
+    }
+
     void FileLogger::init(const std::string &fileName)
     {
         fileStream.open(fileName, std::ios::app);
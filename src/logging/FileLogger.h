@@ -16,6 +16,8 @@ namespace Logging
       public:
         FileLogger(Level level = DEBUGGING);
 
+        virtual ~FileLogger();
+
         void init(const std::string &filename);
 
       private:
@@ -67,8 +67,20 @@ namespace Logging
             Level level,
             boost::posix_time::ptime time,
             const std::string &body) = 0;
+
+        /* The most verbose level that could be logged, so messages above it
+           can be skipped before they're formatted */
+        virtual Level getMaxLevel() const
+        {
+            return TRACE;
+        }
     };
 
+/* Messages more verbose than this are compiled out */
+#ifndef LOGGING_MAX_LEVEL
+#define LOGGING_MAX_LEVEL Logging::TRACE
+#endif
+
 #ifndef ENDL
 #define ENDL std::endl
 #endif
@@ -28,4 +28,16 @@ namespace Logging
         }
     }
 
+    Level LoggerGroup::getMaxLevel() const
+    {
+        Level maxLevel = FATAL;
+
+        for (const auto &logger : loggers)
+        {
+            maxLevel = std::max(maxLevel, logger->getMaxLevel());
+        }
+
+        return std::min(maxLevel, static_cast<Level>(logLevel));
+    }
+
 } // namespace Logging
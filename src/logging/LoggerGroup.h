@@ -24,6 +24,9 @@ namespace Logging
             operator()(const std::string &category, Level level, boost::posix_time::ptime time, const std::string &body)
                 override;
 
+        /* Nothing above the most verbose member logger gets through */
+        virtual Level getMaxLevel() const override;
+
       protected:
         std::vector<ILogger *> loggers;
     };
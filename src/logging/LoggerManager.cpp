@@ -14,7 +14,7 @@ namespace Logging
 {
     using Common::JsonValue;
 
-    LoggerManager::LoggerManager() {}
+    LoggerManager::LoggerManager(): cachedMaxLevel(LoggerGroup::getMaxLevel()) {}
 
     void LoggerManager::
         operator()(const std::string &category, Level level, boost::posix_time::ptime time, const std::string &body)
@@ -23,9 +23,25 @@ namespace Logging
         LoggerGroup::operator()(category, level, time, body);
     }
 
+    Level LoggerManager::getMaxLevel() const
+    {
+        return cachedMaxLevel;
+    }
+
+    void LoggerManager::setMaxLevel(Level level)
+    {
+        std::unique_lock<std::mutex> lock(reconfigureLock);
+        LoggerGroup::setMaxLevel(level);
+        cachedMaxLevel = LoggerGroup::getMaxLevel();
+    }
+
     void LoggerManager::configure(const JsonValue &val)
     {
         std::unique_lock<std::mutex> lock(reconfigureLock);
+
+        /* The old loggers may still have lines waiting to be written */
+        AsyncLogWriter::instance().flush();
+
         loggers.clear();
         LoggerGroup::loggers.clear();
         Level globalLevel;
@@ -140,11 +156,13 @@ namespace Logging
         {
             throw std::runtime_error("loggers parameter missing");
         }
-        setMaxLevel(globalLevel);
+        LoggerGroup::setMaxLevel(globalLevel);
         for (const auto &category : globalDisabledCategories)
         {
             disableCategory(category);
         }
+
+        cachedMaxLevel = LoggerGroup::getMaxLevel();
     }
 
 } // namespace Logging
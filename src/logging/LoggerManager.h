@@ -8,6 +8,7 @@
 #include "../common/JsonValue.h"
 #include "LoggerGroup.h"
 
+#include <atomic>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -25,10 +26,19 @@ namespace Logging
             operator()(const std::string &category, Level level, boost::posix_time::ptime time, const std::string &body)
                 override;
 
+        virtual Level getMaxLevel() const override;
+
+        virtual void setMaxLevel(Level level) override;
+
       private:
         std::vector<std::unique_ptr<CommonLogger>> loggers;
 
         std::mutex reconfigureLock;
+
+        /* LoggerGroup::getMaxLevel(), kept up to date whenever it can change,
+           since it is asked for every message and the loggers can be swapped
+           out under it by configure() */
+        std::atomic<Level> cachedMaxLevel;
     };
 
 } // namespace Logging
@@ -17,10 +17,18 @@ namespace Logging
         logger(logger),
         category(category),
         logLevel(level),
-        message(color),
-        timestamp(boost::posix_time::microsec_clock::local_time()),
-        gotText(false)
+        gotText(false),
+        enabled(level <= LOGGING_MAX_LEVEL && level <= logger->getMaxLevel())
     {
+        if (enabled)
+        {
+            message = color;
+            timestamp = boost::posix_time::microsec_clock::local_time();
+        }
+        else
+        {
+            setstate(std::ios_base::badbit);
+        }
     }
 
     LoggerMessage::~LoggerMessage()
@@ -40,8 +48,9 @@ namespace Logging
         logLevel(other.logLevel),
         logger(other.logger),
         message(other.message),
-        timestamp(boost::posix_time::microsec_clock::local_time()),
-        gotText(false)
+        timestamp(other.timestamp),
+        gotText(false),
+        enabled(other.enabled)
     {
         this->set_rdbuf(this);
     }
@@ -54,8 +63,9 @@ namespace Logging
         logLevel(other.logLevel),
         logger(other.logger),
         message(other.message),
-        timestamp(boost::posix_time::microsec_clock::local_time()),
-        gotText(false)
+        timestamp(other.timestamp),
+        gotText(false),
+        enabled(other.enabled)
     {
         if (this != &other)
         {
@@ -102,6 +112,11 @@ namespace Logging
 
     int LoggerMessage::sync()
     {
+        if (!enabled)
+        {
+            return 0;
+        }
+
         (*logger)(category, logLevel, timestamp, message);
         gotText = false;
         message = DEFAULT;
@@ -110,6 +125,11 @@ namespace Logging
 
     std::streamsize LoggerMessage::xsputn(const char *s, std::streamsize n)
     {
+        if (!enabled)
+        {
+            return n;
+        }
+
         gotText = true;
         message.append(s, n);
         return n;
@@ -117,6 +137,11 @@ namespace Logging
 
     int LoggerMessage::overflow(int c)
     {
+        if (!enabled)
+        {
+            return 0;
+        }
+
         gotText = true;
         message += static_cast<char>(c);
         return 0;
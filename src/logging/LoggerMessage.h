@@ -46,6 +46,10 @@ namespace Logging
         boost::posix_time::ptime timestamp;
 
         bool gotText;
+
+        /* False if no logger would take the message, in which case the stream
+           is left bad so nothing written to it is formatted */
+        bool enabled;
     };
 
 } // namespace Logging
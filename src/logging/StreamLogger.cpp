@@ -14,16 +14,23 @@ namespace Logging
 
     StreamLogger::StreamLogger(std::ostream &stream, Level level): CommonLogger(level), stream(&stream) {}
 
+    StreamLogger::~StreamLogger()
+    {
+        AsyncLogWriter::instance().flush();
+    }
+
     void StreamLogger::attachToStream(std::ostream &stream)
     {
+        /* Lines already queued still go to the old stream */
+        AsyncLogWriter::instance().flush();
+
         this->stream = &stream;
     }
 
-    void StreamLogger::doLogString(const std::string &message)
+    void StreamLogger::writeLog(const std::string &message)
     {
         if (stream != nullptr && stream->good())
         {
-            std::lock_guard<std::mutex> lock(mutex);
             bool readingText = true;
             for (size_t charPos = 0; charPos < message.size(); ++charPos)
             {
@@ -36,8 +43,14 @@ namespace Logging
                     *stream << message[charPos];
                 }
             }
+        }
+    }
 
-            *stream << std::flush;
+    void StreamLogger::flushLog()
+    {
+        if (stream != nullptr)
+        {
+            stream->flush();
         }
     }
 
@@ -7,8 +7,6 @@
 
 #include "CommonLogger.h"
 
-#include <mutex>
-
 namespace Logging
 {
     class StreamLogger : public CommonLogger
@@ -18,16 +16,16 @@ namespace Logging
 
         StreamLogger(std::ostream &stream, Level level = DEBUGGING);
 
+        virtual ~StreamLogger();
+
         void attachToStream(std::ostream &stream);
 
-      protected:
-        virtual void doLogString(const std::string &message) override;
+        virtual void writeLog(const std::string &message) override;
+
+        virtual void flushLog() override;
 
       protected:
         std::ostream *stream;
-
-      private:
-        std::mutex mutex;
     };
 
 } // namespace Logging
@@ -10,6 +10,9 @@
 #include <common/Varint.h>
 #include <serialization/CryptoNoteSerialization.h>
 #include <serialization/SerializationTools.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
 
 std::vector<uint8_t> getParentBlockHashingBinaryArray(const CryptoNote::BlockTemplate &block, const bool headerOnly)
 {
@@ -81,11 +84,15 @@ Crypto::Hash getMerkleRoot(const CryptoNote::BlockTemplate &block)
     return CryptoNote::getObjectHash(getBlockHashingBinaryArray(block));
 }
 
+std::vector<uint8_t> getBlockLongHashingBinaryArray(const CryptoNote::BlockTemplate &block)
+{
+    return block.majorVersion == CryptoNote::BLOCK_MAJOR_VERSION_1 ? getBlockHashingBinaryArray(block)
+                                                                    : getParentBlockHashingBinaryArray(block, true);
+}
+
 Crypto::Hash getBlockLongHash(const CryptoNote::BlockTemplate &block)
 {
-    const std::vector<uint8_t> rawHashingBlock = block.majorVersion == CryptoNote::BLOCK_MAJOR_VERSION_1
-                                                     ? getBlockHashingBinaryArray(block)
-                                                     : getParentBlockHashingBinaryArray(block, true);
+    const std::vector<uint8_t> rawHashingBlock = getBlockLongHashingBinaryArray(block);
 
     Crypto::Hash hash;
 
@@ -102,3 +109,68 @@ Crypto::Hash getBlockLongHash(const CryptoNote::BlockTemplate &block)
         throw std::runtime_error("Unknown block major version.");
     }
 }
+
+BlockHashingTemplate::BlockHashingTemplate(const CryptoNote::BlockTemplate &block)
+{
+    const auto it = CryptoNote::HASHING_ALGORITHMS_BY_BLOCK_VERSION.find(block.majorVersion);
+
+    if (it == CryptoNote::HASHING_ALGORITHMS_BY_BLOCK_VERSION.end())
+    {
+        throw std::runtime_error("Unknown block major version.");
+    }
+
+    /* The table stores plain functions, so grab the pointer directly rather
+       than going through std::function for every hash. If an entry is ever
+       something else, fall back to calling it through std::function. */
+    const auto hashFunction = it->second.target<HashFunction>();
+
+    if (hashFunction != nullptr)
+    {
+        m_hashFunction = *hashFunction;
+    }
+    else
+    {
+        m_hashingAlgorithm = it->second;
+    }
+
+    /* Serialise the blob with two different nonces and diff them to find
+       where the nonce lives. This way we don't depend on the exact layout
+       of the (parent) block serialization. */
+    CryptoNote::BlockTemplate copy = block;
+
+    copy.nonce = 0;
+    m_blob = getBlockLongHashingBinaryArray(copy);
+
+    copy.nonce = std::numeric_limits<uint32_t>::max();
+    const std::vector<uint8_t> other = getBlockLongHashingBinaryArray(copy);
+
+    if (m_blob.size() != other.size())
+    {
+        throw std::runtime_error("Block hashing blob size depends on nonce.");
+    }
+
+    const auto mismatch = std::mismatch(m_blob.begin(), m_blob.end(), other.begin());
+
+    m_nonceOffset = std::distance(m_blob.begin(), mismatch.first);
+
+    if (m_nonceOffset + sizeof(uint32_t) > m_blob.size()
+        || !std::equal(m_blob.begin() + m_nonceOffset + sizeof(uint32_t), m_blob.end(),
+                       other.begin() + m_nonceOffset + sizeof(uint32_t)))
+    {
+        throw std::runtime_error("Could not locate nonce in block hashing blob.");
+    }
+}
+
+void BlockHashingTemplate::hash(const uint32_t nonce, Crypto::Hash &hash)
+{
+    std::memcpy(m_blob.data() + m_nonceOffset, &nonce, sizeof(nonce));
+
+    if (m_hashFunction != nullptr)
+    {
+        m_hashFunction(m_blob.data(), m_blob.size(), hash);
+    }
+    else
+    {
+        m_hashingAlgorithm(m_blob.data(), m_blob.size(), hash);
+    }
+}
@@ -8,6 +8,7 @@
 #include "CryptoTypes.h"
 
 #include <cstdint>
+#include <functional>
 #include <vector>
 
 std::vector<uint8_t> getParentBlockBinaryArray(const CryptoNote::BlockTemplate &block, const bool headerOnly);
@@ -23,4 +24,31 @@ Crypto::Hash getBlockHash(const CryptoNote::BlockTemplate &block);
 
 Crypto::Hash getMerkleRoot(const CryptoNote::BlockTemplate &block);
 
+std::vector<uint8_t> getBlockLongHashingBinaryArray(const CryptoNote::BlockTemplate &block);
+
 Crypto::Hash getBlockLongHash(const CryptoNote::BlockTemplate &block);
+
+/* A block's long hashing blob, serialised once, which can then be rehashed
+   with a different nonce by just patching the nonce bytes in place */
+class BlockHashingTemplate
+{
+  public:
+    using HashFunction = void (*)(const void *data, size_t length, Crypto::Hash &hash);
+
+    explicit BlockHashingTemplate(const CryptoNote::BlockTemplate &block);
+
+    /* Hash the blob with the given nonce. Equivalent to getBlockLongHash()
+       on the template with its nonce set to the given value. */
+    void hash(const uint32_t nonce, Crypto::Hash &hash);
+
+  private:
+    std::vector<uint8_t> m_blob;
+
+    size_t m_nonceOffset;
+
+    /* Set if the hashing algorithm is a plain function */
+    HashFunction m_hashFunction = nullptr;
+
+    /* Used otherwise */
+    std::function<void(const void *data, size_t length, Crypto::Hash &hash)> m_hashingAlgorithm;
+};
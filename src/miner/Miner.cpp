@@ -13,7 +13,6 @@
 #include <crypto/crypto.h>
 #include <crypto/random.h>
 #include <iostream>
-#include <miner/BlockUtilities.h>
 #include <system/InterruptedException.h>
 #include <utilities/ColouredMsg.h>
 
@@ -71,6 +70,9 @@ namespace CryptoNote
         {
             blockMiningParameters.blockTemplate.nonce = Random::randomValue<uint32_t>();
 
+            /* Serialise the hashing blob once, the workers just patch the nonce */
+            const BlockHashingTemplate hashingTemplate(blockMiningParameters.blockTemplate);
+
             for (size_t i = 0; i < threadCount; ++i)
             {
                 m_workers.emplace_back(std::unique_ptr<System::RemoteContext<void>>(new System::RemoteContext<void>(
@@ -79,6 +81,7 @@ namespace CryptoNote
                         &Miner::workerFunc,
                         this,
                         blockMiningParameters.blockTemplate,
+                        hashingTemplate,
                         blockMiningParameters.difficulty,
                         static_cast<uint32_t>(threadCount)))));
 
@@ -97,15 +100,21 @@ namespace CryptoNote
         m_miningStopped.set();
     }
 
-    void Miner::workerFunc(const BlockTemplate &blockTemplate, uint64_t difficulty, uint32_t nonceStep)
+    void Miner::workerFunc(
+        const BlockTemplate &blockTemplate,
+        BlockHashingTemplate hashingTemplate,
+        uint64_t difficulty,
+        uint32_t nonceStep)
     {
         try
         {
-            BlockTemplate block = blockTemplate;
+            uint32_t nonce = blockTemplate.nonce;
+
+            Crypto::Hash hash;
 
             while (m_state == MiningState::MINING_IN_PROGRESS)
             {
-                Crypto::Hash hash = getBlockLongHash(block);
+                hashingTemplate.hash(nonce, hash);
 
                 if (check_hash(hash, difficulty))
                 {
@@ -114,12 +123,13 @@ namespace CryptoNote
                         return;
                     }
 
-                    m_block = block;
+                    m_block = blockTemplate;
+                    m_block.nonce = nonce;
                     return;
                 }
 
                 incrementHashCount();
-                block.nonce += nonceStep;
+                nonce += nonceStep;
             }
         }
         catch (const std::exception &e)
@@ -130,6 +140,55 @@ namespace CryptoNote
         }
     }
 
+    double Miner::benchmark(const BlockTemplate &blockTemplate, size_t threadCount, std::chrono::seconds duration)
+    {
+        const BlockHashingTemplate hashingTemplate(blockTemplate);
+
+        std::atomic<bool> shouldStop = false;
+
+        std::atomic<uint64_t> hashCount = 0;
+
+        std::vector<std::thread> threads;
+
+        const auto startTime = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            threads.push_back(std::thread([&, i]() {
+                /* Thread local copy, since hashing patches the nonce in place */
+                BlockHashingTemplate localTemplate = hashingTemplate;
+
+                uint32_t nonce = static_cast<uint32_t>(i);
+
+                uint64_t hashes = 0;
+
+                Crypto::Hash hash;
+
+                while (!shouldStop)
+                {
+                    localTemplate.hash(nonce, hash);
+                    hashes++;
+                    nonce += static_cast<uint32_t>(threadCount);
+                }
+
+                hashCount += hashes;
+            }));
+        }
+
+        std::this_thread::sleep_for(duration);
+
+        shouldStop = true;
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+        return hashCount / elapsed;
+    }
+
     bool Miner::setStateBlockFound()
     {
         auto state = m_state.load();
@@ -9,7 +9,9 @@
 #include "CryptoNote.h"
 
 #include <atomic>
+#include <chrono>
 #include <mutex>
+#include <miner/BlockUtilities.h>
 #include <system/Dispatcher.h>
 #include <system/Event.h>
 #include <system/RemoteContext.h>
@@ -32,6 +34,10 @@ namespace CryptoNote
 
         uint64_t getHashCount();
 
+        /* Hash the given template on threadCount threads for the given
+           duration, without checking for solutions. Returns hashes/second. */
+        static double benchmark(const BlockTemplate &blockTemplate, size_t threadCount, std::chrono::seconds duration);
+
         // NOTE! this is blocking method
         void stop();
 
@@ -59,7 +65,11 @@ namespace CryptoNote
 
         void runWorkers(BlockMiningParameters blockMiningParameters, size_t threadCount);
 
-        void workerFunc(const BlockTemplate &blockTemplate, uint64_t difficulty, uint32_t nonceStep);
+        void workerFunc(
+            const BlockTemplate &blockTemplate,
+            BlockHashingTemplate hashingTemplate,
+            uint64_t difficulty,
+            uint32_t nonceStep);
 
         bool setStateBlockFound();
 
@@ -32,7 +32,7 @@ namespace CryptoNote
         const size_t CONCURRENCY_LEVEL = std::thread::hardware_concurrency();
     }
 
-    MiningConfig::MiningConfig(): help(false), version(false) {}
+    MiningConfig::MiningConfig(): benchmark(false), benchmarkDuration(0), help(false), version(false) {}
 
     void MiningConfig::parse(int argc, char **argv)
     {
@@ -83,6 +83,15 @@ namespace CryptoNote
             cxxopts::value<size_t>(threadCount)->default_value(std::to_string(CONCURRENCY_LEVEL)),
             "#");
 
+        options.add_options("Benchmark")(
+            "benchmark",
+            "Measure the hashrate for each thread count from 1 to --threads, then exit",
+            cxxopts::value<bool>(benchmark)->default_value("false")->implicit_value("true"))(
+            "benchmark-duration",
+            "How long to hash for at each thread count (seconds)",
+            cxxopts::value<size_t>(benchmarkDuration)->default_value("10"),
+            "#");
+
         try
         {
             auto result = options.parse(argc, argv);
@@ -106,6 +115,22 @@ namespace CryptoNote
             exit(0);
         }
 
+        if (threadCount == 0 || threadCount > CONCURRENCY_LEVEL)
+        {
+            throw std::runtime_error("--threads option must be 1.." + std::to_string(CONCURRENCY_LEVEL));
+        }
+
+        /* Benchmarking doesn't talk to a daemon, so we don't need an address */
+        if (benchmark)
+        {
+            if (benchmarkDuration == 0)
+            {
+                throw std::runtime_error("--benchmark-duration must not be zero");
+            }
+
+            return;
+        }
+
         const bool integratedAddressesAllowed = false;
 
         Error error = validateAddresses({miningAddress}, integratedAddressesAllowed);
@@ -134,11 +159,6 @@ namespace CryptoNote
             }
         }
 
-        if (threadCount == 0 || threadCount > CONCURRENCY_LEVEL)
-        {
-            throw std::runtime_error("--threads option must be 1.." + std::to_string(CONCURRENCY_LEVEL));
-        }
-
         if (scanPeriod == 0)
         {
             throw std::runtime_error("--scan-time must not be zero");
@@ -36,6 +36,10 @@ namespace CryptoNote
 
         int64_t blockTimestampInterval;
 
+        bool benchmark;
+
+        size_t benchmarkDuration;
+
         bool help;
 
         bool version;
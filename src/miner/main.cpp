@@ -5,15 +5,57 @@
 
 #include "MinerManager.h"
 
+#include <config/CryptoNoteConfig.h>
 #include <system/Dispatcher.h>
+#include <utilities/ColouredMsg.h>
+#include <utilities/FormatTools.h>
+
+namespace
+{
+    void runBenchmark(const CryptoNote::MiningConfig &config)
+    {
+        /* A dummy template using the newest hashing algorithm */
+        CryptoNote::BlockTemplate block {};
+
+        for (const auto &[majorVersion, hashingAlgorithm] : CryptoNote::HASHING_ALGORITHMS_BY_BLOCK_VERSION)
+        {
+            block.majorVersion = std::max(block.majorVersion, majorVersion);
+        }
+
+        block.parentBlock.majorVersion = CryptoNote::BLOCK_MAJOR_VERSION_1;
+        block.parentBlock.transactionCount = 1;
+
+        std::cout << InformationMsg("Benchmarking block major version ")
+                  << InformationMsg(std::to_string(block.majorVersion)) << InformationMsg(" for ")
+                  << InformationMsg(std::to_string(config.benchmarkDuration))
+                  << InformationMsg(" seconds per thread count...\n\n");
+
+        for (size_t threads = 1; threads <= config.threadCount; threads++)
+        {
+            const double hashrate = CryptoNote::Miner::benchmark(
+                block, threads, std::chrono::seconds(config.benchmarkDuration)
+            );
+
+            std::cout << SuccessMsg(std::to_string(threads) + " thread(s): ")
+                      << SuccessMsg(Utilities::get_mining_speed(hashrate))
+                      << SuccessMsg(" (" + Utilities::get_mining_speed(hashrate / threads) + " per thread)") << std::endl;
+        }
+    }
+}
 
 int main(int argc, char **argv)
 {
-    while (true)
+    CryptoNote::MiningConfig config;
+    config.parse(argc, argv);
+
+    if (config.benchmark)
     {
-        CryptoNote::MiningConfig config;
-        config.parse(argc, argv);
+        runBenchmark(config);
+        return 0;
+    }
 
+    while (true)
+    {
         try
         {
             System::Dispatcher dispatcher;
@@ -7,16 +7,22 @@
 ////////////////////////
 
 #include <common/CryptoNoteTools.h>
+#include <common/StringTools.h>
 #include <config/CryptoNoteConfig.h>
 #include <cryptonotecore/CachedBlock.h>
 #include <cryptonotecore/Core.h>
 #include <CryptoNote.h>
 #include <errors/ValidateParameters.h>
+#include <mutex>
 #include <utilities/Utilities.h>
 #include <version.h>
 
 using json = nlohmann::json;
 
+/* How long we ask the daemon to hold a /wait_for_block request open for.
+   Stopping has to wait for the request to come back, so keep it short. */
+const std::chrono::seconds WAIT_FOR_BLOCK_TIMEOUT(5);
+
 ////////////////////////////////
 /*   Inline helper methods    */
 ////////////////////////////////
@@ -65,6 +71,7 @@ Nigel::Nigel(
 
     m_requestHeaders = {{"User-Agent", userAgent.str()}};
     m_nodeClient = getClient(m_daemonHost, m_daemonPort, m_daemonSSL, m_timeout);
+    m_waitClient = getClient(m_daemonHost, m_daemonPort, m_daemonSSL, m_timeout + WAIT_FOR_BLOCK_TIMEOUT);
 }
 
 Nigel::~Nigel()
@@ -89,12 +96,16 @@ void Nigel::swapNode(const std::string daemonHost, const uint16_t daemonPort, co
     m_nodeFeeAddress = "";
     m_nodeFeeAmount = 0;
     m_useRawBlocks = true;
+    m_viewKeyScanningAvailable = true;
+    m_waitForBlockAvailable = true;
+    m_topBlockHash = Constants::NULL_HASH;
 
     m_daemonHost = daemonHost;
     m_daemonPort = daemonPort;
     m_daemonSSL = daemonSSL;
 
     m_nodeClient = getClient(m_daemonHost, m_daemonPort, m_daemonSSL, m_timeout);
+    m_waitClient = getClient(m_daemonHost, m_daemonPort, m_daemonSSL, m_timeout + WAIT_FOR_BLOCK_TIMEOUT);
 
     init();
 }
@@ -213,6 +224,82 @@ std::tuple<bool, std::vector<WalletTypes::WalletBlockInfo>, std::optional<Wallet
     return { false, {}, std::nullopt };
 }
 
+std::tuple<bool, std::vector<WalletTypes::WalletBlockInfo>, std::optional<WalletTypes::TopBlock>>
+    Nigel::scanWalletOutputs(
+        const std::vector<Crypto::Hash> blockHashCheckpoints,
+        const uint64_t startHeight,
+        const uint64_t startTimestamp,
+        const bool skipCoinbaseTransactions,
+        const Crypto::SecretKey privateViewKey,
+        const std::vector<Crypto::PublicKey> publicSpendKeys,
+        const std::vector<std::tuple<uint64_t, uint64_t>> unspentGlobalIndexes)
+{
+    Logger::logger.log("Requesting daemon side scan of blocks", Logger::DEBUG, {Logger::SYNC, Logger::DAEMON});
+
+    json unspentInputs = json::array();
+
+    for (const auto &[amount, globalIndex] : unspentGlobalIndexes)
+    {
+        unspentInputs.push_back({{"amount", amount}, {"globalIndex", globalIndex}});
+    }
+
+    json j = {{"blockHashCheckpoints", blockHashCheckpoints},
+              {"startHeight", startHeight},
+              {"startTimestamp", startTimestamp},
+              {"blockCount", m_blockCount.load()},
+              {"skipCoinbaseTransactions", skipCoinbaseTransactions},
+              {"privateViewKey", privateViewKey},
+              {"publicSpendKeys", publicSpendKeys},
+              {"unspentInputs", unspentInputs}};
+
+    /* Not logging the request body here - it contains our private view key */
+    const auto res = m_nodeClient->Post("/scanwalletoutputs", m_requestHeaders, j.dump(), "application/json");
+
+    /* Daemon is too old, or hasn't enabled view key scanning for us. Don't
+       keep asking. */
+    if (res && (res->status == 403 || res->status == 404))
+    {
+        Logger::logger.log(
+            "Daemon does not allow view key scanning, falling back to scanning locally",
+            Logger::WARNING,
+            {Logger::SYNC, Logger::DAEMON});
+
+        m_viewKeyScanningAvailable = false;
+
+        return {false, {}, std::nullopt};
+    }
+
+    const auto parsedResponse = tryParseJSONResponse(
+        res,
+        "Failed to scan blocks with daemon",
+        [](const nlohmann::json j) {
+            const auto items = j.at("items").get<std::vector<WalletTypes::WalletBlockInfo>>();
+
+            std::optional<WalletTypes::TopBlock> topBlock;
+
+            if (j.find("synced") != j.end() && j.find("topBlock") != j.end() && j.at("synced").get<bool>())
+            {
+                topBlock = j.at("topBlock").get<WalletTypes::TopBlock>();
+            }
+
+            return std::make_tuple(items, topBlock);
+        });
+
+    if (parsedResponse)
+    {
+        const auto [items, topBlock] = *parsedResponse;
+
+        return {true, items, topBlock};
+    }
+
+    return {false, {}, std::nullopt};
+}
+
+bool Nigel::viewKeyScanningAvailable() const
+{
+    return m_viewKeyScanningAvailable;
+}
+
 void Nigel::stop()
 {
     m_shouldStop = true;
@@ -225,6 +312,14 @@ void Nigel::stop()
 
 void Nigel::init()
 {
+    std::scoped_lock lock(m_initMutex);
+
+    /* Already running - the connection is shared between multiple wallets */
+    if (m_backgroundThread.joinable())
+    {
+        return;
+    }
+
     m_shouldStop = false;
 
     /* Get the initial daemon info, and the initial fee info before returning.
@@ -320,13 +415,48 @@ bool Nigel::getFeeInfo()
     return parsedResponse.has_value();
 }
 
+bool Nigel::waitForNewBlock()
+{
+    if (!m_waitForBlockAvailable)
+    {
+        return false;
+    }
+
+    const std::string path = "/wait_for_block?after=" + Common::podToHex(m_topBlockHash)
+                             + "&timeout=" + std::to_string(WAIT_FOR_BLOCK_TIMEOUT.count());
+
+    Logger::logger.log("Sending " + path + " request to daemon", Logger::TRACE, {Logger::SYNC, Logger::DAEMON});
+
+    auto res = m_waitClient->Get(path.c_str(), m_requestHeaders);
+
+    /* Older daemon */
+    if (res && res->status == 404)
+    {
+        m_waitForBlockAvailable = false;
+        return false;
+    }
+
+    const auto parsedResponse =
+        tryParseJSONResponse(res, "Failed to wait for new block", [this](const nlohmann::json j) {
+            m_topBlockHash = j.at("hash").get<Crypto::Hash>();
+            return true;
+        });
+
+    return parsedResponse.has_value();
+}
+
 void Nigel::backgroundRefresh()
 {
     while (!m_shouldStop)
     {
         getDaemonInfo();
 
-        Utilities::sleepUnlessStopping(std::chrono::seconds(10), m_shouldStop);
+        /* Comes back as soon as the daemon gets a block, so we see it right
+           away rather than on the next refresh */
+        if (!waitForNewBlock())
+        {
+            Utilities::sleepUnlessStopping(std::chrono::seconds(10), m_shouldStop);
+        }
     }
 }
 
@@ -8,6 +8,7 @@
 #include "httplib.h"
 
 #include <atomic>
+#include <config/Constants.h>
 #include <config/CryptoNoteConfig.h>
 #include <logger/Logger.h>
 #include <rpc/CoreRpcServerCommandsDefinitions.h>
@@ -65,6 +66,23 @@ class Nigel
         const uint64_t startTimestamp,
         const bool skipCoinbaseTransactions);
 
+    /* Has the daemon scan the blocks for us with our private view key,
+       returning only the transactions which send to us or may spend our
+       inputs. Only use with a daemon you trust, since it learns which
+       transactions belong to you. */
+    std::tuple<bool, std::vector<WalletTypes::WalletBlockInfo>, std::optional<WalletTypes::TopBlock>> scanWalletOutputs(
+        const std::vector<Crypto::Hash> blockHashCheckpoints,
+        const uint64_t startHeight,
+        const uint64_t startTimestamp,
+        const bool skipCoinbaseTransactions,
+        const Crypto::SecretKey privateViewKey,
+        const std::vector<Crypto::PublicKey> publicSpendKeys,
+        const std::vector<std::tuple<uint64_t, uint64_t>> unspentGlobalIndexes);
+
+    /* Whether the daemon has /scanwalletoutputs enabled for us, as far
+       as we know */
+    bool viewKeyScanningAvailable() const;
+
     /* Returns a bool on success or not */
     bool getTransactionsStatus(
         const std::unordered_set<Crypto::Hash> transactionHashes,
@@ -92,6 +110,11 @@ class Nigel
 
     bool getDaemonInfo();
 
+    /* Long polls the daemon until it has a block on top of m_topBlockHash,
+       or a few seconds pass. Returns false if the daemon can't do this, and
+       we need to wait ourselves. */
+    bool waitForNewBlock();
+
     bool getFeeInfo();
 
     template<typename F>
@@ -184,6 +207,11 @@ class Nigel
        and making our functions non const) */
     std::shared_ptr<httplib::Client> m_nodeClient = nullptr;
 
+    /* Used by the background thread to wait for new blocks. Separate, as
+       the request stays open until the daemon gets a block, and its timeout
+       has to allow for that. */
+    std::shared_ptr<httplib::Client> m_waitClient = nullptr;
+
     /* Stores the HTTP headers included in all Nigel requests */
     httplib::Headers m_requestHeaders;
 
@@ -193,6 +221,9 @@ class Nigel
     /* If we should stop the background thread */
     std::atomic<bool> m_shouldStop = false;
 
+    /* Stops multiple wallets sharing this connection initializing it at once */
+    std::mutex m_initMutex;
+
     /* Stores how many blocks we'll try to sync */
     std::atomic<uint64_t> m_blockCount = CryptoNote::BLOCKS_SYNCHRONIZING_DEFAULT_COUNT;
 
@@ -232,4 +263,14 @@ class Nigel
 
     /* Whether we should use /getrawblocks instead of /getwalletsyncdata */
     bool m_useRawBlocks = true;
+
+    /* Whether the daemon accepts our /scanwalletoutputs requests */
+    std::atomic<bool> m_viewKeyScanningAvailable = true;
+
+    /* Whether the daemon supports /wait_for_block */
+    bool m_waitForBlockAvailable = true;
+
+    /* The top block the daemon had, as of the last /wait_for_block. Only
+       used by the background thread. */
+    Crypto::Hash m_topBlockHash = Constants::NULL_HASH;
 };
@@ -158,6 +158,8 @@ namespace CryptoNote
             m_context_group = &contextGroup;
             HttpClient httpClient(dispatcher, m_nodeHost, m_nodePort);
             m_httpClient = &httpClient;
+            HttpClient longPollHttpClient(dispatcher, m_nodeHost, m_nodePort);
+            m_longPollHttpClient = &longPollHttpClient;
             Event httpEvent(dispatcher);
             m_httpEvent = &httpEvent;
             m_httpEvent->set();
@@ -192,9 +194,24 @@ namespace CryptoNote
                 while (!m_stop)
                 {
                     updateNodeStatus();
-                    if (!m_stop)
+
+                    if (m_stop)
                     {
-                        pullTimer.sleep(std::chrono::milliseconds(m_pullInterval));
+                        break;
+                    }
+
+                    const auto started = std::chrono::steady_clock::now();
+
+                    const bool changed = waitForChanges();
+
+                    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - started);
+
+                    const std::chrono::milliseconds pullInterval(m_pullInterval);
+
+                    if (!changed && !m_stop && elapsed < pullInterval)
+                    {
+                        pullTimer.sleep(pullInterval - elapsed);
                     }
                 }
             });
@@ -211,6 +228,7 @@ namespace CryptoNote
         m_context_group = nullptr;
         m_httpClient = nullptr;
         m_httpEvent = nullptr;
+        m_longPollHttpClient = nullptr;
         m_connected = false;
         m_rpcProxyObserverManager.notify(&INodeRpcProxyObserver::connectionStatusUpdated, m_connected);
     }
@@ -255,6 +273,40 @@ namespace CryptoNote
         return true;
     }
 
+    bool NodeRpcProxy::waitForChanges()
+    {
+        std::vector<Crypto::Hash> knownTxs = getKnownTxsVector();
+        Crypto::Hash tailBlock = lastLocalBlockHeaderInfo.hash;
+
+        bool isBcActual = false;
+        std::vector<std::unique_ptr<ITransactionReader>> addedTxs;
+        std::vector<Crypto::Hash> deletedTxsIds;
+
+        std::error_code ec = doGetPoolSymmetricDifference(
+            std::move(knownTxs), tailBlock, isBcActual, addedTxs, deletedTxsIds, RPC_MAX_LONG_POLL_SECONDS);
+
+        if (ec)
+        {
+            return false;
+        }
+
+        /* New block, updateNodeStatus() picks it up */
+        if (!isBcActual)
+        {
+            return true;
+        }
+
+        if (addedTxs.empty() && deletedTxsIds.empty())
+        {
+            return false;
+        }
+
+        updatePoolState(addedTxs, deletedTxsIds);
+        m_observerManager.notify(&INodeObserver::poolChanged);
+
+        return true;
+    }
+
     void NodeRpcProxy::updateBlockchainStatus()
     {
         CryptoNote::COMMAND_RPC_GET_LAST_BLOCK_HEADER::request req = AUTO_VAL_INIT(req);
@@ -826,16 +878,18 @@ namespace CryptoNote
         Crypto::Hash knownBlockId,
         bool &isBcActual,
         std::vector<std::unique_ptr<ITransactionReader>> &newTxs,
-        std::vector<Crypto::Hash> &deletedTxIds)
+        std::vector<Crypto::Hash> &deletedTxIds,
+        const uint64_t waitTimeout)
     {
         CryptoNote::COMMAND_RPC_GET_POOL_CHANGES_LITE::request req = AUTO_VAL_INIT(req);
         CryptoNote::COMMAND_RPC_GET_POOL_CHANGES_LITE::response rsp = AUTO_VAL_INIT(rsp);
 
         req.tailBlockId = knownBlockId;
         req.knownTxsIds = knownPoolTxIds;
+        req.timeout = waitTimeout;
 
         m_logger(TRACE) << "Send get_pool_changes_lite request, tailBlockId " << req.tailBlockId;
-        std::error_code ec = jsonCommand("/get_pool_changes_lite", "POST", req, rsp);
+        std::error_code ec = jsonCommand("/get_pool_changes_lite", "POST", req, rsp, waitTimeout != 0);
 
         if (ec)
         {
@@ -946,15 +1000,29 @@ namespace CryptoNote
     }
 
     template<typename Request, typename Response>
-    std::error_code NodeRpcProxy::jsonCommand(const std::string &url, const std::string &method, const Request &req, Response &res)
+    std::error_code NodeRpcProxy::jsonCommand(
+        const std::string &url,
+        const std::string &method,
+        const Request &req,
+        Response &res,
+        const bool longPoll)
     {
         std::error_code ec;
 
         try
         {
             m_logger(TRACE) << "Send " << url << " JSON request";
-            EventLock eventLock(*m_httpEvent);
-            invokeJsonCommand(*m_httpClient, url, method, req, res);
+
+            if (longPoll)
+            {
+                invokeJsonCommand(*m_longPollHttpClient, url, method, req, res);
+            }
+            else
+            {
+                EventLock eventLock(*m_httpEvent);
+                invokeJsonCommand(*m_httpClient, url, method, req, res);
+            }
+
             ec = interpretResponseStatus(res.status);
         }
         catch (const ConnectException &)
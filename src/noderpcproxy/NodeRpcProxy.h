@@ -158,6 +158,12 @@ namespace CryptoNote
 
         bool updatePoolStatus();
 
+        /* Holds a request open on the daemon until the chain or pool moves
+           on, applying any pool changes. Returns false if nothing changed,
+           which with an older daemon that answers at once means we should
+           wait out the pull interval ourselves. */
+        bool waitForChanges();
+
         void updatePeerCount(size_t peerCount);
 
         void updatePoolState(
@@ -208,7 +214,8 @@ namespace CryptoNote
             Crypto::Hash knownBlockId,
             bool &isBcActual,
             std::vector<std::unique_ptr<ITransactionReader>> &newTxs,
-            std::vector<Crypto::Hash> &deletedTxIds);
+            std::vector<Crypto::Hash> &deletedTxIds,
+            const uint64_t waitTimeout = 0);
 
         void scheduleRequest(std::function<std::error_code()> &&procedure, const Callback &callback);
 
@@ -216,7 +223,12 @@ namespace CryptoNote
         std::error_code binaryCommand(const std::string &url, const Request &req, Response &res);
 
         template<typename Request, typename Response>
-        std::error_code jsonCommand(const std::string &url, const std::string &method, const Request &req, Response &res);
+        std::error_code jsonCommand(
+            const std::string &url,
+            const std::string &method,
+            const Request &req,
+            Response &res,
+            const bool longPoll = false);
 
         template<typename Request, typename Response>
         std::error_code jsonRpcCommand(const std::string &method, const Request &req, Response &res);
@@ -259,6 +271,10 @@ namespace CryptoNote
 
         System::Event *m_httpEvent = nullptr;
 
+        /* Only used by the pull loop, for requests the daemon holds open, so
+           they don't hold up everything queued on m_httpClient */
+        HttpClient *m_longPollHttpClient = nullptr;
+
         uint64_t m_pullInterval;
 
         // Internal state
@@ -7,6 +7,7 @@
 
 #include "common/StringTools.h"
 #include "crypto/hash.h"
+#include "p2p/PendingCompactBlock.h"
 #include "p2p/PendingLiteBlock.h"
 
 #include <boost/uuid/uuid.hpp>
@@ -39,6 +40,7 @@ namespace CryptoNote
 
         state m_state = state_befor_handshake;
         std::optional<PendingLiteBlock> m_pending_lite_block;
+        std::optional<PendingCompactBlock> m_pending_compact_block;
         std::list<Crypto::Hash> m_needed_objects;
         std::unordered_set<Crypto::Hash> m_requested_objects;
         uint32_t m_remote_blockchain_height = 0;
@@ -52,15 +52,7 @@ void LevinProtocol::sendMessage(uint32_t command, const BinaryArray &out, bool n
     head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
     head.m_flags = LEVIN_PACKET_REQUEST;
 
-    // write header and body in one operation
-    BinaryArray writeBuffer;
-    writeBuffer.reserve(sizeof(head) + out.size());
-
-    Common::VectorOutputStream stream(writeBuffer);
-    stream.writeSome(&head, sizeof(head));
-    stream.writeSome(out.data(), out.size());
-
-    writeStrict(writeBuffer.data(), writeBuffer.size());
+    writeStrict(reinterpret_cast<const uint8_t *>(&head), sizeof(head), out.data(), out.size());
 }
 
 bool LevinProtocol::readCommand(Command &cmd)
@@ -112,22 +104,23 @@ void LevinProtocol::sendReply(uint32_t command, const BinaryArray &out, int32_t
     head.m_flags = LEVIN_PACKET_RESPONSE;
     head.m_return_code = returnCode;
 
-    BinaryArray writeBuffer;
-    writeBuffer.reserve(sizeof(head) + out.size());
-
-    Common::VectorOutputStream stream(writeBuffer);
-    stream.writeSome(&head, sizeof(head));
-    stream.writeSome(out.data(), out.size());
-
-    writeStrict(writeBuffer.data(), writeBuffer.size());
+    writeStrict(reinterpret_cast<const uint8_t *>(&head), sizeof(head), out.data(), out.size());
 }
 
-void LevinProtocol::writeStrict(const uint8_t *ptr, size_t size)
+void LevinProtocol::writeStrict(const uint8_t *header, size_t headerSize, const uint8_t *body, size_t bodySize)
 {
+    /* Scatter-gather the header and body, so the (possibly large, and
+       possibly shared between connections) body is never copied */
     size_t offset = 0;
-    while (offset < size)
+    while (offset < headerSize)
+    {
+        offset += m_conn.write(header + offset, headerSize - offset, body, bodySize);
+    }
+
+    offset -= headerSize;
+    while (offset < bodySize)
     {
-        offset += m_conn.write(ptr + offset, size - offset);
+        offset += m_conn.write(body + offset, bodySize - offset);
     }
 }
 
@@ -107,7 +107,7 @@ namespace CryptoNote
       private:
         bool readStrict(uint8_t *ptr, size_t size);
 
-        void writeStrict(const uint8_t *ptr, size_t size);
+        void writeStrict(const uint8_t *header, size_t headerSize, const uint8_t *body, size_t bodySize);
 
         System::TcpConnection &m_conn;
     };
@@ -50,6 +50,7 @@
 #include <system/Ipv4Resolver.h>
 #include <system/TcpConnector.h>
 #include <system/TcpListener.h>
+#include <unordered_set>
 
 using namespace Common;
 using namespace Logging;
@@ -57,17 +58,6 @@ using namespace CryptoNote;
 
 namespace
 {
-    size_t get_random_index_with_fixed_probability(size_t max_index)
-    {
-        // divide by zero workaround
-        if (!max_index)
-        {
-            return 0;
-        }
-        size_t x = Random::randomValue<size_t>() % (max_index + 1);
-        return (x * x * x) / (max_index * max_index); // parabola \/
-    }
-
     void addPortMapping(Logging::LoggerRef &logger, uint32_t port)
     {
         // Add UPnP port mapping
@@ -236,6 +226,7 @@ namespace CryptoNote
         m_idleTimer(m_dispatcher),
         m_timedSyncTimer(m_dispatcher),
         m_timeoutTimer(m_dispatcher),
+        m_transactionAnnounceTimer(m_dispatcher),
         m_stop(false),
         // intervals
         // m_peer_handshake_idle_maker_interval(CryptoNote::P2P_DEFAULT_HANDSHAKE_INTERVAL),
@@ -276,6 +267,8 @@ namespace CryptoNote
         int ret = 0;
         handled = true;
 
+        countMessage(cmd.command, false, cmd.buf.size());
+
         if (cmd.isResponse && cmd.command == COMMAND_TIMED_SYNC::ID)
         {
             if (!handleTimedSyncResponse(cmd.buf, ctx))
@@ -381,8 +374,11 @@ namespace CryptoNote
         const BinaryArray &data_buff,
         const boost::uuids::uuid *excludeConnection)
     {
-        m_dispatcher.remoteSpawn([this, command, data_buff, excludeConnection] {
-            relay_notify_to_all(command, data_buff, excludeConnection);
+        /* Copy the payload once, it's then shared by every connection */
+        auto payload = std::make_shared<const BinaryArray>(data_buff);
+
+        m_dispatcher.remoteSpawn([this, command, payload, excludeConnection] {
+            relayNotifyToAll(command, payload, excludeConnection);
         });
     }
 
@@ -392,7 +388,10 @@ namespace CryptoNote
         const BinaryArray &data_buff,
         const std::list<boost::uuids::uuid> relayList)
     {
-        m_dispatcher.remoteSpawn([this, command, data_buff, relayList] {
+        /* Copy the payload once, it's then shared by every connection */
+        auto payload = std::make_shared<const BinaryArray>(data_buff);
+
+        m_dispatcher.remoteSpawn([this, command, payload, relayList] {
             forEachConnection([&](P2pConnectionContext &conn) {
                 if (std::find(relayList.begin(), relayList.end(), conn.m_connection_id) != relayList.end())
                 {
@@ -400,7 +399,7 @@ namespace CryptoNote
                         && (conn.m_state == CryptoNoteConnectionContext::state_normal
                             || conn.m_state == CryptoNoteConnectionContext::state_synchronizing))
                     {
-                        conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, data_buff));
+                        conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, payload));
                     }
                 }
             });
@@ -552,6 +551,7 @@ namespace CryptoNote
         m_workingContextGroup.spawn(std::bind(&NodeServer::onIdle, this));
         m_workingContextGroup.spawn(std::bind(&NodeServer::timedSyncLoop, this));
         m_workingContextGroup.spawn(std::bind(&NodeServer::timeoutLoop, this));
+        m_workingContextGroup.spawn(std::bind(&NodeServer::transactionAnnounceLoop, this));
 
         m_stopEvent.wait();
 
@@ -700,7 +700,7 @@ namespace CryptoNote
     {
         COMMAND_TIMED_SYNC::request arg = boost::value_initialized<COMMAND_TIMED_SYNC::request>();
         m_payload_handler.get_payload_sync_data(arg.payload_data);
-        auto cmdBuf = LevinProtocol::encode<COMMAND_TIMED_SYNC::request>(arg);
+        auto cmdBuf = std::make_shared<const BinaryArray>(LevinProtocol::encode<COMMAND_TIMED_SYNC::request>(arg));
 
         forEachConnection([&](P2pConnectionContext &conn) {
             if (conn.peerId
@@ -770,30 +770,50 @@ namespace CryptoNote
             return true;
         } // dont make connections to ourself
 
-        for (const auto &kv : m_connections)
-        {
-            const auto &cntxt = kv.second;
-            if (cntxt.peerId == peer.id
-                || (!cntxt.m_is_income && peer.adr.ip == cntxt.m_remote_ip && peer.adr.port == cntxt.m_remote_port))
-            {
-                return true;
-            }
-        }
-        return false;
+        return m_connectedPeerIds.count(peer.id) != 0 || m_outgoingAddresses.count(peer.adr) != 0;
     }
     //-----------------------------------------------------------------------------------
 
     bool NodeServer::is_addr_connected(const NetworkAddress &peer)
     {
-        for (const auto &conn : m_connections)
+        return m_outgoingAddresses.count(peer) != 0;
+    }
+    //-----------------------------------------------------------------------------------
+
+    void NodeServer::indexConnection(const P2pConnectionContext &ctx)
+    {
+        if (ctx.peerId)
+        {
+            m_connectedPeerIds[ctx.peerId]++;
+        }
+
+        if (!ctx.m_is_income)
         {
-            if (!conn.second.m_is_income && peer.ip == conn.second.m_remote_ip
-                && peer.port == conn.second.m_remote_port)
+            m_outgoingAddresses[NetworkAddress {ctx.m_remote_ip, ctx.m_remote_port}]++;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+
+    void NodeServer::unindexConnection(const P2pConnectionContext &ctx)
+    {
+        const auto decrement = [](auto &index, const auto &key) {
+            const auto it = index.find(key);
+
+            if (it != index.end() && --it->second == 0)
             {
-                return true;
+                index.erase(it);
             }
+        };
+
+        if (ctx.peerId)
+        {
+            decrement(m_connectedPeerIds, ctx.peerId);
+        }
+
+        if (!ctx.m_is_income)
+        {
+            decrement(m_outgoingAddresses, NetworkAddress {ctx.m_remote_ip, ctx.m_remote_port});
         }
-        return false;
     }
 
     bool NodeServer::try_to_connect_and_handshake_with_new_peer(
@@ -889,6 +909,8 @@ namespace CryptoNote
             const boost::uuids::uuid &connectionId = iter->first;
             P2pConnectionContext &connectionContext = iter->second;
 
+            indexConnection(connectionContext);
+
             m_workingContextGroup.spawn(
                 std::bind(&NodeServer::connectionHandler, this, std::cref(connectionId), std::ref(connectionContext)));
 
@@ -910,8 +932,9 @@ namespace CryptoNote
     //-----------------------------------------------------------------------------------
     bool NodeServer::make_new_connection_from_peerlist(bool use_white_list)
     {
-        size_t local_peers_count =
-            use_white_list ? m_peerlist.get_white_peers_count() : m_peerlist.get_gray_peers_count();
+        const Peerlist &peerlist = use_white_list ? m_peerlist.getWhite() : m_peerlist.getGray();
+
+        size_t local_peers_count = peerlist.count();
         if (!local_peers_count)
         {
             return false;
@@ -919,35 +942,28 @@ namespace CryptoNote
 
         size_t max_random_index = std::min<uint64_t>(local_peers_count - 1, 20);
 
-        std::set<size_t> tried_peers;
+        std::unordered_set<NetworkAddress, NetworkAddressHasher> tried_peers;
 
         size_t try_count = 0;
         size_t rand_count = 0;
         while (rand_count < (max_random_index + 1) * 3 && try_count < 10 && !m_stop)
         {
             ++rand_count;
-            size_t random_index = get_random_index_with_fixed_probability(max_random_index);
-            if (!(random_index < local_peers_count))
+
+            /* Picks a subnet first, so a subnet packed with peers can't fill
+               up all of our connections */
+            PeerlistEntry pe = boost::value_initialized<PeerlistEntry>();
+            if (!peerlist.getRandom(pe))
             {
-                logger(ERROR, BRIGHT_RED) << "random_starter_index < peers_local.size() failed!!";
+                logger(ERROR, BRIGHT_RED) << "Failed to get random peer from peerlist(white:" << use_white_list << ")";
                 return false;
             }
 
-            if (tried_peers.count(random_index))
+            if (!tried_peers.insert(pe.adr).second)
             {
                 continue;
             }
 
-            tried_peers.insert(random_index);
-            PeerlistEntry pe = boost::value_initialized<PeerlistEntry>();
-            bool r = use_white_list ? m_peerlist.get_white_peer_by_index(pe, random_index)
-                                    : m_peerlist.get_gray_peer_by_index(pe, random_index);
-            if (!(r))
-            {
-                logger(ERROR, BRIGHT_RED) << "Failed to get random peer from peerlist(white:" << use_white_list << ")";
-                return false;
-            }
-
             ++try_count;
 
             if (is_peer_used(pe))
@@ -1265,6 +1281,15 @@ namespace CryptoNote
         int command,
         const BinaryArray &data_buff,
         const boost::uuids::uuid *excludeConnection)
+    {
+        relayNotifyToAll(command, std::make_shared<const BinaryArray>(data_buff), excludeConnection);
+    }
+
+    //-----------------------------------------------------------------------------------
+    void NodeServer::relayNotifyToAll(
+        int command,
+        const std::shared_ptr<const BinaryArray> &payload,
+        const boost::uuids::uuid *excludeConnection)
     {
         boost::uuids::uuid excludeId =
             excludeConnection ? *excludeConnection : boost::value_initialized<boost::uuids::uuid>();
@@ -1274,7 +1299,7 @@ namespace CryptoNote
                 && (conn.m_state == CryptoNoteConnectionContext::state_normal
                     || conn.m_state == CryptoNoteConnectionContext::state_synchronizing))
             {
-                conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, data_buff));
+                conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, payload));
             }
         });
     }
@@ -1426,6 +1451,7 @@ namespace CryptoNote
         }
         // associate peer_id with this connection
         context.peerId = arg.node_data.peer_id;
+        indexConnection(context);
 
         if (arg.node_data.peer_id != m_config.m_peer_id && arg.node_data.my_port)
         {
@@ -1625,6 +1651,26 @@ namespace CryptoNote
         }
     }
 
+    void NodeServer::transactionAnnounceLoop()
+    {
+        try
+        {
+            while (!m_stop)
+            {
+                m_transactionAnnounceTimer.sleep(std::chrono::milliseconds(P2P_TX_ANNOUNCE_INTERVAL_MILLISECONDS));
+                m_payload_handler.flushTransactionAnnouncements();
+            }
+        }
+        catch (System::InterruptedException &)
+        {
+            logger(DEBUGGING) << "transactionAnnounceLoop() is interrupted";
+        }
+        catch (std::exception &e)
+        {
+            logger(WARNING) << "Exception in transactionAnnounceLoop: " << e.what();
+        }
+    }
+
     void NodeServer::timedSyncLoop()
     {
         try
@@ -1714,6 +1760,7 @@ namespace CryptoNote
             writeContext.wait();
 
             on_connection_close(ctx);
+            unindexConnection(ctx);
             m_connections.erase(connectionId);
         });
 
@@ -1756,16 +1803,19 @@ namespace CryptoNote
                 for (const auto &msg : msgs)
                 {
                     logger(DEBUGGING) << ctx << "msg " << msg.type << ':' << msg.command;
+
+                    countMessage(msg.command, true, msg.buffer->size());
+
                     switch (msg.type)
                     {
                         case P2pMessage::COMMAND:
-                            proto.sendMessage(msg.command, msg.buffer, true);
+                            proto.sendMessage(msg.command, *msg.buffer, true);
                             break;
                         case P2pMessage::NOTIFY:
-                            proto.sendMessage(msg.command, msg.buffer, false);
+                            proto.sendMessage(msg.command, *msg.buffer, false);
                             break;
                         case P2pMessage::REPLY:
-                            proto.sendReply(msg.command, msg.buffer, msg.returnCode);
+                            proto.sendReply(msg.command, *msg.buffer, msg.returnCode);
                             break;
                         default:
                             assert(false);
@@ -1787,6 +1837,33 @@ namespace CryptoNote
         logger(DEBUGGING) << ctx << "writeHandler finished";
     }
 
+    void NodeServer::countMessage(const int command, const bool outgoing, const size_t bytes)
+    {
+        auto it = m_commandMetrics.find({command, outgoing});
+
+        if (it == m_commandMetrics.end())
+        {
+            /* Peers can send any command id, so only known ranges get their
+               own series */
+            const bool known = (command >= P2P_COMMANDS_POOL_BASE && command < P2P_COMMANDS_POOL_BASE + 100)
+                               || (command >= BC_COMMANDS_POOL_BASE && command < BC_COMMANDS_POOL_BASE + 100);
+
+            const std::string labels = Metrics::label("command", known ? std::to_string(command) : "other") + ","
+                                       + Metrics::label("direction", outgoing ? "out" : "in");
+
+            auto &registry = Metrics::Registry::instance();
+
+            const CommandMetrics metrics {
+                &registry.counter("wrkzd_p2p_messages_total", "P2P messages by command and direction", labels),
+                &registry.counter("wrkzd_p2p_bytes_total", "P2P payload bytes by command and direction", labels)};
+
+            it = m_commandMetrics.emplace(std::make_pair(command, outgoing), metrics).first;
+        }
+
+        it->second.messages->increment();
+        it->second.bytes->increment(bytes);
+    }
+
     template<typename T> void NodeServer::safeInterrupt(T &obj)
     {
         try
@@ -12,6 +12,7 @@
 #include "NetNodeConfig.h"
 #include "P2pProtocolDefinitions.h"
 #include "PeerListManager.h"
+#include "common/Metrics.h"
 #include "cryptonoteprotocol/CryptoNoteProtocolHandler.h"
 #include "logging/LoggerRef.h"
 #include "p2p/OnceInInterval.h"
@@ -19,6 +20,8 @@
 #include <boost/functional/hash.hpp>
 #include <boost/uuid/uuid.hpp>
 #include <functional>
+#include <map>
+#include <memory>
 #include <system/Context.h>
 #include <system/ContextGroup.h>
 #include <system/Dispatcher.h>
@@ -51,7 +54,25 @@ namespace CryptoNote
         P2pMessage(Type type, uint32_t command, const BinaryArray &buffer, int32_t returnCode = 0):
             type(type),
             command(command),
-            buffer(buffer),
+            buffer(std::make_shared<const BinaryArray>(buffer)),
+            returnCode(returnCode)
+        {
+        }
+
+        P2pMessage(Type type, uint32_t command, BinaryArray &&buffer, int32_t returnCode = 0):
+            type(type),
+            command(command),
+            buffer(std::make_shared<const BinaryArray>(std::move(buffer))),
+            returnCode(returnCode)
+        {
+        }
+
+        /* Shares the payload, rather than copying it. Used when relaying the
+           same payload to many connections. */
+        P2pMessage(Type type, uint32_t command, std::shared_ptr<const BinaryArray> buffer, int32_t returnCode = 0):
+            type(type),
+            command(command),
+            buffer(std::move(buffer)),
             returnCode(returnCode)
         {
         }
@@ -66,14 +87,15 @@ namespace CryptoNote
 
         size_t size()
         {
-            return buffer.size();
+            return buffer->size();
         }
 
         Type type;
 
         uint32_t command;
 
-        const BinaryArray buffer;
+        /* Immutable, and possibly shared with other connections' queues */
+        std::shared_ptr<const BinaryArray> buffer;
 
         int32_t returnCode;
     };
@@ -267,6 +289,13 @@ namespace CryptoNote
             const BinaryArray &data_buff,
             const std::list<boost::uuids::uuid> relayList) override;
 
+        /* Queues the same payload on every eligible connection, without
+           copying it per connection */
+        void relayNotifyToAll(
+            int command,
+            const std::shared_ptr<const BinaryArray> &payload,
+            const boost::uuids::uuid *excludeConnection);
+
         //-----------------------------------------------------------------------------------------------
         bool handleConfig(const NetNodeConfig &config);
 
@@ -315,6 +344,30 @@ namespace CryptoNote
 
         ConnectionContainer m_connections;
 
+        /* How many connections we have to each peer id we've handshaked
+           with, and to each address we've connected out to, so checking
+           for an existing connection doesn't walk every connection */
+        std::unordered_map<uint64_t, size_t> m_connectedPeerIds;
+
+        std::unordered_map<NetworkAddress, size_t, NetworkAddressHasher> m_outgoingAddresses;
+
+        struct CommandMetrics
+        {
+            Metrics::Counter *messages;
+
+            Metrics::Counter *bytes;
+        };
+
+        /* Keyed by command and whether it was sent, so the metrics registry
+           is only asked for each once */
+        std::map<std::pair<int, bool>, CommandMetrics> m_commandMetrics;
+
+        void countMessage(int command, bool outgoing, size_t bytes);
+
+        void indexConnection(const P2pConnectionContext &ctx);
+
+        void unindexConnection(const P2pConnectionContext &ctx);
+
         void acceptLoop();
 
         void connectionHandler(const boost::uuids::uuid &connectionId, P2pConnectionContext &connection);
@@ -327,6 +380,8 @@ namespace CryptoNote
 
         void timeoutLoop();
 
+        void transactionAnnounceLoop();
+
         template<typename T> void safeInterrupt(T &obj);
 
         struct config
@@ -391,6 +446,8 @@ namespace CryptoNote
 
         System::Timer m_timedSyncTimer;
 
+        System::Timer m_transactionAnnounceTimer;
+
         std::string m_bind_ip;
 
         std::string m_port;
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <common/StringTools.h>
+#include <functional>
 #include <string.h>
 #include <tuple>
 
@@ -39,6 +40,14 @@ inline bool operator==(const NetworkAddress &a, const NetworkAddress &b)
     return memcmp(&a, &b, sizeof(a)) == 0;
 }
 
+struct NetworkAddressHasher
+{
+    size_t operator()(const NetworkAddress &na) const
+    {
+        return std::hash<uint64_t>()((static_cast<uint64_t>(na.ip) << 32) | na.port);
+    }
+};
+
 inline std::ostream &operator<<(std::ostream &s, const NetworkAddress &na)
 {
     return s << Common::ipAddressToString(na.ip) << ":" << std::to_string(na.port);
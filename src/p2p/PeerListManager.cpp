@@ -7,23 +7,138 @@
 #include "serialization/SerializationOverloads.h"
 
 #include <algorithm>
+#include <limits>
+#include <stdexcept>
 #include <system/Ipv4Address.h>
 #include <time.h>
 
+namespace
+{
+    /* ip, port, id and last seen */
+    const size_t PACKED_PEER_SIZE = 4 + 2 + 8 + 8;
+
+    void packValue(std::string &blob, uint64_t value, size_t bytes)
+    {
+        for (size_t i = 0; i < bytes; i++)
+        {
+            blob.push_back(static_cast<char>(value >> (i * 8)));
+        }
+    }
+
+    uint64_t unpackValue(const std::string &blob, size_t &offset, size_t bytes)
+    {
+        uint64_t value = 0;
+
+        for (size_t i = 0; i < bytes; i++)
+        {
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(blob[offset++])) << (i * 8);
+        }
+
+        return value;
+    }
+
+    std::string packPeerlist(const Peerlist &peerlist)
+    {
+        std::string blob;
+        blob.reserve(peerlist.count() * PACKED_PEER_SIZE);
+
+        peerlist.forEach([&blob](const PeerlistEntry &peer) {
+            /* Not a port we could ever connect to */
+            if (peer.adr.port > std::numeric_limits<uint16_t>::max())
+            {
+                return true;
+            }
+
+            packValue(blob, peer.adr.ip, 4);
+            packValue(blob, peer.adr.port, 2);
+            packValue(blob, peer.id, 8);
+            packValue(blob, peer.last_seen, 8);
+
+            return true;
+        });
+
+        return blob;
+    }
+
+    void unpackPeerlist(const std::string &blob, Peerlist &peerlist)
+    {
+        if (blob.size() % PACKED_PEER_SIZE != 0)
+        {
+            throw std::runtime_error("Invalid packed peer list size");
+        }
+
+        size_t offset = 0;
+
+        while (offset < blob.size())
+        {
+            PeerlistEntry peer;
+            peer.adr.ip = static_cast<uint32_t>(unpackValue(blob, offset, 4));
+            peer.adr.port = static_cast<uint32_t>(unpackValue(blob, offset, 2));
+            peer.id = unpackValue(blob, offset, 8);
+            peer.last_seen = unpackValue(blob, offset, 8);
+
+            peerlist.insert(peer);
+        }
+
+        peerlist.trim();
+    }
+} // namespace
+
 void PeerlistManager::serialize(CryptoNote::ISerializer &s)
 {
-    const uint8_t currentVersion = 1;
+    /* Version 1 stored each list as a vector of serialized entries. Version 2
+       packs each list into one blob of fixed width entries instead. */
+    const uint8_t currentVersion = 2;
     uint8_t version = currentVersion;
 
     s(version, "version");
 
+    if (version == 1 && s.type() == CryptoNote::ISerializer::INPUT)
+    {
+        std::vector<PeerlistEntry> white;
+        std::vector<PeerlistEntry> gray;
+
+        s(white, "whitelist");
+        s(gray, "graylist");
+
+        for (const auto &peer : white)
+        {
+            m_whitePeerlist.insert(peer);
+        }
+
+        for (const auto &peer : gray)
+        {
+            m_grayPeerlist.insert(peer);
+        }
+
+        trim_white_peerlist();
+        trim_gray_peerlist();
+
+        return;
+    }
+
     if (version != currentVersion)
     {
         return;
     }
 
-    s(m_peers_white, "whitelist");
-    s(m_peers_gray, "graylist");
+    std::string white;
+    std::string gray;
+
+    if (s.type() == CryptoNote::ISerializer::OUTPUT)
+    {
+        white = packPeerlist(m_whitePeerlist);
+        gray = packPeerlist(m_grayPeerlist);
+    }
+
+    s.binary(white, "whitelist");
+    s.binary(gray, "graylist");
+
+    if (s.type() == CryptoNote::ISerializer::INPUT)
+    {
+        unpackPeerlist(white, m_whitePeerlist);
+        unpackPeerlist(gray, m_grayPeerlist);
+    }
 }
 
 void serialize(NetworkAddress &na, CryptoNote::ISerializer &s)
@@ -40,8 +155,8 @@ void serialize(PeerlistEntry &pe, CryptoNote::ISerializer &s)
 }
 
 PeerlistManager::PeerlistManager():
-    m_whitePeerlist(m_peers_white, CryptoNote::P2P_LOCAL_WHITE_PEERLIST_LIMIT),
-    m_grayPeerlist(m_peers_gray, CryptoNote::P2P_LOCAL_GRAY_PEERLIST_LIMIT)
+    m_whitePeerlist(CryptoNote::P2P_LOCAL_WHITE_PEERLIST_LIMIT),
+    m_grayPeerlist(CryptoNote::P2P_LOCAL_GRAY_PEERLIST_LIMIT)
 {
 }
 
@@ -63,6 +178,8 @@ void PeerlistManager::trim_gray_peerlist()
 
 bool PeerlistManager::merge_peerlist(const std::list<PeerlistEntry> &outer_bs)
 {
+    /* Each append is a hash lookup, so this stays cheap even with a full
+       gray list */
     for (const PeerlistEntry &be : outer_bs)
     {
         append_with_peer_gray(be);
@@ -101,39 +218,43 @@ bool PeerlistManager::is_ip_allowed(uint32_t ip) const
     return true;
 }
 
-bool PeerlistManager::get_peerlist_head(std::list<PeerlistEntry> &bs_head, uint32_t depth)
+bool PeerlistManager::get_peerlist_head(std::list<PeerlistEntry> &bs_head, uint32_t depth) const
 {
-    /* Sort the peers by last seen [Newer peers come first] */
-    std::sort(m_peers_white.begin(), m_peers_white.end(), [](const auto &lhs, const auto &rhs) {
-        return lhs.last_seen > rhs.last_seen;
-    });
-
     uint32_t i = 0;
 
-    for (const auto &peer : m_peers_white)
-    {
+    /* Newer peers come first */
+    m_whitePeerlist.forEach([&](const PeerlistEntry &peer) {
         if (!peer.last_seen)
         {
-            continue;
+            return true;
         }
 
         bs_head.push_back(peer);
 
         if (i > depth)
         {
-            break;
+            return false;
         }
 
         i++;
-    }
+
+        return true;
+    });
 
     return true;
 }
 
 bool PeerlistManager::get_peerlist_full(std::list<PeerlistEntry> &pl_gray, std::list<PeerlistEntry> &pl_white) const
 {
-    std::copy(m_peers_gray.begin(), m_peers_gray.end(), std::back_inserter(pl_gray));
-    std::copy(m_peers_white.begin(), m_peers_white.end(), std::back_inserter(pl_white));
+    m_grayPeerlist.forEach([&pl_gray](const PeerlistEntry &peer) {
+        pl_gray.push_back(peer);
+        return true;
+    });
+
+    m_whitePeerlist.forEach([&pl_white](const PeerlistEntry &peer) {
+        pl_white.push_back(peer);
+        return true;
+    });
 
     return true;
 }
@@ -173,33 +294,12 @@ bool PeerlistManager::append_with_peer_white(const PeerlistEntry &newPeer)
             return true;
         }
 
-        /* See if the peer already exists */
-        auto whiteListIterator = std::find_if(m_peers_white.begin(), m_peers_white.end(), [&newPeer](const auto peer) {
-            return peer.adr == newPeer.adr;
-        });
-
-        /* Peer doesn't exist */
-        if (whiteListIterator == m_peers_white.end())
-        {
-            // put new record into white list
-            m_peers_white.push_back(newPeer);
-            trim_white_peerlist();
-        }
-        /* It does, update it */
-        else
-        {
-            // update record in white list
-            *whiteListIterator = newPeer;
-        }
+        /* Put new record into white list, or update the existing one */
+        m_whitePeerlist.insert(newPeer);
+        trim_white_peerlist();
 
         // remove from gray list, if need
-        auto grayListIterator = std::find_if(
-            m_peers_gray.begin(), m_peers_gray.end(), [&newPeer](const auto peer) { return peer.adr == newPeer.adr; });
-
-        if (grayListIterator != m_peers_gray.end())
-        {
-            m_peers_gray.erase(grayListIterator);
-        }
+        m_grayPeerlist.remove(newPeer.adr);
 
         return true;
     }
@@ -221,30 +321,14 @@ bool PeerlistManager::append_with_peer_gray(const PeerlistEntry &newPeer)
         }
 
         // find in white list
-        auto whiteListIterator = std::find_if(m_peers_white.begin(), m_peers_white.end(), [&newPeer](const auto peer) {
-            return peer.adr == newPeer.adr;
-        });
-
-        if (whiteListIterator != m_peers_white.end())
+        if (m_whitePeerlist.find(newPeer.adr) != nullptr)
         {
             return true;
         }
 
-        // update gray list
-        auto grayListIterator = std::find_if(
-            m_peers_gray.begin(), m_peers_gray.end(), [&newPeer](const auto peer) { return peer.adr == newPeer.adr; });
-
-        if (grayListIterator == m_peers_gray.end())
-        {
-            // put new record into white list
-            m_peers_gray.push_back(newPeer);
-            trim_gray_peerlist();
-        }
-        else
-        {
-            // update record in white list
-            *grayListIterator = newPeer;
-        }
+        /* Put new record into gray list, or update the existing one */
+        m_grayPeerlist.insert(newPeer);
+        trim_gray_peerlist();
 
         return true;
     }
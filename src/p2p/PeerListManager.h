@@ -19,19 +19,19 @@ class PeerlistManager
 
     size_t get_white_peers_count() const
     {
-        return m_peers_white.size();
+        return m_whitePeerlist.count();
     }
 
     size_t get_gray_peers_count() const
     {
-        return m_peers_gray.size();
+        return m_grayPeerlist.count();
     }
 
     bool merge_peerlist(const std::list<PeerlistEntry> &outer_bs);
 
     bool get_peerlist_head(
         std::list<PeerlistEntry> &bs_head,
-        uint32_t depth = CryptoNote::P2P_DEFAULT_PEERS_IN_HANDSHAKE);
+        uint32_t depth = CryptoNote::P2P_DEFAULT_PEERS_IN_HANDSHAKE) const;
 
     bool get_peerlist_full(std::list<PeerlistEntry> &pl_gray, std::list<PeerlistEntry> &pl_white) const;
 
@@ -66,10 +66,6 @@ class PeerlistManager
 
     bool m_allow_local_ip;
 
-    std::vector<PeerlistEntry> m_peers_gray;
-
-    std::vector<PeerlistEntry> m_peers_white;
-
     Peerlist m_whitePeerlist;
 
     Peerlist m_grayPeerlist;
@@ -2,44 +2,143 @@
 //
 // Please see the included LICENSE file for more information.
 
-#include <algorithm>
+#include <crypto/random.h>
+#include <iterator>
 #include <p2p/Peerlist.h>
 
-Peerlist::Peerlist(std::vector<PeerlistEntry> &peers, size_t maxSize): m_peers(peers), m_maxSize(maxSize) {}
+Peerlist::Peerlist(size_t maxSize): m_maxSize(maxSize) {}
 
 size_t Peerlist::count() const
 {
-    return m_peers.size();
+    return m_byAddress.size();
 }
 
 bool Peerlist::get(PeerlistEntry &entry, size_t i) const
 {
-    if (i >= m_peers.size())
+    if (i >= m_byTime.size())
     {
         return false;
     }
 
-    /* Sort the peers by last seen [Newer peers come first] */
-    std::sort(
-        m_peers.begin(), m_peers.end(), [](const auto &lhs, const auto &rhs) { return lhs.last_seen > rhs.last_seen; });
+    entry = m_byAddress.at(std::next(m_byTime.begin(), i)->address).entry;
 
-    entry = m_peers[i];
+    return true;
+}
+
+bool Peerlist::getRandom(PeerlistEntry &entry) const
+{
+    if (m_bucketKeys.empty())
+    {
+        return false;
+    }
+
+    const uint32_t key = m_bucketKeys[Random::randomValue<size_t>() % m_bucketKeys.size()];
+
+    const auto &peers = m_buckets.at(key).peers;
+
+    const PeerlistEntry &first = m_byAddress.at(peers[Random::randomValue<size_t>() % peers.size()]).entry;
+    const PeerlistEntry &second = m_byAddress.at(peers[Random::randomValue<size_t>() % peers.size()]).entry;
+
+    entry = first.last_seen >= second.last_seen ? first : second;
 
     return true;
 }
 
-/* Remove the oldest peers */
-void Peerlist::trim()
+const PeerlistEntry *Peerlist::find(const NetworkAddress &address) const
 {
-    if (m_peers.size() <= m_maxSize)
+    const auto it = m_byAddress.find(address);
+
+    if (it == m_byAddress.end())
     {
+        return nullptr;
+    }
+
+    return &it->second.entry;
+}
+
+void Peerlist::insert(const PeerlistEntry &entry)
+{
+    const auto it = m_byAddress.find(entry.adr);
+
+    /* Already have it, just update it and its place in the time order */
+    if (it != m_byAddress.end())
+    {
+        m_byTime.erase(TimeKey {it->second.entry.last_seen, entry.adr});
+        m_byTime.insert(TimeKey {entry.last_seen, entry.adr});
+
+        it->second.entry = entry;
+
         return;
     }
 
-    /* Sort the peers by last seen [Newer peers come first] */
-    std::sort(
-        m_peers.begin(), m_peers.end(), [](const auto &lhs, const auto &rhs) { return lhs.last_seen > rhs.last_seen; });
+    const uint32_t key = subnet(entry.adr);
+
+    const auto [bucket, inserted] = m_buckets.try_emplace(key);
+
+    if (inserted)
+    {
+        bucket->second.keyIndex = m_bucketKeys.size();
+        m_bucketKeys.push_back(key);
+    }
+
+    m_byAddress.emplace(entry.adr, Record {entry, bucket->second.peers.size()});
+    bucket->second.peers.push_back(entry.adr);
+    m_byTime.insert(TimeKey {entry.last_seen, entry.adr});
+}
 
-    /* Trim to max size */
-    m_peers.erase(m_peers.begin() + m_maxSize, m_peers.end());
+bool Peerlist::remove(const NetworkAddress &address)
+{
+    const auto it = m_byAddress.find(address);
+
+    if (it == m_byAddress.end())
+    {
+        return false;
+    }
+
+    m_byTime.erase(TimeKey {it->second.entry.last_seen, address});
+
+    const uint32_t key = subnet(address);
+
+    const auto bucket = m_buckets.find(key);
+
+    auto &peers = bucket->second.peers;
+
+    /* Move the last peer in the bucket into the removed one's slot */
+    const size_t index = it->second.bucketIndex;
+    peers[index] = peers.back();
+    m_byAddress.at(peers[index]).bucketIndex = index;
+    peers.pop_back();
+
+    if (peers.empty())
+    {
+        /* Same again for the bucket's key */
+        const size_t keyIndex = bucket->second.keyIndex;
+        m_bucketKeys[keyIndex] = m_bucketKeys.back();
+        m_buckets.at(m_bucketKeys[keyIndex]).keyIndex = keyIndex;
+        m_bucketKeys.pop_back();
+
+        m_buckets.erase(bucket);
+    }
+
+    m_byAddress.erase(it);
+
+    return true;
+}
+
+/* Remove the oldest peers */
+void Peerlist::trim()
+{
+    while (m_byAddress.size() > m_maxSize)
+    {
+        /* Copy it, as removing it frees the key it lives in */
+        const NetworkAddress oldest = std::prev(m_byTime.end())->address;
+
+        remove(oldest);
+    }
+}
+
+uint32_t Peerlist::subnet(const NetworkAddress &address)
+{
+    /* Addresses are stored in network byte order */
+    return networkToHost(address.ip) >> 16;
 }
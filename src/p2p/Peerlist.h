@@ -5,12 +5,16 @@
 #pragma once
 
 #include <p2p/P2pProtocolTypes.h>
+#include <set>
+#include <unordered_map>
 #include <vector>
 
+/* A peer list, indexed by address, ordered by when the peers were last
+   seen, and grouped by /16 subnet for random selection. */
 class Peerlist
 {
   public:
-    Peerlist(std::vector<PeerlistEntry> &peers, size_t maxSize);
+    explicit Peerlist(size_t maxSize);
 
     /* Gets the size of the peer list */
     size_t count() const;
@@ -18,11 +22,81 @@ class Peerlist
     /* Gets a peer list entry, indexed by time */
     bool get(PeerlistEntry &entry, size_t index) const;
 
+    /* Gets a random peer. A subnet is picked first, so a subnet holding
+       lots of our peers is no more likely to be picked than any other, then
+       the more recently seen of two peers from it. */
+    bool getRandom(PeerlistEntry &entry) const;
+
+    /* Gets the peer with the given address, or nullptr */
+    const PeerlistEntry *find(const NetworkAddress &address) const;
+
+    /* Adds a peer, or replaces the one with the same address */
+    void insert(const PeerlistEntry &entry);
+
+    /* Removes the peer with the given address, returns false if there
+       wasn't one */
+    bool remove(const NetworkAddress &address);
+
+    /* Calls f with each peer, newest first, until f returns false */
+    template<typename F> void forEach(F &&f) const
+    {
+        for (const auto &key : m_byTime)
+        {
+            if (!f(m_byAddress.at(key.address).entry))
+            {
+                break;
+            }
+        }
+    }
+
     /* Trim the peer list, removing the oldest ones */
     void trim();
 
   private:
-    std::vector<PeerlistEntry> &m_peers;
+    struct Record
+    {
+        PeerlistEntry entry;
+
+        /* Position of this peer in its subnet's bucket */
+        size_t bucketIndex;
+    };
+
+    struct Bucket
+    {
+        std::vector<NetworkAddress> peers;
+
+        /* Position of this bucket in m_bucketKeys */
+        size_t keyIndex;
+    };
+
+    struct TimeKey
+    {
+        uint64_t lastSeen;
+
+        NetworkAddress address;
+
+        /* Newer peers come first */
+        bool operator<(const TimeKey &other) const
+        {
+            if (lastSeen != other.lastSeen)
+            {
+                return lastSeen > other.lastSeen;
+            }
+
+            return address < other.address;
+        }
+    };
+
+    static uint32_t subnet(const NetworkAddress &address);
+
+    std::unordered_map<NetworkAddress, Record, NetworkAddressHasher> m_byAddress;
+
+    std::set<TimeKey> m_byTime;
+
+    std::unordered_map<uint32_t, Bucket> m_buckets;
+
+    /* Lets us pick a random bucket in constant time */
+    std::vector<uint32_t> m_bucketKeys;
 
     const size_t m_maxSize;
 };
@@ -0,0 +1,33 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "cryptonoteprotocol/CryptoNoteProtocolDefinitions.h"
+
+#include <unordered_set>
+#include <vector>
+
+namespace CryptoNote
+{
+    /* A compact block we're waiting on transactions for */
+    struct PendingCompactBlock
+    {
+        NOTIFY_NEW_COMPACT_BLOCK_request request;
+
+        /* Every transaction in the block, with missingIndexes left empty */
+        std::vector<Crypto::Hash> transactionHashes;
+        std::vector<BinaryArray> transactions;
+
+        std::vector<uint32_t> missingIndexes;
+
+        /* Transactions which weren't in our pool, so are sent in full when
+           we relay the block */
+        std::unordered_set<Crypto::Hash> unpooledTransactions;
+
+        /* The ids matched pool transactions, but the result wasn't the
+           announced block, so every transaction has been requested */
+        bool requestedAll;
+    };
+} // namespace CryptoNote
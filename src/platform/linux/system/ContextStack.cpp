@@ -0,0 +1,102 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "ContextStack.h"
+
+#include "ErrorMessage.h"
+
+#include <atomic>
+#include <cassert>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace System
+{
+    namespace
+    {
+        /* Each guard page splits its stack into a mapping of its own, which
+           counts towards vm.max_map_count (65530 by default). Past this many
+           guarded stacks, new stacks come from the heap without a guard, so
+           a burst of contexts can't exhaust the mappings. */
+        const size_t MAX_GUARDED_STACKS = 16384;
+
+        std::atomic<size_t> guardedStacks(0);
+
+        size_t pageSize()
+        {
+            static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+            return size;
+        }
+    } // namespace
+
+    ContextStack::ContextStack(const size_t size): m_size(roundToPageSize(size)), m_guarded(false)
+    {
+        m_mappingSize = m_size + pageSize();
+
+        if (guardedStacks++ < MAX_GUARDED_STACKS)
+        {
+            void *mapping =
+                mmap(nullptr, m_mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+
+            if (mapping == MAP_FAILED)
+            {
+                guardedStacks--;
+                throw std::runtime_error("ContextStack::ContextStack, mmap failed, " + lastErrorMessage());
+            }
+
+            m_mapping = static_cast<uint8_t *>(mapping);
+
+            /* Stacks grow down, so the guard page goes at the bottom */
+            if (mprotect(m_mapping, pageSize(), PROT_NONE) == -1)
+            {
+                const std::string message = lastErrorMessage();
+                munmap(m_mapping, m_mappingSize);
+                guardedStacks--;
+                throw std::runtime_error("ContextStack::ContextStack, mprotect failed, " + message);
+            }
+
+            m_guarded = true;
+        }
+        else
+        {
+            guardedStacks--;
+            m_mapping = new uint8_t[m_mappingSize];
+        }
+    }
+
+    ContextStack::~ContextStack()
+    {
+        if (m_guarded)
+        {
+            auto result = munmap(m_mapping, m_mappingSize);
+            if (result)
+            {
+            }
+            assert(result == 0);
+            guardedStacks--;
+        }
+        else
+        {
+            delete[] m_mapping;
+        }
+    }
+
+    void *ContextStack::base() const
+    {
+        return m_mapping + pageSize();
+    }
+
+    size_t ContextStack::size() const
+    {
+        return m_size;
+    }
+
+    size_t ContextStack::roundToPageSize(const size_t size)
+    {
+        return ((size + pageSize() - 1) / pageSize()) * pageSize();
+    }
+
+} // namespace System
@@ -0,0 +1,47 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace System
+{
+    /* A context's stack, mapped with mmap() and with an inaccessible guard
+       page below it, so overflowing the stack faults instead of silently
+       overwriting whatever memory comes next. Pages are only committed when
+       first touched, so a context costs little more than what it uses.
+       Once a very large number of stacks are alive, further ones are heap
+       allocated without a guard page - see ContextStack.cpp. */
+    class ContextStack
+    {
+      public:
+        /* size is rounded up to a whole number of pages */
+        explicit ContextStack(size_t size);
+
+        ~ContextStack();
+
+        ContextStack(const ContextStack &) = delete;
+
+        ContextStack &operator=(const ContextStack &) = delete;
+
+        /* Lowest usable address, just above the guard page */
+        void *base() const;
+
+        size_t size() const;
+
+        static size_t roundToPageSize(size_t size);
+
+      private:
+        uint8_t *m_mapping;
+
+        size_t m_mappingSize;
+
+        size_t m_size;
+
+        bool m_guarded;
+    };
+
+} // namespace System
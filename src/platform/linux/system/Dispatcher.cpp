@@ -5,7 +5,9 @@
 
 #include "Dispatcher.h"
 
+#include "ContextStack.h"
 #include "ErrorMessage.h"
+#include "MachineContext.h"
 
 #include <cassert>
 #include <fcntl.h>
@@ -13,8 +15,8 @@
 #include <string.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
+#include <memory>
 #include <sys/timerfd.h>
-#include <ucontext.h>
 #include <unistd.h>
 
 namespace System
@@ -24,7 +26,8 @@ namespace System
         struct ContextMakingData
         {
             Dispatcher *dispatcher;
-            void *ucontext;
+            MachineContext *machineContext;
+            ContextStack *stack;
         };
 
         class MutextGuard
@@ -50,6 +53,7 @@ namespace System
 
         static_assert(Dispatcher::SIZEOF_PTHREAD_MUTEX_T == sizeof(pthread_mutex_t), "invalid pthread mutex size");
 
+        /* Default stack size, used when a spawn site doesn't ask for one */
         const size_t STACK_SIZE = 64 * 1024;
 
     }; // namespace
@@ -64,59 +68,56 @@ namespace System
         }
         else
         {
-            mainContext.ucontext = new ucontext_t;
-            if (getcontext(reinterpret_cast<ucontext_t *>(mainContext.ucontext)) == -1)
+            mainContext.machineContext = new MachineContext;
+            mainContext.stack = nullptr;
+
+            remoteSpawnEvent = eventfd(0, O_NONBLOCK);
+            if (remoteSpawnEvent == -1)
             {
-                message = "getcontext failed, " + lastErrorMessage();
+                message = "eventfd failed, " + lastErrorMessage();
             }
             else
             {
-                remoteSpawnEvent = eventfd(0, O_NONBLOCK);
-                if (remoteSpawnEvent == -1)
+                remoteSpawnEventContext.writeContext = nullptr;
+                remoteSpawnEventContext.readContext = nullptr;
+
+                epoll_event remoteSpawnEventEpollEvent;
+                remoteSpawnEventEpollEvent.events = EPOLLIN;
+                remoteSpawnEventEpollEvent.data.ptr = &remoteSpawnEventContext;
+
+                if (epoll_ctl(epoll, EPOLL_CTL_ADD, remoteSpawnEvent, &remoteSpawnEventEpollEvent) == -1)
                 {
-                    message = "eventfd failed, " + lastErrorMessage();
+                    message = "epoll_ctl failed, " + lastErrorMessage();
                 }
                 else
                 {
-                    remoteSpawnEventContext.writeContext = nullptr;
-                    remoteSpawnEventContext.readContext = nullptr;
-
-                    epoll_event remoteSpawnEventEpollEvent;
-                    remoteSpawnEventEpollEvent.events = EPOLLIN;
-                    remoteSpawnEventEpollEvent.data.ptr = &remoteSpawnEventContext;
-
-                    if (epoll_ctl(epoll, EPOLL_CTL_ADD, remoteSpawnEvent, &remoteSpawnEventEpollEvent) == -1)
-                    {
-                        message = "epoll_ctl failed, " + lastErrorMessage();
-                    }
-                    else
-                    {
-                        *reinterpret_cast<pthread_mutex_t *>(this->mutex) = pthread_mutex_t(PTHREAD_MUTEX_INITIALIZER);
-
-                        mainContext.interrupted = false;
-                        mainContext.group = &contextGroup;
-                        mainContext.groupPrev = nullptr;
-                        mainContext.groupNext = nullptr;
-                        mainContext.inExecutionQueue = false;
-                        contextGroup.firstContext = nullptr;
-                        contextGroup.lastContext = nullptr;
-                        contextGroup.firstWaiter = nullptr;
-                        contextGroup.lastWaiter = nullptr;
-                        currentContext = &mainContext;
-                        firstResumingContext = nullptr;
-                        firstReusableContext = nullptr;
-                        runningContextCount = 0;
-                        return;
-                    }
+                    *reinterpret_cast<pthread_mutex_t *>(this->mutex) = pthread_mutex_t(PTHREAD_MUTEX_INITIALIZER);
+
+                    mainContext.interrupted = false;
+                    mainContext.group = &contextGroup;
+                    mainContext.groupPrev = nullptr;
+                    mainContext.groupNext = nullptr;
+                    mainContext.inExecutionQueue = false;
+                    contextGroup.firstContext = nullptr;
+                    contextGroup.lastContext = nullptr;
+                    contextGroup.firstWaiter = nullptr;
+                    contextGroup.lastWaiter = nullptr;
+                    currentContext = &mainContext;
+                    firstResumingContext = nullptr;
+                    createdContext = nullptr;
+                    runningContextCount = 0;
+                    return;
+                }
 
-                    auto result = close(remoteSpawnEvent);
-                    if (result)
-                    {
-                    }
-                    assert(result == 0);
+                auto result = close(remoteSpawnEvent);
+                if (result)
+                {
                 }
+                assert(result == 0);
             }
 
+            delete mainContext.machineContext;
+
             auto result = close(epoll);
             if (result)
             {
@@ -139,14 +140,8 @@ namespace System
         assert(contextGroup.firstWaiter == nullptr);
         assert(firstResumingContext == nullptr);
         assert(runningContextCount == 0);
-        while (firstReusableContext != nullptr)
-        {
-            auto ucontext = static_cast<ucontext_t *>(firstReusableContext->ucontext);
-            auto stackPtr = static_cast<uint8_t *>(firstReusableContext->stackPtr);
-            firstReusableContext = firstReusableContext->next;
-            delete[] stackPtr;
-            delete ucontext;
-        }
+        destroyReusableContexts();
+        delete mainContext.machineContext;
 
         while (!timers.empty())
         {
@@ -171,14 +166,7 @@ namespace System
 
     void Dispatcher::clear()
     {
-        while (firstReusableContext != nullptr)
-        {
-            auto ucontext = static_cast<ucontext_t *>(firstReusableContext->ucontext);
-            auto stackPtr = static_cast<uint8_t *>(firstReusableContext->stackPtr);
-            firstReusableContext = firstReusableContext->next;
-            delete[] stackPtr;
-            delete ucontext;
-        }
+        destroyReusableContexts();
 
         while (!timers.empty())
         {
@@ -261,12 +249,9 @@ namespace System
 
         if (context != currentContext)
         {
-            ucontext_t *oldContext = static_cast<ucontext_t *>(currentContext->ucontext);
+            NativeContext *oldContext = currentContext;
             currentContext = context;
-            if (swapcontext(oldContext, static_cast<ucontext_t *>(context->ucontext)) == -1)
-            {
-                throw std::runtime_error("Dispatcher::dispatch, swapcontext failed, " + lastErrorMessage());
-            }
+            switchMachineContext(*oldContext->machineContext, *context->machineContext);
         }
     }
 
@@ -459,37 +444,34 @@ namespace System
         return epoll;
     }
 
-    NativeContext &Dispatcher::getReusableContext()
+    NativeContext &Dispatcher::getReusableContext(const size_t stackSize)
     {
+        const size_t size = ContextStack::roundToPageSize(stackSize == 0 ? STACK_SIZE : stackSize);
+
+        NativeContext *&firstReusableContext = reusableContexts[size];
+
         if (firstReusableContext == nullptr)
         {
-            ucontext_t *newlyCreatedContext = new ucontext_t;
-            if (getcontext(newlyCreatedContext) == -1)
-            { // makecontext precondition
-                throw std::runtime_error("Dispatcher::getReusableContext, getcontext failed, " + lastErrorMessage());
-            }
+            auto stack = std::make_unique<ContextStack>(size);
+            auto machineContext = std::make_unique<MachineContext>();
 
-            auto stackPointer = new uint8_t[STACK_SIZE];
-            newlyCreatedContext->uc_stack.ss_sp = stackPointer;
-            newlyCreatedContext->uc_stack.ss_size = STACK_SIZE;
+            ContextMakingData makingContextData {this, machineContext.get(), stack.get()};
+            makeMachineContext(
+                *machineContext, stack->base(), stack->size(), contextProcedureStatic, &makingContextData);
 
-            ContextMakingData makingContextData {this, newlyCreatedContext};
-            makecontext(
-                newlyCreatedContext,
-                (void (*)())contextProcedureStatic,
-                1,
-                reinterpret_cast<int *>(&makingContextData));
+            /* The new context sets up its NativeContext on its own stack, then
+               switches straight back to us */
+            switchMachineContext(*currentContext->machineContext, *machineContext);
 
-            ucontext_t *oldContext = static_cast<ucontext_t *>(currentContext->ucontext);
-            if (swapcontext(oldContext, newlyCreatedContext) == -1)
-            {
-                throw std::runtime_error("Dispatcher::getReusableContext, swapcontext failed, " + lastErrorMessage());
-            }
+            assert(createdContext != nullptr);
+            assert(createdContext->machineContext == machineContext.get());
 
-            assert(firstReusableContext != nullptr);
-            assert(firstReusableContext->ucontext == newlyCreatedContext);
-            firstReusableContext->stackPtr = stackPointer;
-        };
+            NativeContext *context = createdContext;
+            createdContext = nullptr;
+            stack.release();
+            machineContext.release();
+            return *context;
+        }
 
         NativeContext *context = firstReusableContext;
         firstReusableContext = firstReusableContext->next;
@@ -498,11 +480,31 @@ namespace System
 
     void Dispatcher::pushReusableContext(NativeContext &context)
     {
+        NativeContext *&firstReusableContext = reusableContexts[context.stack->size()];
         context.next = firstReusableContext;
         firstReusableContext = &context;
         --runningContextCount;
     }
 
+    void Dispatcher::destroyReusableContexts()
+    {
+        for (auto &[size, firstReusableContext] : reusableContexts)
+        {
+            while (firstReusableContext != nullptr)
+            {
+                auto machineContext = firstReusableContext->machineContext;
+                auto stack = firstReusableContext->stack;
+                firstReusableContext = firstReusableContext->next;
+
+                /* The NativeContext itself lives on that stack, so goes with it */
+                delete stack;
+                delete machineContext;
+            }
+        }
+
+        reusableContexts.clear();
+    }
+
     int Dispatcher::getTimer()
     {
         int timer;
@@ -532,20 +534,18 @@ namespace System
         timers.push(timer);
     }
 
-    void Dispatcher::contextProcedure(void *ucontext)
+    void Dispatcher::contextProcedure(void *makingData)
     {
-        assert(firstReusableContext == nullptr);
+        assert(createdContext == nullptr);
+        ContextMakingData *makingContextData = static_cast<ContextMakingData *>(makingData);
         NativeContext context;
-        context.ucontext = ucontext;
+        context.machineContext = makingContextData->machineContext;
+        context.stack = makingContextData->stack;
         context.interrupted = false;
         context.next = nullptr;
         context.inExecutionQueue = false;
-        firstReusableContext = &context;
-        ucontext_t *oldContext = static_cast<ucontext_t *>(context.ucontext);
-        if (swapcontext(oldContext, static_cast<ucontext_t *>(currentContext->ucontext)) == -1)
-        {
-            throw std::runtime_error("Dispatcher::contextProcedure, swapcontext failed, " + lastErrorMessage());
-        }
+        createdContext = &context;
+        switchMachineContext(*context.machineContext, *currentContext->machineContext);
 
         for (;;)
         {
@@ -614,8 +614,8 @@ namespace System
 
     void Dispatcher::contextProcedureStatic(void *context)
     {
-        ContextMakingData *makingContextData = reinterpret_cast<ContextMakingData *>(context);
-        makingContextData->dispatcher->contextProcedure(makingContextData->ucontext);
+        ContextMakingData *makingContextData = static_cast<ContextMakingData *>(context);
+        makingContextData->dispatcher->contextProcedure(makingContextData);
     }
 
 } // namespace System
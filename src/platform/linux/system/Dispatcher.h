@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <queue>
 #include <stack>
 
@@ -21,10 +22,14 @@ namespace System
 {
     struct NativeContextGroup;
 
+    struct MachineContext;
+
+    class ContextStack;
+
     struct NativeContext
     {
-        void *ucontext;
-        void *stackPtr;
+        MachineContext *machineContext;
+        ContextStack *stack;
         bool interrupted;
         bool inExecutionQueue;
         NativeContext *next;
@@ -88,7 +93,10 @@ namespace System
         // system-dependent
         int getEpoll() const;
 
-        NativeContext &getReusableContext();
+        /* Stack sizes are rounded up to whole pages, and 0 means the
+           default. Contexts are reused for later spawns asking for the
+           same size. */
+        NativeContext &getReusableContext(size_t stackSize = 0);
 
         void pushReusableContext(NativeContext &);
 
@@ -135,11 +143,17 @@ namespace System
 
         NativeContext *lastResumingContext;
 
-        NativeContext *firstReusableContext;
+        /* Free lists of finished contexts, by stack size */
+        std::map<size_t, NativeContext *> reusableContexts;
+
+        /* Set by a new context once it has started, for getReusableContext() */
+        NativeContext *createdContext;
 
         size_t runningContextCount;
 
-        void contextProcedure(void *ucontext);
+        void destroyReusableContexts();
+
+        void contextProcedure(void *makingData);
 
         static void contextProcedureStatic(void *context);
     };
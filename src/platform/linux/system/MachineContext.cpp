@@ -0,0 +1,195 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "MachineContext.h"
+
+#include "ErrorMessage.h"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__aarch64__)
+
+extern "C"
+{
+    void system_switch_context(void **from, void *to);
+
+    void system_context_trampoline();
+}
+
+#if defined(__x86_64__)
+
+/* Pushes rbp, rbx and r12-r15 along with the x87 control word and MXCSR
+   onto the current stack, stores the stack pointer in *from, then pops the
+   same from the stack at to and returns to whatever is on top of it.
+
+   A fresh context returns into the trampoline, which calls the entry
+   function held in r12 with the argument held in r13. */
+asm(R"(
+    .text
+    .p2align 4
+    .type system_switch_context, @function
+system_switch_context:
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    leaq -8(%rsp), %rsp
+    fnstcw (%rsp)
+    stmxcsr 4(%rsp)
+    movq %rsp, (%rdi)
+    movq %rsi, %rsp
+    fldcw (%rsp)
+    ldmxcsr 4(%rsp)
+    leaq 8(%rsp), %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .size system_switch_context, .-system_switch_context
+
+    .p2align 4
+    .type system_context_trampoline, @function
+system_context_trampoline:
+    movq %r13, %rdi
+    callq *%r12
+    ud2
+    .size system_context_trampoline, .-system_context_trampoline
+)");
+
+#else
+
+/* As above, with x19-x30 and d8-d15. The trampoline calls the entry
+   function held in x19 with the argument held in x20. */
+asm(R"(
+    .text
+    .p2align 4
+    .type system_switch_context, %function
+system_switch_context:
+    sub sp, sp, #160
+    stp x19, x20, [sp, #0]
+    stp x21, x22, [sp, #16]
+    stp x23, x24, [sp, #32]
+    stp x25, x26, [sp, #48]
+    stp x27, x28, [sp, #64]
+    stp x29, x30, [sp, #80]
+    stp d8, d9, [sp, #96]
+    stp d10, d11, [sp, #112]
+    stp d12, d13, [sp, #128]
+    stp d14, d15, [sp, #144]
+    mov x9, sp
+    str x9, [x0]
+    mov sp, x1
+    ldp x19, x20, [sp, #0]
+    ldp x21, x22, [sp, #16]
+    ldp x23, x24, [sp, #32]
+    ldp x25, x26, [sp, #48]
+    ldp x27, x28, [sp, #64]
+    ldp x29, x30, [sp, #80]
+    ldp d8, d9, [sp, #96]
+    ldp d10, d11, [sp, #112]
+    ldp d12, d13, [sp, #128]
+    ldp d14, d15, [sp, #144]
+    add sp, sp, #160
+    ret
+    .size system_switch_context, .-system_switch_context
+
+    .p2align 4
+    .type system_context_trampoline, %function
+system_context_trampoline:
+    mov x0, x20
+    blr x19
+    brk #0
+    .size system_context_trampoline, .-system_context_trampoline
+)");
+
+#endif
+
+namespace System
+{
+    void makeMachineContext(
+        MachineContext &context,
+        void *stack,
+        size_t stackSize,
+        void (*entry)(void *),
+        void *argument)
+    {
+        const uintptr_t top = (reinterpret_cast<uintptr_t>(stack) + stackSize) & ~static_cast<uintptr_t>(15);
+
+#if defined(__x86_64__)
+        /* The frame system_switch_context() pops: control words, r15, r14,
+           r13, r12, rbx, rbp and the return address. It sits so that the
+           stack is 16 byte aligned once the return address is popped, as
+           the trampoline's call then needs. */
+        uint64_t *frame = reinterpret_cast<uint64_t *>(top - 80);
+
+        std::memset(frame, 0, 80);
+
+        /* Default x87 control word and MXCSR */
+        frame[0] = (static_cast<uint64_t>(0x1F80) << 32) | 0x037F;
+        frame[3] = reinterpret_cast<uint64_t>(argument);
+        frame[4] = reinterpret_cast<uint64_t>(entry);
+        frame[7] = reinterpret_cast<uint64_t>(&system_context_trampoline);
+#else
+        /* x19-x30 then d8-d15, with x30 (the link register) pointing at the
+           trampoline */
+        uint64_t *frame = reinterpret_cast<uint64_t *>(top - 160);
+
+        std::memset(frame, 0, 160);
+
+        frame[0] = reinterpret_cast<uint64_t>(entry);
+        frame[1] = reinterpret_cast<uint64_t>(argument);
+        frame[11] = reinterpret_cast<uint64_t>(&system_context_trampoline);
+#endif
+
+        context.stackPointer = frame;
+    }
+
+    void switchMachineContext(MachineContext &from, MachineContext &to)
+    {
+        system_switch_context(&from.stackPointer, to.stackPointer);
+    }
+
+} // namespace System
+
+#else
+
+namespace System
+{
+    void makeMachineContext(
+        MachineContext &context,
+        void *stack,
+        size_t stackSize,
+        void (*entry)(void *),
+        void *argument)
+    {
+        if (getcontext(&context.context) == -1)
+        { // makecontext precondition
+            throw std::runtime_error("makeMachineContext, getcontext failed, " + lastErrorMessage());
+        }
+
+        context.context.uc_stack.ss_sp = stack;
+        context.context.uc_stack.ss_size = stackSize;
+        context.context.uc_link = nullptr;
+
+        makecontext(&context.context, (void (*)())entry, 1, reinterpret_cast<int *>(argument));
+    }
+
+    void switchMachineContext(MachineContext &from, MachineContext &to)
+    {
+        if (swapcontext(&from.context, &to.context) == -1)
+        {
+            throw std::runtime_error("switchMachineContext, swapcontext failed, " + lastErrorMessage());
+        }
+    }
+
+} // namespace System
+
+#endif
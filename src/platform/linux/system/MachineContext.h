@@ -0,0 +1,42 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <cstddef>
+
+#if !defined(__x86_64__) && !defined(__aarch64__)
+#include <ucontext.h>
+#endif
+
+namespace System
+{
+    /* The saved state of a suspended context.
+
+       On x86_64 and aarch64 a switch only saves and restores the registers
+       the ABI requires a callee to preserve, by hand. Unlike swapcontext(),
+       it doesn't save and restore the signal mask, so switching doesn't
+       cost a syscall. Other architectures fall back to ucontext. */
+    struct MachineContext
+    {
+#if defined(__x86_64__) || defined(__aarch64__)
+        void *stackPointer = nullptr;
+#else
+        ucontext_t context;
+#endif
+    };
+
+    /* Prepares context so that switching to it runs entry(argument) on the
+       given stack. entry must never return. */
+    void makeMachineContext(
+        MachineContext &context,
+        void *stack,
+        size_t stackSize,
+        void (*entry)(void *),
+        void *argument);
+
+    /* Saves the running context into from, and resumes to */
+    void switchMachineContext(MachineContext &from, MachineContext &to);
+
+} // namespace System
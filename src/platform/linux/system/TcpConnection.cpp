@@ -12,6 +12,7 @@
 #include <sys/epoll.h>
 #include <system/ErrorMessage.h>
 #include <system/InterruptedException.h>
+#include <sys/uio.h>
 #include <system/Ipv4Address.h>
 #include <unistd.h>
 
@@ -192,6 +193,15 @@ namespace System
     }
 
     std::size_t TcpConnection::write(const uint8_t *data, size_t size)
+    {
+        return write(data, size, nullptr, 0);
+    }
+
+    std::size_t TcpConnection::write(
+        const uint8_t *header,
+        size_t headerSize,
+        const uint8_t *body,
+        size_t bodySize)
     {
         assert(dispatcher != nullptr);
         assert(contextPair.writeContext == nullptr);
@@ -200,6 +210,16 @@ namespace System
             throw InterruptedException();
         }
 
+        const size_t size = headerSize + bodySize;
+
+        /* Hand both buffers to the kernel in one call, rather than copying
+           them into one contiguous buffer first */
+        iovec buffers[2] = {{const_cast<uint8_t *>(header), headerSize}, {const_cast<uint8_t *>(body), bodySize}};
+
+        msghdr messageHeader = {};
+        messageHeader.msg_iov = buffers;
+        messageHeader.msg_iovlen = bodySize == 0 ? 1 : 2;
+
         std::string message;
         if (size == 0)
         {
@@ -211,7 +231,7 @@ namespace System
             return 0;
         }
 
-        ssize_t transferred = ::send(connection, (void *)data, size, MSG_NOSIGNAL);
+        ssize_t transferred = ::sendmsg(connection, &messageHeader, MSG_NOSIGNAL);
         if (transferred == -1)
         {
             bool knownError = false;
@@ -302,7 +322,7 @@ namespace System
                         throw std::runtime_error("TcpConnection::write, events & (EPOLLERR | EPOLLHUP) != 0");
                     }
 
-                    ssize_t transferred = ::send(connection, (void *)data, size, 0);
+                    ssize_t transferred = ::sendmsg(connection, &messageHeader, 0);
                     if (transferred == -1)
                     {
                         message = "send failed, " + lastErrorMessage();
@@ -34,6 +34,11 @@ namespace System
 
         std::size_t write(const uint8_t *data, std::size_t size);
 
+        /* Writes from header then body as if they were one contiguous buffer,
+           without copying them together. Returns the number of bytes written,
+           which may be less than headerSize + bodySize. */
+        std::size_t write(const uint8_t *header, std::size_t headerSize, const uint8_t *body, std::size_t bodySize);
+
         std::pair<Ipv4Address, uint16_t> getPeerAddressAndPort() const;
 
       private:
@@ -423,7 +423,7 @@ namespace System
         return kqueue;
     }
 
-    NativeContext &Dispatcher::getReusableContext()
+    NativeContext &Dispatcher::getReusableContext(size_t)
     {
         if (firstReusableContext == nullptr)
         {
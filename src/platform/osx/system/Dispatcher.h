@@ -74,7 +74,9 @@ namespace System
 
         int getKqueue() const;
 
-        NativeContext &getReusableContext();
+        /* stackSize is only honoured on Linux, contexts here always get
+           the default stack */
+        NativeContext &getReusableContext(size_t stackSize = 0);
 
         void pushReusableContext(NativeContext &);
 
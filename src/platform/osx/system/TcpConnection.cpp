@@ -14,6 +14,7 @@
 #include <sys/socket.h>
 #include <system/ErrorMessage.h>
 #include <system/InterruptedException.h>
+#include <sys/uio.h>
 #include <system/Ipv4Address.h>
 #include <unistd.h>
 
@@ -158,6 +159,15 @@ namespace System
     }
 
     size_t TcpConnection::write(const uint8_t *data, size_t size)
+    {
+        return write(data, size, nullptr, 0);
+    }
+
+    size_t TcpConnection::write(
+        const uint8_t *header,
+        size_t headerSize,
+        const uint8_t *body,
+        size_t bodySize)
     {
         assert(dispatcher != nullptr);
         assert(writeContext == nullptr);
@@ -166,6 +176,16 @@ namespace System
             throw InterruptedException();
         }
 
+        const size_t size = headerSize + bodySize;
+
+        /* Hand both buffers to the kernel in one call, rather than copying
+           them into one contiguous buffer first */
+        iovec buffers[2] = {{const_cast<uint8_t *>(header), headerSize}, {const_cast<uint8_t *>(body), bodySize}};
+
+        msghdr messageHeader = {};
+        messageHeader.msg_iov = buffers;
+        messageHeader.msg_iovlen = bodySize == 0 ? 1 : 2;
+
         std::string message;
         if (size == 0)
         {
@@ -177,7 +197,7 @@ namespace System
             return 0;
         }
 
-        ssize_t transferred = ::send(connection, (void *)data, size, 0);
+        ssize_t transferred = ::sendmsg(connection, &messageHeader, 0);
         if (transferred == -1)
         {
             if (errno != EAGAIN && errno != EWOULDBLOCK)
@@ -229,7 +249,7 @@ namespace System
                         throw InterruptedException();
                     }
 
-                    ssize_t transferred = ::send(connection, (void *)data, size, 0);
+                    ssize_t transferred = ::sendmsg(connection, &messageHeader, 0);
                     if (transferred == -1)
                     {
                         message = "send failed, " + lastErrorMessage();
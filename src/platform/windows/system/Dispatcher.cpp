@@ -416,7 +416,7 @@ namespace System
         return completionPort;
     }
 
-    NativeContext &Dispatcher::getReusableContext()
+    NativeContext &Dispatcher::getReusableContext(size_t)
     {
         if (firstReusableContext == nullptr)
         {
@@ -171,6 +171,11 @@ namespace System
     }
 
     size_t TcpConnection::write(const uint8_t *data, size_t size)
+    {
+        return write(data, size, nullptr, 0);
+    }
+
+    size_t TcpConnection::write(const uint8_t *header, size_t headerSize, const uint8_t *body, size_t bodySize)
     {
         assert(dispatcher != nullptr);
         assert(writeContext == nullptr);
@@ -179,6 +184,8 @@ namespace System
             throw InterruptedException();
         }
 
+        const size_t size = headerSize + bodySize;
+
         if (size == 0)
         {
             if (shutdown(connection, SD_SEND) != 0)
@@ -189,10 +196,13 @@ namespace System
             return 0;
         }
 
-        WSABUF buf {static_cast<ULONG>(size), reinterpret_cast<char *>(const_cast<uint8_t *>(data))};
+        /* Hand both buffers to WSASend in one call, rather than copying them
+           into one contiguous buffer first */
+        WSABUF buffers[2] = {{static_cast<ULONG>(headerSize), reinterpret_cast<char *>(const_cast<uint8_t *>(header))},
+                             {static_cast<ULONG>(bodySize), reinterpret_cast<char *>(const_cast<uint8_t *>(body))}};
         TcpConnectionContext context;
         context.hEvent = NULL;
-        if (WSASend(connection, &buf, 1, NULL, 0, &context, NULL) != 0)
+        if (WSASend(connection, buffers, bodySize == 0 ? 1 : 2, NULL, 0, &context, NULL) != 0)
         {
             int lastError = WSAGetLastError();
             if (lastError != WSA_IO_PENDING)
@@ -33,6 +33,11 @@ namespace System
 
         size_t write(const uint8_t *data, size_t size);
 
+        /* Writes from header then body as if they were one contiguous buffer,
+           without copying them together. Returns the number of bytes written,
+           which may be less than headerSize + bodySize. */
+        size_t write(const uint8_t *header, size_t headerSize, const uint8_t *body, size_t bodySize);
+
         std::pair<Ipv4Address, uint16_t> getPeerAddressAndPort() const;
 
       private:
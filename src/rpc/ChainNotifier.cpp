@@ -0,0 +1,102 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include <rpc/ChainNotifier.h>
+
+#include <system/InterruptedException.h>
+
+ChainNotifier::ChainNotifier(System::Dispatcher &dispatcher, const std::shared_ptr<CryptoNote::Core> core):
+    m_dispatcher(dispatcher),
+    m_core(core),
+    m_messageQueue(dispatcher),
+    m_contextGroup(dispatcher)
+{
+    m_core->addMessageQueue(m_messageQueue);
+
+    m_contextGroup.spawn([this]() { consumeMessages(); });
+}
+
+ChainNotifier::~ChainNotifier()
+{
+    stop();
+
+    m_core->removeMessageQueue(m_messageQueue);
+
+    m_contextGroup.interrupt();
+    m_contextGroup.wait();
+
+    /* Run any pushes the core made before we were removed, they still
+       reference the queue */
+    m_dispatcher.yield();
+}
+
+ChainNotifier::Position ChainNotifier::position() const
+{
+    std::scoped_lock lock(m_mutex);
+    return m_position;
+}
+
+bool ChainNotifier::waitFor(const Position &since, const int events, const std::chrono::milliseconds timeout) const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    return m_changed.wait_for(lock, timeout, [&]() {
+        const bool newBlock = (events & NEW_BLOCK) && m_position.blocks != since.blocks;
+        const bool poolChanged = (events & POOL_CHANGED) && m_position.poolChanges != since.poolChanges;
+
+        return m_stopped || newBlock || poolChanged;
+    }) && !m_stopped;
+}
+
+void ChainNotifier::stop()
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        m_stopped = true;
+    }
+
+    m_changed.notify_all();
+}
+
+void ChainNotifier::consumeMessages()
+{
+    try
+    {
+        while (true)
+        {
+            const auto type = m_messageQueue.front().getType();
+            m_messageQueue.pop();
+
+            {
+                std::scoped_lock lock(m_mutex);
+
+                switch (type)
+                {
+                    case CryptoNote::BlockchainMessage::Type::NewBlock:
+                    case CryptoNote::BlockchainMessage::Type::ChainSwitch:
+                    {
+                        m_position.blocks++;
+                        break;
+                    }
+                    case CryptoNote::BlockchainMessage::Type::AddTransaction:
+                    case CryptoNote::BlockchainMessage::Type::DeleteTransaction:
+                    {
+                        m_position.poolChanges++;
+                        break;
+                    }
+                    /* Doesn't change the top of the chain */
+                    case CryptoNote::BlockchainMessage::Type::NewAlternativeBlock:
+                    {
+                        continue;
+                    }
+                }
+            }
+
+            m_changed.notify_all();
+        }
+    }
+    catch (const System::InterruptedException &)
+    {
+    }
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cryptonotecore/BlockchainMessages.h>
+#include <cryptonotecore/Core.h>
+#include <cryptonotecore/MessageQueue.h>
+#include <mutex>
+#include <system/ContextGroup.h>
+#include <system/Dispatcher.h>
+
+/* Lets RPC handlers block until the core sees a new block or the pool
+   changes, so clients can long poll us instead of asking over and over
+   whether anything has happened.
+
+   Fed from the core's blockchain message queue, which is drained on the
+   dispatcher thread. Waiting is done with a plain condition variable, so
+   it can be done from the RPC server threads. Construct and destroy on the
+   dispatcher thread. */
+class ChainNotifier
+{
+  public:
+    enum Events
+    {
+        NEW_BLOCK = 1,
+        POOL_CHANGED = 2
+    };
+
+    /* How many of each event we've seen. Take one before looking at the
+       core, then wait on it, so an event in between isn't missed. */
+    struct Position
+    {
+        uint64_t blocks;
+
+        uint64_t poolChanges;
+    };
+
+    ChainNotifier(System::Dispatcher &dispatcher, const std::shared_ptr<CryptoNote::Core> core);
+
+    ~ChainNotifier();
+
+    ChainNotifier(const ChainNotifier &) = delete;
+
+    ChainNotifier &operator=(const ChainNotifier &) = delete;
+
+    Position position() const;
+
+    /* Blocks until one of events has happened since position. Returns false
+       if we timed out or are shutting down. */
+    bool waitFor(const Position &since, const int events, const std::chrono::milliseconds timeout) const;
+
+    /* Wakes everyone waiting and makes any further waits return straight
+       away. Safe to call from any thread. */
+    void stop();
+
+  private:
+    void consumeMessages();
+
+    System::Dispatcher &m_dispatcher;
+
+    const std::shared_ptr<CryptoNote::Core> m_core;
+
+    CryptoNote::MessageQueue<CryptoNote::BlockchainMessage> m_messageQueue;
+
+    System::ContextGroup m_contextGroup;
+
+    Position m_position {0, 0};
+
+    bool m_stopped = false;
+
+    mutable std::mutex m_mutex;
+
+    mutable std::condition_variable m_changed;
+};
@@ -154,10 +154,15 @@ namespace CryptoNote
 
             std::vector<Crypto::Hash> knownTxsIds;
 
+            /* If nothing has changed, how many seconds the daemon may hold
+               the request until something does. Zero to answer at once. */
+            uint64_t timeout;
+
             void serialize(ISerializer &s)
             {
                 KV_MEMBER(tailBlockId)
                 KV_MEMBER(knownTxsIds);
+                KV_MEMBER(timeout)
             }
         };
 
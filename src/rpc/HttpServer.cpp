@@ -6,13 +6,30 @@
 #include "HttpServer.h"
 
 #include <boost/scope_exit.hpp>
-#include <http/HttpParser.h>
+#include <http/HttpRequestParser.h>
 #include <system/InterruptedException.h>
 #include <system/Ipv4Address.h>
-#include <system/TcpStream.h>
+#include <vector>
 
 using namespace Logging;
 
+namespace
+{
+    /* Bytes read off the socket at a time */
+    const size_t READ_BUFFER_SIZE = 64 * 1024;
+
+    void writeAll(System::TcpConnection &connection, const std::string &data)
+    {
+        size_t written = 0;
+
+        while (written < data.size())
+        {
+            written += connection.write(
+                reinterpret_cast<const uint8_t *>(data.data()) + written, data.size() - written);
+        }
+    }
+} // namespace
+
 namespace CryptoNote
 {
     HttpServer::HttpServer(System::Dispatcher &dispatcher, std::shared_ptr<Logging::ILogger> log):
@@ -70,25 +87,48 @@ namespace CryptoNote
 
             logger(DEBUGGING) << "Incoming connection from " << addr.first.toDottedDecimal() << ":" << addr.second;
 
-            System::TcpStreambuf streambuf(connection);
-            std::iostream stream(&streambuf);
-            HttpParser parser;
+            HttpRequestParser parser;
 
-            for (;;)
-            {
-                HttpRequest req;
-                HttpResponse resp;
+            std::vector<char> readBuffer(READ_BUFFER_SIZE);
+
+            std::string output;
 
-                parser.receiveRequest(stream, req);
-                processRequest(req, resp);
+            bool keepAlive = true;
 
-                stream << resp;
-                stream.flush();
+            while (keepAlive)
+            {
+                const size_t bytesRead =
+                    connection.read(reinterpret_cast<uint8_t *>(readBuffer.data()), readBuffer.size());
 
-                if (stream.peek() == std::iostream::traits_type::eof())
+                if (bytesRead == 0)
                 {
                     break;
                 }
+
+                parser.feed(readBuffer.data(), bytesRead);
+
+                HttpRequest req;
+
+                /* A pipelining client can send several requests before
+                   reading any responses, answer them all in one write */
+                while (keepAlive && parser.next(req))
+                {
+                    HttpResponse resp;
+
+                    processRequest(req, resp);
+
+                    keepAlive = parser.keepAlive();
+
+                    if (!keepAlive)
+                    {
+                        resp.addHeader("Connection", "close");
+                    }
+
+                    resp.appendTo(output);
+                }
+
+                writeAll(connection, output);
+                output.clear();
             }
 
             logger(DEBUGGING) << "Closing connection from " << addr.first.toDottedDecimal() << ":" << addr.second
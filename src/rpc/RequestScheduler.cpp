@@ -0,0 +1,217 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include <rpc/RequestScheduler.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+RequestScheduler::RequestScheduler(const uint32_t workers, const uint32_t maxQueued):
+    /* Need at least one worker for each side of the reservation */
+    m_workers(std::max<uint32_t>(workers, 2)),
+    m_reservedWorkers(std::max<uint32_t>(m_workers / 4, 1)),
+    m_maxQueued(maxQueued)
+{
+    auto &registry = Metrics::Registry::instance();
+
+    for (size_t i = 0; i < CLASS_COUNT; i++)
+    {
+        const auto requestClass = static_cast<Class>(i);
+        const auto labels = Metrics::label("class", className(requestClass));
+
+        auto &state = m_classes[i];
+
+        switch (requestClass)
+        {
+            case MINING:
+            case TX_SUBMIT:
+            {
+                state.maxActive = m_workers;
+                break;
+            }
+            case WALLET_SYNC:
+            {
+                state.maxActive = std::max<uint32_t>(m_workers / 2, 1);
+                break;
+            }
+            case EXPLORER:
+            {
+                state.maxActive = std::max<uint32_t>(m_workers / 4, 1);
+                break;
+            }
+        }
+
+        state.queueDepth = &registry.gauge(
+            "wrkzd_rpc_queue_depth", "RPC requests waiting for a worker, by class", labels);
+
+        state.activeRequests = &registry.gauge(
+            "wrkzd_rpc_active_requests", "RPC requests being handled, by class", labels);
+
+        state.rejected = &registry.counter(
+            "wrkzd_rpc_rejected_total", "RPC requests turned away because their queue was full, by class", labels);
+
+        state.queueWait = &registry.histogram(
+            "wrkzd_rpc_queue_wait_seconds", "Time RPC requests spent waiting for a worker, by class", labels);
+    }
+}
+
+bool RequestScheduler::acquire(const Class requestClass)
+{
+    auto &state = m_classes[requestClass];
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    Waiter waiter;
+
+    state.queue.push_back(&waiter);
+
+    dispatch();
+
+    if (!waiter.admitted && state.queue.size() > m_maxQueued)
+    {
+        /* We're still at the back, nothing has been dispatched since */
+        state.queue.pop_back();
+        state.rejected->increment();
+        updateGauges(state);
+
+        return false;
+    }
+
+    m_admitted.wait(lock, [&]() { return waiter.admitted || m_stopped; });
+
+    if (!waiter.admitted)
+    {
+        state.queue.erase(std::find(state.queue.begin(), state.queue.end(), &waiter));
+        updateGauges(state);
+
+        return false;
+    }
+
+    state.queueWait->observeSince(start);
+
+    return true;
+}
+
+void RequestScheduler::release(const Class requestClass)
+{
+    std::scoped_lock lock(m_mutex);
+
+    m_classes[requestClass].active--;
+    m_active--;
+
+    /* Updates the gauges too */
+    dispatch();
+}
+
+void RequestScheduler::reacquire(const Class requestClass)
+{
+    auto &state = m_classes[requestClass];
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    Waiter waiter;
+
+    state.queue.push_front(&waiter);
+
+    dispatch();
+
+    m_admitted.wait(lock, [&]() { return waiter.admitted || m_stopped; });
+
+    if (!waiter.admitted)
+    {
+        state.queue.erase(std::find(state.queue.begin(), state.queue.end(), &waiter));
+
+        state.active++;
+        m_active++;
+
+        updateGauges(state);
+    }
+}
+
+void RequestScheduler::stop()
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        m_stopped = true;
+    }
+
+    m_admitted.notify_all();
+}
+
+std::string RequestScheduler::className(const Class requestClass)
+{
+    switch (requestClass)
+    {
+        case MINING:
+        {
+            return "mining";
+        }
+        case TX_SUBMIT:
+        {
+            return "tx_submit";
+        }
+        case WALLET_SYNC:
+        {
+            return "wallet_sync";
+        }
+        case EXPLORER:
+        {
+            return "explorer";
+        }
+    }
+
+    throw std::invalid_argument("Unknown request class");
+}
+
+bool RequestScheduler::canRun(const Class requestClass) const
+{
+    const auto &state = m_classes[requestClass];
+
+    if (m_stopped || state.active >= state.maxActive)
+    {
+        return false;
+    }
+
+    const bool isPriority = requestClass == MINING || requestClass == TX_SUBMIT;
+
+    return m_active < (isPriority ? m_workers : m_workers - m_reservedWorkers);
+}
+
+void RequestScheduler::dispatch()
+{
+    bool admittedAny = false;
+
+    for (size_t i = 0; i < CLASS_COUNT; i++)
+    {
+        auto &state = m_classes[i];
+
+        while (!state.queue.empty() && canRun(static_cast<Class>(i)))
+        {
+            state.queue.front()->admitted = true;
+            state.queue.pop_front();
+
+            state.active++;
+            m_active++;
+
+            admittedAny = true;
+        }
+
+        updateGauges(state);
+    }
+
+    /* We might have admitted ourselves, in which case nobody is waiting on
+       this, but it's harmless */
+    if (admittedAny)
+    {
+        m_admitted.notify_all();
+    }
+}
+
+void RequestScheduler::updateGauges(ClassState &state) const
+{
+    state.queueDepth->set(state.queue.size());
+    state.activeRequests->set(state.active);
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <array>
+#include <common/Metrics.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+/* Decides which RPC requests get to run. The HTTP server gives every
+   connection its own thread, so without this a flood of expensive requests
+   all run at once and starve everything else.
+
+   There are a fixed number of workers. A request takes one before its
+   handler runs and gives it back when done, waiting in its class's queue
+   if none are free. When a worker frees up it goes to the highest priority
+   class that is allowed to run. The low priority classes are each capped
+   to a share of the workers, and may never take the workers reserved for
+   mining and sending transactions, so those stay responsive however busy
+   wallets and explorers keep us. If a class's queue is full, the request is
+   turned away immediately. */
+class RequestScheduler
+{
+  public:
+    /* In order of priority, highest first */
+    enum Class
+    {
+        MINING = 0,
+        TX_SUBMIT = 1,
+        WALLET_SYNC = 2,
+        EXPLORER = 3,
+    };
+
+    static const size_t CLASS_COUNT = 4;
+
+    RequestScheduler(const uint32_t workers, const uint32_t maxQueued);
+
+    RequestScheduler(const RequestScheduler &) = delete;
+
+    RequestScheduler &operator=(const RequestScheduler &) = delete;
+
+    /* Blocks until a worker is ours. Returns false without waiting if the
+       queue for this class is full, or if we're shutting down. Every
+       successful acquire must be paired with a release. */
+    bool acquire(const Class requestClass);
+
+    void release(const Class requestClass);
+
+    /* Takes a worker back for a request which gave its own up with release()
+       while it slept. Goes to the front of the queue and ignores the queue
+       limit, and once we're shutting down takes the worker without waiting,
+       so the request's final release always has a worker to give back. */
+    void reacquire(const Class requestClass);
+
+    /* Turns away everyone still queued, and any further requests */
+    void stop();
+
+    static std::string className(const Class requestClass);
+
+  private:
+    struct Waiter
+    {
+        bool admitted = false;
+    };
+
+    struct ClassState
+    {
+        /* Most workers this class may use at once */
+        uint32_t maxActive;
+
+        uint32_t active = 0;
+
+        std::deque<Waiter *> queue;
+
+        Metrics::Gauge *queueDepth;
+
+        Metrics::Gauge *activeRequests;
+
+        Metrics::Counter *rejected;
+
+        Metrics::Histogram *queueWait;
+    };
+
+    bool canRun(const Class requestClass) const;
+
+    /* Hands out free workers to queued requests, by priority. Call with the
+       lock held. */
+    void dispatch();
+
+    void updateGauges(ClassState &state) const;
+
+    const uint32_t m_workers;
+
+    /* Workers only the priority classes may use */
+    const uint32_t m_reservedWorkers;
+
+    const uint32_t m_maxQueued;
+
+    uint32_t m_active = 0;
+
+    std::array<ClassState, CLASS_COUNT> m_classes;
+
+    bool m_stopped = false;
+
+    std::mutex m_mutex;
+
+    std::condition_variable m_admitted;
+};
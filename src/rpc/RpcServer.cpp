@@ -7,11 +7,14 @@
 //////////////////////////
 
 #include <iostream>
+#include <unordered_set>
 
 #include "version.h"
 
 #include <config/Constants.h>
 #include <common/CryptoNoteTools.h>
+#include <common/Metrics.h>
+#include <common/ScopeExit.h>
 #include <errors/ValidateParameters.h>
 #include <logger/Logger.h>
 #include <serialization/SerializationTools.h>
@@ -19,6 +22,7 @@
 #include <utilities/ColouredMsg.h>
 #include <utilities/FormatTools.h>
 #include <utilities/ParseExtra.h>
+#include <utilities/Utilities.h>
 
 RpcServer::RpcServer(
     const uint16_t bindPort,
@@ -27,18 +31,25 @@ RpcServer::RpcServer(
     const std::string feeAddress,
     const uint64_t feeAmount,
     const RpcMode rpcMode,
+    const bool enableViewKeyScanning,
+    const uint32_t workerThreads,
+    const uint32_t maxQueuedRequests,
     const std::shared_ptr<CryptoNote::Core> core,
     const std::shared_ptr<CryptoNote::NodeServer> p2p,
-    const std::shared_ptr<CryptoNote::ICryptoNoteProtocolHandler> syncManager):
+    const std::shared_ptr<CryptoNote::ICryptoNoteProtocolHandler> syncManager,
+    System::Dispatcher &dispatcher):
     m_port(bindPort),
     m_host(rpcBindIp),
     m_corsHeader(corsHeader),
     m_feeAddress(feeAddress),
     m_feeAmount(feeAmount),
     m_rpcMode(rpcMode),
+    m_enableViewKeyScanning(enableViewKeyScanning),
     m_core(core),
     m_p2p(p2p),
-    m_syncManager(syncManager)
+    m_syncManager(syncManager),
+    m_chainNotifier(std::make_unique<ChainNotifier>(dispatcher, core)),
+    m_scheduler(workerThreads, maxQueuedRequests)
 {
     if (m_feeAddress != "")
     {
@@ -51,15 +62,35 @@ RpcServer::RpcServer(
         }
     }
 
+    if (m_enableViewKeyScanning)
+    {
+        m_scanningThreadPool = std::make_unique<Utilities::ThreadPool<bool>>();
+    }
+
     const bool bodyRequired = true;
     const bool bodyNotRequired = false;
 
     const bool syncRequired = true;
     const bool syncNotRequired = false;
 
+    /* Which queue each route waits in. Pools poll the block count and last
+       block header to spot new blocks, so those count as mining, and wallets
+       need random outputs to send, so those count as sending. */
+    const auto mining = RequestScheduler::MINING;
+    const auto txSubmit = RequestScheduler::TX_SUBMIT;
+    const auto walletSync = RequestScheduler::WALLET_SYNC;
+    const auto explorer = RequestScheduler::EXPLORER;
+
+    /* Long polls spend their time asleep, so don't tie up a worker */
+    const std::optional<RequestScheduler::Class> longPoll;
+
+    /* Status requests are cheap, and wallets and pools use them to tell if
+       we're alive, so don't queue them behind the expensive requests */
+    const std::optional<RequestScheduler::Class> status;
+
     /* Route the request through our middleware function, before forwarding
        to the specified function */
-    const auto router = [this](const auto function, const RpcMode routePermissions, const bool isBodyRequired, const bool syncRequired) {
+    const auto router = [this](const auto function, const RpcMode routePermissions, const bool isBodyRequired, const bool syncRequired, const std::optional<RequestScheduler::Class> requestClass) {
         return [=](const httplib::Request &req, httplib::Response &res) {
             /* Pass the inputted function with the arguments passed through
                to middleware */
@@ -69,12 +100,13 @@ RpcServer::RpcServer(
                 routePermissions,
                 isBodyRequired,
                 syncRequired,
+                requestClass,
                 std::bind(function, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)
             );
         };
     };
 
-    const auto jsonRpc = [this, router, bodyRequired, bodyNotRequired, syncRequired, syncNotRequired](const auto &req, auto &res) {
+    const auto jsonRpc = [this, router, bodyRequired, bodyNotRequired, syncRequired, syncNotRequired, mining, explorer](const auto &req, auto &res) {
         const auto body = getJsonBody(req, res, true);
 
         if (!body)
@@ -92,43 +124,43 @@ RpcServer::RpcServer(
 
         if (method == "getblocktemplate")
         {
-            router(&RpcServer::getBlockTemplate, RpcMode::MiningEnabled, bodyRequired, syncNotRequired)(req, res);
+            router(&RpcServer::getBlockTemplate, RpcMode::MiningEnabled, bodyRequired, syncNotRequired, mining)(req, res);
         }
         else if (method == "submitblock")
         {
-            router(&RpcServer::submitBlock, RpcMode::MiningEnabled, bodyRequired, syncNotRequired)(req, res);
+            router(&RpcServer::submitBlock, RpcMode::MiningEnabled, bodyRequired, syncNotRequired, mining)(req, res);
         }
         else if (method == "getblockcount")
         {
-            router(&RpcServer::getBlockCount, RpcMode::Default, bodyNotRequired, syncNotRequired)(req, res);
+            router(&RpcServer::getBlockCount, RpcMode::Default, bodyNotRequired, syncNotRequired, mining)(req, res);
         }
         else if (method == "getlastblockheader")
         {
-            router(&RpcServer::getLastBlockHeader, RpcMode::Default, bodyNotRequired, syncNotRequired)(req, res);
+            router(&RpcServer::getLastBlockHeader, RpcMode::Default, bodyNotRequired, syncNotRequired, mining)(req, res);
         }
         else if (method == "getblockheaderbyhash")
         {
-            router(&RpcServer::getBlockHeaderByHash, RpcMode::Default, bodyRequired, syncNotRequired)(req, res);
+            router(&RpcServer::getBlockHeaderByHash, RpcMode::Default, bodyRequired, syncNotRequired, explorer)(req, res);
         }
         else if (method == "getblockheaderbyheight")
         {
-            router(&RpcServer::getBlockHeaderByHeight, RpcMode::Default, bodyRequired, syncNotRequired)(req, res);
+            router(&RpcServer::getBlockHeaderByHeight, RpcMode::Default, bodyRequired, syncNotRequired, explorer)(req, res);
         }
         else if (method == "f_blocks_list_json")
         {
-            router(&RpcServer::getBlocksByHeight, RpcMode::BlockExplorerEnabled, bodyRequired, syncNotRequired)(req, res);
+            router(&RpcServer::getBlocksByHeight, RpcMode::BlockExplorerEnabled, bodyRequired, syncNotRequired, explorer)(req, res);
         }
         else if (method == "f_block_json")
         {
-            router(&RpcServer::getBlockDetailsByHash, RpcMode::BlockExplorerEnabled, bodyRequired, syncNotRequired)(req, res);
+            router(&RpcServer::getBlockDetailsByHash, RpcMode::BlockExplorerEnabled, bodyRequired, syncNotRequired, explorer)(req, res);
         }
         else if (method == "f_transaction_json")
         {
-            router(&RpcServer::getTransactionDetailsByHash, RpcMode::BlockExplorerEnabled, bodyRequired, syncNotRequired)(req, res);
+            router(&RpcServer::getTransactionDetailsByHash, RpcMode::BlockExplorerEnabled, bodyRequired, syncNotRequired, explorer)(req, res);
         }
         else if (method == "f_on_transactions_pool_json")
         {
-            router(&RpcServer::getTransactionsInPool, RpcMode::BlockExplorerEnabled, bodyNotRequired, syncNotRequired)(req, res);
+            router(&RpcServer::getTransactionsInPool, RpcMode::BlockExplorerEnabled, bodyNotRequired, syncNotRequired, explorer)(req, res);
         }
         else
         {
@@ -138,22 +170,27 @@ RpcServer::RpcServer(
 
     /* Note: /json_rpc is exposed on both GET and POST */
     m_server.Get("/json_rpc", jsonRpc)
-            .Get("/info", router(&RpcServer::info, RpcMode::Default, bodyNotRequired, syncNotRequired))
-            .Get("/fee", router(&RpcServer::fee, RpcMode::Default, bodyNotRequired, syncNotRequired))
-            .Get("/height", router(&RpcServer::height, RpcMode::Default, bodyNotRequired, syncNotRequired))
-            .Get("/peers", router(&RpcServer::peers, RpcMode::Default, bodyNotRequired, syncNotRequired))
+            .Get("/info", router(&RpcServer::info, RpcMode::Default, bodyNotRequired, syncNotRequired, status))
+            .Get("/fee", router(&RpcServer::fee, RpcMode::Default, bodyNotRequired, syncNotRequired, status))
+            .Get("/height", router(&RpcServer::height, RpcMode::Default, bodyNotRequired, syncNotRequired, status))
+            .Get("/peers", router(&RpcServer::peers, RpcMode::Default, bodyNotRequired, syncNotRequired, status))
+            .Get("/wait_for_block", router(&RpcServer::waitForBlock, RpcMode::Default, bodyNotRequired, syncNotRequired, longPoll))
+
+            /* NOTE: Not passing through middleware */
+            .Get("/metrics", [this](const auto &req, auto &res) { metrics(req, res); })
 
             .Post("/json_rpc", jsonRpc)
-            .Post("/sendrawtransaction", router(&RpcServer::sendTransaction, RpcMode::Default, bodyRequired, syncRequired))
-            .Post("/getrandom_outs", router(&RpcServer::getRandomOuts, RpcMode::Default, bodyRequired, syncNotRequired))
-            .Post("/getwalletsyncdata", router(&RpcServer::getWalletSyncData, RpcMode::Default, bodyRequired, syncNotRequired))
-            .Post("/get_global_indexes_for_range", router(&RpcServer::getGlobalIndexes, RpcMode::Default, bodyRequired, syncNotRequired))
-            .Post("/queryblockslite", router(&RpcServer::queryBlocksLite, RpcMode::Default, bodyRequired, syncNotRequired))
-            .Post("/get_transactions_status", router(&RpcServer::getTransactionsStatus, RpcMode::Default, bodyRequired, syncNotRequired))
-            .Post("/get_pool_changes_lite", router(&RpcServer::getPoolChanges, RpcMode::Default, bodyRequired, syncNotRequired))
-            .Post("/queryblocksdetailed", router(&RpcServer::queryBlocksDetailed, RpcMode::AllMethodsEnabled, bodyRequired, syncNotRequired))
-            .Post("/get_o_indexes", router(&RpcServer::getGlobalIndexesDeprecated, RpcMode::Default, bodyRequired, syncNotRequired))
-            .Post("/getrawblocks", router(&RpcServer::getRawBlocks, RpcMode::Default, bodyRequired, syncNotRequired))
+            .Post("/sendrawtransaction", router(&RpcServer::sendTransaction, RpcMode::Default, bodyRequired, syncRequired, txSubmit))
+            .Post("/getrandom_outs", router(&RpcServer::getRandomOuts, RpcMode::Default, bodyRequired, syncNotRequired, txSubmit))
+            .Post("/getwalletsyncdata", router(&RpcServer::getWalletSyncData, RpcMode::Default, bodyRequired, syncNotRequired, walletSync))
+            .Post("/get_global_indexes_for_range", router(&RpcServer::getGlobalIndexes, RpcMode::Default, bodyRequired, syncNotRequired, walletSync))
+            .Post("/queryblockslite", router(&RpcServer::queryBlocksLite, RpcMode::Default, bodyRequired, syncNotRequired, walletSync))
+            .Post("/get_transactions_status", router(&RpcServer::getTransactionsStatus, RpcMode::Default, bodyRequired, syncNotRequired, walletSync))
+            .Post("/get_pool_changes_lite", router(&RpcServer::getPoolChanges, RpcMode::Default, bodyRequired, syncNotRequired, walletSync))
+            .Post("/queryblocksdetailed", router(&RpcServer::queryBlocksDetailed, RpcMode::AllMethodsEnabled, bodyRequired, syncNotRequired, explorer))
+            .Post("/get_o_indexes", router(&RpcServer::getGlobalIndexesDeprecated, RpcMode::Default, bodyRequired, syncNotRequired, walletSync))
+            .Post("/getrawblocks", router(&RpcServer::getRawBlocks, RpcMode::Default, bodyRequired, syncNotRequired, walletSync))
+            .Post("/scanwalletoutputs", router(&RpcServer::scanWalletOutputs, RpcMode::Default, bodyRequired, syncNotRequired, walletSync))
 
             /* Matches everything */
             /* NOTE: Not passing through middleware */
@@ -184,6 +221,13 @@ void RpcServer::listen()
 
 void RpcServer::stop()
 {
+    /* The server waits for every request to finish, so let the long polls
+       go first */
+    m_chainNotifier->stop();
+
+    /* And anything waiting for a worker */
+    m_scheduler.stop();
+
     m_server.stop();
 
     if (m_serverThread.joinable())
@@ -245,16 +289,24 @@ void RpcServer::middleware(
     const RpcMode routePermissions,
     const bool bodyRequired,
     const bool syncRequired,
+    const std::optional<RequestScheduler::Class> requestClass,
     std::function<std::tuple<Error, uint16_t>(
         const httplib::Request &req,
         httplib::Response &res,
         const rapidjson::Document &body)> handler)
 {
-    Logger::logger.log(
-        "[" + req.get_header_value("REMOTE_ADDR") + "] Incoming " + req.method + " request: " + req.path + ", User-Agent: " + req.get_header_value("User-Agent"),
-        Logger::DEBUG,
-        { Logger::DAEMON_RPC }
-    );
+    /* Only ever called for the paths we've registered, so these are bounded */
+    Metrics::ScopedTimer timer(Metrics::Registry::instance().histogram(
+        "wrkzd_rpc_request_seconds", "Time taken to handle RPC requests, by route", Metrics::label("route", req.path)));
+
+    if (Logger::logger.isEnabled(Logger::DEBUG))
+    {
+        Logger::logger.log(
+            "[" + getRemoteAddress(req) + "] Incoming " + req.method + " request: " + req.path + ", User-Agent: " + req.get_header_value("User-Agent"),
+            Logger::DEBUG,
+            { Logger::DAEMON_RPC }
+        );
+    }
 
     if (m_corsHeader != "")
     {
@@ -263,6 +315,23 @@ void RpcServer::middleware(
 
     res.set_header("Content-Type", "application/json");
 
+    if (requestClass && !m_scheduler.acquire(*requestClass))
+    {
+        res.set_header("Retry-After", "1");
+        failRequest(503, "Too many requests are queued, please retry later", res);
+        return;
+    }
+
+    /* Give the worker back once the handler has produced its data. Streamed
+       responses are written out after we return, and a client slowly
+       reading one shouldn't hold up anyone else. */
+    Tools::ScopeExit worker([this, requestClass]() {
+        if (requestClass)
+        {
+            m_scheduler.release(*requestClass);
+        }
+    });
+
     const auto jsonBody = getJsonBody(req, res, bodyRequired);
 
     if (!jsonBody)
@@ -367,6 +436,328 @@ void RpcServer::middleware(
     }
 }
 
+void RpcServer::streamJsonArray(
+    const httplib::Request &req,
+    httplib::Response &res,
+    const size_t count,
+    std::function<void(rapidjson::Writer<rapidjson::StringBuffer> &writer)> writeStart,
+    std::function<void(rapidjson::Writer<rapidjson::StringBuffer> &writer, const size_t index)> writeItem,
+    std::function<void(rapidjson::Writer<rapidjson::StringBuffer> &writer)> writeEnd) const
+{
+    struct Stream
+    {
+        rapidjson::StringBuffer sb;
+
+        rapidjson::Writer<rapidjson::StringBuffer> writer {sb};
+
+        /* The next item to write. Zero before the start is written. */
+        size_t position = 0;
+
+        bool finished = false;
+    };
+
+    const auto stream = std::make_shared<Stream>();
+
+    /* Writes the next piece, returns false once the end is written */
+    const auto writeNext = [=]() {
+        if (stream->position == 0)
+        {
+            writeStart(stream->writer);
+        }
+        else if (stream->position <= count)
+        {
+            writeItem(stream->writer, stream->position - 1);
+        }
+        else
+        {
+            writeEnd(stream->writer);
+            return false;
+        }
+
+        stream->position++;
+
+        return true;
+    };
+
+    /* Chunked encoding is HTTP/1.1 only */
+    if (req.version != "HTTP/1.1")
+    {
+        while (writeNext())
+        {
+        }
+
+        res.body = stream->sb.GetString();
+
+        return;
+    }
+
+    /* Items can be tiny, so batch them up rather than sending a chunk
+       header and doing a write for every one */
+    const size_t chunkSize = 64 * 1024;
+
+    res.body.clear();
+
+    res.chunked_content_provider = [stream, writeNext, path = req.path](const uint64_t offset, std::string &chunk) {
+        try
+        {
+            while (!stream->finished && stream->sb.GetSize() < chunkSize)
+            {
+                stream->finished = !writeNext();
+            }
+        }
+        catch (const std::exception &e)
+        {
+            Logger::logger.log(
+                "Caught unexpected exception: " + std::string(e.what()) + " while streaming " + path + " response",
+                Logger::FATAL,
+                { Logger::DAEMON_RPC }
+            );
+
+            /* The headers are already out, so the best we can do is drop the
+               connection without ending the body, so the client knows the
+               response is incomplete */
+            return false;
+        }
+
+        chunk.assign(stream->sb.GetString(), stream->sb.GetSize());
+
+        stream->sb.Clear();
+
+        return true;
+    };
+}
+
+void RpcServer::streamWalletSyncData(
+    const httplib::Request &req,
+    httplib::Response &res,
+    std::vector<WalletTypes::WalletBlockInfo> walletBlocks,
+    const std::optional<WalletTypes::TopBlock> topBlockInfo,
+    std::function<void(std::vector<WalletTypes::WalletBlockInfo> &walletBlocks, const size_t index)> prepareBlock) const
+{
+    const auto blocks = std::make_shared<std::vector<WalletTypes::WalletBlockInfo>>(std::move(walletBlocks));
+
+    streamJsonArray(
+        req,
+        res,
+        blocks->size(),
+        [](auto &writer) {
+            writer.StartObject();
+
+            writer.Key("items");
+            writer.StartArray();
+        },
+        [blocks, prepareBlock](auto &writer, const size_t index) {
+            if (prepareBlock)
+            {
+                prepareBlock(*blocks, index);
+            }
+
+            writeWalletBlock(writer, (*blocks)[index]);
+
+            (*blocks)[index] = WalletTypes::WalletBlockInfo();
+        },
+        [blocks, topBlockInfo](auto &writer) {
+            writer.EndArray();
+
+            if (topBlockInfo)
+            {
+                writer.Key("topBlock");
+                writer.StartObject();
+                {
+                    writer.Key("hash");
+                    writer.String(Common::podToHex(topBlockInfo->hash));
+
+                    writer.Key("height");
+                    writer.Uint64(topBlockInfo->height);
+                }
+                writer.EndObject();
+            }
+
+            writer.Key("synced");
+            writer.Bool(blocks->empty());
+
+            writer.Key("status");
+            writer.String("OK");
+
+            writer.EndObject();
+        });
+}
+
+void RpcServer::writeWalletBlock(
+    rapidjson::Writer<rapidjson::StringBuffer> &writer,
+    const WalletTypes::WalletBlockInfo &block)
+{
+    writer.StartObject();
+
+    if (block.coinbaseTransaction)
+    {
+        writer.Key("coinbaseTX");
+        writer.StartObject();
+        {
+            writer.Key("outputs");
+            writer.StartArray();
+            {
+                for (const auto &output : block.coinbaseTransaction->keyOutputs)
+                {
+                    writer.StartObject();
+                    {
+                        writer.Key("key");
+                        writer.String(Common::podToHex(output.key));
+
+                        writer.Key("amount");
+                        writer.Uint64(output.amount);
+
+                        if (output.globalOutputIndex)
+                        {
+                            writer.Key("globalIndex");
+                            writer.Uint64(*output.globalOutputIndex);
+                        }
+                    }
+                    writer.EndObject();
+                }
+            }
+            writer.EndArray();
+
+            writer.Key("hash");
+            writer.String(Common::podToHex(block.coinbaseTransaction->hash));
+
+            writer.Key("txPublicKey");
+            writer.String(Common::podToHex(block.coinbaseTransaction->transactionPublicKey));
+
+            writer.Key("unlockTime");
+            writer.Uint64(block.coinbaseTransaction->unlockTime);
+        }
+        writer.EndObject();
+    }
+
+    writer.Key("transactions");
+    writer.StartArray();
+    {
+        for (const auto &transaction : block.transactions)
+        {
+            writer.StartObject();
+            {
+                writer.Key("outputs");
+                writer.StartArray();
+                {
+                    for (const auto &output : transaction.keyOutputs)
+                    {
+                        writer.StartObject();
+                        {
+                            writer.Key("key");
+                            writer.String(Common::podToHex(output.key));
+
+                            writer.Key("amount");
+                            writer.Uint64(output.amount);
+
+                            if (output.globalOutputIndex)
+                            {
+                                writer.Key("globalIndex");
+                                writer.Uint64(*output.globalOutputIndex);
+                            }
+                        }
+                        writer.EndObject();
+                    }
+                }
+                writer.EndArray();
+
+                writer.Key("hash");
+                writer.String(Common::podToHex(transaction.hash));
+
+                writer.Key("txPublicKey");
+                writer.String(Common::podToHex(transaction.transactionPublicKey));
+
+                writer.Key("unlockTime");
+                writer.Uint64(transaction.unlockTime);
+
+                writer.Key("paymentID");
+                writer.String(transaction.paymentID);
+
+                writer.Key("inputs");
+                writer.StartArray();
+                {
+                    for (const auto &input : transaction.keyInputs)
+                    {
+                        writer.StartObject();
+                        {
+                            writer.Key("amount");
+                            writer.Uint64(input.amount);
+
+                            writer.Key("key_offsets");
+                            writer.StartArray();
+                            {
+                                for (const auto &offset : input.outputIndexes)
+                                {
+                                    writer.Uint64(offset);
+                                }
+                            }
+                            writer.EndArray();
+
+                            writer.Key("k_image");
+                            writer.String(Common::podToHex(input.keyImage));
+                        }
+                        writer.EndObject();
+                    }
+                }
+                writer.EndArray();
+            }
+            writer.EndObject();
+        }
+    }
+    writer.EndArray();
+
+    writer.Key("blockHeight");
+    writer.Uint64(block.blockHeight);
+
+    writer.Key("blockHash");
+    writer.String(Common::podToHex(block.blockHash));
+
+    writer.Key("blockTimestamp");
+    writer.Uint64(block.blockTimestamp);
+
+    writer.EndObject();
+}
+
+std::string RpcServer::getRemoteAddress(const httplib::Request &req)
+{
+    const auto [begin, end] = req.headers.equal_range("REMOTE_ADDR");
+
+    if (begin == end)
+    {
+        return "";
+    }
+
+    return std::prev(end)->second;
+}
+
+void RpcServer::runScanningJobs(const size_t count, const std::function<void(const size_t index)> &job)
+{
+    const size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    const size_t chunkSize = (count + threadCount - 1) / threadCount;
+
+    std::vector<std::future<bool>> results;
+
+    for (size_t start = 0; start < count; start += chunkSize)
+    {
+        const size_t end = std::min(start + chunkSize, count);
+
+        results.push_back(m_scanningThreadPool->addJob([&job, start, end]() {
+            for (size_t i = start; i < end; i++)
+            {
+                job(i);
+            }
+
+            return true;
+        }));
+    }
+
+    for (auto &result : results)
+    {
+        result.get();
+    }
+}
+
 void RpcServer::failRequest(uint16_t statusCode, std::string body, httplib::Response &res)
 {
     rapidjson::StringBuffer sb;
@@ -449,6 +840,36 @@ void RpcServer::handleOptions(const httplib::Request &req, httplib::Response &re
     res.status = 200;
 }
 
+void RpcServer::metrics(const httplib::Request &req, httplib::Response &res)
+{
+    auto &registry = Metrics::Registry::instance();
+
+    /* Values that are kept elsewhere are sampled as we're scraped */
+    registry.gauge("wrkzd_height", "Height of our chain").set(m_core->getTopBlockIndex() + 1);
+
+    registry.gauge("wrkzd_network_height", "Highest height reported by our peers")
+        .set(m_syncManager->getBlockchainHeight());
+
+    registry.gauge("wrkzd_alt_blocks", "Blocks on alternative chains").set(m_core->getAlternativeBlockCount());
+
+    const uint64_t connections = m_p2p->get_connections_count();
+    const uint64_t outgoingConnections = m_p2p->get_outgoing_connections_count();
+
+    registry.gauge("wrkzd_p2p_connections", "Open P2P connections", Metrics::label("direction", "out"))
+        .set(outgoingConnections);
+
+    registry.gauge("wrkzd_p2p_connections", "Open P2P connections", Metrics::label("direction", "in"))
+        .set(connections - outgoingConnections);
+
+    if (m_corsHeader != "")
+    {
+        res.set_header("Access-Control-Allow-Origin", m_corsHeader);
+    }
+
+    res.set_content(registry.render(), "text/plain; version=0.0.4");
+    res.status = 200;
+}
+
 std::tuple<Error, uint16_t> RpcServer::info(
     const httplib::Request &req,
     httplib::Response &res,
@@ -645,6 +1066,70 @@ std::tuple<Error, uint16_t> RpcServer::peers(
     return {SUCCESS, 200};
 }
 
+std::tuple<Error, uint16_t> RpcServer::waitForBlock(
+    const httplib::Request &req,
+    httplib::Response &res,
+    const rapidjson::Document &body)
+{
+    Crypto::Hash knownTopHash;
+
+    if (!req.has_param("after") || !Common::podFromHex(req.get_param_value("after"), knownTopHash))
+    {
+        failRequest(400, "Query parameter 'after' must be the hash of the block you have as the top block", res);
+        return {SUCCESS, 400};
+    }
+
+    uint64_t timeout = CryptoNote::RPC_MAX_LONG_POLL_SECONDS;
+
+    if (req.has_param("timeout"))
+    {
+        try
+        {
+            timeout = std::min<uint64_t>(std::stoull(req.get_param_value("timeout")), timeout);
+        }
+        catch (const std::exception &)
+        {
+            failRequest(400, "Query parameter 'timeout' must be a number of seconds", res);
+            return {SUCCESS, 400};
+        }
+    }
+
+    const auto position = m_chainNotifier->position();
+
+    if (m_core->getTopBlockHash() == knownTopHash)
+    {
+        m_chainNotifier->waitFor(position, ChainNotifier::NEW_BLOCK, std::chrono::seconds(timeout));
+    }
+
+    const Crypto::Hash topHash = m_core->getTopBlockHash();
+
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+
+    writer.StartObject();
+
+    writer.Key("changed");
+    writer.Bool(topHash != knownTopHash);
+
+    writer.Key("hash");
+    writer.String(Common::podToHex(topHash));
+
+    writer.Key("height");
+    writer.Uint64(m_core->getTopBlockIndex() + 1);
+
+    writer.Key("network_height");
+    writer.Uint64(std::max(1u, m_syncManager->getBlockchainHeight()));
+
+    writer.Key("status");
+    writer.String("OK");
+
+    writer.EndObject();
+
+    res.body = sb.GetString();
+
+    return {SUCCESS, 200};
+}
+
 std::tuple<Error, uint16_t> RpcServer::sendTransaction(
     const httplib::Request &req,
     httplib::Response &res,
@@ -815,11 +1300,6 @@ std::tuple<Error, uint16_t> RpcServer::getWalletSyncData(
     httplib::Response &res,
     const rapidjson::Document &body)
 {
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-
-    writer.StartObject();
-
     std::vector<Crypto::Hash> blockHashCheckpoints;
 
     if (hasMember(body, "blockHashCheckpoints"))
@@ -844,8 +1324,8 @@ std::tuple<Error, uint16_t> RpcServer::getWalletSyncData(
         : 0;
 
     const uint64_t blockCount = hasMember(body, "blockCount")
-        ? getUint64FromJSON(body, "blockCount")
-        : 100;
+        ? std::min(getUint64FromJSON(body, "blockCount"), CryptoNote::BLOCKS_SYNCHRONIZING_DEFAULT_COUNT)
+        : CryptoNote::BLOCKS_SYNCHRONIZING_DEFAULT_COUNT;
 
     const bool skipCoinbaseTransactions = hasMember(body, "skipCoinbaseTransactions")
         ? getBoolFromJSON(body, "skipCoinbaseTransactions")
@@ -869,155 +1349,7 @@ std::tuple<Error, uint16_t> RpcServer::getWalletSyncData(
         return {SUCCESS, 500};
     }
 
-    writer.Key("items");
-    writer.StartArray();
-    {
-        for (const auto &block : walletBlocks)
-        {
-            writer.StartObject();
-
-            if (block.coinbaseTransaction)
-            {
-                writer.Key("coinbaseTX");
-                writer.StartObject();
-                {
-                    writer.Key("outputs");
-                    writer.StartArray();
-                    {
-                        for (const auto &output : block.coinbaseTransaction->keyOutputs)
-                        {
-                            writer.StartObject();
-                            {
-                                writer.Key("key");
-                                writer.String(Common::podToHex(output.key));
-
-                                writer.Key("amount");
-                                writer.Uint64(output.amount);
-                            }
-                            writer.EndObject();
-                        }
-                    }
-                    writer.EndArray();
-
-                    writer.Key("hash");
-                    writer.String(Common::podToHex(block.coinbaseTransaction->hash));
-
-                    writer.Key("txPublicKey");
-                    writer.String(Common::podToHex(block.coinbaseTransaction->transactionPublicKey));
-
-                    writer.Key("unlockTime");
-                    writer.Uint64(block.coinbaseTransaction->unlockTime);
-                }
-                writer.EndObject();
-            }
-
-            writer.Key("transactions");
-            writer.StartArray();
-            {
-                for (const auto &transaction : block.transactions)
-                {
-                    writer.StartObject();
-                    {
-                        writer.Key("outputs");
-                        writer.StartArray();
-                        {
-                            for (const auto &output : transaction.keyOutputs)
-                            {
-                                writer.StartObject();
-                                {
-                                    writer.Key("key");
-                                    writer.String(Common::podToHex(output.key));
-
-                                    writer.Key("amount");
-                                    writer.Uint64(output.amount);
-                                }
-                                writer.EndObject();
-                            }
-                        }
-                        writer.EndArray();
-
-                        writer.Key("hash");
-                        writer.String(Common::podToHex(transaction.hash));
-
-                        writer.Key("txPublicKey");
-                        writer.String(Common::podToHex(transaction.transactionPublicKey));
-
-                        writer.Key("unlockTime");
-                        writer.Uint64(transaction.unlockTime);
-
-                        writer.Key("paymentID");
-                        writer.String(transaction.paymentID);
-
-                        writer.Key("inputs");
-                        writer.StartArray();
-                        {
-                            for (const auto &input : transaction.keyInputs)
-                            {
-                                writer.StartObject();
-                                {
-                                    writer.Key("amount");
-                                    writer.Uint64(input.amount);
-
-                                    writer.Key("key_offsets");
-                                    writer.StartArray();
-                                    {
-                                        for (const auto &offset : input.outputIndexes)
-                                        {
-                                            writer.Uint64(offset);
-                                        }
-                                    }
-                                    writer.EndArray();
-
-                                    writer.Key("k_image");
-                                    writer.String(Common::podToHex(input.keyImage));
-                                }
-                                writer.EndObject();
-                            }
-                        }
-                        writer.EndArray();
-                    }
-                    writer.EndObject();
-                }
-            }
-            writer.EndArray();
-
-            writer.Key("blockHeight");
-            writer.Uint64(block.blockHeight);
-
-            writer.Key("blockHash");
-            writer.String(Common::podToHex(block.blockHash));
-
-            writer.Key("blockTimestamp");
-            writer.Uint64(block.blockTimestamp);
-
-            writer.EndObject();
-        }
-    }
-    writer.EndArray();
-
-    if (topBlockInfo)
-    {
-        writer.Key("topBlock");
-        writer.StartObject();
-        {
-            writer.Key("hash");
-            writer.String(Common::podToHex(topBlockInfo->hash));
-
-            writer.Key("height");
-            writer.Uint64(topBlockInfo->height);
-        }
-        writer.EndObject();
-    }
-
-    writer.Key("synced");
-    writer.Bool(walletBlocks.empty());
-
-    writer.Key("status");
-    writer.String("OK");
-
-    writer.EndObject();
-
-    res.body = sb.GetString();
+    streamWalletSyncData(req, res, std::move(walletBlocks), topBlockInfo);
 
     return {SUCCESS, 200};
 }
@@ -2191,68 +2523,72 @@ std::tuple<Error, uint16_t> RpcServer::getTransactionsInPool(
     httplib::Response &res,
     const rapidjson::Document &body)
 {
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    const auto transactions = std::make_shared<std::vector<CryptoNote::Transaction>>(m_core->getPoolTransactions());
 
-    writer.StartObject();
+    streamJsonArray(
+        req,
+        res,
+        transactions->size(),
+        [](auto &writer) {
+            writer.StartObject();
 
-    writer.Key("jsonrpc");
-    writer.String("2.0");
+            writer.Key("jsonrpc");
+            writer.String("2.0");
 
-    writer.Key("result");
-    writer.StartObject();
-    {
-        writer.Key("status");
-        writer.String("OK");
+            writer.Key("result");
+            writer.StartObject();
 
-        writer.Key("transactions");
-        writer.StartArray();
-        {
-            for (const auto &tx : m_core->getPoolTransactions())
-            {
-                writer.StartObject();
+            writer.Key("status");
+            writer.String("OK");
 
-                const uint64_t outputAmount = std::accumulate(tx.outputs.begin(), tx.outputs.end(), 0ull,
-                    [](const auto acc, const auto out) {
-                        return acc + out.amount;
-                    }
-                );
+            writer.Key("transactions");
+            writer.StartArray();
+        },
+        [transactions](auto &writer, const size_t index) {
+            const auto &tx = (*transactions)[index];
 
-                const uint64_t inputAmount = std::accumulate(tx.inputs.begin(), tx.inputs.end(), 0ull,
-                    [](const auto acc, const auto in) {
-                        if (in.type() == typeid(CryptoNote::KeyInput))
-                        {
-                            return acc + boost::get<CryptoNote::KeyInput>(in).amount;
-                        }
+            writer.StartObject();
 
-                        return acc;
-                    }
-                );
+            const uint64_t outputAmount = std::accumulate(tx.outputs.begin(), tx.outputs.end(), 0ull,
+                [](const auto acc, const auto out) {
+                    return acc + out.amount;
+                }
+            );
 
-                const uint64_t fee = inputAmount - outputAmount;
+            const uint64_t inputAmount = std::accumulate(tx.inputs.begin(), tx.inputs.end(), 0ull,
+                [](const auto acc, const auto in) {
+                    if (in.type() == typeid(CryptoNote::KeyInput))
+                    {
+                        return acc + boost::get<CryptoNote::KeyInput>(in).amount;
+                    }
 
-                writer.Key("hash");
-                writer.String(Common::podToHex(getObjectHash(tx)));
+                    return acc;
+                }
+            );
 
-                writer.Key("fee");
-                writer.Uint64(fee);
+            const uint64_t fee = inputAmount - outputAmount;
 
-                writer.Key("amount_out");
-                writer.Uint64(outputAmount);
+            writer.Key("hash");
+            writer.String(Common::podToHex(getObjectHash(tx)));
 
-                writer.Key("size");
-                writer.Uint64(getObjectBinarySize(tx));
+            writer.Key("fee");
+            writer.Uint64(fee);
 
-                writer.EndObject();
-            }
-        }
-        writer.EndArray();
-    }
-    writer.EndObject();
+            writer.Key("amount_out");
+            writer.Uint64(outputAmount);
 
-    writer.EndObject();
+            writer.Key("size");
+            writer.Uint64(getObjectBinarySize(tx));
 
-    res.body = sb.GetString();
+            writer.EndObject();
+        },
+        [](auto &writer) {
+            writer.EndArray();
+
+            writer.EndObject();
+
+            writer.EndObject();
+        });
 
     return {SUCCESS, 200};
 }
@@ -2568,13 +2904,48 @@ std::tuple<Error, uint16_t> RpcServer::getPoolChanges(
         knownHashes.push_back(hash);
     }
 
+    /* Optional, if nothing has changed, hold the request open until
+       something does, or this many seconds pass */
+    const uint64_t timeout = hasMember(body, "timeout")
+        ? std::min(getUint64FromJSON(body, "timeout"), CryptoNote::RPC_MAX_LONG_POLL_SECONDS)
+        : 0;
+
+    const auto position = m_chainNotifier->position();
+
     std::vector<CryptoNote::TransactionPrefixInfo> addedTransactions;
     std::vector<Crypto::Hash> deletedTransactions;
 
-    const bool atTopOfChain = m_core->getPoolChangesLite(
+    bool atTopOfChain = m_core->getPoolChangesLite(
         lastBlockHash, knownHashes, addedTransactions, deletedTransactions
     );
 
+    const bool unchanged = atTopOfChain && addedTransactions.empty() && deletedTransactions.empty();
+
+    if (unchanged && timeout != 0)
+    {
+        /* The diffs go through the scheduler like any wallet request, but
+           don't tie up a worker while we sleep */
+        bool changed;
+
+        {
+            m_scheduler.release(RequestScheduler::WALLET_SYNC);
+
+            /* The middleware gives the worker back when we're done, so we
+               must have one again however we leave */
+            Tools::ScopeExit reacquire([this]() { m_scheduler.reacquire(RequestScheduler::WALLET_SYNC); });
+
+            changed = m_chainNotifier->waitFor(
+                position, ChainNotifier::NEW_BLOCK | ChainNotifier::POOL_CHANGED, std::chrono::seconds(timeout));
+        }
+
+        if (changed)
+        {
+            atTopOfChain = m_core->getPoolChangesLite(
+                lastBlockHash, knownHashes, addedTransactions, deletedTransactions
+            );
+        }
+    }
+
     writer.StartObject();
 
     writer.Key("addedTxs");
@@ -2715,9 +3086,6 @@ std::tuple<Error, uint16_t> RpcServer::queryBlocksDetailed(
     httplib::Response &res,
     const rapidjson::Document &body)
 {
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-
     uint64_t timestamp = 0;
 
     if (hasMember(body, "timestamp"))
@@ -2762,22 +3130,30 @@ std::tuple<Error, uint16_t> RpcServer::queryBlocksDetailed(
         return {SUCCESS, 500};
     }
 
-    writer.StartObject();
+    const auto detailedBlocks = std::make_shared<std::vector<CryptoNote::BlockDetails>>(std::move(blocks));
 
-    writer.Key("fullOffset");
-    writer.Uint64(fullOffset);
+    streamJsonArray(
+        req,
+        res,
+        detailedBlocks->size(),
+        [fullOffset, currentHeight, startHeight](auto &writer) {
+            writer.StartObject();
 
-    writer.Key("currentHeight");
-    writer.Uint64(currentHeight);
+            writer.Key("fullOffset");
+            writer.Uint64(fullOffset);
 
-    writer.Key("startHeight");
-    writer.Uint64(startHeight);
+            writer.Key("currentHeight");
+            writer.Uint64(currentHeight);
+
+            writer.Key("startHeight");
+            writer.Uint64(startHeight);
+
+            writer.Key("blocks");
+            writer.StartArray();
+        },
+        [detailedBlocks](auto &writer, const size_t index) {
+            const auto &block = (*detailedBlocks)[index];
 
-    writer.Key("blocks");
-    writer.StartArray();
-    {
-        for (const auto &block : blocks)
-        {
             writer.StartObject();
             {
                 writer.Key("major_version");
@@ -3045,16 +3421,15 @@ std::tuple<Error, uint16_t> RpcServer::queryBlocksDetailed(
                 writer.EndArray();
             }
             writer.EndObject();
-        }
-    }
-    writer.EndArray();
-
-    writer.Key("status");
-    writer.String("OK");
+        },
+        [](auto &writer) {
+            writer.EndArray();
 
-    writer.EndObject();
+            writer.Key("status");
+            writer.String("OK");
 
-    res.body = sb.GetString();
+            writer.EndObject();
+        });
 
     return {SUCCESS, 200};
 }
@@ -3114,11 +3489,6 @@ std::tuple<Error, uint16_t> RpcServer::getRawBlocks(
     httplib::Response &res,
     const rapidjson::Document &body)
 {
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-
-    writer.StartObject();
-
     std::vector<Crypto::Hash> blockHashCheckpoints;
 
     if (hasMember(body, "blockHashCheckpoints"))
@@ -3143,8 +3513,8 @@ std::tuple<Error, uint16_t> RpcServer::getRawBlocks(
         : 0;
 
     const uint64_t blockCount = hasMember(body, "blockCount")
-        ? getUint64FromJSON(body, "blockCount")
-        : 100;
+        ? std::min(getUint64FromJSON(body, "blockCount"), CryptoNote::BLOCKS_SYNCHRONIZING_DEFAULT_COUNT)
+        : CryptoNote::BLOCKS_SYNCHRONIZING_DEFAULT_COUNT;
 
     const bool skipCoinbaseTransactions = hasMember(body, "skipCoinbaseTransactions")
         ? getBoolFromJSON(body, "skipCoinbaseTransactions")
@@ -3168,11 +3538,21 @@ std::tuple<Error, uint16_t> RpcServer::getRawBlocks(
         return {SUCCESS, 500};
     }
 
-    writer.Key("items");
-    writer.StartArray();
-    {
-        for (const auto &block : blocks)
-        {
+    const auto rawBlocks = std::make_shared<std::vector<CryptoNote::RawBlock>>(std::move(blocks));
+
+    streamJsonArray(
+        req,
+        res,
+        rawBlocks->size(),
+        [](auto &writer) {
+            writer.StartObject();
+
+            writer.Key("items");
+            writer.StartArray();
+        },
+        [rawBlocks](auto &writer, const size_t index) {
+            const auto &block = (*rawBlocks)[index];
+
             writer.StartObject();
 
             writer.Key("block");
@@ -3187,34 +3567,350 @@ std::tuple<Error, uint16_t> RpcServer::getRawBlocks(
             writer.EndArray();
 
             writer.EndObject();
+        },
+        [rawBlocks, topBlockInfo](auto &writer) {
+            writer.EndArray();
+
+            if (topBlockInfo)
+            {
+                writer.Key("topBlock");
+                writer.StartObject();
+                {
+                    writer.Key("hash");
+                    writer.String(Common::podToHex(topBlockInfo->hash));
+
+                    writer.Key("height");
+                    writer.Uint64(topBlockInfo->height);
+                }
+                writer.EndObject();
+            }
+
+            writer.Key("synced");
+            writer.Bool(rawBlocks->empty());
+
+            writer.Key("status");
+            writer.String("OK");
+
+            writer.EndObject();
+        });
+
+    return {SUCCESS, 200};
+}
+
+
+std::tuple<Error, uint16_t> RpcServer::scanWalletOutputs(
+    const httplib::Request &req,
+    httplib::Response &res,
+    const rapidjson::Document &body)
+{
+    if (!m_enableViewKeyScanning)
+    {
+        failRequest(
+            403,
+            "View key scanning is disabled. Please relaunch your daemon with the --enable-view-key-scanning "
+            "command line option to access this method.",
+            res);
+
+        return {SUCCESS, 403};
+    }
+
+    /* The caller is handing us their private view key, and we are telling
+       them which transactions are theirs. Don't offer that to the world. */
+    const std::string remoteAddress = getRemoteAddress(req);
+
+    if (remoteAddress != "127.0.0.1" && remoteAddress != "::1")
+    {
+        failRequest(403, "View key scanning is only available to wallets on the same machine as the daemon.", res);
+        return {SUCCESS, 403};
+    }
+
+    Crypto::SecretKey privateViewKey;
+
+    if (!Common::podFromHex(getStringFromJSON(body, "privateViewKey"), privateViewKey))
+    {
+        failRequest(400, "privateViewKey parameter is not a valid private key", res);
+        return {SUCCESS, 400};
+    }
+
+    std::vector<Crypto::PublicKey> publicSpendKeys;
+
+    for (const auto &jsonKey : getArrayFromJSON(body, "publicSpendKeys"))
+    {
+        Crypto::PublicKey publicSpendKey;
+
+        if (!Common::podFromHex(getStringFromJSONString(jsonKey), publicSpendKey))
+        {
+            failRequest(400, "publicSpendKeys parameter contains an invalid public key", res);
+            return {SUCCESS, 400};
         }
+
+        publicSpendKeys.push_back(publicSpendKey);
     }
-    writer.EndArray();
 
-    if (topBlockInfo)
+    /* Outputs the wallet already owns, by amount then global index. A
+       transaction using one of these in a ring may be spending it. */
+    std::unordered_map<uint64_t, std::unordered_set<uint64_t>> watchedOutputs;
+
+    if (hasMember(body, "unspentInputs"))
     {
-        writer.Key("topBlock");
-        writer.StartObject();
+        for (const auto &input : getArrayFromJSON(body, "unspentInputs"))
         {
-            writer.Key("hash");
-            writer.String(Common::podToHex(topBlockInfo->hash));
+            watchedOutputs[getUint64FromJSON(input, "amount")].insert(getUint64FromJSON(input, "globalIndex"));
+        }
+    }
 
-            writer.Key("height");
-            writer.Uint64(topBlockInfo->height);
+    std::vector<Crypto::Hash> blockHashCheckpoints;
+
+    if (hasMember(body, "blockHashCheckpoints"))
+    {
+        for (const auto &jsonHash : getArrayFromJSON(body, "blockHashCheckpoints"))
+        {
+            std::string hashStr = jsonHash.GetString();
+
+            Crypto::Hash hash;
+            Common::podFromHex(hashStr, hash);
+
+            blockHashCheckpoints.push_back(hash);
         }
-        writer.EndObject();
     }
 
-    writer.Key("synced");
-    writer.Bool(blocks.empty());
+    const uint64_t startHeight = hasMember(body, "startHeight")
+        ? getUint64FromJSON(body, "startHeight")
+        : 0;
 
-    writer.Key("status");
-    writer.String("OK");
+    const uint64_t startTimestamp = hasMember(body, "startTimestamp")
+        ? getUint64FromJSON(body, "startTimestamp")
+        : 0;
 
-    writer.EndObject();
+    const uint64_t blockCount = hasMember(body, "blockCount")
+        ? std::min(getUint64FromJSON(body, "blockCount"), CryptoNote::BLOCKS_SYNCHRONIZING_DEFAULT_COUNT)
+        : CryptoNote::BLOCKS_SYNCHRONIZING_DEFAULT_COUNT;
 
-    res.body = sb.GetString();
+    const bool skipCoinbaseTransactions = hasMember(body, "skipCoinbaseTransactions")
+        ? getBoolFromJSON(body, "skipCoinbaseTransactions")
+        : false;
+
+    std::vector<WalletTypes::WalletBlockInfo> walletBlocks;
+    std::optional<WalletTypes::TopBlock> topBlockInfo;
+
+    const bool success = m_core->getWalletSyncData(
+        blockHashCheckpoints,
+        startHeight,
+        startTimestamp,
+        blockCount,
+        skipCoinbaseTransactions,
+        walletBlocks,
+        topBlockInfo
+    );
+
+    if (!success)
+    {
+        return {SUCCESS, 500};
+    }
+
+    struct Scan
+    {
+        /* Outputs the wallet owns, by amount then global index. A transaction
+           using one of these in a ring may be spending it. */
+        std::unordered_map<uint64_t, std::unordered_set<uint64_t>> watchedOutputs;
+
+        /* Blocks before this have been scanned */
+        size_t scanned = 0;
+
+        /* Whether the worker the request was admitted with is still ours.
+           Once the handler returns it is given back, so each batch scanned
+           while streaming has to take one again. */
+        bool haveWorker = true;
+    };
+
+    const auto scan = std::make_shared<Scan>();
+
+    scan->watchedOutputs = std::move(watchedOutputs);
+
+    /* Scans the blocks a batch at a time as they are sent, so we only hold
+       the filtered blocks of one batch on top of the raw ones */
+    const auto prepareBlock = [this, scan, privateViewKey, publicSpendKeys](
+        std::vector<WalletTypes::WalletBlockInfo> &walletBlocks,
+        const size_t index) {
+        if (index < scan->scanned)
+        {
+            return;
+        }
+
+        const size_t batchSize = 20;
+
+        const size_t first = scan->scanned;
+        const size_t count = std::min(batchSize, walletBlocks.size() - first);
+
+        if (!scan->haveWorker)
+        {
+            m_scheduler.reacquire(RequestScheduler::WALLET_SYNC);
+        }
+
+        Tools::ScopeExit worker([this, scan]() {
+            if (!scan->haveWorker)
+            {
+                m_scheduler.release(RequestScheduler::WALLET_SYNC);
+            }
+        });
+
+        scanWalletBlocks(walletBlocks, first, count, privateViewKey, publicSpendKeys, scan->watchedOutputs);
+
+        scan->scanned += count;
+    };
+
+    streamWalletSyncData(req, res, std::move(walletBlocks), topBlockInfo, prepareBlock);
+
+    /* Our caller gives the worker back when we return */
+    scan->haveWorker = false;
 
     return {SUCCESS, 200};
 }
 
+void RpcServer::scanWalletBlocks(
+    std::vector<WalletTypes::WalletBlockInfo> &walletBlocks,
+    const size_t first,
+    const size_t count,
+    const Crypto::SecretKey &privateViewKey,
+    const std::vector<Crypto::PublicKey> &publicSpendKeys,
+    std::unordered_map<uint64_t, std::unordered_set<uint64_t>> &watchedOutputs)
+{
+    /* Which transactions in each block we are returning. Index zero is the
+       coinbase transaction, the rest follow the block transactions. */
+    std::vector<std::vector<bool>> keepTransaction(count);
+
+    /* The outputs in each block which belong to the wallet */
+    std::vector<std::vector<std::tuple<uint64_t, Crypto::Hash, uint64_t>>> ownedOutputs(count);
+
+    /* First pass - find the outputs sent to the wallet. This is the bulk of
+       the work, so spread it over our cores. */
+    runScanningJobs(count, [&](const size_t i) {
+        const auto &block = walletBlocks[first + i];
+
+        keepTransaction[i].resize(block.transactions.size() + 1, false);
+
+        const auto scanTransaction = [&](const WalletTypes::RawCoinbaseTransaction &tx, const size_t txIndex) {
+            const auto owned = Utilities::findOwnedOutputs(tx, privateViewKey, publicSpendKeys);
+
+            for (const auto &[outputIndex, publicSpendKey] : owned)
+            {
+                ownedOutputs[i].emplace_back(txIndex, tx.hash, outputIndex);
+            }
+
+            keepTransaction[i][txIndex] = !owned.empty();
+        };
+
+        if (block.coinbaseTransaction)
+        {
+            scanTransaction(*block.coinbaseTransaction, 0);
+        }
+
+        for (size_t j = 0; j < block.transactions.size(); j++)
+        {
+            scanTransaction(block.transactions[j], j + 1);
+        }
+    });
+
+    /* Attach the global indexes of the wallets outputs so it doesn't need to
+       fetch them, and watch them for being spent later on */
+    for (size_t i = 0; i < count; i++)
+    {
+        auto &block = walletBlocks[first + i];
+
+        std::unordered_map<Crypto::Hash, std::vector<uint32_t>> globalIndexes;
+
+        for (const auto &[txIndex, txHash, outputIndex] : ownedOutputs[i])
+        {
+            auto &tx = txIndex == 0
+                ? *block.coinbaseTransaction
+                : static_cast<WalletTypes::RawCoinbaseTransaction &>(block.transactions[txIndex - 1]);
+
+            auto it = globalIndexes.find(txHash);
+
+            if (it == globalIndexes.end())
+            {
+                std::vector<uint32_t> indexes;
+
+                if (!m_core->getTransactionGlobalIndexes(txHash, indexes) || indexes.size() != tx.keyOutputs.size())
+                {
+                    /* Wallet will fetch them itself */
+                    continue;
+                }
+
+                it = globalIndexes.emplace(txHash, std::move(indexes)).first;
+            }
+
+            const uint64_t globalIndex = it->second[outputIndex];
+
+            tx.keyOutputs[outputIndex].globalOutputIndex = globalIndex;
+
+            watchedOutputs[tx.keyOutputs[outputIndex].amount].insert(globalIndex);
+        }
+    }
+
+    /* Second pass - find the transactions which may be spending the wallets
+       outputs. We can't tell which ring member is the real one, so the
+       wallet checks the key images itself. */
+    runScanningJobs(count, [&](const size_t i) {
+        const auto &block = walletBlocks[first + i];
+
+        for (size_t j = 0; j < block.transactions.size(); j++)
+        {
+            if (keepTransaction[i][j + 1])
+            {
+                continue;
+            }
+
+            for (const auto &input : block.transactions[j].keyInputs)
+            {
+                const auto outputs = watchedOutputs.find(input.amount);
+
+                if (outputs == watchedOutputs.end())
+                {
+                    continue;
+                }
+
+                /* Offsets are relative to the previous ring member */
+                uint64_t globalIndex = 0;
+
+                const bool usesOurOutput = std::any_of(
+                    input.outputIndexes.begin(),
+                    input.outputIndexes.end(),
+                    [&](const auto offset) {
+                        globalIndex += offset;
+                        return outputs->second.find(globalIndex) != outputs->second.end();
+                    });
+
+                if (usesOurOutput)
+                {
+                    keepTransaction[i][j + 1] = true;
+                    break;
+                }
+            }
+        }
+    });
+
+    /* Drop everything that doesn't concern the wallet. The blocks themselves
+       stay, so the wallet can keep track of the chain. */
+    for (size_t i = 0; i < count; i++)
+    {
+        auto &block = walletBlocks[first + i];
+
+        if (!keepTransaction[i][0])
+        {
+            block.coinbaseTransaction = std::nullopt;
+        }
+
+        std::vector<WalletTypes::RawTransaction> transactions;
+
+        for (size_t j = 0; j < block.transactions.size(); j++)
+        {
+            if (keepTransaction[i][j + 1])
+            {
+                transactions.push_back(std::move(block.transactions[j]));
+            }
+        }
+
+        block.transactions = std::move(transactions);
+    }
+}
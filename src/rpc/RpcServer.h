@@ -4,10 +4,13 @@
 
 #pragma once
 
+#include <functional>
 #include <future>
 #include <memory>
 #include <optional>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "httplib.h"
 #include "JsonHelper.h"
@@ -18,6 +21,9 @@
 #include <cryptonoteprotocol/CryptoNoteProtocolHandlerCommon.h>
 #include <errors/Errors.h>
 #include <p2p/NetNode.h>
+#include <rpc/ChainNotifier.h>
+#include <rpc/RequestScheduler.h>
+#include <utilities/ThreadPool.h>
 
 enum class RpcMode
 {
@@ -41,9 +47,13 @@ class RpcServer
         const std::string feeAddress,
         const uint64_t feeAmount,
         const RpcMode rpcMode,
+        const bool enableViewKeyScanning,
+        const uint32_t workerThreads,
+        const uint32_t maxQueuedRequests,
         const std::shared_ptr<CryptoNote::Core> core,
         const std::shared_ptr<CryptoNote::NodeServer> p2p,
-        const std::shared_ptr<CryptoNote::ICryptoNoteProtocolHandler> syncManager);
+        const std::shared_ptr<CryptoNote::ICryptoNoteProtocolHandler> syncManager,
+        System::Dispatcher &dispatcher);
 
     ~RpcServer();
 
@@ -73,18 +83,70 @@ class RpcServer
         httplib::Response &res,
         const bool bodyRequired);
 
-    /* Handles stuff like parsing json and then forwards onto the handler */
+    /* Handles stuff like parsing json and then forwards onto the handler.
+       Waits for a worker for the request class first, if it has one. */
     void middleware(
         const httplib::Request &req,
         httplib::Response &res,
         const RpcMode routePermissions,
         const bool bodyRequired,
         const bool syncRequired,
+        const std::optional<RequestScheduler::Class> requestClass,
         std::function<std::tuple<Error, uint16_t>(
             const httplib::Request &req,
             httplib::Response &res,
             const rapidjson::Document &body)> handler);
 
+    /* Sends the response a chunk at a time as it is written, rather than
+       building all of it in memory first. Called once the handler is done,
+       so everything the callbacks use must be owned by them. Writes the
+       start of the response, then each of the count items in turn, then
+       the end. If a callback throws once streaming has begun, the connection
+       is dropped rather than the response ended. */
+    void streamJsonArray(
+        const httplib::Request &req,
+        httplib::Response &res,
+        const size_t count,
+        std::function<void(rapidjson::Writer<rapidjson::StringBuffer> &writer)> writeStart,
+        std::function<void(rapidjson::Writer<rapidjson::StringBuffer> &writer, const size_t index)> writeItem,
+        std::function<void(rapidjson::Writer<rapidjson::StringBuffer> &writer)> writeEnd) const;
+
+    /* Streams the blocks in the format returned by /getwalletsyncdata. If
+       given, prepareBlock is called on each block just before it is written.
+       Blocks are freed once written. */
+    void streamWalletSyncData(
+        const httplib::Request &req,
+        httplib::Response &res,
+        std::vector<WalletTypes::WalletBlockInfo> walletBlocks,
+        const std::optional<WalletTypes::TopBlock> topBlockInfo,
+        std::function<void(std::vector<WalletTypes::WalletBlockInfo> &walletBlocks, const size_t index)> prepareBlock =
+            nullptr) const;
+
+    /* Writes a block in the format returned by /getwalletsyncdata */
+    static void writeWalletBlock(
+        rapidjson::Writer<rapidjson::StringBuffer> &writer,
+        const WalletTypes::WalletBlockInfo &block);
+
+    /* Strips the count blocks starting at first down to the transactions
+       sending to, or possibly spending from, the wallet with these keys.
+       watchedOutputs holds the wallets outputs, and has the outputs found
+       added to it. */
+    void scanWalletBlocks(
+        std::vector<WalletTypes::WalletBlockInfo> &walletBlocks,
+        const size_t first,
+        const size_t count,
+        const Crypto::SecretKey &privateViewKey,
+        const std::vector<Crypto::PublicKey> &publicSpendKeys,
+        std::unordered_map<uint64_t, std::unordered_set<uint64_t>> &watchedOutputs);
+
+    /* The address of the peer. The client can send its own REMOTE_ADDR
+       header, but the server adds the real one after the clients. */
+    static std::string getRemoteAddress(const httplib::Request &req);
+
+    /* Runs the function on every index in [0, count), split across the
+       scanning thread pool */
+    void runScanningJobs(const size_t count, const std::function<void(const size_t index)> &job);
+
     void failRequest(uint16_t statusCode, std::string body, httplib::Response &res);
 
     void failJsonRpcRequest(
@@ -98,6 +160,10 @@ class RpcServer
 
     void handleOptions(const httplib::Request &req, httplib::Response &res) const;
 
+    /* Serves the metrics registry in the Prometheus text format. Not JSON, so
+       doesn't go through middleware */
+    void metrics(const httplib::Request &req, httplib::Response &res);
+
     //////////////////
     /* GET REQUESTS */
     //////////////////
@@ -114,6 +180,10 @@ class RpcServer
     std::tuple<Error, uint16_t>
         peers(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
 
+    /* Long poll, returns once the top block is no longer the one given */
+    std::tuple<Error, uint16_t>
+        waitForBlock(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
+
     ///////////////////
     /* POST REQUESTS */
     ///////////////////
@@ -149,6 +219,9 @@ class RpcServer
     std::tuple<Error, uint16_t>
         getRawBlocks(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
 
+    std::tuple<Error, uint16_t>
+        scanWalletOutputs(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
+
     ///////////////////////
     /* JSON RPC REQUESTS */
     ///////////////////////
@@ -215,6 +288,14 @@ class RpcServer
     /* RPC methods that are enabled */
     const RpcMode m_rpcMode;
 
+    /* Whether wallets on this machine may have us scan blocks with their
+       private view key */
+    const bool m_enableViewKeyScanning;
+
+    /* Threads used to scan blocks for wallets. Only created if view key
+       scanning is enabled. */
+    std::unique_ptr<Utilities::ThreadPool<bool>> m_scanningThreadPool;
+
     /* A pointer to our CryptoNoteCore instance */
     const std::shared_ptr<CryptoNote::Core> m_core;
 
@@ -222,4 +303,10 @@ class RpcServer
     const std::shared_ptr<CryptoNote::NodeServer> m_p2p;
 
     const std::shared_ptr<CryptoNote::ICryptoNoteProtocolHandler> m_syncManager;
+
+    /* Wakes long polling requests when a block or pool transaction arrives */
+    std::unique_ptr<ChainNotifier> m_chainNotifier;
+
+    /* Limits how many requests we handle at once, and in what order */
+    RequestScheduler m_scheduler;
 };
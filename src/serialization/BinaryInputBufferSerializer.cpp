@@ -0,0 +1,178 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "BinaryInputBufferSerializer.h"
+
+#include <cassert>
+#include <config/CryptoNoteConfig.h>
+#include <cstring>
+#include <stdexcept>
+
+namespace CryptoNote
+{
+    BinaryInputBufferSerializer::BinaryInputBufferSerializer(const void *data, const size_t size):
+        m_position(static_cast<const uint8_t *>(data)),
+        m_end(static_cast<const uint8_t *>(data) + size)
+    {
+    }
+
+    bool BinaryInputBufferSerializer::endOfBuffer() const
+    {
+        return m_position == m_end;
+    }
+
+    /* Same checks as Common::readVarint(), so both reject the same input */
+    template<typename T> T BinaryInputBufferSerializer::readVarint()
+    {
+        T temp = 0;
+
+        for (uint8_t shift = 0;; shift += 7)
+        {
+            if (m_position == m_end)
+            {
+                throw std::runtime_error("readVarint, unexpected end of buffer");
+            }
+
+            const uint8_t piece = *m_position++;
+
+            if (shift >= sizeof(temp) * 8 - 7 && piece >= 1 << (sizeof(temp) * 8 - shift))
+            {
+                throw std::runtime_error("readVarint, value overflow");
+            }
+
+            temp |= static_cast<uint64_t>(piece & 0x7f) << shift;
+
+            if ((piece & 0x80) == 0)
+            {
+                if (piece == 0 && shift != 0)
+                {
+                    throw std::runtime_error("readVarint, invalid value representation");
+                }
+
+                break;
+            }
+        }
+
+        return temp;
+    }
+
+    const uint8_t *BinaryInputBufferSerializer::take(const uint64_t size)
+    {
+        if (size > static_cast<uint64_t>(m_end - m_position))
+        {
+            throw std::runtime_error("Failed to read from buffer, unexpected end of buffer");
+        }
+
+        const uint8_t *data = m_position;
+
+        m_position += size;
+
+        return data;
+    }
+
+    ISerializer::SerializerType BinaryInputBufferSerializer::type() const
+    {
+        return ISerializer::INPUT;
+    }
+
+    bool BinaryInputBufferSerializer::beginObject(Common::StringView name)
+    {
+        return true;
+    }
+
+    void BinaryInputBufferSerializer::endObject() {}
+
+    bool BinaryInputBufferSerializer::beginArray(uint64_t &size, Common::StringView name)
+    {
+        size = readVarint<uint64_t>();
+        return true;
+    }
+
+    void BinaryInputBufferSerializer::endArray() {}
+
+    bool BinaryInputBufferSerializer::operator()(uint8_t &value, Common::StringView name)
+    {
+        value = readVarint<uint8_t>();
+        return true;
+    }
+
+    bool BinaryInputBufferSerializer::operator()(uint16_t &value, Common::StringView name)
+    {
+        value = readVarint<uint16_t>();
+        return true;
+    }
+
+    bool BinaryInputBufferSerializer::operator()(int16_t &value, Common::StringView name)
+    {
+        value = static_cast<int16_t>(readVarint<uint16_t>());
+        return true;
+    }
+
+    bool BinaryInputBufferSerializer::operator()(uint32_t &value, Common::StringView name)
+    {
+        value = readVarint<uint32_t>();
+        return true;
+    }
+
+    bool BinaryInputBufferSerializer::operator()(int32_t &value, Common::StringView name)
+    {
+        value = static_cast<int32_t>(readVarint<uint32_t>());
+        return true;
+    }
+
+    bool BinaryInputBufferSerializer::operator()(int64_t &value, Common::StringView name)
+    {
+        value = static_cast<int64_t>(readVarint<uint64_t>());
+        return true;
+    }
+
+    bool BinaryInputBufferSerializer::operator()(uint64_t &value, Common::StringView name)
+    {
+        value = readVarint<uint64_t>();
+        return true;
+    }
+
+    bool BinaryInputBufferSerializer::operator()(bool &value, Common::StringView name)
+    {
+        value = *take(1) != 0;
+        return true;
+    }
+
+    bool BinaryInputBufferSerializer::operator()(std::string &value, Common::StringView name)
+    {
+        const uint64_t size = readVarint<uint64_t>();
+
+        const uint8_t *data = take(size);
+
+        /* Oversized merge mining tags are skipped, as BinaryInputStreamSerializer does */
+        if (size > CryptoNote::parameters::MAX_EXTRA_SIZE && name == Common::StringView("mm_tag"))
+        {
+            value.clear();
+            return true;
+        }
+
+        value.assign(reinterpret_cast<const char *>(data), size);
+
+        return true;
+    }
+
+    bool BinaryInputBufferSerializer::binary(void *value, uint64_t size, Common::StringView name)
+    {
+        std::memcpy(value, take(size), size);
+        return true;
+    }
+
+    bool BinaryInputBufferSerializer::binary(std::string &value, Common::StringView name)
+    {
+        return (*this)(value, name);
+    }
+
+    bool BinaryInputBufferSerializer::operator()(double &value, Common::StringView name)
+    {
+        assert(false); // the method is not supported for this type of serialization
+        throw std::runtime_error("double serialization is not supported in BinaryInputBufferSerializer");
+        return false;
+    }
+
+} // namespace CryptoNote
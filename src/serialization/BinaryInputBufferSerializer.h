@@ -0,0 +1,74 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "ISerializer.h"
+#include "SerializationOverloads.h"
+
+namespace CryptoNote
+{
+    /* Reads the same format as BinaryInputStreamSerializer, straight out of a
+       contiguous buffer. Varints are decoded in place rather than a byte at a
+       time through IInputStream, and strings are copied out in one go. */
+    class BinaryInputBufferSerializer final : public ISerializer
+    {
+      public:
+        BinaryInputBufferSerializer(const void *data, size_t size);
+
+        virtual ~BinaryInputBufferSerializer() {}
+
+        /* Whether everything in the buffer has been read */
+        bool endOfBuffer() const;
+
+        virtual ISerializer::SerializerType type() const override;
+
+        virtual bool beginObject(Common::StringView name) override;
+
+        virtual void endObject() override;
+
+        virtual bool beginArray(uint64_t &size, Common::StringView name) override;
+
+        virtual void endArray() override;
+
+        virtual bool operator()(uint8_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int16_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint16_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int32_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint32_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int64_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint64_t &value, Common::StringView name) override;
+
+        virtual bool operator()(double &value, Common::StringView name) override;
+
+        virtual bool operator()(bool &value, Common::StringView name) override;
+
+        virtual bool operator()(std::string &value, Common::StringView name) override;
+
+        virtual bool binary(void *value, uint64_t size, Common::StringView name) override;
+
+        virtual bool binary(std::string &value, Common::StringView name) override;
+
+        template<typename T> bool operator()(T &value, Common::StringView name)
+        {
+            return ISerializer::operator()(value, name);
+        }
+
+      private:
+        template<typename T> T readVarint();
+
+        const uint8_t *take(uint64_t size);
+
+        const uint8_t *m_position;
+
+        const uint8_t *m_end;
+    };
+
+} // namespace CryptoNote
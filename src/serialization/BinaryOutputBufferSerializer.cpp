@@ -0,0 +1,130 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "BinaryOutputBufferSerializer.h"
+
+#include <cassert>
+#include <stdexcept>
+
+namespace CryptoNote
+{
+    void BinaryOutputBufferSerializer::writeVarint(uint64_t value)
+    {
+        uint8_t encoded[10];
+
+        size_t size = 0;
+
+        while (value >= 0x80)
+        {
+            encoded[size++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+
+        encoded[size++] = static_cast<uint8_t>(value);
+
+        m_buffer.insert(m_buffer.end(), encoded, encoded + size);
+    }
+
+    void BinaryOutputBufferSerializer::write(const void *data, const uint64_t size)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+
+        m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+    }
+
+    ISerializer::SerializerType BinaryOutputBufferSerializer::type() const
+    {
+        return ISerializer::OUTPUT;
+    }
+
+    bool BinaryOutputBufferSerializer::beginObject(Common::StringView name)
+    {
+        return true;
+    }
+
+    void BinaryOutputBufferSerializer::endObject() {}
+
+    bool BinaryOutputBufferSerializer::beginArray(uint64_t &size, Common::StringView name)
+    {
+        writeVarint(size);
+        return true;
+    }
+
+    void BinaryOutputBufferSerializer::endArray() {}
+
+    bool BinaryOutputBufferSerializer::operator()(uint8_t &value, Common::StringView name)
+    {
+        writeVarint(value);
+        return true;
+    }
+
+    bool BinaryOutputBufferSerializer::operator()(uint16_t &value, Common::StringView name)
+    {
+        writeVarint(value);
+        return true;
+    }
+
+    bool BinaryOutputBufferSerializer::operator()(int16_t &value, Common::StringView name)
+    {
+        writeVarint(static_cast<uint16_t>(value));
+        return true;
+    }
+
+    bool BinaryOutputBufferSerializer::operator()(uint32_t &value, Common::StringView name)
+    {
+        writeVarint(value);
+        return true;
+    }
+
+    bool BinaryOutputBufferSerializer::operator()(int32_t &value, Common::StringView name)
+    {
+        writeVarint(static_cast<uint32_t>(value));
+        return true;
+    }
+
+    bool BinaryOutputBufferSerializer::operator()(int64_t &value, Common::StringView name)
+    {
+        writeVarint(static_cast<uint64_t>(value));
+        return true;
+    }
+
+    bool BinaryOutputBufferSerializer::operator()(uint64_t &value, Common::StringView name)
+    {
+        writeVarint(value);
+        return true;
+    }
+
+    bool BinaryOutputBufferSerializer::operator()(bool &value, Common::StringView name)
+    {
+        m_buffer.push_back(value ? 1 : 0);
+        return true;
+    }
+
+    bool BinaryOutputBufferSerializer::operator()(std::string &value, Common::StringView name)
+    {
+        writeVarint(value.size());
+        write(value.data(), value.size());
+        return true;
+    }
+
+    bool BinaryOutputBufferSerializer::binary(void *value, uint64_t size, Common::StringView name)
+    {
+        write(value, size);
+        return true;
+    }
+
+    bool BinaryOutputBufferSerializer::binary(std::string &value, Common::StringView name)
+    {
+        // write as string (with size prefix)
+        return (*this)(value, name);
+    }
+
+    bool BinaryOutputBufferSerializer::operator()(double &value, Common::StringView name)
+    {
+        assert(false); // the method is not supported for this type of serialization
+        throw std::runtime_error("double serialization is not supported in BinaryOutputBufferSerializer");
+        return false;
+    }
+
+} // namespace CryptoNote
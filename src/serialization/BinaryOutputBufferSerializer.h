@@ -0,0 +1,71 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "ISerializer.h"
+#include "SerializationOverloads.h"
+
+#include <vector>
+
+namespace CryptoNote
+{
+    /* Writes the same format as BinaryOutputStreamSerializer, appending
+       straight to a byte vector rather than through IOutputStream. Each
+       varint is encoded on the stack and appended with a single insert. */
+    class BinaryOutputBufferSerializer final : public ISerializer
+    {
+      public:
+        explicit BinaryOutputBufferSerializer(std::vector<uint8_t> &buffer): m_buffer(buffer) {}
+
+        virtual ~BinaryOutputBufferSerializer() {}
+
+        virtual ISerializer::SerializerType type() const override;
+
+        virtual bool beginObject(Common::StringView name) override;
+
+        virtual void endObject() override;
+
+        virtual bool beginArray(uint64_t &size, Common::StringView name) override;
+
+        virtual void endArray() override;
+
+        virtual bool operator()(uint8_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int16_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint16_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int32_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint32_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int64_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint64_t &value, Common::StringView name) override;
+
+        virtual bool operator()(double &value, Common::StringView name) override;
+
+        virtual bool operator()(bool &value, Common::StringView name) override;
+
+        virtual bool operator()(std::string &value, Common::StringView name) override;
+
+        virtual bool binary(void *value, uint64_t size, Common::StringView name) override;
+
+        virtual bool binary(std::string &value, Common::StringView name) override;
+
+        template<typename T> bool operator()(T &value, Common::StringView name)
+        {
+            return ISerializer::operator()(value, name);
+        }
+
+      private:
+        void writeVarint(uint64_t value);
+
+        void write(const void *data, uint64_t size);
+
+        std::vector<uint8_t> &m_buffer;
+    };
+
+} // namespace CryptoNote
@@ -3,7 +3,9 @@
 //
 // Please see the included LICENSE file for more information.
 
+#include "BinaryInputBufferSerializer.h"
 #include "BinaryInputStreamSerializer.h"
+#include "BinaryOutputBufferSerializer.h"
 #include "BinaryOutputStreamSerializer.h"
 #include "common/MemoryInputStream.h"
 #include "common/StdInputStream.h"
@@ -18,16 +20,14 @@ namespace CryptoNote
     template<typename T> BinaryArray storeToBinary(const T &obj)
     {
         BinaryArray result;
-        Common::VectorOutputStream stream(result);
-        BinaryOutputStreamSerializer ba(stream);
+        BinaryOutputBufferSerializer ba(result);
         serialize(const_cast<T &>(obj), ba);
         return result;
     }
 
     template<typename T> void loadFromBinary(T &obj, const BinaryArray &blob)
     {
-        Common::MemoryInputStream stream(blob.data(), blob.size());
-        BinaryInputStreamSerializer ba(stream);
+        BinaryInputBufferSerializer ba(blob.data(), blob.size());
         serialize(obj, ba);
     }
 
@@ -0,0 +1,115 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "BinarySizeSerializer.h"
+
+#include <cassert>
+#include <stdexcept>
+
+namespace CryptoNote
+{
+    void BinarySizeSerializer::addVarint(uint64_t value)
+    {
+        /* 7 bits per byte */
+        do
+        {
+            m_size++;
+            value >>= 7;
+        } while (value != 0);
+    }
+
+    ISerializer::SerializerType BinarySizeSerializer::type() const
+    {
+        return ISerializer::OUTPUT;
+    }
+
+    bool BinarySizeSerializer::beginObject(Common::StringView name)
+    {
+        return true;
+    }
+
+    void BinarySizeSerializer::endObject() {}
+
+    bool BinarySizeSerializer::beginArray(uint64_t &size, Common::StringView name)
+    {
+        addVarint(size);
+        return true;
+    }
+
+    void BinarySizeSerializer::endArray() {}
+
+    bool BinarySizeSerializer::operator()(uint8_t &value, Common::StringView name)
+    {
+        addVarint(value);
+        return true;
+    }
+
+    bool BinarySizeSerializer::operator()(uint16_t &value, Common::StringView name)
+    {
+        addVarint(value);
+        return true;
+    }
+
+    bool BinarySizeSerializer::operator()(int16_t &value, Common::StringView name)
+    {
+        addVarint(static_cast<uint16_t>(value));
+        return true;
+    }
+
+    bool BinarySizeSerializer::operator()(uint32_t &value, Common::StringView name)
+    {
+        addVarint(value);
+        return true;
+    }
+
+    bool BinarySizeSerializer::operator()(int32_t &value, Common::StringView name)
+    {
+        addVarint(static_cast<uint32_t>(value));
+        return true;
+    }
+
+    bool BinarySizeSerializer::operator()(int64_t &value, Common::StringView name)
+    {
+        addVarint(static_cast<uint64_t>(value));
+        return true;
+    }
+
+    bool BinarySizeSerializer::operator()(uint64_t &value, Common::StringView name)
+    {
+        addVarint(value);
+        return true;
+    }
+
+    bool BinarySizeSerializer::operator()(bool &value, Common::StringView name)
+    {
+        m_size++;
+        return true;
+    }
+
+    bool BinarySizeSerializer::operator()(std::string &value, Common::StringView name)
+    {
+        addVarint(value.size());
+        m_size += value.size();
+        return true;
+    }
+
+    bool BinarySizeSerializer::binary(void *value, uint64_t size, Common::StringView name)
+    {
+        m_size += size;
+        return true;
+    }
+
+    bool BinarySizeSerializer::binary(std::string &value, Common::StringView name)
+    {
+        return (*this)(value, name);
+    }
+
+    bool BinarySizeSerializer::operator()(double &value, Common::StringView name)
+    {
+        assert(false); // the method is not supported for this type of serialization
+        throw std::runtime_error("double serialization is not supported in BinarySizeSerializer");
+        return false;
+    }
+
+} // namespace CryptoNote
@@ -0,0 +1,72 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "ISerializer.h"
+#include "SerializationOverloads.h"
+
+namespace CryptoNote
+{
+    /* Walks an object as BinaryOutputStreamSerializer would, but only adds up
+       how many bytes it would have written, so an object's binary size can
+       be found without building its blob. */
+    class BinarySizeSerializer final : public ISerializer
+    {
+      public:
+        BinarySizeSerializer() {}
+
+        virtual ~BinarySizeSerializer() {}
+
+        uint64_t size() const
+        {
+            return m_size;
+        }
+
+        virtual ISerializer::SerializerType type() const override;
+
+        virtual bool beginObject(Common::StringView name) override;
+
+        virtual void endObject() override;
+
+        virtual bool beginArray(uint64_t &size, Common::StringView name) override;
+
+        virtual void endArray() override;
+
+        virtual bool operator()(uint8_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int16_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint16_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int32_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint32_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int64_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint64_t &value, Common::StringView name) override;
+
+        virtual bool operator()(double &value, Common::StringView name) override;
+
+        virtual bool operator()(bool &value, Common::StringView name) override;
+
+        virtual bool operator()(std::string &value, Common::StringView name) override;
+
+        virtual bool binary(void *value, uint64_t size, Common::StringView name) override;
+
+        virtual bool binary(std::string &value, Common::StringView name) override;
+
+        template<typename T> bool operator()(T &value, Common::StringView name)
+        {
+            return ISerializer::operator()(value, name);
+        }
+
+      private:
+        void addVarint(uint64_t value);
+
+        uint64_t m_size = 0;
+    };
+
+} // namespace CryptoNote
@@ -0,0 +1,234 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "RapidJsonInputSerializer.h"
+
+#include "common/StringTools.h"
+
+#include <cassert>
+#include <stdexcept>
+
+using namespace CryptoNote;
+
+namespace
+{
+    const rapidjson::Value *findMember(const rapidjson::Value &object, Common::StringView name)
+    {
+        const auto member = object.FindMember(
+            rapidjson::Value(rapidjson::StringRef(name.getData(), static_cast<rapidjson::SizeType>(name.getSize()))));
+
+        return member == object.MemberEnd() ? nullptr : &member->value;
+    }
+
+} // namespace
+
+RapidJsonInputSerializer::RapidJsonInputSerializer(const rapidjson::Value &value)
+{
+    if (!value.IsObject())
+    {
+        throw std::runtime_error("Serializer doesn't support this type of serialization: Object expected.");
+    }
+
+    chain.push_back(&value);
+}
+
+RapidJsonInputSerializer::~RapidJsonInputSerializer() {}
+
+ISerializer::SerializerType RapidJsonInputSerializer::type() const
+{
+    return ISerializer::INPUT;
+}
+
+bool RapidJsonInputSerializer::beginObject(Common::StringView name)
+{
+    const rapidjson::Value *v = getValue(name);
+
+    if (v == nullptr)
+    {
+        return false;
+    }
+
+    if (!v->IsObject())
+    {
+        throw std::runtime_error("Object expected");
+    }
+
+    chain.push_back(v);
+    return true;
+}
+
+void RapidJsonInputSerializer::endObject()
+{
+    assert(!chain.empty());
+    chain.pop_back();
+}
+
+bool RapidJsonInputSerializer::beginArray(uint64_t &size, Common::StringView name)
+{
+    const rapidjson::Value *arr = getValue(name);
+
+    if (arr == nullptr)
+    {
+        size = 0;
+        return false;
+    }
+
+    if (!arr->IsArray())
+    {
+        throw std::runtime_error("Array expected");
+    }
+
+    size = arr->Size();
+    chain.push_back(arr);
+    idxs.push_back(0);
+    return true;
+}
+
+void RapidJsonInputSerializer::endArray()
+{
+    assert(!chain.empty());
+    assert(!idxs.empty());
+
+    chain.pop_back();
+    idxs.pop_back();
+}
+
+bool RapidJsonInputSerializer::operator()(uint16_t &value, Common::StringView name)
+{
+    return getNumber(name, value);
+}
+
+bool RapidJsonInputSerializer::operator()(int16_t &value, Common::StringView name)
+{
+    return getNumber(name, value);
+}
+
+bool RapidJsonInputSerializer::operator()(uint32_t &value, Common::StringView name)
+{
+    return getNumber(name, value);
+}
+
+bool RapidJsonInputSerializer::operator()(int32_t &value, Common::StringView name)
+{
+    return getNumber(name, value);
+}
+
+bool RapidJsonInputSerializer::operator()(int64_t &value, Common::StringView name)
+{
+    return getNumber(name, value);
+}
+
+bool RapidJsonInputSerializer::operator()(uint64_t &value, Common::StringView name)
+{
+    return getNumber(name, value);
+}
+
+bool RapidJsonInputSerializer::operator()(double &value, Common::StringView name)
+{
+    const auto ptr = getValue(name);
+
+    if (ptr == nullptr)
+    {
+        return false;
+    }
+
+    if (!ptr->IsNumber())
+    {
+        throw std::runtime_error("Number expected");
+    }
+
+    value = ptr->GetDouble();
+    return true;
+}
+
+bool RapidJsonInputSerializer::operator()(uint8_t &value, Common::StringView name)
+{
+    return getNumber(name, value);
+}
+
+bool RapidJsonInputSerializer::operator()(std::string &value, Common::StringView name)
+{
+    const auto str = getString(name);
+
+    if (str == nullptr)
+    {
+        return false;
+    }
+
+    value.assign(str->GetString(), str->GetStringLength());
+    return true;
+}
+
+bool RapidJsonInputSerializer::operator()(bool &value, Common::StringView name)
+{
+    const auto ptr = getValue(name);
+
+    if (ptr == nullptr)
+    {
+        return false;
+    }
+
+    if (!ptr->IsBool())
+    {
+        throw std::runtime_error("Bool expected");
+    }
+
+    value = ptr->GetBool();
+    return true;
+}
+
+bool RapidJsonInputSerializer::binary(void *value, uint64_t size, Common::StringView name)
+{
+    const auto str = getString(name);
+
+    if (str == nullptr)
+    {
+        return false;
+    }
+
+    Common::fromHex(std::string(str->GetString(), str->GetStringLength()), value, size);
+    return true;
+}
+
+bool RapidJsonInputSerializer::binary(std::string &value, Common::StringView name)
+{
+    const auto str = getString(name);
+
+    if (str == nullptr)
+    {
+        return false;
+    }
+
+    value = Common::asString(Common::fromHex(std::string(str->GetString(), str->GetStringLength())));
+    return true;
+}
+
+const rapidjson::Value *RapidJsonInputSerializer::getString(Common::StringView name)
+{
+    const auto ptr = getValue(name);
+
+    if (ptr != nullptr && !ptr->IsString())
+    {
+        throw std::runtime_error("String expected");
+    }
+
+    return ptr;
+}
+
+const rapidjson::Value *RapidJsonInputSerializer::getValue(Common::StringView name)
+{
+    const rapidjson::Value &val = *chain.back();
+
+    if (val.IsArray())
+    {
+        if (idxs.back() >= val.Size())
+        {
+            throw std::out_of_range("Array index out of range");
+        }
+
+        return &val[idxs.back()++];
+    }
+
+    return findMember(val, name);
+}
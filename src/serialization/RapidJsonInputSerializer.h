@@ -0,0 +1,103 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "ISerializer.h"
+
+#include <rapidjson/document.h>
+#include <stdexcept>
+#include <vector>
+
+namespace CryptoNote
+{
+    /* Deserializes straight out of a parsed rapidjson document, with the same
+       rules as JsonInputValueSerializer: missing fields return false, fields
+       of the wrong type throw, and binary fields are read as hex. The value
+       must outlive the serializer. */
+    class RapidJsonInputSerializer : public ISerializer
+    {
+      public:
+        explicit RapidJsonInputSerializer(const rapidjson::Value &value);
+
+        virtual ~RapidJsonInputSerializer();
+
+        SerializerType type() const override;
+
+        virtual bool beginObject(Common::StringView name) override;
+
+        virtual void endObject() override;
+
+        virtual bool beginArray(uint64_t &size, Common::StringView name) override;
+
+        virtual void endArray() override;
+
+        virtual bool operator()(uint8_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int16_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint16_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int32_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint32_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int64_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint64_t &value, Common::StringView name) override;
+
+        virtual bool operator()(double &value, Common::StringView name) override;
+
+        virtual bool operator()(bool &value, Common::StringView name) override;
+
+        virtual bool operator()(std::string &value, Common::StringView name) override;
+
+        virtual bool binary(void *value, uint64_t size, Common::StringView name) override;
+
+        virtual bool binary(std::string &value, Common::StringView name) override;
+
+        template<typename T> bool operator()(T &value, Common::StringView name)
+        {
+            return ISerializer::operator()(value, name);
+        }
+
+      private:
+        /* The value called name in the current object, or the next element
+           if we're in an array. nullptr if there's no such field. */
+        const rapidjson::Value *getValue(Common::StringView name);
+
+        template<typename T> bool getNumber(Common::StringView name, T &v)
+        {
+            const auto ptr = getValue(name);
+
+            if (!ptr)
+            {
+                return false;
+            }
+
+            if (ptr->IsInt64())
+            {
+                v = static_cast<T>(ptr->GetInt64());
+            }
+            else if (ptr->IsUint64())
+            {
+                v = static_cast<T>(ptr->GetUint64());
+            }
+            else
+            {
+                throw std::runtime_error("Integer expected");
+            }
+
+            return true;
+        }
+
+        /* As getValue, but throws if the field isn't a string */
+        const rapidjson::Value *getString(Common::StringView name);
+
+        std::vector<const rapidjson::Value *> chain;
+
+        std::vector<rapidjson::SizeType> idxs;
+    };
+
+} // namespace CryptoNote
@@ -0,0 +1,138 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "RapidJsonOutputSerializer.h"
+
+#include "common/StringTools.h"
+
+#include <cassert>
+
+using namespace CryptoNote;
+
+RapidJsonOutputSerializer::RapidJsonOutputSerializer(JsonWriter &writer): writer(writer)
+{
+    inArray.push_back(false);
+}
+
+RapidJsonOutputSerializer::~RapidJsonOutputSerializer() {}
+
+ISerializer::SerializerType RapidJsonOutputSerializer::type() const
+{
+    return ISerializer::OUTPUT;
+}
+
+bool RapidJsonOutputSerializer::beginObject(Common::StringView name)
+{
+    key(name);
+    writer.StartObject();
+    inArray.push_back(false);
+    return true;
+}
+
+void RapidJsonOutputSerializer::endObject()
+{
+    assert(inArray.size() > 1);
+    inArray.pop_back();
+    writer.EndObject();
+}
+
+bool RapidJsonOutputSerializer::beginArray(uint64_t &size, Common::StringView name)
+{
+    key(name);
+    writer.StartArray();
+    inArray.push_back(true);
+    return true;
+}
+
+void RapidJsonOutputSerializer::endArray()
+{
+    assert(inArray.size() > 1);
+    inArray.pop_back();
+    writer.EndArray();
+}
+
+/* Unsigned 64 bit values are written as signed, as JsonOutputStreamSerializer
+   does, so clients see the same output as before */
+bool RapidJsonOutputSerializer::operator()(uint64_t &value, Common::StringView name)
+{
+    int64_t v = static_cast<int64_t>(value);
+    return operator()(v, name);
+}
+
+bool RapidJsonOutputSerializer::operator()(uint16_t &value, Common::StringView name)
+{
+    uint64_t v = static_cast<uint64_t>(value);
+    return operator()(v, name);
+}
+
+bool RapidJsonOutputSerializer::operator()(int16_t &value, Common::StringView name)
+{
+    int64_t v = static_cast<int64_t>(value);
+    return operator()(v, name);
+}
+
+bool RapidJsonOutputSerializer::operator()(uint32_t &value, Common::StringView name)
+{
+    uint64_t v = static_cast<uint64_t>(value);
+    return operator()(v, name);
+}
+
+bool RapidJsonOutputSerializer::operator()(int32_t &value, Common::StringView name)
+{
+    int64_t v = static_cast<int64_t>(value);
+    return operator()(v, name);
+}
+
+bool RapidJsonOutputSerializer::operator()(int64_t &value, Common::StringView name)
+{
+    key(name);
+    writer.Int64(value);
+    return true;
+}
+
+bool RapidJsonOutputSerializer::operator()(double &value, Common::StringView name)
+{
+    key(name);
+    writer.Double(value);
+    return true;
+}
+
+bool RapidJsonOutputSerializer::operator()(std::string &value, Common::StringView name)
+{
+    key(name);
+    writer.String(value.data(), static_cast<rapidjson::SizeType>(value.size()));
+    return true;
+}
+
+bool RapidJsonOutputSerializer::operator()(uint8_t &value, Common::StringView name)
+{
+    int64_t v = static_cast<int64_t>(value);
+    return operator()(v, name);
+}
+
+bool RapidJsonOutputSerializer::operator()(bool &value, Common::StringView name)
+{
+    key(name);
+    writer.Bool(value);
+    return true;
+}
+
+bool RapidJsonOutputSerializer::binary(void *value, uint64_t size, Common::StringView name)
+{
+    std::string hex = Common::toHex(value, size);
+    return (*this)(hex, name);
+}
+
+bool RapidJsonOutputSerializer::binary(std::string &value, Common::StringView name)
+{
+    return binary(const_cast<char *>(value.data()), value.size(), name);
+}
+
+void RapidJsonOutputSerializer::key(Common::StringView name)
+{
+    if (!inArray.back())
+    {
+        writer.Key(name.getData(), static_cast<rapidjson::SizeType>(name.getSize()));
+    }
+}
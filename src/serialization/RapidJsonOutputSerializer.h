@@ -0,0 +1,80 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "ISerializer.h"
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <vector>
+
+namespace CryptoNote
+{
+    typedef rapidjson::Writer<rapidjson::StringBuffer> JsonWriter;
+
+    /* Serializes straight into a rapidjson writer, rather than building a
+       JsonValue tree and printing it afterwards. The output matches
+       JsonOutputStreamSerializer, except that the fields of an object come
+       out in the order they're serialized instead of sorted by name.
+
+       The writer must already be inside an object, which the caller opens
+       before serializing and closes afterwards. */
+    class RapidJsonOutputSerializer : public ISerializer
+    {
+      public:
+        explicit RapidJsonOutputSerializer(JsonWriter &writer);
+
+        virtual ~RapidJsonOutputSerializer();
+
+        SerializerType type() const override;
+
+        virtual bool beginObject(Common::StringView name) override;
+
+        virtual void endObject() override;
+
+        virtual bool beginArray(uint64_t &size, Common::StringView name) override;
+
+        virtual void endArray() override;
+
+        virtual bool operator()(uint8_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int16_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint16_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int32_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint32_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int64_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint64_t &value, Common::StringView name) override;
+
+        virtual bool operator()(double &value, Common::StringView name) override;
+
+        virtual bool operator()(bool &value, Common::StringView name) override;
+
+        virtual bool operator()(std::string &value, Common::StringView name) override;
+
+        virtual bool binary(void *value, uint64_t size, Common::StringView name) override;
+
+        virtual bool binary(std::string &value, Common::StringView name) override;
+
+        template<typename T> bool operator()(T &value, Common::StringView name)
+        {
+            return ISerializer::operator()(value, name);
+        }
+
+      private:
+        /* Writes the name of the next value, unless we're in an array */
+        void key(Common::StringView name);
+
+        JsonWriter &writer;
+
+        /* Whether each open container is an array, innermost last */
+        std::vector<bool> inArray;
+    };
+
+} // namespace CryptoNote
@@ -14,7 +14,9 @@
 #include <common/StringOutputStream.h>
 #include <common/VectorOutputStream.h>
 #include <list>
+#include <serialization/BinaryInputBufferSerializer.h>
 #include <serialization/BinaryInputStreamSerializer.h>
+#include <serialization/BinaryOutputBufferSerializer.h>
 #include <serialization/BinaryOutputStreamSerializer.h>
 #include <serialization/CryptoNoteSerialization.h>
 #include <vector>
@@ -169,8 +171,7 @@ namespace CryptoNote
     template<class T> std::vector<uint8_t> toBinaryArray(const T &object)
     {
         std::vector<uint8_t> ba;
-        Common::VectorOutputStream stream(ba);
-        BinaryOutputStreamSerializer serializer(stream);
+        BinaryOutputBufferSerializer serializer(ba);
         serialize(const_cast<T &>(object), serializer);
         return ba;
     }
@@ -210,10 +211,9 @@ namespace CryptoNote
     template<class T> T fromBinaryArray(const std::vector<uint8_t> &binaryArray)
     {
         T object;
-        Common::MemoryInputStream stream(binaryArray.data(), binaryArray.size());
-        BinaryInputStreamSerializer serializer(stream);
+        BinaryInputBufferSerializer serializer(binaryArray.data(), binaryArray.size());
         serialize(object, serializer);
-        if (!stream.endOfStream())
+        if (!serializer.endOfBuffer())
         { // check that all data was consumed
             throw std::runtime_error("failed to unpack type");
         }
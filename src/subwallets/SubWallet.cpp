@@ -532,6 +532,26 @@ std::vector<Crypto::KeyImage> SubWallet::getKeyImages() const
     return result;
 }
 
+std::vector<std::tuple<uint64_t, uint64_t>> SubWallet::getUnspentGlobalIndexes() const
+{
+    std::vector<std::tuple<uint64_t, uint64_t>> result;
+
+    const auto getGlobalIndexes = [&result](const auto &vec) {
+        for (const auto &input : vec)
+        {
+            if (input.globalOutputIndex)
+            {
+                result.emplace_back(input.amount, *input.globalOutputIndex);
+            }
+        }
+    };
+
+    getGlobalIndexes(m_unspentInputs);
+    getGlobalIndexes(m_lockedInputs);
+
+    return result;
+}
+
 void SubWallet::fromJSON(const JSONValue &j)
 {
     if (j.HasMember("walletIndex"))
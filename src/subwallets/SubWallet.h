@@ -99,6 +99,10 @@ class SubWallet
 
     std::vector<Crypto::KeyImage> getKeyImages() const;
 
+    /* Gets the amount and global index of every input we have not yet seen
+       spent in a block, used to spot the transactions spending them */
+    std::vector<std::tuple<uint64_t, uint64_t>> getUnspentGlobalIndexes() const;
+
     /////////////////////////////
     /* Public member variables */
     /////////////////////////////
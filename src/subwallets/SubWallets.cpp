@@ -8,6 +8,7 @@
 
 #include <config/CryptoNoteConfig.h>
 #include <ctime>
+#include <limits>
 #include <mutex>
 #include <logger/Logger.h>
 #include <random>
@@ -68,6 +69,9 @@ SubWallets::SubWallets(
 SubWallets::SubWallets(const SubWallets &other):
     m_subWallets(other.m_subWallets),
     m_transactions(other.m_transactions),
+    m_transactionIndexes(other.m_transactionIndexes),
+    m_transactionsByHeight(other.m_transactionsByHeight),
+    m_transactionsByAddress(other.m_transactionsByAddress),
     m_lockedTransactions(other.m_lockedTransactions),
     m_privateViewKey(other.m_privateViewKey),
     m_isViewWallet(other.m_isViewWallet),
@@ -231,6 +235,8 @@ Error SubWallets::deleteSubWallet(const std::string address)
     deleteAddressTransactions(m_transactions, spendKey);
     deleteAddressTransactions(m_lockedTransactions, spendKey);
 
+    rebuildTransactionIndexes();
+
     const auto it2 = std::remove(m_publicSpendKeys.begin(), m_publicSpendKeys.end(), spendKey);
 
     if (it2 != m_publicSpendKeys.end())
@@ -326,7 +332,7 @@ void SubWallets::addUnconfirmedTransaction(const WalletTypes::Transaction tx)
     std::scoped_lock lock(m_mutex);
 
     const auto it2 =
-        std::find_if(m_lockedTransactions.begin(), m_lockedTransactions.end(), [tx](const auto transaction) {
+        std::find_if(m_lockedTransactions.begin(), m_lockedTransactions.end(), [&tx](const auto &transaction) {
             return tx.hash == transaction.hash;
         });
 
@@ -357,7 +363,7 @@ void SubWallets::addTransaction(const WalletTypes::Transaction tx)
        when the transaction actually comes in, we will update the transaction
        with the block infomation. */
     const auto it =
-        std::remove_if(m_lockedTransactions.begin(), m_lockedTransactions.end(), [tx](const auto transaction) {
+        std::remove_if(m_lockedTransactions.begin(), m_lockedTransactions.end(), [&tx](const auto &transaction) {
             return tx.hash == transaction.hash;
         });
 
@@ -367,11 +373,7 @@ void SubWallets::addTransaction(const WalletTypes::Transaction tx)
         m_lockedTransactions.erase(it, m_lockedTransactions.end());
     }
 
-    const auto it2 = std::find_if(m_transactions.begin(), m_transactions.end(), [tx](const auto transaction) {
-        return tx.hash == transaction.hash;
-    });
-
-    if (it2 != m_transactions.end())
+    if (m_transactionIndexes.find(tx.hash) != m_transactionIndexes.end())
     {
         std::stringstream stream;
 
@@ -387,6 +389,61 @@ void SubWallets::addTransaction(const WalletTypes::Transaction tx)
     }
 
     m_transactions.push_back(tx);
+
+    indexTransaction(m_transactions.size() - 1);
+}
+
+void SubWallets::indexTransaction(const size_t position)
+{
+    const auto &tx = m_transactions[position];
+
+    m_transactionIndexes[tx.hash] = position;
+
+    insertByHeight(m_transactionsByHeight, position);
+
+    for (const auto &[publicKey, amount] : tx.transfers)
+    {
+        insertByHeight(m_transactionsByAddress[publicKey], position);
+    }
+}
+
+void SubWallets::rebuildTransactionIndexes()
+{
+    m_transactionIndexes.clear();
+    m_transactionsByHeight.clear();
+    m_transactionsByAddress.clear();
+
+    for (size_t i = 0; i < m_transactions.size(); i++)
+    {
+        indexTransaction(i);
+    }
+}
+
+void SubWallets::insertByHeight(std::vector<size_t> &index, const size_t position) const
+{
+    const uint64_t height = m_transactions[position].blockHeight;
+
+    /* Transactions almost always arrive in height order, so this is
+       normally just an append */
+    if (index.empty() || m_transactions[index.back()].blockHeight <= height)
+    {
+        index.push_back(position);
+        return;
+    }
+
+    const auto it = std::upper_bound(index.begin(), index.end(), height, [this](const uint64_t h, const size_t i) {
+        return h < m_transactions[i].blockHeight;
+    });
+
+    index.insert(it, position);
+}
+
+std::vector<size_t>::const_iterator
+    SubWallets::lowerBoundByHeight(const std::vector<size_t> &index, const uint64_t height) const
+{
+    return std::lower_bound(index.begin(), index.end(), height, [this](const size_t i, const uint64_t h) {
+        return m_transactions[i].blockHeight < h;
+    });
 }
 
 std::tuple<Crypto::KeyImage, Crypto::SecretKey> SubWallets::getTxInputKeyImage(
@@ -776,7 +833,7 @@ void SubWallets::removeForkedTransactions(const uint64_t forkHeight)
 {
     std::scoped_lock lock(m_mutex);
 
-    const auto it = std::remove_if(m_transactions.begin(), m_transactions.end(), [forkHeight](auto tx) {
+    const auto it = std::remove_if(m_transactions.begin(), m_transactions.end(), [forkHeight](const auto &tx) {
         /* Remove the transaction if it's height is >= than the fork height */
         return tx.blockHeight >= forkHeight;
     });
@@ -784,6 +841,8 @@ void SubWallets::removeForkedTransactions(const uint64_t forkHeight)
     if (it != m_transactions.end())
     {
         m_transactions.erase(it, m_transactions.end());
+
+        rebuildTransactionIndexes();
     }
 
     std::vector<Crypto::KeyImage> keyImagesToRemove;
@@ -831,6 +890,29 @@ Crypto::SecretKey SubWallets::getPrivateViewKey() const
     return m_privateViewKey;
 }
 
+std::vector<Crypto::PublicKey> SubWallets::getPublicSpendKeys() const
+{
+    std::scoped_lock lock(m_mutex);
+
+    return m_publicSpendKeys;
+}
+
+std::vector<std::tuple<uint64_t, uint64_t>> SubWallets::getUnspentGlobalIndexes() const
+{
+    std::scoped_lock lock(m_mutex);
+
+    std::vector<std::tuple<uint64_t, uint64_t>> result;
+
+    for (const auto &[pubKey, subWallet] : m_subWallets)
+    {
+        const auto globalIndexes = subWallet.getUnspentGlobalIndexes();
+
+        result.insert(result.end(), globalIndexes.begin(), globalIndexes.end());
+    }
+
+    return result;
+}
+
 std::tuple<Error, Crypto::SecretKey, uint64_t> SubWallets::getPrivateSpendKey(const Crypto::PublicKey publicSpendKey) const
 {
     throwIfViewWallet();
@@ -883,6 +965,8 @@ void SubWallets::reset(const uint64_t scanHeight)
     m_transactions.clear();
     m_transactionPrivateKeys.clear();
 
+    rebuildTransactionIndexes();
+
     for (auto &[pubKey, subWallet] : m_subWallets)
     {
         subWallet.reset(scanHeight);
@@ -919,9 +1003,117 @@ Crypto::SecretKey SubWallets::getPrimaryPrivateSpendKey() const
 
 std::vector<WalletTypes::Transaction> SubWallets::getTransactions() const
 {
+    std::scoped_lock lock(m_mutex);
+
     return m_transactions;
 }
 
+std::optional<WalletTypes::Transaction> SubWallets::getTransaction(const Crypto::Hash &hash) const
+{
+    std::scoped_lock lock(m_mutex);
+
+    const auto it = m_transactionIndexes.find(hash);
+
+    if (it == m_transactionIndexes.end())
+    {
+        return std::nullopt;
+    }
+
+    return m_transactions[it->second];
+}
+
+std::vector<WalletTypes::Transaction> SubWallets::getTransactionsRange(
+    const uint64_t startHeight,
+    const uint64_t endHeight,
+    const std::optional<Crypto::PublicKey> publicSpendKey) const
+{
+    const auto [error, transactions, cursor] = getTransactionsPage(
+        startHeight, endHeight, publicSpendKey, std::nullopt, std::numeric_limits<uint64_t>::max());
+
+    return transactions;
+}
+
+std::tuple<Error, std::vector<WalletTypes::Transaction>, std::optional<Crypto::Hash>> SubWallets::getTransactionsPage(
+    const uint64_t startHeight,
+    const uint64_t endHeight,
+    const std::optional<Crypto::PublicKey> publicSpendKey,
+    const std::optional<Crypto::Hash> cursor,
+    const uint64_t limit) const
+{
+    std::scoped_lock lock(m_mutex);
+
+    std::vector<WalletTypes::Transaction> result;
+
+    const std::vector<size_t> *index = &m_transactionsByHeight;
+
+    if (publicSpendKey)
+    {
+        const auto it = m_transactionsByAddress.find(*publicSpendKey);
+
+        /* No transactions for this address */
+        if (it == m_transactionsByAddress.end())
+        {
+            if (cursor)
+            {
+                return {INVALID_TRANSACTION_CURSOR, result, std::nullopt};
+            }
+
+            return {SUCCESS, result, std::nullopt};
+        }
+
+        index = &it->second;
+    }
+
+    auto it = lowerBoundByHeight(*index, startHeight);
+
+    if (cursor)
+    {
+        const auto position = m_transactionIndexes.find(*cursor);
+
+        if (position == m_transactionIndexes.end())
+        {
+            return {INVALID_TRANSACTION_CURSOR, result, std::nullopt};
+        }
+
+        /* Find the cursor transaction amongst the transactions at its height,
+           and continue from the one after it */
+        auto cursorIt = lowerBoundByHeight(*index, m_transactions[position->second].blockHeight);
+
+        while (cursorIt != index->end() && *cursorIt != position->second)
+        {
+            cursorIt++;
+        }
+
+        if (cursorIt == index->end())
+        {
+            return {INVALID_TRANSACTION_CURSOR, result, std::nullopt};
+        }
+
+        it = std::max(it, cursorIt + 1);
+    }
+
+    for (; it != index->end() && result.size() < limit; it++)
+    {
+        const auto &tx = m_transactions[*it];
+
+        if (tx.blockHeight >= endHeight)
+        {
+            break;
+        }
+
+        result.push_back(tx);
+    }
+
+    std::optional<Crypto::Hash> nextCursor;
+
+    if (it != index->end() && m_transactions[*it].blockHeight < endHeight && !result.empty())
+    {
+        nextCursor = result.back().hash;
+    }
+
+    return {SUCCESS, result, nextCursor};
+}
+
 /* Note that this DOES NOT return incoming transactions in the pool. It only
    returns outgoing transactions which we sent but have not encountered in a
    block yet. */
@@ -1045,6 +1237,8 @@ void SubWallets::fromJSON(const JSONObject &j)
         m_transactions.push_back(tx);
     }
 
+    rebuildTransactionIndexes();
+
     for (const auto &x : getArrayFromJSON(j, "lockedTransactions"))
     {
         WalletTypes::Transaction tx;
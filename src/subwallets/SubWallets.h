@@ -5,6 +5,7 @@
 #pragma once
 
 #include <crypto/crypto.h>
+#include <optional>
 #include <subwallets/SubWallet.h>
 
 class SubWallets
@@ -125,6 +126,13 @@ class SubWallets
 
     Crypto::SecretKey getPrivateViewKey() const;
 
+    /* Gets the public spend keys of every subwallet */
+    std::vector<Crypto::PublicKey> getPublicSpendKeys() const;
+
+    /* Gets the amount and global index of every unspent input, across all
+       subwallets */
+    std::vector<std::tuple<uint64_t, uint64_t>> getUnspentGlobalIndexes() const;
+
     /* Gets the private spend key and subwallet index for the given public spend, if it exists */
     std::tuple<Error, Crypto::SecretKey, uint64_t> getPrivateSpendKey(const Crypto::PublicKey publicSpendKey) const;
 
@@ -149,6 +157,29 @@ class SubWallets
 
     std::vector<WalletTypes::Transaction> getTransactions() const;
 
+    /* Gets the transaction with the given hash, if it exists. Does not
+       include unconfirmed transactions. */
+    std::optional<WalletTypes::Transaction> getTransaction(const Crypto::Hash &hash) const;
+
+    /* Returns transactions in the range [startHeight, endHeight - 1]. If
+       publicSpendKey is given, only transactions involving that subwallet
+       are returned. */
+    std::vector<WalletTypes::Transaction> getTransactionsRange(
+        const uint64_t startHeight,
+        const uint64_t endHeight,
+        const std::optional<Crypto::PublicKey> publicSpendKey = std::nullopt) const;
+
+    /* Returns up to limit transactions in the range [startHeight, endHeight - 1],
+       continuing after the transaction given by cursor, if any. The returned
+       cursor is the hash to pass in to get the next page, and is empty if
+       there are no more transactions in the range. */
+    std::tuple<Error, std::vector<WalletTypes::Transaction>, std::optional<Crypto::Hash>> getTransactionsPage(
+        const uint64_t startHeight,
+        const uint64_t endHeight,
+        const std::optional<Crypto::PublicKey> publicSpendKey,
+        const std::optional<Crypto::Hash> cursor,
+        const uint64_t limit) const;
+
     /* Note that this DOES NOT return incoming transactions in the pool. It only
        returns outgoing transactions which we sent but have not encountered in a
        block yet. */
@@ -192,6 +223,22 @@ class SubWallets
        in the tx */
     void deleteAddressTransactions(std::vector<WalletTypes::Transaction> &txs, const Crypto::PublicKey spendKey);
 
+    /* Adds the transaction at the given position in m_transactions to the
+       hash, height and address indexes */
+    void indexTransaction(const size_t position);
+
+    /* Rebuilds the transaction indexes from scratch. Needed whenever
+       transactions are removed, as that invalidates stored positions. */
+    void rebuildTransactionIndexes();
+
+    /* Inserts the position into the height ordered index */
+    void insertByHeight(std::vector<size_t> &index, const size_t position) const;
+
+    /* Gets the first position in the height ordered index with a block
+       height >= the given height */
+    std::vector<size_t>::const_iterator
+        lowerBoundByHeight(const std::vector<size_t> &index, const uint64_t height) const;
+
     //////////////////////////////
     /* Private member variables */
     //////////////////////////////
@@ -205,6 +252,16 @@ class SubWallets
     /* A vector of transactions */
     std::vector<WalletTypes::Transaction> m_transactions;
 
+    /* Transaction hash -> position in m_transactions */
+    std::unordered_map<Crypto::Hash, size_t> m_transactionIndexes;
+
+    /* Positions in m_transactions, ordered by block height */
+    std::vector<size_t> m_transactionsByHeight;
+
+    /* Subwallet public spend key -> positions in m_transactions of the
+       transactions involving that subwallet, ordered by block height */
+    std::unordered_map<Crypto::PublicKey, std::vector<size_t>> m_transactionsByAddress;
+
     /* Transactions which we sent, but haven't been added to a block yet */
     std::vector<WalletTypes::Transaction> m_lockedTransactions;
 
@@ -14,11 +14,12 @@ namespace System
     template<typename ResultType = void> class Context
     {
       public:
-        Context(Dispatcher &dispatcher, std::function<ResultType()> &&target):
+        /* stackSize of 0 uses the dispatcher's default stack size */
+        Context(Dispatcher &dispatcher, std::function<ResultType()> &&target, size_t stackSize = 0):
             dispatcher(dispatcher),
             target(std::move(target)),
             ready(dispatcher),
-            bindingContext(dispatcher.getReusableContext())
+            bindingContext(dispatcher.getReusableContext(stackSize))
         {
             bindingContext.interrupted = false;
             bindingContext.groupNext = nullptr;
@@ -100,11 +101,11 @@ namespace System
     template<> class Context<void>
     {
       public:
-        Context(Dispatcher &dispatcher, std::function<void()> &&target):
+        Context(Dispatcher &dispatcher, std::function<void()> &&target, size_t stackSize = 0):
             dispatcher(dispatcher),
             target(std::move(target)),
             ready(dispatcher),
-            bindingContext(dispatcher.getReusableContext())
+            bindingContext(dispatcher.getReusableContext(stackSize))
         {
             bindingContext.interrupted = false;
             bindingContext.groupNext = nullptr;
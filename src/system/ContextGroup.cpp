@@ -56,10 +56,10 @@ namespace System
         }
     }
 
-    void ContextGroup::spawn(std::function<void()> &&procedure)
+    void ContextGroup::spawn(std::function<void()> &&procedure, size_t stackSize)
     {
         assert(dispatcher != nullptr);
-        NativeContext &context = dispatcher->getReusableContext();
+        NativeContext &context = dispatcher->getReusableContext(stackSize);
         if (contextGroup.firstContext != nullptr)
         {
             context.groupPrev = contextGroup.lastContext;
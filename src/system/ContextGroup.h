@@ -26,7 +26,8 @@ namespace System
 
         void interrupt();
 
-        void spawn(std::function<void()> &&procedure);
+        /* stackSize of 0 uses the dispatcher's default stack size */
+        void spawn(std::function<void()> &&procedure, size_t stackSize = 0);
 
         void wait();
 
@@ -432,6 +432,10 @@ namespace CryptoNote
         }
 
         workingThread.reset();
+
+        /* Anything prefetched may be stale by the time we start again */
+        m_prefetchedBlocks.reset();
+
         m_logger(INFO, BRIGHT_WHITE) << "Stopped";
     }
 
@@ -535,20 +539,35 @@ namespace CryptoNote
         {
             if (!req.knownBlocks.empty())
             {
-                auto queryBlocksCompleted = std::promise<std::error_code>();
-                auto queryBlocksWaitFuture = queryBlocksCompleted.get_future();
+                std::error_code ec;
 
-                m_node.queryBlocks(
-                    std::move(req.knownBlocks),
-                    req.syncStart.timestamp,
-                    response.newBlocks,
-                    response.startHeight,
-                    [&queryBlocksCompleted](std::error_code ec) {
-                        auto detachedPromise = std::move(queryBlocksCompleted);
-                        detachedPromise.set_value(ec);
-                    });
+                const auto prefetched = std::move(m_prefetchedBlocks);
 
-                std::error_code ec = queryBlocksWaitFuture.get();
+                /* The prefetched batch is only the right one if the consumers
+                   got through everything before it */
+                if (prefetched && prefetched->knownTop == req.knownBlocks.front()
+                    && prefetched->timestamp == req.syncStart.timestamp)
+                {
+                    ec = prefetched->result.get();
+                    response = std::move(prefetched->response);
+                }
+                else
+                {
+                    auto queryBlocksCompleted = std::promise<std::error_code>();
+                    auto queryBlocksWaitFuture = queryBlocksCompleted.get_future();
+
+                    m_node.queryBlocks(
+                        std::vector<Crypto::Hash>(req.knownBlocks),
+                        req.syncStart.timestamp,
+                        response.newBlocks,
+                        response.startHeight,
+                        [&queryBlocksCompleted](std::error_code ec) {
+                            auto detachedPromise = std::move(queryBlocksCompleted);
+                            detachedPromise.set_value(ec);
+                        });
+
+                    ec = queryBlocksWaitFuture.get();
+                }
 
                 if (ec)
                 {
@@ -560,6 +579,7 @@ namespace CryptoNote
                 {
                     m_logger(DEBUGGING) << "Blocks received, start index " << response.startHeight << ", count "
                                         << response.newBlocks.size();
+                    prefetchBlocks(req, response);
                     processBlocks(response);
                 }
             }
@@ -574,6 +594,46 @@ namespace CryptoNote
         }
     }
 
+    void BlockchainSynchronizer::prefetchBlocks(const GetBlocksRequest &request, const GetBlocksResponse &response)
+    {
+        if (response.newBlocks.empty())
+        {
+            return;
+        }
+
+        const uint32_t lastHeight = response.startHeight + static_cast<uint32_t>(response.newBlocks.size()) - 1;
+
+        /* Nothing more to fetch once we've caught up */
+        if (lastHeight >= m_node.getLastLocalBlockHeight())
+        {
+            return;
+        }
+
+        auto prefetch = std::make_shared<PrefetchedBlocks>();
+
+        prefetch->knownTop = response.newBlocks.back().blockHash;
+        prefetch->timestamp = request.syncStart.timestamp;
+        prefetch->result = prefetch->completed.get_future();
+
+        /* The chain we'll have once this batch is processed: this batch's last
+           block on top of what we asked with */
+        std::vector<Crypto::Hash> knownBlocks;
+        knownBlocks.reserve(request.knownBlocks.size() + 1);
+        knownBlocks.push_back(prefetch->knownTop);
+        knownBlocks.insert(knownBlocks.end(), request.knownBlocks.begin(), request.knownBlocks.end());
+
+        m_logger(DEBUGGING) << "Prefetching blocks after " << prefetch->knownTop;
+
+        m_node.queryBlocks(
+            std::move(knownBlocks),
+            prefetch->timestamp,
+            prefetch->response.newBlocks,
+            prefetch->response.startHeight,
+            [prefetch](std::error_code ec) { prefetch->completed.set_value(ec); });
+
+        m_prefetchedBlocks = prefetch;
+    }
+
     void BlockchainSynchronizer::processBlocks(GetBlocksResponse &response)
     {
         m_logger(DEBUGGING) << "Process blocks, start index " << response.startHeight << ", count "
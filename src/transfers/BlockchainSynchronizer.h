@@ -82,6 +82,23 @@ namespace CryptoNote
             std::vector<Crypto::Hash> knownBlocks;
         };
 
+        /* A queryBlocks for the batch after the one being processed, so the
+           node fetches it while the consumers scan. The node's callback holds
+           a reference, so it can be dropped while still in flight. */
+        struct PrefetchedBlocks
+        {
+            /* The top of the chain the query assumed we'd have by then */
+            Crypto::Hash knownTop;
+
+            uint64_t timestamp;
+
+            std::promise<std::error_code> completed;
+
+            std::future<std::error_code> result;
+
+            GetBlocksResponse response;
+        };
+
         struct GetPoolResponse
         {
             bool isLastKnownBlockActual;
@@ -120,6 +137,8 @@ namespace CryptoNote
 
         void processBlocks(GetBlocksResponse &response);
 
+        void prefetchBlocks(const GetBlocksRequest &request, const GetBlocksResponse &response);
+
         UpdateConsumersResult
             updateConsumers(const BlockchainInterval &interval, const std::vector<CompleteBlock> &blocks);
 
@@ -171,6 +190,9 @@ namespace CryptoNote
 
         std::unique_ptr<std::thread> workingThread;
 
+        /* Only touched by the working thread */
+        std::shared_ptr<PrefetchedBlocks> m_prefetchedBlocks;
+
         std::list<std::pair<const ITransactionReader *, std::promise<std::error_code>>> m_addTransactionTasks;
 
         std::list<std::pair<const Crypto::Hash *, std::promise<void>>> m_removeTransactionTasks;
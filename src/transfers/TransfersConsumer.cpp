@@ -10,7 +10,6 @@
 #include "CommonTypes.h"
 #include "INode.h"
 #include "WalletGreenTypes.h"
-#include "common/BlockingQueue.h"
 #include "cryptonotecore/CryptoNoteBasicImpl.h"
 #include "cryptonotecore/CryptoNoteFormatUtils.h"
 #include "cryptonotecore/TransactionApi.h"
@@ -64,14 +63,16 @@ namespace
         }
     }
 
+    /* The derivation is handed back so creating the transfers of the outputs
+       found doesn't need to compute it again, once per output */
     void findMyOutputs(
         const ITransactionReader &tx,
         const SecretKey &viewSecretKey,
         const std::unordered_set<PublicKey> &spendKeys,
+        KeyDerivation &derivation,
         std::unordered_map<PublicKey, std::vector<uint32_t>> &outputs)
     {
         auto txPublicKey = tx.getTransactionPublicKey();
-        KeyDerivation derivation;
 
         if (!generate_key_derivation(txPublicKey, viewSecretKey, derivation))
         {
@@ -117,11 +118,13 @@ namespace CryptoNote
         const CryptoNote::Currency &currency,
         INode &node,
         std::shared_ptr<Logging::ILogger> logger,
-        const SecretKey &viewSecret):
+        const SecretKey &viewSecret,
+        Utilities::ThreadPool<std::error_code> &workerPool):
         m_node(node),
         m_viewSecret(viewSecret),
         m_currency(currency),
-        m_logger(logger, "TransfersConsumer")
+        m_logger(logger, "TransfersConsumer"),
+        m_workerPool(workerPool)
     {
         updateSyncStart();
     }
@@ -245,110 +248,112 @@ namespace CryptoNote
         };
 
         std::vector<PreprocessedTx> preprocessedTransactions;
-        std::mutex preprocessedTransactionsMutex;
 
-        size_t workers = std::thread::hardware_concurrency();
-        if (workers == 0)
+        uint32_t emptyBlockCount = 0;
+
+        for (uint32_t i = 0; i < count; ++i)
         {
-            workers = 2;
-        }
+            const auto &block = blocks[i].block;
 
-        BlockingQueue<Tx> inputQueue(workers * 2);
+            if (!block.is_initialized())
+            {
+                ++emptyBlockCount;
+                continue;
+            }
 
-        std::atomic<bool> stopProcessing(false);
-        std::atomic<size_t> emptyBlockCount(0);
+            // filter by syncStartTimestamp
+            if (m_syncStart.timestamp && block->timestamp < m_syncStart.timestamp)
+            {
+                ++emptyBlockCount;
+                continue;
+            }
 
-        auto pushingThread = std::async(std::launch::async, [&] {
-            for (uint32_t i = 0; i < count && !stopProcessing; ++i)
+            TransactionBlockInfo blockInfo;
+            blockInfo.height = startHeight + i;
+            blockInfo.timestamp = block->timestamp;
+            blockInfo.transactionIndex = 0; // position in block
+
+            for (const auto &tx : blocks[i].transactions)
             {
-                const auto &block = blocks[i].block;
+                auto pubKey = tx->getTransactionPublicKey();
+                bool isLastTransactionInBlock = blockInfo.transactionIndex + 1 == blocks[i].transactions.size();
 
-                if (!block.is_initialized())
+                /* Need to ensure we add the last tx in the block even if it
+                 * has a null pub key, as we use this to indicate when we
+                 * have finished processing a block. */
+                if (pubKey == Constants::NULL_PUBLIC_KEY && !isLastTransactionInBlock)
                 {
-                    ++emptyBlockCount;
+                    ++blockInfo.transactionIndex;
                     continue;
                 }
 
-                // filter by syncStartTimestamp
-                if (m_syncStart.timestamp && block->timestamp < m_syncStart.timestamp)
-                {
-                    ++emptyBlockCount;
-                    continue;
-                }
+                PreprocessedTx item;
+                item.blockInfo = blockInfo;
+                item.tx = tx.get();
+                item.isLastTransactionInBlock = isLastTransactionInBlock;
 
-                TransactionBlockInfo blockInfo;
-                blockInfo.height = startHeight + i;
-                blockInfo.timestamp = block->timestamp;
-                blockInfo.transactionIndex = 0; // position in block
+                preprocessedTransactions.push_back(std::move(item));
+                ++blockInfo.transactionIndex;
+            }
+        }
 
-                for (const auto &tx : blocks[i].transactions)
-                {
-                    auto pubKey = tx->getTransactionPublicKey();
-                    bool isLastTransactionInBlock = blockInfo.transactionIndex + 1 == blocks[i].transactions.size();
+        std::atomic<bool> stopProcessing(false);
 
-                    /* Need to ensure we add the last tx in the block even if it
-                     * has a null pub key, as we use this to indicate when we
-                     * have finished processing a block. */
-                    if (pubKey == Constants::NULL_PUBLIC_KEY && !isLastTransactionInBlock)
-                    {
-                        ++blockInfo.transactionIndex;
-                        continue;
-                    }
+        /* Each job scans a contiguous run of transactions in place, so they
+           stay in block order without sorting. A few jobs per thread evens
+           out batches where a handful of blocks hold most transactions. */
+        const size_t jobCount = std::min<size_t>(
+            preprocessedTransactions.size(), std::max<size_t>(1, m_workerPool.threadCount() * 4));
 
-                    Tx item = {blockInfo, tx.get(), isLastTransactionInBlock};
-                    inputQueue.push(item);
-                    ++blockInfo.transactionIndex;
-                }
-            }
+        std::vector<std::future<std::error_code>> processingJobs;
 
-            inputQueue.close();
-        });
+        for (size_t job = 0; job < jobCount; ++job)
+        {
+            const size_t begin = preprocessedTransactions.size() * job / jobCount;
+            const size_t end = preprocessedTransactions.size() * (job + 1) / jobCount;
 
-        auto processingFunction = [&] {
-            Tx item;
-            std::error_code ec;
-            while (!stopProcessing && inputQueue.pop(item))
-            {
-                PreprocessedTx output;
-                static_cast<Tx &>(output) = item;
+            processingJobs.push_back(m_workerPool.addJob([&, begin, end]() -> std::error_code {
+                std::error_code ec;
+
+                try
+                {
+                    for (size_t i = begin; i < end && !stopProcessing; ++i)
+                    {
+                        auto &item = preprocessedTransactions[i];
+
+                        ec = preprocessOutputs(item.blockInfo, *item.tx, item);
+
+                        if (ec)
+                        {
+                            break;
+                        }
+                    }
+                }
+                catch (const std::system_error &e)
+                {
+                    ec = e.code();
+                }
+                catch (const std::exception &)
+                {
+                    ec = std::make_error_code(std::errc::operation_canceled);
+                }
 
-                ec = preprocessOutputs(item.blockInfo, *item.tx, output);
                 if (ec)
                 {
                     stopProcessing = true;
-                    break;
                 }
 
-                std::lock_guard<std::mutex> lk(preprocessedTransactionsMutex);
-                preprocessedTransactions.push_back(std::move(output));
-            }
-            return ec;
-        };
-
-        std::vector<std::future<std::error_code>> processingThreads;
-        for (size_t i = 0; i < workers; ++i)
-        {
-            processingThreads.push_back(std::async(std::launch::async, processingFunction));
+                return ec;
+            }));
         }
 
         std::error_code processingError;
-        for (auto &f : processingThreads)
+        for (auto &f : processingJobs)
         {
-            try
+            std::error_code ec = f.get();
+            if (!processingError && ec)
             {
-                std::error_code ec = f.get();
-                if (!processingError && ec)
-                {
-                    processingError = ec;
-                }
-            }
-            catch (const std::system_error &e)
-            {
-                processingError = e.code();
-            }
-            catch (const std::exception &)
-            {
-                processingError = std::make_error_code(std::errc::operation_canceled);
+                processingError = ec;
             }
         }
 
@@ -362,16 +367,7 @@ namespace CryptoNote
         std::vector<Crypto::Hash> blockHashes = getBlockHashes(blocks, count);
         m_observerManager.notify(&IBlockchainConsumerObserver::onBlocksAdded, this, blockHashes);
 
-        // sort by block height and transaction index in block
-        std::sort(
-            preprocessedTransactions.begin(),
-            preprocessedTransactions.end(),
-            [](const PreprocessedTx &a, const PreprocessedTx &b) {
-                return std::tie(a.blockInfo.height, a.blockInfo.transactionIndex)
-                       < std::tie(b.blockInfo.height, b.blockInfo.transactionIndex);
-            });
-
-        uint32_t processedBlockCount = static_cast<uint32_t>(emptyBlockCount);
+        uint32_t processedBlockCount = emptyBlockCount;
         try
         {
             for (const auto &tx : preprocessedTransactions)
@@ -499,6 +495,7 @@ namespace CryptoNote
         const AccountKeys &account,
         const TransactionBlockInfo &blockInfo,
         const ITransactionReader &tx,
+        const KeyDerivation &derivation,
         const std::vector<uint32_t> &outputs,
         const std::vector<uint32_t> &globalIdxs,
         std::vector<TransactionOutputInformationIn> &transfers,
@@ -540,7 +537,7 @@ namespace CryptoNote
                 tx.getOutput(idx, out, amount);
 
                 CryptoNote::KeyPair in_ephemeral;
-                CryptoNote::generate_key_image_helper(account, txPubKey, idx, in_ephemeral, info.keyImage);
+                CryptoNote::generate_key_image_helper(account, derivation, idx, in_ephemeral, info.keyImage);
 
                 assert(out.key == reinterpret_cast<const PublicKey &>(in_ephemeral.publicKey));
 
@@ -579,9 +576,10 @@ namespace CryptoNote
         PreprocessInfo &info)
     {
         std::unordered_map<PublicKey, std::vector<uint32_t>> outputs;
+        KeyDerivation derivation;
         try
         {
-            findMyOutputs(tx, m_viewSecret, m_spendKeys, outputs);
+            findMyOutputs(tx, m_viewSecret, m_spendKeys, derivation, outputs);
         }
         catch (const std::exception &e)
         {
@@ -613,7 +611,7 @@ namespace CryptoNote
             {
                 auto &transfers = info.outputs[kv.first];
                 errorCode = createTransfers(
-                    it->second->getKeys(), blockInfo, tx, kv.second, info.globalIdxs, transfers, m_logger);
+                    it->second->getKeys(), blockInfo, tx, derivation, kv.second, info.globalIdxs, transfers, m_logger);
                 if (errorCode)
                 {
                     return errorCode;
@@ -16,6 +16,7 @@
 #include "logging/LoggerRef.h"
 
 #include <unordered_set>
+#include <utilities/ThreadPool.h>
 
 namespace CryptoNote
 {
@@ -28,7 +29,8 @@ namespace CryptoNote
             const CryptoNote::Currency &currency,
             INode &node,
             std::shared_ptr<Logging::ILogger> logger,
-            const Crypto::SecretKey &viewSecret);
+            const Crypto::SecretKey &viewSecret,
+            Utilities::ThreadPool<std::error_code> &workerPool);
 
         ITransfersSubscription &addSubscription(const AccountSubscription &subscription);
 
@@ -116,6 +118,10 @@ namespace CryptoNote
         const CryptoNote::Currency &m_currency;
 
         Logging::LoggerRef m_logger;
+
+        /* Shared by every consumer of the synchronizer, and used to scan the
+           transactions of each batch of blocks */
+        Utilities::ThreadPool<std::error_code> &m_workerPool;
     };
 
 } // namespace CryptoNote
@@ -14,6 +14,9 @@
 #include "serialization/BinaryInputStreamSerializer.h"
 #include "serialization/BinaryOutputStreamSerializer.h"
 
+#include <algorithm>
+#include <thread>
+
 using namespace Common;
 using namespace Crypto;
 
@@ -28,6 +31,7 @@ namespace CryptoNote
         INode &node):
         m_currency(currency),
         m_logger(logger, "TransfersSyncronizer"),
+        m_workerPool(std::max(1u, std::thread::hardware_concurrency())),
         m_sync(sync),
         m_node(node)
     {
@@ -57,7 +61,7 @@ namespace CryptoNote
         if (it == m_consumers.end())
         {
             std::unique_ptr<TransfersConsumer> consumer(
-                new TransfersConsumer(m_currency, m_node, m_logger.getLogger(), acc.keys.viewSecretKey));
+                new TransfersConsumer(m_currency, m_node, m_logger.getLogger(), acc.keys.viewSecretKey, m_workerPool));
 
             m_sync.addConsumer(consumer.get());
             consumer->addObserver(this);
@@ -16,6 +16,7 @@
 #include <cstring>
 #include <memory>
 #include <unordered_map>
+#include <utilities/ThreadPool.h>
 
 namespace CryptoNote
 {
@@ -73,6 +74,10 @@ namespace CryptoNote
       private:
         Logging::LoggerRef m_logger;
 
+        /* Scans blocks for every consumer, so a container with many view keys
+           doesn't start a set of threads per key for every batch of blocks */
+        Utilities::ThreadPool<std::error_code> m_workerPool;
+
         // map { view public key -> consumer }
         typedef std::unordered_map<Crypto::PublicKey, std::unique_ptr<TransfersConsumer>> ConsumersContainer;
 
@@ -87,6 +87,13 @@ namespace Utilities
                 return result;
             }
 
+            /* The amount of worker threads, useful for splitting work into
+               a suitable number of jobs */
+            uint64_t threadCount() const
+            {
+                return m_threadCount;
+            }
+
         private:
 
             //////////////////////////////
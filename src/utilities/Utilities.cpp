@@ -9,6 +9,7 @@
 #include <atomic>
 #include <common/Base58.h>
 #include <config/CryptoNoteConfig.h>
+#include <crypto/crypto.h>
 #include <thread>
 #include <utilities/String.h>
 
@@ -347,4 +348,43 @@ namespace Utilities
         return (transactionSize - headerSize - outputsSize) / inputSize;
     }
 
+    std::vector<std::tuple<uint64_t, Crypto::PublicKey>> findOwnedOutputs(
+        const WalletTypes::RawCoinbaseTransaction &rawTX,
+        const Crypto::SecretKey &privateViewKey,
+        const std::vector<Crypto::PublicKey> &publicSpendKeys)
+    {
+        std::vector<std::tuple<uint64_t, Crypto::PublicKey>> ownedOutputs;
+
+        Crypto::KeyDerivation derivation;
+
+        if (!Crypto::generate_key_derivation(rawTX.transactionPublicKey, privateViewKey, derivation))
+        {
+            return ownedOutputs;
+        }
+
+        uint64_t outputIndex = 0;
+
+        for (const auto &output : rawTX.keyOutputs)
+        {
+            Crypto::PublicKey derivedSpendKey;
+
+            /* Take the output key, and remove the derivation, leaving us
+               with the public spend key it was sent to */
+            if (Crypto::underive_public_key(derivation, outputIndex, output.key, derivedSpendKey))
+            {
+                /* See if the derived spend key matches any of our spend keys */
+                const auto ourSpendKey = std::find(publicSpendKeys.begin(), publicSpendKeys.end(), derivedSpendKey);
+
+                if (ourSpendKey != publicSpendKeys.end())
+                {
+                    ownedOutputs.emplace_back(outputIndex, derivedSpendKey);
+                }
+            }
+
+            outputIndex++;
+        }
+
+        return ownedOutputs;
+    }
+
 } // namespace Utilities
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <CryptoNote.h>
+#include <WalletTypes.h>
 #include <atomic>
 #include <chrono>
 #include <errors/Errors.h>
@@ -57,6 +58,14 @@ namespace Utilities
         const size_t outputCount,
         const size_t mixinCount);
 
+    /* Finds the outputs of a transaction which were sent to one of the given
+       public spend keys. Returns the index of each output in the transaction,
+       along with the spend key it belongs to. */
+    std::vector<std::tuple<uint64_t, Crypto::PublicKey>> findOwnedOutputs(
+        const WalletTypes::RawCoinbaseTransaction &rawTX,
+        const Crypto::SecretKey &privateViewKey,
+        const std::vector<Crypto::PublicKey> &publicSpendKeys);
+
     /* Verify that a + b will not overflow when added. */
     /* 2 positive numbers - should always get greater (or equal) when summed. */
     /* Any negative numbers - should always get smaller (or equal) when summed. */
@@ -31,12 +31,14 @@
 #include <cryptonotecore/TransactionApi.h>
 #include <ctime>
 #include <fstream>
+#include <future>
 #include <numeric>
 #include <random>
 #include <serialization/CryptoNoteSerialization.h>
 #include <set>
 #include <system/EventLock.h>
 #include <system/RemoteContext.h>
+#include <thread>
 #include <transfers/TransfersContainer.h>
 #include <tuple>
 #include <utilities/Addresses.h>
@@ -59,6 +61,14 @@ using namespace Logging;
 
 namespace
 {
+    /* Saves appended to the journal before a save writes the container out
+       in full again. The transfers synchronizer state is only written out in
+       full, so this bounds how far back a reloaded wallet rescans from. */
+    const uint64_t MAX_JOURNAL_RECORDS = 256;
+
+    /* Fewer keys than this aren't worth starting another thread for */
+    const size_t MIN_KEYS_PER_DERIVATION_THREAD = 256;
+
     void asyncRequestCompletion(System::Event &requestFinished)
     {
         requestFinished.set();
@@ -150,6 +160,7 @@ namespace CryptoNote
         m_node(node),
         m_logger(logger, "WalletGreen/empty"),
         m_stopped(false),
+        m_journal(&WalletSerializerV2::mergeJournalRecords),
         m_blockchainSynchronizerStarted(false),
         m_blockchainSynchronizer(node, logger, currency.genesisBlockHash()),
         m_synchronizer(currency, logger, m_blockchainSynchronizer, node),
@@ -158,7 +169,8 @@ namespace CryptoNote
         m_state(WalletState::NOT_INITIALIZED),
         m_actualBalance(0),
         m_pendingBalance(0),
-        m_transactionSoftLockTime(transactionSoftLockTime)
+        m_transactionSoftLockTime(transactionSoftLockTime),
+        m_journalNeedsSnapshot(true)
     {
         m_readyEvent.set();
     }
@@ -233,6 +245,7 @@ namespace CryptoNote
         stopBlockchainSynchronizer();
         m_blockchainSynchronizer.removeObserver(this);
 
+        m_journal.close();
         m_containerStorage.close();
         m_walletsContainer.clear();
 
@@ -289,6 +302,10 @@ namespace CryptoNote
             m_fusionTxsCache.clear();
             m_blockchain.clear();
         }
+
+        /* Whatever was cleared can't be journaled as individual changes */
+        m_changedTransactions.clear();
+        m_journalNeedsSnapshot = true;
     }
 
     void WalletGreen::decryptKeyPair(
@@ -441,11 +458,32 @@ namespace CryptoNote
         throwIfNotInitialized();
         throwIfStopped();
 
+        /* Appending to the journal doesn't touch the transfers synchronizer,
+           so it can keep running */
+        if (saveLevel == WalletSaveLevel::SAVE_ALL && !m_journalNeedsSnapshot && m_journal.isOpened()
+            && m_journal.sequence() < MAX_JOURNAL_RECORDS)
+        {
+            try
+            {
+                saveJournalRecord(extra);
+
+                /* Don't report the container saved until the record is on disk */
+                m_journal.flush();
+
+                m_logger(INFO, BRIGHT_WHITE) << "Container saved";
+                return;
+            }
+            catch (const std::exception &e)
+            {
+                m_logger(WARNING, BRIGHT_YELLOW) << "Failed to write container journal, saving in full: " << e.what();
+            }
+        }
+
         stopBlockchainSynchronizer();
 
         try
         {
-            saveWalletCache(m_containerStorage, m_key, saveLevel, extra);
+            saveSnapshot(saveLevel, extra);
         }
         catch (const std::exception &e)
         {
@@ -560,6 +598,7 @@ namespace CryptoNote
                     std::unordered_set<Crypto::PublicKey> addedSpendKeys;
                     std::unordered_set<Crypto::PublicKey> deletedSpendKeys;
                     loadWalletCache(addedSpendKeys, deletedSpendKeys, extra);
+                    loadJournal(path, extra);
 
                     if (!addedSpendKeys.empty())
                     {
@@ -578,7 +617,7 @@ namespace CryptoNote
 
                     if (!addedSpendKeys.empty() || !deletedSpendKeys.empty())
                     {
-                        saveWalletCache(m_containerStorage, m_key, WalletSaveLevel::SAVE_ALL, extra);
+                        saveSnapshot(WalletSaveLevel::SAVE_ALL, extra);
                     }
                 }
                 catch (const std::exception &e)
@@ -778,6 +817,125 @@ namespace CryptoNote
         m_logger(DEBUGGING) << "Container saving finished";
     }
 
+    void WalletGreen::saveSnapshot(WalletSaveLevel saveLevel, const std::string &extra)
+    {
+        saveWalletCache(m_containerStorage, m_key, saveLevel, extra);
+
+        resetJournal(saveLevel);
+    }
+
+    void WalletGreen::resetJournal(WalletSaveLevel saveLevel)
+    {
+        /* Everything journaled so far is in the snapshot now */
+        const Crypto::chacha8_iv baseIv = getContainerSuffixIv(m_containerStorage);
+
+        m_changedTransactions.clear();
+
+        try
+        {
+            if (m_journal.isOpened())
+            {
+                m_journal.reset(m_key, baseIv);
+            }
+            else
+            {
+                m_journal.open(m_path + ".journal", m_key, baseIv);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            m_logger(WARNING, BRIGHT_YELLOW) << "Failed to start container journal: " << e.what();
+            m_journalNeedsSnapshot = true;
+            return;
+        }
+
+        /* Journal records hold transactions, which a lesser save throws away */
+        m_journalNeedsSnapshot = saveLevel != WalletSaveLevel::SAVE_ALL;
+    }
+
+    void WalletGreen::saveJournalRecord(const std::string &extra)
+    {
+        std::string record;
+        Common::StringOutputStream recordStream(record);
+
+        WalletSerializerV2 s(
+            *this,
+            m_viewPublicKey,
+            m_viewSecretKey,
+            m_actualBalance,
+            m_pendingBalance,
+            m_walletsContainer,
+            m_synchronizer,
+            m_unlockTransactionsJob,
+            m_transactions,
+            m_transfers,
+            m_uncommitedTransactions,
+            const_cast<std::string &>(extra),
+            m_transactionSoftLockTime);
+
+        s.saveJournalRecord(recordStream, m_changedTransactions);
+
+        m_journal.append(std::move(record));
+
+        m_changedTransactions.clear();
+        m_extra = extra;
+
+        m_logger(DEBUGGING) << "Container journal record " << m_journal.sequence() << " written";
+    }
+
+    void WalletGreen::loadJournal(const std::string &path, std::string &extra)
+    {
+        std::vector<std::string> records;
+
+        try
+        {
+            records = m_journal.open(path + ".journal", m_key, getContainerSuffixIv(m_containerStorage));
+        }
+        catch (const std::exception &e)
+        {
+            m_logger(WARNING, BRIGHT_YELLOW) << "Failed to open container journal: " << e.what();
+            m_journalNeedsSnapshot = true;
+            return;
+        }
+
+        WalletSerializerV2 s(
+            *this,
+            m_viewPublicKey,
+            m_viewSecretKey,
+            m_actualBalance,
+            m_pendingBalance,
+            m_walletsContainer,
+            m_synchronizer,
+            m_unlockTransactionsJob,
+            m_transactions,
+            m_transfers,
+            m_uncommitedTransactions,
+            extra,
+            m_transactionSoftLockTime);
+
+        for (const auto &record : records)
+        {
+            Common::MemoryInputStream recordStream(record.data(), record.size());
+            s.loadJournalRecord(recordStream);
+        }
+
+        m_changedTransactions.clear();
+        m_journalNeedsSnapshot = false;
+
+        m_logger(DEBUGGING) << "Container journal replayed, " << records.size() << " records";
+    }
+
+    Crypto::chacha8_iv WalletGreen::getContainerSuffixIv(ContainerStorage &storage)
+    {
+        Common::MemoryInputStream suffixStream(storage.suffix(), storage.suffixSize());
+        BinaryInputStreamSerializer suffixSerializer(suffixStream);
+
+        Crypto::chacha8_iv suffixIv;
+        suffixSerializer(suffixIv, "suffixIv");
+
+        return suffixIv;
+    }
+
     void WalletGreen::copyContainerStorageKeys(
         ContainerStorage &src,
         const chacha8_key &srcKey,
@@ -1031,21 +1189,35 @@ namespace CryptoNote
         Crypto::chacha8_key newKey;
         Crypto::generate_chacha8_key(newPassword, newKey);
 
-        m_containerStorage.atomicUpdate([this, newKey](ContainerStorage &newStorage) {
-            copyContainerStoragePrefix(m_containerStorage, m_key, newStorage, newKey);
-            copyContainerStorageKeys(m_containerStorage, m_key, newStorage, newKey);
+        stopBlockchainSynchronizer();
 
-            if (m_containerStorage.suffixSize() > 0)
-            {
-                BinaryArray containerData;
-                loadAndDecryptContainerData(m_containerStorage, m_key, containerData);
-                encryptAndSaveContainerData(newStorage, newKey, containerData.data(), containerData.size());
-            }
-        });
+        try
+        {
+            /* Write the cache out in full under the new key, rather than
+               re-encrypting the old snapshot, so it takes in everything
+               journaled since. A crash before the journal is reset below
+               then only leaves behind a journal for the old snapshot, which
+               is dropped on load without losing anything. */
+            m_containerStorage.atomicUpdate([this, newKey](ContainerStorage &newStorage) {
+                copyContainerStoragePrefix(m_containerStorage, m_key, newStorage, newKey);
+                copyContainerStorageKeys(m_containerStorage, m_key, newStorage, newKey);
+                saveWalletCache(newStorage, newKey, WalletSaveLevel::SAVE_ALL, m_extra);
+            });
+        }
+        catch (const std::exception &e)
+        {
+            m_logger(ERROR, BRIGHT_RED) << "Failed to change password: " << e.what();
+            startBlockchainSynchronizer();
+            throw;
+        }
 
         m_key = newKey;
         m_password = newPassword;
 
+        resetJournal(WalletSaveLevel::SAVE_ALL);
+
+        startBlockchainSynchronizer();
+
         m_logger(INFO, BRIGHT_WHITE) << "Container password changed";
     }
 
@@ -1159,20 +1331,48 @@ namespace CryptoNote
     {
         std::vector<NewAddressData> addressDataList(spendSecretKeys.size());
 
-        for (size_t i = 0; i < spendSecretKeys.size(); ++i)
+        /* Returns the index of the first key that isn't valid, or end */
+        const auto deriveKeys = [&spendSecretKeys, &addressDataList](const size_t start, const size_t end) {
+            for (size_t i = start; i < end; ++i)
+            {
+                if (!Crypto::secret_key_to_public_key(spendSecretKeys[i], addressDataList[i].spendPublicKey))
+                {
+                    return i;
+                }
+
+                addressDataList[i].spendSecretKey = spendSecretKeys[i];
+            }
+
+            return end;
+        };
+
+        /* Deriving the public keys is most of the work of importing a big
+           list, and each key is independent, so split them across our cores */
+        const size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+        const size_t chunkSize = std::max<size_t>(
+            MIN_KEYS_PER_DERIVATION_THREAD, (spendSecretKeys.size() + threadCount - 1) / threadCount);
+
+        std::vector<std::pair<size_t, std::future<size_t>>> results;
+
+        for (size_t start = 0; start < spendSecretKeys.size(); start += chunkSize)
+        {
+            const size_t end = std::min(start + chunkSize, spendSecretKeys.size());
+
+            results.emplace_back(end, std::async(std::launch::async, deriveKeys, start, end));
+        }
+
+        for (auto &[end, result] : results)
         {
-            Crypto::PublicKey spendPublicKey;
+            const size_t invalid = result.get();
 
-            if (!Crypto::secret_key_to_public_key(spendSecretKeys[i], spendPublicKey))
+            if (invalid != end)
             {
                 m_logger(ERROR, BRIGHT_RED)
                     << "createAddressList(): failed to convert secret key to public key, secret key "
-                    << spendSecretKeys[i];
+                    << spendSecretKeys[invalid];
                 throw std::system_error(make_error_code(CryptoNote::error::KEY_GENERATION_ERROR));
             }
-
-            addressDataList[i].spendSecretKey = spendSecretKeys[i];
-            addressDataList[i].spendPublicKey = spendPublicKey;
         }
 
         return doCreateAddressList(addressDataList, scanHeight, newAddress);
@@ -1348,6 +1548,8 @@ namespace CryptoNote
             index.insert(insertIt, std::move(wallet));
             m_logger(DEBUGGING) << "Wallet count " << m_walletsContainer.size();
 
+            m_journalNeedsSnapshot = true;
+
             if (index.size() == 1)
             {
                 m_synchronizer.subscribeConsumerNotifications(m_viewPublicKey, this);
@@ -1517,6 +1719,8 @@ namespace CryptoNote
         m_walletsContainer.get<KeysIndex>().erase(it);
         m_logger(DEBUGGING) << "Wallet count " << m_walletsContainer.size();
 
+        m_journalNeedsSnapshot = true;
+
         if (m_walletsContainer.get<RandomAccessIndex>().size() != 0)
         {
             startBlockchainSynchronizer();
@@ -3720,6 +3924,15 @@ namespace CryptoNote
 
     void WalletGreen::pushEvent(const WalletEvent &event)
     {
+        if (event.type == WalletEventType::TRANSACTION_CREATED)
+        {
+            m_changedTransactions.insert(event.transactionCreated.transactionIndex);
+        }
+        else if (event.type == WalletEventType::TRANSACTION_UPDATED)
+        {
+            m_changedTransactions.insert(event.transactionUpdated.transactionIndex);
+        }
+
         m_events.push(event);
         m_eventOccurred.set();
     }
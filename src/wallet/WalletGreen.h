@@ -10,8 +10,10 @@
 #include "logging/LoggerRef.h"
 #include "transfers/BlockchainSynchronizer.h"
 #include "transfers/TransfersSynchronizer.h"
+#include "wallet/WalletJournal.h"
 
 #include <queue>
+#include <set>
 #include <system/Dispatcher.h>
 #include <system/Event.h>
 #include <unordered_map>
@@ -560,6 +562,21 @@ namespace CryptoNote
             WalletSaveLevel saveLevel,
             const std::string &extra);
 
+        /* Writes the cache out in full and starts a new journal on top of it */
+        void saveSnapshot(WalletSaveLevel saveLevel, const std::string &extra);
+
+        /* Starts a new journal on top of the cache just written to m_containerStorage */
+        void resetJournal(WalletSaveLevel saveLevel);
+
+        /* Appends the transactions changed since the last save to the journal */
+        void saveJournalRecord(const std::string &extra);
+
+        /* Replays the journal written on top of the loaded cache */
+        void loadJournal(const std::string &path, std::string &extra);
+
+        /* The iv the container cache was encrypted with, which identifies it */
+        static Crypto::chacha8_iv getContainerSuffixIv(ContainerStorage &storage);
+
         void subscribeWallets();
 
         std::vector<OutputToTransfer> pickRandomFusionInputs(
@@ -648,6 +665,8 @@ namespace CryptoNote
 
         ContainerStorage m_containerStorage;
 
+        WalletJournal m_journal;
+
         UnlockTransactionJobs m_unlockTransactionsJob;
 
         WalletTransactions m_transactions;
@@ -690,6 +709,13 @@ namespace CryptoNote
 
         BlockHashesContainer m_blockchain;
 
+        /* Indexes of the transactions changed since the last save */
+        std::set<size_t> m_changedTransactions;
+
+        /* Set by changes the journal can't hold, such as adding an address,
+           so the next save writes the container out in full */
+        bool m_journalNeedsSnapshot;
+
         friend std::ostream &operator<<(std::ostream &os, CryptoNote::WalletGreen::WalletState state);
 
         friend std::ostream &operator<<(std::ostream &os, CryptoNote::WalletGreen::WalletTrackingMode mode);
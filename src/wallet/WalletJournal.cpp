@@ -0,0 +1,499 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "WalletJournal.h"
+
+#include <algorithm>
+#include <common/FileSystemShim.h>
+#include <common/MemoryInputStream.h>
+#include <common/StreamTools.h>
+#include <common/StringOutputStream.h>
+#include <cstring>
+#include <crypto/hash.h>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const char JOURNAL_MAGIC[8] = {'W', 'R', 'K', 'Z', 'J', 'R', 'N', 'L'};
+
+    const uint8_t JOURNAL_VERSION = 2;
+
+    const uint64_t HEADER_SIZE = sizeof(JOURNAL_MAGIC) + sizeof(JOURNAL_VERSION) + sizeof(Crypto::chacha8_iv);
+
+    /* Size, sequence and iv */
+    const uint64_t RECORD_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(Crypto::chacha8_iv);
+
+    /* Don't bother compacting a journal smaller than this */
+    const uint64_t MIN_COMPACTION_SIZE = 1024 * 1024;
+
+    void throwIfFailed(const bool success, const std::string &path)
+    {
+        if (!success)
+        {
+            throw std::runtime_error("Failed to write wallet journal " + path);
+        }
+    }
+
+    std::FILE *openFile(const std::string &path, const char *mode)
+    {
+        std::FILE *file = std::fopen(path.c_str(), mode);
+
+        throwIfFailed(file != nullptr, path);
+
+        return file;
+    }
+
+    void writeFile(std::FILE *file, const std::string &data, const std::string &path)
+    {
+        throwIfFailed(std::fwrite(data.data(), 1, data.size(), file) == data.size(), path);
+    }
+
+    /* Pushes what has been written all the way to the disk, not just to the
+       OS, so it survives a power cut as well as a crash */
+    void syncFile(std::FILE *file, const std::string &path)
+    {
+        throwIfFailed(std::fflush(file) == 0, path);
+
+#ifdef _WIN32
+        throwIfFailed(_commit(_fileno(file)) == 0, path);
+#else
+        throwIfFailed(::fsync(fileno(file)) == 0, path);
+#endif
+    }
+
+    /* Makes a file created or renamed into path stick, as the directory entry
+       is written separately from the file itself. Windows has no way to sync
+       a directory, nor a need to. */
+    void syncDirectory(const std::string &path)
+    {
+#ifndef _WIN32
+        std::string directory = fs::path(path).parent_path().string();
+
+        if (directory.empty())
+        {
+            directory = ".";
+        }
+
+        const int fd = ::open(directory.c_str(), O_RDONLY);
+
+        throwIfFailed(fd != -1, path);
+
+        const bool synced = ::fsync(fd) == 0;
+
+        ::close(fd);
+
+        throwIfFailed(synced, path);
+#endif
+    }
+
+    bool readFile(const std::string &path, std::string &contents)
+    {
+        std::ifstream file(path, std::ios_base::binary);
+
+        if (!file)
+        {
+            return false;
+        }
+
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+        return true;
+    }
+
+    std::string makeHeader(const Crypto::chacha8_iv &baseIv)
+    {
+        std::string header;
+        Common::StringOutputStream stream(header);
+
+        Common::write(stream, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+        Common::write(stream, JOURNAL_VERSION);
+        Common::write(stream, &baseIv, sizeof(baseIv));
+
+        return header;
+    }
+} // namespace
+
+namespace CryptoNote
+{
+    WalletJournal::WalletJournal(MergeFunction merge): m_merge(std::move(merge)) {}
+
+    WalletJournal::~WalletJournal()
+    {
+        try
+        {
+            close();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    std::vector<std::string> WalletJournal::open(
+        const std::string &path,
+        const Crypto::chacha8_key &key,
+        const Crypto::chacha8_iv &baseIv)
+    {
+        close();
+
+        m_path = path;
+        m_key = key;
+        m_baseIv = baseIv;
+        m_sequence = 0;
+        m_error = nullptr;
+
+        std::vector<PendingRecord> records;
+        uint64_t validSize = 0;
+
+        if (readRecords(records, validSize))
+        {
+            /* Cut off a record torn by a crash, or it would hide everything
+               appended after it */
+            fs::resize_file(m_path, validSize);
+            openForAppend();
+
+            m_fileSize = validSize;
+
+            if (!records.empty())
+            {
+                m_sequence = records.back().sequence;
+            }
+        }
+        else
+        {
+            createFile();
+        }
+
+        m_compactedSize = m_fileSize;
+        m_stop = false;
+        m_opened = true;
+        m_writer = std::thread(&WalletJournal::writerLoop, this);
+
+        std::vector<std::string> result;
+        result.reserve(records.size());
+
+        for (auto &record : records)
+        {
+            result.push_back(std::move(record.data));
+        }
+
+        return result;
+    }
+
+    void WalletJournal::close()
+    {
+        if (!m_opened)
+        {
+            return;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+
+        m_haveRecords.notify_one();
+
+        /* The writer drains the queue before it exits */
+        m_writer.join();
+
+        closeFile();
+        m_opened = false;
+    }
+
+    bool WalletJournal::isOpened() const
+    {
+        return m_opened;
+    }
+
+    void WalletJournal::append(std::string record)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            if (m_error)
+            {
+                std::rethrow_exception(m_error);
+            }
+
+            m_queue.push_back({++m_sequence, std::move(record)});
+        }
+
+        m_haveRecords.notify_one();
+    }
+
+    void WalletJournal::flush()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        waitIdle(lock);
+
+        if (m_error)
+        {
+            std::rethrow_exception(m_error);
+        }
+    }
+
+    void WalletJournal::reset(const Crypto::chacha8_key &key, const Crypto::chacha8_iv &baseIv)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        waitIdle(lock);
+
+        m_key = key;
+        m_baseIv = baseIv;
+        m_sequence = 0;
+        m_error = nullptr;
+
+        createFile();
+
+        m_compactedSize = m_fileSize;
+    }
+
+    uint64_t WalletJournal::sequence() const
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_sequence;
+    }
+
+    void WalletJournal::waitIdle(std::unique_lock<std::mutex> &lock)
+    {
+        m_idle.wait(lock, [this] { return m_queue.empty() && !m_busy; });
+    }
+
+    void WalletJournal::writerLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (true)
+        {
+            m_haveRecords.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+
+            if (m_queue.empty())
+            {
+                break;
+            }
+
+            std::deque<PendingRecord> records;
+            records.swap(m_queue);
+
+            /* Once a write has failed the file may end in a partial record,
+               and nothing appended after it would be read back */
+            if (m_error)
+            {
+                m_idle.notify_all();
+                continue;
+            }
+
+            m_busy = true;
+            lock.unlock();
+
+            std::exception_ptr error;
+
+            try
+            {
+                for (const auto &record : records)
+                {
+                    writeRecord(m_file, m_path, record.sequence, record.data);
+                }
+
+                syncFile(m_file, m_path);
+
+                if (m_fileSize >= std::max(MIN_COMPACTION_SIZE, m_compactedSize * 2))
+                {
+                    compact();
+                }
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            lock.lock();
+
+            m_busy = false;
+
+            if (error && !m_error)
+            {
+                m_error = error;
+            }
+
+            m_idle.notify_all();
+        }
+    }
+
+    void WalletJournal::createFile()
+    {
+        closeFile();
+
+        m_file = openFile(m_path, "wb");
+        m_fileSize = HEADER_SIZE;
+
+        writeFile(m_file, makeHeader(m_baseIv), m_path);
+        syncFile(m_file, m_path);
+        syncDirectory(m_path);
+    }
+
+    void WalletJournal::openForAppend()
+    {
+        closeFile();
+
+        m_file = openFile(m_path, "ab");
+    }
+
+    void WalletJournal::closeFile()
+    {
+        if (m_file != nullptr)
+        {
+            std::fclose(m_file);
+            m_file = nullptr;
+        }
+    }
+
+    void WalletJournal::writeRecord(
+        std::FILE *file,
+        const std::string &path,
+        const uint64_t sequence,
+        const std::string &data)
+    {
+        const Crypto::chacha8_iv iv = Crypto::randomChachaIV();
+
+        std::string frame;
+        frame.reserve(RECORD_HEADER_SIZE + data.size() + sizeof(Crypto::Hash));
+
+        Common::StringOutputStream frameStream(frame);
+        Common::write(frameStream, static_cast<uint32_t>(data.size()));
+        Common::write(frameStream, sequence);
+        Common::write(frameStream, &iv, sizeof(iv));
+
+        frame.resize(RECORD_HEADER_SIZE + data.size());
+        Crypto::chacha8(data.data(), data.size(), m_key, iv, &frame[RECORD_HEADER_SIZE]);
+
+        const Crypto::Hash checksum = Crypto::cn_fast_hash(frame.data(), frame.size());
+        Common::write(frameStream, &checksum, sizeof(checksum));
+
+        writeFile(file, frame, path);
+
+        m_fileSize += frame.size();
+    }
+
+    void WalletJournal::compact()
+    {
+        std::vector<PendingRecord> records;
+        uint64_t validSize = 0;
+
+        if (!readRecords(records, validSize) || records.size() < 2)
+        {
+            m_compactedSize = m_fileSize;
+            return;
+        }
+
+        std::vector<std::string> data;
+        data.reserve(records.size());
+
+        for (auto &record : records)
+        {
+            data.push_back(std::move(record.data));
+        }
+
+        const std::string merged = m_merge(data);
+
+        const std::string tmpPath = m_path + ".tmp";
+
+        std::FILE *file = openFile(tmpPath, "wb");
+
+        try
+        {
+            writeFile(file, makeHeader(m_baseIv), tmpPath);
+
+            m_fileSize = HEADER_SIZE;
+            writeRecord(file, tmpPath, records.back().sequence, merged);
+
+            /* The merged file has to be on disk before it replaces the old
+               one, or a crash could leave an empty journal in its place */
+            syncFile(file, tmpPath);
+        }
+        catch (...)
+        {
+            std::fclose(file);
+            throw;
+        }
+
+        std::fclose(file);
+
+        closeFile();
+        fs::rename(tmpPath, m_path);
+        syncDirectory(m_path);
+        openForAppend();
+
+        m_compactedSize = m_fileSize;
+    }
+
+    bool WalletJournal::readRecords(std::vector<PendingRecord> &records, uint64_t &validSize) const
+    {
+        std::string contents;
+
+        if (!readFile(m_path, contents) || contents.size() < HEADER_SIZE)
+        {
+            return false;
+        }
+
+        if (contents.compare(0, HEADER_SIZE, makeHeader(m_baseIv)) != 0)
+        {
+            return false;
+        }
+
+        uint64_t position = HEADER_SIZE;
+
+        while (contents.size() - position >= RECORD_HEADER_SIZE)
+        {
+            Common::MemoryInputStream stream(contents.data() + position, contents.size() - position);
+
+            uint32_t size;
+            uint64_t sequence;
+            Crypto::chacha8_iv iv;
+
+            Common::read(stream, size);
+            Common::read(stream, sequence);
+            Common::read(stream, &iv, sizeof(iv));
+
+            const uint64_t frameSize = RECORD_HEADER_SIZE + size;
+
+            if (contents.size() - position < frameSize + sizeof(Crypto::Hash))
+            {
+                break;
+            }
+
+            const Crypto::Hash checksum = Crypto::cn_fast_hash(contents.data() + position, frameSize);
+
+            if (std::memcmp(&checksum, contents.data() + position + frameSize, sizeof(checksum)) != 0)
+            {
+                break;
+            }
+
+            PendingRecord record;
+            record.sequence = sequence;
+            record.data.resize(size);
+
+            Crypto::chacha8(contents.data() + position + RECORD_HEADER_SIZE, size, m_key, iv, &record.data[0]);
+
+            records.push_back(std::move(record));
+
+            position += frameSize + sizeof(Crypto::Hash);
+        }
+
+        validSize = position;
+
+        return true;
+    }
+
+} // namespace CryptoNote
@@ -0,0 +1,147 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <condition_variable>
+#include <crypto/chacha8.h>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace CryptoNote
+{
+    /* An append only log of the changes made to a wallet container since its
+       cache was last written out in full. Saving then only has to append the
+       few transactions that changed, instead of rewriting a cache that can
+       run into gigabytes.
+
+       The journal lives beside the container and is tied to one snapshot of
+       the container cache by the iv that snapshot was encrypted with, so a
+       journal left over from an older snapshot is never replayed on top of a
+       newer one. Each record is encrypted with the wallet key under its own
+       random iv, and checksummed, so a record torn by a crash is dropped
+       along with anything after it.
+
+       Records are encrypted and written on a background thread. Once the
+       file has grown enough, the same thread merges every record into one
+       and swaps it in for the old file. */
+    class WalletJournal
+    {
+      public:
+        /* Merges records, oldest first, into one record holding the same
+           changes. Called on the writer thread. */
+        typedef std::function<std::string(const std::vector<std::string> &records)> MergeFunction;
+
+        explicit WalletJournal(MergeFunction merge);
+
+        ~WalletJournal();
+
+        WalletJournal(const WalletJournal &) = delete;
+
+        WalletJournal &operator=(const WalletJournal &) = delete;
+
+        /* Opens the journal at path, creating it if needed, and returns the
+           records written against the snapshot encrypted with baseIv, oldest
+           first. A journal belonging to another snapshot is emptied. */
+        std::vector<std::string> open(
+            const std::string &path,
+            const Crypto::chacha8_key &key,
+            const Crypto::chacha8_iv &baseIv);
+
+        /* Writes out anything still queued, then closes the file */
+        void close();
+
+        bool isOpened() const;
+
+        /* Queues a record to be written. Throws if an earlier write failed,
+           in which case the journal can't be trusted until it is reset. */
+        void append(std::string record);
+
+        /* Blocks until every queued record has been written and synced to
+           disk, throwing if any of them couldn't be */
+        void flush();
+
+        /* Drops every record, once the container has been written out in
+           full under key as the snapshot encrypted with baseIv */
+        void reset(const Crypto::chacha8_key &key, const Crypto::chacha8_iv &baseIv);
+
+        /* How many records have been appended since the last snapshot */
+        uint64_t sequence() const;
+
+      private:
+        struct PendingRecord
+        {
+            uint64_t sequence;
+
+            std::string data;
+        };
+
+        /* Waits for the writer to go idle. Expects m_mutex held. */
+        void waitIdle(std::unique_lock<std::mutex> &lock);
+
+        void writerLoop();
+
+        /* Starts an empty journal based on m_baseIv */
+        void createFile();
+
+        void openForAppend();
+
+        void closeFile();
+
+        void writeRecord(std::FILE *file, const std::string &path, uint64_t sequence, const std::string &data);
+
+        /* Merges every record into one, swapping the merged file in for the
+           old one */
+        void compact();
+
+        /* Reads the records written against m_baseIv. Returns false if the
+           file is missing or belongs to another snapshot. validSize is set to
+           the length of the file up to the first bad record. */
+        bool readRecords(std::vector<PendingRecord> &records, uint64_t &validSize) const;
+
+        const MergeFunction m_merge;
+
+        std::string m_path;
+
+        Crypto::chacha8_key m_key;
+
+        Crypto::chacha8_iv m_baseIv;
+
+        /* Only touched by the writer thread, or with the writer idle */
+        std::FILE *m_file = nullptr;
+
+        uint64_t m_fileSize = 0;
+
+        /* File size just after the last compaction */
+        uint64_t m_compactedSize = 0;
+
+        uint64_t m_sequence = 0;
+
+        bool m_opened = false;
+
+        std::deque<PendingRecord> m_queue;
+
+        bool m_busy = false;
+
+        bool m_stop = false;
+
+        /* The first write that failed since the journal was last reset */
+        std::exception_ptr m_error;
+
+        mutable std::mutex m_mutex;
+
+        std::condition_variable m_haveRecords;
+
+        std::condition_variable m_idle;
+
+        std::thread m_writer;
+    };
+
+} // namespace CryptoNote
@@ -5,10 +5,15 @@
 
 #include "WalletSerializationV2.h"
 
+#include "common/MemoryInputStream.h"
+#include "common/StringOutputStream.h"
 #include "serialization/BinaryInputStreamSerializer.h"
 #include "serialization/BinaryOutputStreamSerializer.h"
 #include "serialization/CryptoNoteSerialization.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 using namespace Common;
 using namespace Crypto;
 
@@ -81,6 +86,81 @@ namespace
         uint8_t type;
     };
 
+    /* A transaction along with all of its transfers */
+    struct JournalTransactionDto
+    {
+        WalletTransactionDtoV2 transaction;
+
+        std::vector<WalletTransferDtoV2> transfers;
+    };
+
+    /* Uncommited transactions are keyed by transaction index in the wallet,
+       which isn't stable across saves, so the journal keys them by hash */
+    struct UncommitedTransactionDto
+    {
+        Hash transactionHash;
+
+        CryptoNote::Transaction transaction;
+    };
+
+    /* Everything a journal record holds: the transactions that changed, and
+       the current value of everything small enough to write out in full.
+       Balances and unlock jobs follow the transfers synchronizer state, which
+       only a full save writes out, so they are left to the rescan. */
+    struct JournalRecordDto
+    {
+        std::vector<JournalTransactionDto> transactions;
+
+        std::vector<UncommitedTransactionDto> uncommitedTransactions;
+
+        std::string extra;
+    };
+
+    CryptoNote::WalletTransaction toWalletTransaction(const WalletTransactionDtoV2 &dto)
+    {
+        CryptoNote::WalletTransaction tx;
+        tx.state = dto.state;
+        tx.timestamp = dto.timestamp;
+        tx.blockHeight = dto.blockHeight;
+        tx.hash = dto.hash;
+        tx.totalAmount = dto.totalAmount;
+        tx.fee = dto.fee;
+        tx.creationTime = dto.creationTime;
+        tx.unlockTime = dto.unlockTime;
+        tx.extra = dto.extra;
+        tx.isBase = dto.isBase;
+
+        return tx;
+    }
+
+    CryptoNote::WalletTransfer toWalletTransfer(const WalletTransferDtoV2 &dto)
+    {
+        CryptoNote::WalletTransfer tr;
+        tr.address = dto.address;
+        tr.amount = dto.amount;
+        tr.type = static_cast<CryptoNote::WalletTransferType>(dto.type);
+
+        return tr;
+    }
+
+    /* The transfers of a transaction, transfers being sorted by transaction */
+    std::pair<CryptoNote::WalletTransfers::iterator, CryptoNote::WalletTransfers::iterator>
+        transfersOf(CryptoNote::WalletTransfers &transfers, const uint64_t transactionId)
+    {
+        auto first = std::lower_bound(
+            transfers.begin(),
+            transfers.end(),
+            transactionId,
+            [](const CryptoNote::TransactionTransferPair &pair, uint64_t id) { return pair.first < id; });
+
+        auto last = std::upper_bound(
+            first, transfers.end(), transactionId, [](uint64_t id, const CryptoNote::TransactionTransferPair &pair) {
+                return id < pair.first;
+            });
+
+        return {first, last};
+    }
+
     void serialize(UnlockTransactionJobDtoV2 &value, CryptoNote::ISerializer &serializer)
     {
         serializer(value.blockHeight, "blockHeight");
@@ -114,6 +194,43 @@ namespace
         serializer(value.type, "type");
     }
 
+    template<typename T>
+    void serializeList(
+        std::vector<T> &list,
+        Common::StringView countName,
+        Common::StringView itemName,
+        CryptoNote::ISerializer &serializer)
+    {
+        uint64_t count = list.size();
+        serializer(count, countName);
+
+        list.resize(count);
+
+        for (auto &item : list)
+        {
+            serializer(item, itemName);
+        }
+    }
+
+    void serialize(JournalTransactionDto &value, CryptoNote::ISerializer &serializer)
+    {
+        serializer(value.transaction, "transaction");
+        serializeList(value.transfers, "transferCount", "transfer", serializer);
+    }
+
+    void serialize(UncommitedTransactionDto &value, CryptoNote::ISerializer &serializer)
+    {
+        serializer(value.transactionHash, "transactionHash");
+        serializer(value.transaction, "transaction");
+    }
+
+    void serialize(JournalRecordDto &value, CryptoNote::ISerializer &serializer)
+    {
+        serializeList(value.transactions, "transactionCount", "transaction", serializer);
+        serializeList(value.uncommitedTransactions, "uncommitedTransactionsCount", "uncommitedTransaction", serializer);
+        serializer(value.extra, "extra");
+    }
+
 } // namespace
 
 namespace CryptoNote
@@ -195,6 +312,153 @@ namespace CryptoNote
         s(m_extra, "extra");
     }
 
+    void WalletSerializerV2::saveJournalRecord(
+        Common::IOutputStream &destination,
+        const std::set<size_t> &changedTransactions)
+    {
+        JournalRecordDto record;
+
+        const auto &transactions = m_transactions.get<RandomAccessIndex>();
+
+        for (const size_t transactionId : changedTransactions)
+        {
+            JournalTransactionDto dto;
+            dto.transaction = WalletTransactionDtoV2(transactions[transactionId]);
+
+            const auto [first, last] = transfersOf(m_transfers, transactionId);
+
+            for (auto it = first; it != last; ++it)
+            {
+                dto.transfers.emplace_back(it->second);
+            }
+
+            record.transactions.push_back(std::move(dto));
+        }
+
+        for (const auto &[transactionId, transaction] : m_uncommitedTransactions)
+        {
+            record.uncommitedTransactions.push_back({transactions[transactionId].hash, transaction});
+        }
+
+        record.extra = m_extra;
+
+        CryptoNote::BinaryOutputStreamSerializer s(destination);
+        s(record, "journalRecord");
+    }
+
+    void WalletSerializerV2::loadJournalRecord(Common::IInputStream &source)
+    {
+        JournalRecordDto record;
+
+        CryptoNote::BinaryInputStreamSerializer s(source);
+        s(record, "journalRecord");
+
+        auto &hashIndex = m_transactions.get<TransactionIndex>();
+        auto &randomIndex = m_transactions.get<RandomAccessIndex>();
+
+        for (const auto &dto : record.transactions)
+        {
+            size_t transactionId;
+
+            auto it = hashIndex.find(dto.transaction.hash);
+
+            if (it != hashIndex.end())
+            {
+                hashIndex.replace(it, toWalletTransaction(dto.transaction));
+                transactionId = std::distance(randomIndex.begin(), m_transactions.project<RandomAccessIndex>(it));
+            }
+            /* Deleted transactions are left out of the container, so there is
+               nothing to update */
+            else if (dto.transaction.state == WalletTransactionState::DELETED)
+            {
+                continue;
+            }
+            else
+            {
+                randomIndex.push_back(toWalletTransaction(dto.transaction));
+                transactionId = randomIndex.size() - 1;
+            }
+
+            const auto [first, last] = transfersOf(m_transfers, transactionId);
+
+            WalletTransfers transfers;
+
+            for (const auto &transfer : dto.transfers)
+            {
+                transfers.emplace_back(transactionId, toWalletTransfer(transfer));
+            }
+
+            if (static_cast<size_t>(std::distance(first, last)) == transfers.size())
+            {
+                std::move(transfers.begin(), transfers.end(), first);
+            }
+            else
+            {
+                m_transfers.insert(m_transfers.erase(first, last), transfers.begin(), transfers.end());
+            }
+        }
+
+        m_uncommitedTransactions.clear();
+
+        for (const auto &dto : record.uncommitedTransactions)
+        {
+            auto it = hashIndex.find(dto.transactionHash);
+
+            if (it != hashIndex.end())
+            {
+                const size_t transactionId =
+                    std::distance(randomIndex.begin(), m_transactions.project<RandomAccessIndex>(it));
+
+                m_uncommitedTransactions.emplace(transactionId, dto.transaction);
+            }
+        }
+
+        m_extra = record.extra;
+    }
+
+    std::string WalletSerializerV2::mergeJournalRecords(const std::vector<std::string> &records)
+    {
+        JournalRecordDto merged;
+
+        /* Where each transaction is in the merged record */
+        std::unordered_map<Hash, size_t> positions;
+
+        for (const auto &data : records)
+        {
+            JournalRecordDto record;
+
+            Common::MemoryInputStream stream(data.data(), data.size());
+            CryptoNote::BinaryInputStreamSerializer s(stream);
+            s(record, "journalRecord");
+
+            for (auto &dto : record.transactions)
+            {
+                const auto [it, inserted] = positions.emplace(dto.transaction.hash, merged.transactions.size());
+
+                if (inserted)
+                {
+                    merged.transactions.push_back(std::move(dto));
+                }
+                else
+                {
+                    merged.transactions[it->second] = std::move(dto);
+                }
+            }
+
+            /* Everything else is written out in full each time */
+            merged.uncommitedTransactions = std::move(record.uncommitedTransactions);
+            merged.extra = std::move(record.extra);
+        }
+
+        std::string result;
+        Common::StringOutputStream stream(result);
+
+        CryptoNote::BinaryOutputStreamSerializer s(stream);
+        s(merged, "journalRecord");
+
+        return result;
+    }
+
     std::unordered_set<Crypto::PublicKey> &WalletSerializerV2::addedKeys()
     {
         return m_addedKeys;
@@ -285,19 +549,7 @@ namespace CryptoNote
             WalletTransactionDtoV2 dto;
             serializer(dto, "transaction");
 
-            WalletTransaction tx;
-            tx.state = dto.state;
-            tx.timestamp = dto.timestamp;
-            tx.blockHeight = dto.blockHeight;
-            tx.hash = dto.hash;
-            tx.totalAmount = dto.totalAmount;
-            tx.fee = dto.fee;
-            tx.creationTime = dto.creationTime;
-            tx.unlockTime = dto.unlockTime;
-            tx.extra = dto.extra;
-            tx.isBase = dto.isBase;
-
-            m_transactions.get<RandomAccessIndex>().push_back(std::move(tx));
+            m_transactions.get<RandomAccessIndex>().push_back(toWalletTransaction(dto));
         }
     }
 
@@ -328,13 +580,8 @@ namespace CryptoNote
             WalletTransferDtoV2 dto;
             serializer(dto, "transfer");
 
-            WalletTransfer tr;
-            tr.address = dto.address;
-            tr.amount = dto.amount;
-            tr.type = static_cast<WalletTransferType>(dto.type);
-
             m_transfers.emplace_back(
-                std::piecewise_construct, std::forward_as_tuple(txId), std::forward_as_tuple(std::move(tr)));
+                std::piecewise_construct, std::forward_as_tuple(txId), std::forward_as_tuple(toWalletTransfer(dto)));
         }
     }
 
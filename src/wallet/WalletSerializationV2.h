@@ -11,6 +11,10 @@
 #include "transfers/TransfersSynchronizer.h"
 #include "wallet/WalletIndices.h"
 
+#include <set>
+#include <string>
+#include <vector>
+
 namespace CryptoNote
 {
     class WalletSerializerV2
@@ -35,6 +39,20 @@ namespace CryptoNote
 
         void save(Common::IOutputStream &destination, WalletSaveLevel saveLevel);
 
+        /* Writes a journal record holding the given transactions, by index,
+           along with the uncommited transactions and extra. The transfers
+           synchronizer state is not included, nor the balances and unlock
+           jobs that follow from it. */
+        void saveJournalRecord(Common::IOutputStream &destination, const std::set<size_t> &changedTransactions);
+
+        /* Applies a journal record on top of a loaded cache. Balances and
+           unlock jobs stay as the cache left them, in step with the transfers
+           synchronizer, until it rescans the blocks the record covers. */
+        void loadJournalRecord(Common::IInputStream &source);
+
+        /* Merges journal records, oldest first, into a single record */
+        static std::string mergeJournalRecords(const std::vector<std::string> &records);
+
         std::unordered_set<Crypto::PublicKey> &addedKeys();
 
         std::unordered_set<Crypto::PublicKey> &deletedKeys();
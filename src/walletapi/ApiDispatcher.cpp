@@ -8,6 +8,7 @@
 
 #include "json.hpp"
 
+#include <algorithm>
 #include <config/CryptoNoteConfig.h>
 #include <common/StringTools.h>
 #include <crypto/random.h>
@@ -18,21 +19,92 @@
 #include <errors/ValidateParameters.h>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <utilities/Addresses.h>
 #include <utilities/ColouredMsg.h>
 #include <walletapi/Constants.h>
 #include <walletbackend/JsonSerialization.h>
 
+RouteTable::RouteTable(httplib::Server &server): m_server(server) {}
+
+RouteTable &RouteTable::Get(const std::string &pattern, const httplib::Server::Handler handler)
+{
+    m_server.Get(pattern, handler);
+    m_routes.push_back({"GET", std::regex(pattern), handler});
+    return *this;
+}
+
+RouteTable &RouteTable::Post(const std::string &pattern, const httplib::Server::Handler handler)
+{
+    m_server.Post(pattern, handler);
+    m_routes.push_back({"POST", std::regex(pattern), handler});
+    return *this;
+}
+
+RouteTable &RouteTable::Put(const std::string &pattern, const httplib::Server::Handler handler)
+{
+    m_server.Put(pattern, handler);
+    m_routes.push_back({"PUT", std::regex(pattern), handler});
+    return *this;
+}
+
+RouteTable &RouteTable::Delete(const std::string &pattern, const httplib::Server::Handler handler)
+{
+    m_server.Delete(pattern, handler);
+    m_routes.push_back({"DELETE", std::regex(pattern), handler});
+    return *this;
+}
+
+RouteTable &RouteTable::Options(const std::string &pattern, const httplib::Server::Handler handler)
+{
+    m_server.Options(pattern, handler);
+    m_routes.push_back({"OPTIONS", std::regex(pattern), handler});
+    return *this;
+}
+
+bool RouteTable::route(httplib::Request &req, httplib::Response &res) const
+{
+    /* Same as httplib, which handles HEAD requests with the GET routes */
+    const std::string method = req.method == "HEAD" ? "GET" : req.method;
+
+    for (const auto &route : m_routes)
+    {
+        if (route.method == method && std::regex_match(req.path, req.matches, route.pattern))
+        {
+            route.handler(req, res);
+            return true;
+        }
+    }
+
+    return false;
+}
+
 ApiDispatcher::ApiDispatcher(
     const uint16_t bindPort,
     const std::string rpcBindIp,
     const std::string rpcPassword,
     const std::string corsHeader,
-    unsigned int walletSyncThreads):
+    unsigned int walletSyncThreads,
+    const bool multiWallet):
+    ApiDispatcher(bindPort, rpcBindIp, rpcPassword, corsHeader, walletSyncThreads, multiWallet, nullptr)
+{
+}
+
+ApiDispatcher::ApiDispatcher(
+    const uint16_t bindPort,
+    const std::string rpcBindIp,
+    const std::string rpcPassword,
+    const std::string corsHeader,
+    unsigned int walletSyncThreads,
+    const bool multiWallet,
+    const ApiDispatcher *parent):
     m_port(bindPort),
     m_host(rpcBindIp),
     m_corsHeader(corsHeader),
-    m_rpcPassword(rpcPassword)
+    m_rpcPassword(rpcPassword),
+    m_multiWallet(multiWallet),
+    m_authenticatedByParent(parent != nullptr),
+    m_routes(m_server)
 {
     if (walletSyncThreads == 0)
     {
@@ -41,11 +113,20 @@ ApiDispatcher::ApiDispatcher(
 
     m_walletSyncThreads = walletSyncThreads;
 
-    /* Generate the salt used for pbkdf2 api authentication */
-    Random::randomBytes(16, m_salt);
+    if (parent != nullptr)
+    {
+        /* No need to hash the password again, it's the same one */
+        std::copy(std::begin(parent->m_salt), std::end(parent->m_salt), std::begin(m_salt));
+        m_hashedPassword = parent->m_hashedPassword;
+    }
+    else
+    {
+        /* Generate the salt used for pbkdf2 api authentication */
+        Random::randomBytes(16, m_salt);
 
-    /* Make sure to do this after initializing the salt above! */
-    m_hashedPassword = hashPassword(rpcPassword);
+        /* Make sure to do this after initializing the salt above! */
+        m_hashedPassword = hashPassword(rpcPassword);
+    }
 
     using namespace std::placeholders;
 
@@ -68,7 +149,7 @@ ApiDispatcher::ApiDispatcher(
     const bool viewWalletsBanned = false;
 
     /* POST */
-    m_server
+    m_routes
         .Post("/wallet/open", router(&ApiDispatcher::openWallet, WalletMustBeClosed, viewWalletsAllowed))
 
         /* Import wallet with keys */
@@ -229,6 +310,9 @@ ApiDispatcher::ApiDispatcher(
             "/transactions/address/" + ApiConstants::addressRegex + "/\\d+/\\d+",
             router(&ApiDispatcher::getTransactionsFromHeightToHeightWithAddress, WalletMustBeOpen, viewWalletsAllowed))
 
+        /* Get a page of transactions, continuing from the given cursor */
+        .Get("/transactions/page", router(&ApiDispatcher::getTransactionsPage, WalletMustBeOpen, viewWalletsAllowed))
+
         /* Get the transaction private key for the given hash */
         .Get(
             "/transactions/privatekey/" + ApiConstants::hashRegex,
@@ -263,6 +347,24 @@ ApiDispatcher::ApiDispatcher(
         /* Matches everything */
         /* NOTE: Not passing through middleware */
         .Options(".*", [this](auto &req, auto &res) { handleOptions(req, res); });
+
+    /* Each wallet gets its own dispatcher, addressed by /wallets/{id}/...,
+       with the same routes as above. The unprefixed routes continue to work
+       on a default wallet. */
+    if (m_multiWallet)
+    {
+        const std::string walletRoute = "/wallets/(" + ApiConstants::walletIdRegex + ")(/.*)";
+
+        const auto forward = [this](const httplib::Request &req, httplib::Response &res) {
+            forwardToWallet(req, res);
+        };
+
+        m_routes.Get("/wallets", router(&ApiDispatcher::listWallets, DoesntMatter, viewWalletsAllowed))
+            .Get(walletRoute, forward)
+            .Post(walletRoute, forward)
+            .Put(walletRoute, forward)
+            .Delete(walletRoute, forward);
+    }
 }
 
 void ApiDispatcher::start()
@@ -319,7 +421,8 @@ void ApiDispatcher::middleware(
         res.set_header("Access-Control-Allow-Origin", m_corsHeader);
     }
 
-    if (!checkAuthenticated(req, res))
+    /* Requests forwarded to a wallet's dispatcher were already checked */
+    if (!m_authenticatedByParent && !checkAuthenticated(req, res))
     {
         return;
     }
@@ -1242,11 +1345,7 @@ std::tuple<Error, uint16_t>
 std::tuple<Error, uint16_t>
     ApiDispatcher::getTransactions(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const
 {
-    nlohmann::json j {{"transactions", m_walletBackend->getTransactions()}};
-
-    publicKeysToAddresses(j);
-
-    res.set_content(j.dump(4) + "\n", "application/json");
+    streamTransactions(res, 0, std::numeric_limits<uint64_t>::max(), std::nullopt);
 
     return {SUCCESS, 200};
 }
@@ -1309,13 +1408,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsFromHeight(
     {
         uint64_t startHeight = std::stoull(startHeightStr);
 
-        const auto txs = m_walletBackend->getTransactionsRange(startHeight, startHeight + 1000);
-
-        nlohmann::json j {{"transactions", txs}};
-
-        publicKeysToAddresses(j);
-
-        res.set_content(j.dump(4) + "\n", "application/json");
+        streamTransactions(res, startHeight, startHeight + 1000, std::nullopt);
 
         return {SUCCESS, 200};
     }
@@ -1358,13 +1451,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsFromHeightToHeight(
             return {SUCCESS, 400};
         }
 
-        const auto txs = m_walletBackend->getTransactionsRange(startHeight, endHeight);
-
-        nlohmann::json j {{"transactions", txs}};
-
-        publicKeysToAddresses(j);
-
-        res.set_content(j.dump(4) + "\n", "application/json");
+        streamTransactions(res, startHeight, endHeight, std::nullopt);
 
         return {SUCCESS, 200};
     }
@@ -1403,30 +1490,9 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsFromHeightWithAddress(
     {
         uint64_t startHeight = std::stoull(startHeightStr);
 
-        const auto txs = m_walletBackend->getTransactionsRange(startHeight, startHeight + 1000);
-
-        std::vector<WalletTypes::Transaction> result;
-
-        std::copy_if(txs.begin(), txs.end(), std::back_inserter(result), [address, this](const auto tx) {
-            for (const auto [key, transfer] : tx.transfers)
-            {
-                const auto [error, actualAddress] = m_walletBackend->getAddress(key);
-
-                /* If the transfer contains our address, keep it, else skip */
-                if (actualAddress == address)
-                {
-                    return true;
-                }
-            }
-
-            return false;
-        });
-
-        nlohmann::json j {{"transactions", result}};
+        const auto [publicSpendKey, publicViewKey] = Utilities::addressToKeys(address);
 
-        publicKeysToAddresses(j);
-
-        res.set_content(j.dump(4) + "\n", "application/json");
+        streamTransactions(res, startHeight, startHeight + 1000, publicSpendKey);
 
         return {SUCCESS, 200};
     }
@@ -1480,30 +1546,9 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsFromHeightToHeightWith
             return {SUCCESS, 400};
         }
 
-        const auto txs = m_walletBackend->getTransactionsRange(startHeight, endHeight);
+        const auto [publicSpendKey, publicViewKey] = Utilities::addressToKeys(address);
 
-        std::vector<WalletTypes::Transaction> result;
-
-        std::copy_if(txs.begin(), txs.end(), std::back_inserter(result), [address, this](const auto tx) {
-            for (const auto [key, transfer] : tx.transfers)
-            {
-                const auto [error, actualAddress] = m_walletBackend->getAddress(key);
-
-                /* If the transfer contains our address, keep it, else skip */
-                if (actualAddress == address)
-                {
-                    return true;
-                }
-            }
-
-            return false;
-        });
-
-        nlohmann::json j {{"transactions", result}};
-
-        publicKeysToAddresses(j);
-
-        res.set_content(j.dump(4) + "\n", "application/json");
+        streamTransactions(res, startHeight, endHeight, publicSpendKey);
 
         return {SUCCESS, 200};
     }
@@ -1519,47 +1564,141 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsFromHeightToHeightWith
     }
 }
 
-std::tuple<Error, uint16_t> ApiDispatcher::getTransactionDetails(
+std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsPage(
     const httplib::Request &req,
     httplib::Response &res,
     const nlohmann::json &body) const
 {
-    std::string hashStr = req.path.substr(std::string("/transactions/hash/").size());
+    uint64_t startHeight = 0;
 
-    Crypto::Hash hash;
+    uint64_t endHeight = std::numeric_limits<uint64_t>::max();
 
-    Common::podFromHex(hashStr, hash.data);
+    uint64_t limit = ApiConstants::defaultTransactionPageSize;
 
-    for (const auto &tx : m_walletBackend->getTransactions())
+    std::optional<Crypto::PublicKey> publicSpendKey;
+
+    std::optional<Crypto::Hash> cursor;
+
+    try
     {
-        if (tx.hash == hash)
+        if (req.has_param("startHeight"))
         {
-            nlohmann::json j {{"transaction", tx}};
+            startHeight = std::stoull(req.get_param_value("startHeight"));
+        }
 
-            /* Replace publicKey with address for ease of use */
-            for (auto &tx : j.at("transaction").at("transfers"))
-            {
-                /* Get the spend key */
-                Crypto::PublicKey spendKey = tx.at("publicKey").get<Crypto::PublicKey>();
+        if (req.has_param("endHeight"))
+        {
+            endHeight = std::stoull(req.get_param_value("endHeight"));
+        }
 
-                /* Get the address it belongs to */
-                const auto [error, address] = m_walletBackend->getAddress(spendKey);
+        if (req.has_param("limit"))
+        {
+            limit = std::stoull(req.get_param_value("limit"));
+        }
+    }
+    catch (const std::out_of_range &)
+    {
+        std::cout << "Height or limit parameter is too large or too small!" << std::endl;
+        return {SUCCESS, 400};
+    }
+    catch (const std::invalid_argument &)
+    {
+        std::cout << "Failed to parse parameter as height or limit...\n";
+        return {SUCCESS, 400};
+    }
+
+    if (startHeight >= endHeight)
+    {
+        std::cout << "Start height must be < end height..." << std::endl;
+        return {SUCCESS, 400};
+    }
 
-                /* Add the address to the json */
-                tx["address"] = address;
+    if (limit == 0 || limit > ApiConstants::maxTransactionPageSize)
+    {
+        std::cout << "Limit must be between 1 and " << ApiConstants::maxTransactionPageSize << std::endl;
+        return {SUCCESS, 400};
+    }
 
-                /* Remove the spend key */
-                tx.erase("publicKey");
-            }
+    if (req.has_param("address"))
+    {
+        const std::string address = req.get_param_value("address");
 
-            res.set_content(j.dump(4) + "\n", "application/json");
+        if (Error error = validateAddresses({address}, false); error != SUCCESS)
+        {
+            return {error, 400};
+        }
+
+        const auto [spendKey, viewKey] = Utilities::addressToKeys(address);
+
+        publicSpendKey = spendKey;
+    }
+
+    if (req.has_param("cursor"))
+    {
+        const std::string cursorStr = req.get_param_value("cursor");
 
-            return {SUCCESS, 200};
+        if (Error error = validateHash(cursorStr); error != SUCCESS)
+        {
+            return {error, 400};
         }
+
+        Crypto::Hash hash;
+
+        Common::podFromHex(cursorStr, hash.data);
+
+        cursor = hash;
+    }
+
+    const auto [error, txs, nextCursor] =
+        m_walletBackend->getTransactionsPage(startHeight, endHeight, publicSpendKey, cursor, limit);
+
+    if (error)
+    {
+        return {error, 400};
     }
 
+    nlohmann::json j {{"transactions", txs}};
+
+    publicKeysToAddresses(j);
+
+    if (nextCursor)
+    {
+        j["cursor"] = Common::podToHex(*nextCursor);
+    }
+    else
+    {
+        j["cursor"] = nullptr;
+    }
+
+    res.set_content(j.dump(4) + "\n", "application/json");
+
+    return {SUCCESS, 200};
+}
+
+std::tuple<Error, uint16_t> ApiDispatcher::getTransactionDetails(
+    const httplib::Request &req,
+    httplib::Response &res,
+    const nlohmann::json &body) const
+{
+    std::string hashStr = req.path.substr(std::string("/transactions/hash/").size());
+
+    Crypto::Hash hash;
+
+    Common::podFromHex(hashStr, hash.data);
+
+    const auto tx = m_walletBackend->getTransaction(hash);
+
     /* Not found */
-    return {SUCCESS, 404};
+    if (!tx)
+    {
+        return {SUCCESS, 404};
+    }
+
+    nlohmann::json j {{"transaction", transactionToJson(*tx, m_walletBackend)}};
+
+    res.set_content(j.dump(4) + "\n", "application/json");
+
+    return {SUCCESS, 200};
 }
 
 std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsByPaymentId(
@@ -1691,6 +1830,93 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTxPrivateKey(
 /* OPTIONS REQUESTS */
 //////////////////////
 
+void ApiDispatcher::forwardToWallet(const httplib::Request &req, httplib::Response &res)
+{
+    /* Check before creating anything, so unauthenticated requests can't make
+       us allocate dispatchers */
+    if (!checkAuthenticated(req, res))
+    {
+        return;
+    }
+
+    const std::string walletId = req.matches[1];
+    const std::string walletPath = req.matches[2];
+
+    /* Only these can give a wallet id a wallet, anything else for an id
+       without one is a 404 */
+    const bool opensWallet = req.method == "POST"
+                             && (walletPath == "/wallet/open" || walletPath == "/wallet/create"
+                                 || walletPath.rfind("/wallet/import/", 0) == 0);
+
+    std::shared_ptr<ApiDispatcher> wallet;
+
+    {
+        std::scoped_lock lock(m_walletsMutex);
+
+        const auto it = m_wallets.find(walletId);
+
+        if (it != m_wallets.end())
+        {
+            wallet = it->second;
+        }
+        else if (opensWallet)
+        {
+            wallet = std::shared_ptr<ApiDispatcher>(new ApiDispatcher(
+                m_port, m_host, m_rpcPassword, m_corsHeader, m_walletSyncThreads, false, this));
+
+            m_wallets[walletId] = wallet;
+        }
+        else
+        {
+            res.status = 404;
+            return;
+        }
+    }
+
+    /* Strip the /wallets/{id} prefix, then route as normal */
+    httplib::Request walletRequest = req;
+    walletRequest.path = walletPath;
+
+    if (!wallet->m_routes.route(walletRequest, res))
+    {
+        res.status = 404;
+    }
+
+    /* Don't keep dispatchers around for wallets which have been closed, or
+       never opened */
+    std::scoped_lock lock(m_walletsMutex, wallet->m_mutex);
+
+    const auto it = m_wallets.find(walletId);
+
+    if (it != m_wallets.end() && it->second == wallet && wallet->m_walletBackend == nullptr)
+    {
+        m_wallets.erase(it);
+    }
+}
+
+std::tuple<Error, uint16_t>
+    ApiDispatcher::listWallets(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const
+{
+    std::vector<std::string> walletIds;
+
+    {
+        std::scoped_lock lock(m_walletsMutex);
+
+        for (const auto &[walletId, wallet] : m_wallets)
+        {
+            walletIds.push_back(walletId);
+        }
+    }
+
+    std::sort(walletIds.begin(), walletIds.end());
+
+    nlohmann::json j {{"wallets", walletIds}};
+
+    res.set_content(j.dump(4) + "\n", "application/json");
+
+    return {SUCCESS, 200};
+}
+
 void ApiDispatcher::handleOptions(const httplib::Request &req, httplib::Response &res) const
 {
     std::cout << "Incoming " << req.method << " request: " << req.path << std::endl;
@@ -1823,6 +2049,110 @@ void ApiDispatcher::publicKeysToAddresses(nlohmann::json &j) const
     }
 }
 
+nlohmann::json ApiDispatcher::transactionToJson(
+    const WalletTypes::Transaction &tx,
+    const std::shared_ptr<WalletBackend> &walletBackend) const
+{
+    nlohmann::json j = tx;
+
+    /* Replace publicKey with address for ease of use */
+    for (auto &transfer : j.at("transfers"))
+    {
+        /* Get the spend key */
+        Crypto::PublicKey spendKey = transfer.at("publicKey").get<Crypto::PublicKey>();
+
+        /* Get the address it belongs to */
+        const auto [error, address] = walletBackend->getAddress(spendKey);
+
+        /* Add the address to the json */
+        transfer["address"] = address;
+
+        /* Remove the spend key */
+        transfer.erase("publicKey");
+    }
+
+    return j;
+}
+
+void ApiDispatcher::streamTransactions(
+    httplib::Response &res,
+    const uint64_t startHeight,
+    const uint64_t endHeight,
+    const std::optional<Crypto::PublicKey> publicSpendKey) const
+{
+    struct StreamState
+    {
+        /* The transaction to continue after on the next page */
+        std::optional<Crypto::Hash> cursor;
+
+        bool started = false;
+
+        bool wroteTransaction = false;
+
+        bool finished = false;
+    };
+
+    auto state = std::make_shared<StreamState>();
+
+    /* The stream callback runs after we return, so keep the wallet alive
+       even if it gets closed in the meantime */
+    const auto walletBackend = m_walletBackend;
+
+    res.set_header("Content-Type", "application/json");
+
+    /* Produces the same output as j.dump(4), one page at a time. An empty
+       string signals the end of the response. */
+    res.streamcb = [this, state, walletBackend, startHeight, endHeight, publicSpendKey](const uint64_t offset) {
+        std::string chunk;
+
+        if (state->finished)
+        {
+            return chunk;
+        }
+
+        if (!state->started)
+        {
+            chunk += "{\n    \"transactions\": [";
+            state->started = true;
+        }
+
+        const auto [error, txs, nextCursor] = walletBackend->getTransactionsPage(
+            startHeight, endHeight, publicSpendKey, state->cursor, ApiConstants::transactionStreamPageSize);
+
+        for (const auto &tx : txs)
+        {
+            std::string txJson = transactionToJson(tx, walletBackend).dump(4);
+
+            /* Indent to match the nesting inside the transactions array */
+            chunk += state->wroteTransaction ? ",\n        " : "\n        ";
+
+            for (const char c : txJson)
+            {
+                chunk += c;
+
+                if (c == '\n')
+                {
+                    chunk += "        ";
+                }
+            }
+
+            state->wroteTransaction = true;
+        }
+
+        /* A fork removed the cursor transaction mid stream - nothing more we
+           can reliably return, so just end the response */
+        if (error || !nextCursor)
+        {
+            chunk += state->wroteTransaction ? "\n    ]\n}\n" : "]\n}\n";
+            state->finished = true;
+        }
+
+        state->cursor = nextCursor;
+
+        return chunk;
+    };
+}
+
 std::string ApiDispatcher::hashPassword(const std::string password) const
 {
     using namespace CryptoPP;
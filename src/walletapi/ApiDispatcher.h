@@ -7,6 +7,7 @@
 #include "httplib.h"
 
 #include <cryptopp/modes.h>
+#include <regex>
 #include <walletbackend/WalletBackend.h>
 
 enum WalletState
@@ -43,6 +44,43 @@ template<typename T> T getJsonValue(const nlohmann::json &body, const std::strin
     }
 }
 
+/* Registers routes with a server, as with httplib::Server::Get() and so on,
+   and keeps hold of them, so a request can also be routed without going
+   through the server's socket */
+class RouteTable
+{
+  public:
+    RouteTable(httplib::Server &server);
+
+    RouteTable &Get(const std::string &pattern, const httplib::Server::Handler handler);
+
+    RouteTable &Post(const std::string &pattern, const httplib::Server::Handler handler);
+
+    RouteTable &Put(const std::string &pattern, const httplib::Server::Handler handler);
+
+    RouteTable &Delete(const std::string &pattern, const httplib::Server::Handler handler);
+
+    RouteTable &Options(const std::string &pattern, const httplib::Server::Handler handler);
+
+    /* Calls the handler of the first route matching the request, filling in
+       req.matches. Returns false if no route matches. */
+    bool route(httplib::Request &req, httplib::Response &res) const;
+
+  private:
+    struct Route
+    {
+        std::string method;
+
+        std::regex pattern;
+
+        httplib::Server::Handler handler;
+    };
+
+    httplib::Server &m_server;
+
+    std::vector<Route> m_routes;
+};
+
 class ApiDispatcher
 {
   public:
@@ -55,7 +93,8 @@ class ApiDispatcher
         const std::string rpcBindIp,
         const std::string rpcPassword,
         std::string corsHeader,
-        unsigned int walletSyncThreads = std::thread::hardware_concurrency());
+        unsigned int walletSyncThreads = std::thread::hardware_concurrency(),
+        const bool multiWallet = false);
 
     /////////////////////////////
     /* Public member functions */
@@ -68,6 +107,17 @@ class ApiDispatcher
     void stop();
 
   private:
+    /* Dispatcher for one wallet in multi wallet mode, which takes the
+       password hash from, and is only reached through, parent */
+    ApiDispatcher(
+        const uint16_t bindPort,
+        const std::string rpcBindIp,
+        const std::string rpcPassword,
+        std::string corsHeader,
+        unsigned int walletSyncThreads,
+        const bool multiWallet,
+        const ApiDispatcher *parent);
+
     //////////////////////////////
     /* Private member functions */
     //////////////////////////////
@@ -268,6 +318,10 @@ class ApiDispatcher
         httplib::Response &res,
         const nlohmann::json &body) const;
 
+    /* Gets a page of transactions, using cursor based pagination */
+    std::tuple<Error, uint16_t>
+        getTransactionsPage(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const;
+
     std::tuple<Error, uint16_t>
         getTransactionDetails(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const;
 
@@ -300,6 +354,17 @@ class ApiDispatcher
     /* Handles an OPTIONS request */
     void handleOptions(const httplib::Request &req, httplib::Response &res) const;
 
+    ///////////////////////////
+    /* MULTI WALLET REQUESTS */
+    ///////////////////////////
+
+    /* Forwards a /wallets/{id}/... request to the dispatcher for that wallet */
+    void forwardToWallet(const httplib::Request &req, httplib::Response &res);
+
+    /* Lists the ids of the wallets currently open */
+    std::tuple<Error, uint16_t>
+        listWallets(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const;
+
     //////////////////////////
     /* END OF API FUNCTIONS */
     //////////////////////////
@@ -323,6 +388,20 @@ class ApiDispatcher
     /* Converts a public spend key to an address in a transactions json */
     void publicKeysToAddresses(nlohmann::json &j) const;
 
+    /* Converts a transaction to json, replacing public spend keys with addresses */
+    nlohmann::json transactionToJson(
+        const WalletTypes::Transaction &tx,
+        const std::shared_ptr<WalletBackend> &walletBackend) const;
+
+    /* Streams the transactions in [startHeight, endHeight - 1] as a chunked
+       response, a page at a time, so memory use does not depend on the size
+       of the wallet history */
+    void streamTransactions(
+        httplib::Response &res,
+        const uint64_t startHeight,
+        const uint64_t endHeight,
+        const std::optional<Crypto::PublicKey> publicSpendKey) const;
+
     std::string hashPassword(const std::string password) const;
 
     //////////////////////////////
@@ -334,6 +413,10 @@ class ApiDispatcher
     /* Our server instance */
     httplib::Server m_server;
 
+    /* The routes registered with m_server, so the parent dispatcher can
+       route requests to us in multi wallet mode */
+    RouteTable m_routes;
+
     /* The --rpc-password hashed with pbkdf2 */
     std::string m_hashedPassword;
 
@@ -359,4 +442,16 @@ class ApiDispatcher
 
     /* Amount of threads to use during wallet syncing */
     unsigned int m_walletSyncThreads;
+
+    /* Whether we serve multiple wallets, under /wallets/{id}/... */
+    bool m_multiWallet;
+
+    /* Whether requests reach us through a parent dispatcher, which has
+       already checked the api key */
+    bool m_authenticatedByParent;
+
+    /* Wallet id -> dispatcher handling that wallet (multi wallet mode only) */
+    std::unordered_map<std::string, std::shared_ptr<ApiDispatcher>> m_wallets;
+
+    mutable std::mutex m_walletsMutex;
 };
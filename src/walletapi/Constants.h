@@ -21,4 +21,17 @@ namespace ApiConstants
 
     /* 64 char, hex */
     const std::string hashRegex = "[a-fA-F0-9]{64}";
+
+    /* Identifies a wallet in multi wallet mode, e.g. /wallets/customer-123/balance */
+    const std::string walletIdRegex = "[a-zA-Z0-9_-]{1,64}";
+
+    /* How many transactions to fetch from the wallet at once when streaming
+       a transaction list response */
+    const uint64_t transactionStreamPageSize = 1000;
+
+    /* Default and maximum number of transactions returned by a single
+       /transactions/page request */
+    const uint64_t defaultTransactionPageSize = 100;
+
+    const uint64_t maxTransactionPageSize = 1000;
 } // namespace ApiConstants
@@ -22,7 +22,7 @@ ApiConfig parseArguments(int argc, char **argv)
 
     cxxopts::Options options(argv[0], CryptoNote::getProjectCLIHeader());
 
-    bool help, version, scanCoinbaseTransactions, noConsole;
+    bool help, version, scanCoinbaseTransactions, noConsole, multiWallet, daemonSideScanning;
 
     int logLevel;
 
@@ -47,6 +47,17 @@ ApiConfig parseArguments(int argc, char **argv)
          "If set, will not provide an interactive console",
          cxxopts::value<bool>(noConsole)->default_value("false")->implicit_value("true"))
 
+        ("multi-wallet",
+         "Serve multiple wallets from this process, addressed as /wallets/{id}/... They share one connection to "
+         "each daemon, which downloads each block once for all of them, and scan blocks on one pool of --threads "
+         "sync threads.",
+         cxxopts::value<bool>(multiWallet)->default_value("false")->implicit_value("true"))
+
+        ("daemon-side-scanning",
+         "Send the wallets private view key to the daemon, and let it find our transactions instead of downloading "
+         "every block. Only use this with your own daemon, running on this machine with --enable-view-key-scanning.",
+         cxxopts::value<bool>(daemonSideScanning)->default_value("false")->implicit_value("true"))
+
         ("scan-coinbase-transactions",
          "Scan miner/coinbase transactions",
          cxxopts::value<bool>(scanCoinbaseTransactions)->default_value("false")->implicit_value("true"))
@@ -159,5 +170,16 @@ ApiConfig parseArguments(int argc, char **argv)
         Config::config.wallet.skipCoinbaseTransactions = false;
     }
 
+    if (multiWallet)
+    {
+        config.multiWallet = true;
+        Config::config.wallet.shareDaemonConnections = true;
+    }
+
+    if (daemonSideScanning)
+    {
+        Config::config.wallet.daemonSideScanning = true;
+    }
+
     return config;
 }
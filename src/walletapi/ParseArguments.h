@@ -33,6 +33,9 @@ struct ApiConfig
     bool noConsole = false;
 
     unsigned int threads;
+
+    /* Serve many wallets from this process, under /wallets/{id}/... */
+    bool multiWallet = false;
 };
 
 ApiConfig parseArguments(int argc, char **argv);
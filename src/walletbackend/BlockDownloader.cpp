@@ -154,6 +154,44 @@ void BlockDownloader::dropBlock(const uint64_t blockHeight, const Crypto::Hash b
     m_shouldTryFetch.notify_one();
 }
 
+void BlockDownloader::storeProcessedBlock(const uint64_t blockHeight, const Crypto::Hash blockHash)
+{
+    m_synchronizationStatus.storeBlockHash(blockHash, blockHeight);
+}
+
+ScanPosition BlockDownloader::getScanPosition() const
+{
+    ScanPosition position;
+
+    const auto recentBlockHashes = m_synchronizationStatus.getRecentBlockHashes();
+    const auto blockCheckpoints = m_synchronizationStatus.getBlockCheckpoints();
+
+    position.recentBlockHashes.assign(recentBlockHashes.begin(), recentBlockHashes.end());
+    position.blockCheckpoints.assign(blockCheckpoints.begin(), blockCheckpoints.end());
+
+    if (!recentBlockHashes.empty())
+    {
+        position.topBlock = WalletTypes::TopBlock {recentBlockHashes.front(), m_synchronizationStatus.getHeight()};
+    }
+
+    position.startHeight = m_startHeight;
+    position.startTimestamp = m_startTimestamp;
+
+    return position;
+}
+
+void BlockDownloader::convertSyncTimestampToHeight(const uint64_t firstBlockHeight)
+{
+    /* Timestamp is transient and can change - block height is constant. */
+    if (m_startTimestamp != 0)
+    {
+        m_startTimestamp = 0;
+        m_startHeight = firstBlockHeight;
+
+        m_subWallets->convertSyncTimestampToHeight(m_startTimestamp, m_startHeight);
+    }
+}
+
 std::vector<std::tuple<WalletTypes::WalletBlockInfo, uint32_t>> BlockDownloader::fetchBlocks(const size_t blockCount)
 {
     /* Attempt to fetch more blocks if we've run out */
@@ -235,6 +273,8 @@ bool BlockDownloader::downloadBlocks()
         return false;
     }
 
+    const bool daemonSideScanning = Config::config.wallet.daemonSideScanning && m_daemon->viewKeyScanningAvailable();
+
     const auto blockCheckpoints = getBlockCheckpoints();
 
     if (blockCheckpoints.size() > 0)
@@ -246,8 +286,10 @@ bool BlockDownloader::downloadBlocks()
         Logger::logger.log(stream.str(), Logger::DEBUG, {Logger::SYNC});
     }
 
-    const auto [success, blocks, topBlock] = m_daemon->getWalletSyncData(
-        blockCheckpoints, m_startHeight, m_startTimestamp, Config::config.wallet.skipCoinbaseTransactions);
+    const auto [success, blocks, daemonTopBlock] = daemonSideScanning
+        ? scanBlocksWithDaemon(blockCheckpoints)
+        : m_daemon->getWalletSyncData(
+            blockCheckpoints, m_startHeight, m_startTimestamp, Config::config.wallet.skipCoinbaseTransactions);
 
     /* Synced, store the top block so sync status displayes correctly if
        we are not scanning coinbase tx only blocks */
@@ -257,9 +299,9 @@ bool BlockDownloader::downloadBlocks()
        topblock, which is also 1000, as having being processed, when in
        fact, we're still waiting for it to be processed. So, if we only store
        it if we have no blocks waiting to be processed, it fixes this issue */
-    if (success && blocks.empty() && topBlock && m_storedBlocks.size() == 0)
+    if (success && blocks.empty() && daemonTopBlock && m_storedBlocks.size() == 0)
     {
-        m_synchronizationStatus.storeBlockHash(topBlock->hash, topBlock->height);
+        m_synchronizationStatus.storeBlockHash(daemonTopBlock->hash, daemonTopBlock->height);
         return false;
     }
     /* If we get no blocks, we are fully synced.
@@ -282,14 +324,7 @@ bool BlockDownloader::downloadBlocks()
        bit before */
     m_daemon->resetRequestedBlockCount();
 
-    /* Timestamp is transient and can change - block height is constant. */
-    if (m_startTimestamp != 0)
-    {
-        m_startTimestamp = 0;
-        m_startHeight = blocks.front().blockHeight;
-
-        m_subWallets->convertSyncTimestampToHeight(m_startTimestamp, m_startHeight);
-    }
+    convertSyncTimestampToHeight(blocks.front().blockHeight);
 
     std::stringstream stream;
 
@@ -298,6 +333,67 @@ bool BlockDownloader::downloadBlocks()
 
     Logger::logger.log(stream.str(), Logger::DEBUG, {Logger::SYNC});
 
+    storeBlocks(blocks);
+
+    return true;
+}
+
+std::tuple<bool, std::vector<WalletTypes::WalletBlockInfo>, std::optional<WalletTypes::TopBlock>>
+    BlockDownloader::scanBlocksWithDaemon(const std::vector<Crypto::Hash> &blockCheckpoints) const
+{
+    std::vector<std::tuple<uint64_t, uint64_t>> globalIndexes;
+
+    const auto privateViewKey = m_subWallets->getPrivateViewKey();
+    const auto publicSpendKeys = m_subWallets->getPublicSpendKeys();
+
+    /* The daemon spots our outgoing transactions by the inputs they use, so
+       it needs to know about our outputs in blocks we have downloaded but
+       not yet processed, too. Get these before the inputs from the
+       subwallets - a block is only dropped once its inputs are stored, so we
+       can't miss any in between. The stored transactions may have outputs
+       to other people, so only send the ones which are ours. */
+    for (const auto &[block, arrivalIndex] : m_storedBlocks.back_n(m_storedBlocks.size()))
+    {
+        const auto addOutputs = [&](const WalletTypes::RawCoinbaseTransaction &tx) {
+            for (const auto &[outputIndex, publicSpendKey] :
+                 Utilities::findOwnedOutputs(tx, privateViewKey, publicSpendKeys))
+            {
+                const auto &output = tx.keyOutputs[outputIndex];
+
+                if (output.globalOutputIndex)
+                {
+                    globalIndexes.emplace_back(output.amount, *output.globalOutputIndex);
+                }
+            }
+        };
+
+        if (block.coinbaseTransaction)
+        {
+            addOutputs(*block.coinbaseTransaction);
+        }
+
+        for (const auto &tx : block.transactions)
+        {
+            addOutputs(tx);
+        }
+    }
+
+    const auto unspentGlobalIndexes = m_subWallets->getUnspentGlobalIndexes();
+
+    globalIndexes.insert(globalIndexes.end(), unspentGlobalIndexes.begin(), unspentGlobalIndexes.end());
+
+    return m_daemon->scanWalletOutputs(
+        blockCheckpoints,
+        m_startHeight,
+        m_startTimestamp,
+        Config::config.wallet.skipCoinbaseTransactions,
+        privateViewKey,
+        publicSpendKeys,
+        globalIndexes);
+}
+
+void BlockDownloader::storeBlocks(const std::vector<WalletTypes::WalletBlockInfo> &blocks)
+{
     std::vector<std::tuple<WalletTypes::WalletBlockInfo, uint32_t>> blocksWithIndex;
 
     for (const auto &block : blocks)
@@ -306,8 +402,6 @@ bool BlockDownloader::downloadBlocks()
     }
 
     m_storedBlocks.push_back_n(blocksWithIndex.begin(), blocksWithIndex.end());
-
-    return true;
 }
 
 void BlockDownloader::fromJSON(const JSONObject &j, const uint64_t startHeight, const uint64_t startTimestamp)
@@ -10,6 +10,7 @@
 #include <subwallets/SubWallets.h>
 #include <utilities/ThreadSafeDeque.h>
 #include <vector>
+#include <walletbackend/SharedBlockDownloader.h>
 #include <walletbackend/SynchronizationStatus.h>
 
 class BlockDownloader
@@ -45,6 +46,18 @@ class BlockDownloader
     /* Drops the oldest block from the internal queue */
     void dropBlock(const uint64_t blockHeight, const Crypto::Hash blockHash);
 
+    /* Records a block handed to us by a SharedBlockDownloader as processed,
+       as we don't store those */
+    void storeProcessedBlock(const uint64_t blockHeight, const Crypto::Hash blockHash);
+
+    /* Gets how far we have processed, for a SharedBlockDownloader to fetch
+       the following blocks */
+    ScanPosition getScanPosition() const;
+
+    /* Once we receive our first blocks, switches from syncing from a
+       timestamp to syncing from the height of the first block */
+    void convertSyncTimestampToHeight(const uint64_t firstBlockHeight);
+
     /* Start block downloading process */
     void start();
 
@@ -82,6 +95,14 @@ class BlockDownloader
     /* Downloads a set of blocks, if needed */
     bool downloadBlocks();
 
+    /* Has the daemon scan the next set of blocks for our transactions,
+       rather than downloading them all */
+    std::tuple<bool, std::vector<WalletTypes::WalletBlockInfo>, std::optional<WalletTypes::TopBlock>>
+        scanBlocksWithDaemon(const std::vector<Crypto::Hash> &blockCheckpoints) const;
+
+    /* Adds the blocks to the internal store, ready for processing */
+    void storeBlocks(const std::vector<WalletTypes::WalletBlockInfo> &blocks);
+
     //////////////////////////////
     /* Private member variables */
     //////////////////////////////
@@ -0,0 +1,541 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+////////////////////////////////////////////////
+#include <walletbackend/SharedBlockDownloader.h>
+////////////////////////////////////////////////
+
+#include <algorithm>
+#include <config/Config.h>
+#include <config/WalletConfig.h>
+#include <logger/Logger.h>
+#include <sstream>
+#include <walletbackend/Constants.h>
+
+namespace
+{
+    /* How long to wait before asking the daemon again for blocks following
+       a block it had nothing after, or after a request failed */
+    const std::chrono::steady_clock::duration DAEMON_POLL_INTERVAL = std::chrono::seconds(5);
+} // namespace
+
+/* Constructor */
+SharedBlockDownloader::SharedBlockDownloader(
+    const std::shared_ptr<Nigel> daemon,
+    const std::shared_ptr<Utilities::ThreadPool<bool>> pool):
+
+    m_daemon(daemon),
+    m_pool(pool)
+{
+    m_downloadThread = std::thread(&SharedBlockDownloader::downloader, this);
+}
+
+/* Destructor */
+SharedBlockDownloader::~SharedBlockDownloader()
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        m_shouldStop = true;
+        m_haveWork.notify_all();
+    }
+
+    if (m_downloadThread.joinable())
+    {
+        m_downloadThread.join();
+    }
+}
+
+void SharedBlockDownloader::subscribe(BlockScanner *scanner)
+{
+    std::scoped_lock lock(m_mutex);
+
+    m_subscribers[scanner] = Subscriber();
+
+    m_haveWorkFlag = true;
+    m_haveWork.notify_all();
+}
+
+void SharedBlockDownloader::unsubscribe(BlockScanner *scanner)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_scannerReleased.wait(lock, [&] {
+        const auto it = m_subscribers.find(scanner);
+        return it == m_subscribers.end() || !it->second.busy;
+    });
+
+    m_subscribers.erase(scanner);
+}
+
+void SharedBlockDownloader::downloader()
+{
+    while (!m_shouldStop)
+    {
+        bool madeProgress = false;
+
+        /* Scanners that have got to the same block share one request to
+           the daemon */
+        std::unordered_map<Crypto::Hash, std::tuple<ScanPosition, std::vector<BlockScanner *>>> waiting;
+
+        for (const auto scanner : takeReadyScanners())
+        {
+            const auto position = scanner->getScanPosition();
+
+            {
+                std::scoped_lock lock(m_mutex);
+
+                m_subscribers[scanner].height = position.topBlock
+                    ? std::optional<uint64_t>(position.topBlock->height)
+                    : std::nullopt;
+            }
+
+            if (!position.topBlock)
+            {
+                madeProgress = !fetchBlocks(position, {scanner}).empty() || madeProgress;
+                continue;
+            }
+
+            const auto blocks = getBlocksAfter(position.topBlock->hash, Constants::BLOCK_PROCESSING_CHUNK);
+
+            if (!blocks.empty())
+            {
+                scan(scanner, blocks);
+                advanceHead(position, blocks);
+                madeProgress = true;
+                continue;
+            }
+
+            if (polledRecently(position.topBlock->hash))
+            {
+                releaseScanner(scanner, DAEMON_POLL_INTERVAL);
+                continue;
+            }
+
+            auto &[groupPosition, scanners] = waiting[position.topBlock->hash];
+
+            if (scanners.empty())
+            {
+                groupPosition = position;
+            }
+
+            scanners.push_back(scanner);
+        }
+
+        for (const auto &[hash, group] : waiting)
+        {
+            const auto &[position, scanners] = group;
+
+            madeProgress = !fetchBlocks(position, scanners).empty() || madeProgress;
+        }
+
+        madeProgress = prefetchBlocks() || madeProgress;
+
+        evictBlocks();
+
+        const auto now = std::chrono::steady_clock::now();
+
+        for (auto it = m_polledAt.begin(); it != m_polledAt.end();)
+        {
+            it = now - it->second >= DAEMON_POLL_INTERVAL ? m_polledAt.erase(it) : std::next(it);
+        }
+
+        if (!madeProgress)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_haveWork.wait_for(lock, std::chrono::seconds(1), [&] { return m_shouldStop || m_haveWorkFlag; });
+
+            m_haveWorkFlag = false;
+        }
+    }
+}
+
+std::vector<BlockScanner *> SharedBlockDownloader::takeReadyScanners()
+{
+    std::scoped_lock lock(m_mutex);
+
+    std::vector<BlockScanner *> scanners;
+
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto &[scanner, subscriber] : m_subscribers)
+    {
+        if (!subscriber.busy && subscriber.retryAt <= now)
+        {
+            subscriber.busy = true;
+            scanners.push_back(scanner);
+        }
+    }
+
+    return scanners;
+}
+
+void SharedBlockDownloader::releaseScanner(
+    BlockScanner *scanner,
+    const std::chrono::steady_clock::duration retryAfter)
+{
+    /* Notify while holding the lock, as the downloader may be destroyed as
+       soon as an unsubscribing scanner sees it released */
+    std::scoped_lock lock(m_mutex);
+
+    const auto it = m_subscribers.find(scanner);
+
+    if (it != m_subscribers.end())
+    {
+        it->second.busy = false;
+        it->second.retryAt = std::chrono::steady_clock::now() + retryAfter;
+    }
+
+    m_haveWorkFlag = true;
+    m_haveWork.notify_all();
+    m_scannerReleased.notify_all();
+}
+
+void SharedBlockDownloader::scan(BlockScanner *scanner, const std::vector<SharedBlock> &blocks)
+{
+    scanner->scanBlocks(blocks, *m_pool, [this, scanner](const bool success) {
+        releaseScanner(scanner, success ? std::chrono::steady_clock::duration::zero() : DAEMON_POLL_INTERVAL);
+    });
+}
+
+std::vector<SharedBlock> SharedBlockDownloader::fetchBlocks(
+    const ScanPosition &position,
+    const std::vector<BlockScanner *> &scanners)
+{
+    std::vector<Crypto::Hash> blockCheckpoints = position.recentBlockHashes;
+
+    blockCheckpoints.insert(
+        blockCheckpoints.end(), position.blockCheckpoints.begin(), position.blockCheckpoints.end());
+
+    auto [success, blocks, topBlock] = m_daemon->getWalletSyncData(
+        blockCheckpoints,
+        position.startHeight,
+        position.startTimestamp,
+        Config::config.wallet.skipCoinbaseTransactions);
+
+    if (!success)
+    {
+        /* We may have failed because we requested more data than could be
+           returned in a reasonable amount of time, so we'll back off a
+           little bit */
+        m_daemon->decreaseRequestedBlockCount();
+
+        Logger::logger.log("Failed to get blocks from daemon", Logger::DEBUG, {Logger::SYNC, Logger::DAEMON});
+
+        for (const auto scanner : scanners)
+        {
+            releaseScanner(scanner, DAEMON_POLL_INTERVAL);
+        }
+
+        return {};
+    }
+
+    if (blocks.empty())
+    {
+        Logger::logger.log("Zero blocks received from daemon, possibly fully synced", Logger::DEBUG, {Logger::SYNC});
+
+        if (position.topBlock)
+        {
+            m_polledAt[position.topBlock->hash] = std::chrono::steady_clock::now();
+        }
+
+        for (const auto scanner : scanners)
+        {
+            m_pool->addJob([this, scanner, topBlock = topBlock] {
+                scanner->synced(topBlock);
+                releaseScanner(scanner, DAEMON_POLL_INTERVAL);
+                return true;
+            });
+        }
+
+        return {};
+    }
+
+    /* If we received data back, we'll make sure we're back to running at
+       full speed in case we backed off a little bit before */
+    m_daemon->resetRequestedBlockCount();
+
+    std::stringstream stream;
+
+    stream << "Downloaded " << blocks.size() << " blocks from daemon for " << scanners.size() << " wallets, ["
+           << blocks.front().blockHeight << ", " << blocks.back().blockHeight << "]";
+
+    Logger::logger.log(stream.str(), Logger::DEBUG, {Logger::SYNC});
+
+    std::optional<Crypto::Hash> previousHash;
+
+    /* The daemon carried on from our newest block, so we know how the
+       blocks link up. If it went back further, the chain forked. */
+    if (position.topBlock && blocks.front().blockHeight > position.topBlock->height)
+    {
+        previousHash = position.topBlock->hash;
+    }
+
+    const auto storedBlocks = storeBlocks(previousHash, std::move(blocks));
+
+    for (const auto scanner : scanners)
+    {
+        scan(scanner, storedBlocks);
+    }
+
+    advanceHead(position, storedBlocks);
+
+    return storedBlocks;
+}
+
+bool SharedBlockDownloader::prefetchBlocks()
+{
+    if (!m_head || m_memoryUsage + WalletConfig::maxBodyResponseSize >= WalletConfig::blockStoreMemoryLimit)
+    {
+        return false;
+    }
+
+    {
+        std::scoped_lock lock(m_mutex);
+
+        if (m_subscribers.empty())
+        {
+            return false;
+        }
+    }
+
+    const Crypto::Hash headHash = m_head->topBlock->hash;
+
+    if (polledRecently(headHash) || !getBlocksAfter(headHash, 1).empty())
+    {
+        return false;
+    }
+
+    /* Copy, as fetching moves the head on */
+    const ScanPosition head = *m_head;
+
+    const bool downloaded = !fetchBlocks(head, {}).empty();
+
+    /* Don't keep retrying a failing request every round */
+    if (!downloaded)
+    {
+        m_polledAt[headHash] = std::chrono::steady_clock::now();
+    }
+
+    return downloaded;
+}
+
+void SharedBlockDownloader::advanceHead(const ScanPosition &position, const std::vector<SharedBlock> &blocks)
+{
+    const auto &newest = blocks.back();
+
+    /* Always move on from the head itself, even backwards, in case the
+       chain forked underneath it */
+    const bool fromHead = m_head && position.topBlock && position.topBlock->hash == m_head->topBlock->hash;
+
+    if (m_head && !fromHead && m_head->topBlock->height >= newest->blockHeight)
+    {
+        return;
+    }
+
+    ScanPosition head;
+
+    for (auto it = blocks.rbegin();
+         it != blocks.rend() && head.recentBlockHashes.size() < Constants::LAST_KNOWN_BLOCK_HASHES_SIZE;
+         it++)
+    {
+        head.recentBlockHashes.push_back((*it)->blockHash);
+    }
+
+    for (const auto &hash : position.recentBlockHashes)
+    {
+        if (head.recentBlockHashes.size() >= Constants::LAST_KNOWN_BLOCK_HASHES_SIZE)
+        {
+            break;
+        }
+
+        head.recentBlockHashes.push_back(hash);
+    }
+
+    head.blockCheckpoints = position.blockCheckpoints;
+    head.topBlock = WalletTypes::TopBlock {newest->blockHash, newest->blockHeight};
+    head.startHeight = position.startHeight;
+
+    m_head = head;
+}
+
+bool SharedBlockDownloader::polledRecently(const Crypto::Hash &blockHash) const
+{
+    const auto it = m_polledAt.find(blockHash);
+
+    return it != m_polledAt.end() && std::chrono::steady_clock::now() - it->second < DAEMON_POLL_INTERVAL;
+}
+
+std::vector<SharedBlock>
+    SharedBlockDownloader::getBlocksAfter(const Crypto::Hash &blockHash, const size_t blockCount) const
+{
+    std::vector<SharedBlock> result;
+
+    Crypto::Hash hash = blockHash;
+
+    while (result.size() < blockCount)
+    {
+        const auto next = m_nextBlock.find(hash);
+
+        if (next == m_nextBlock.end())
+        {
+            break;
+        }
+
+        const auto block = m_blocks.find(next->second);
+
+        /* Evicted */
+        if (block == m_blocks.end())
+        {
+            break;
+        }
+
+        result.push_back(block->second);
+
+        hash = block->first;
+    }
+
+    return result;
+}
+
+std::vector<SharedBlock> SharedBlockDownloader::storeBlocks(
+    const std::optional<Crypto::Hash> &previousHash,
+    std::vector<WalletTypes::WalletBlockInfo> &&blocks)
+{
+    std::vector<SharedBlock> storedBlocks;
+
+    for (auto &block : blocks)
+    {
+        const auto existing = m_blocks.find(block.blockHash);
+
+        if (existing != m_blocks.end())
+        {
+            storedBlocks.push_back(existing->second);
+            continue;
+        }
+
+        const Crypto::Hash hash = block.blockHash;
+        const uint64_t height = block.blockHeight;
+        const size_t memoryUsage = block.memoryUsage();
+
+        const auto storedBlock = std::make_shared<const WalletTypes::WalletBlockInfo>(std::move(block));
+
+        m_blocks[hash] = storedBlock;
+        m_blockHeights.emplace(height, hash);
+        m_memoryUsage += memoryUsage;
+
+        storedBlocks.push_back(storedBlock);
+    }
+
+    /* Overwrites any existing link, in case the chain forked since we last
+       saw the block following it. The blocks on the old branch can't be
+       handed to anyone any more, so drop them. */
+    const auto link = [this](const Crypto::Hash &from, const Crypto::Hash &to) {
+        const auto it = m_nextBlock.find(from);
+
+        if (it != m_nextBlock.end() && it->second != to)
+        {
+            const Crypto::Hash forked = it->second;
+
+            m_nextBlock.erase(it);
+
+            removeBranch(forked);
+        }
+
+        m_nextBlock[from] = to;
+    };
+
+    if (previousHash && !storedBlocks.empty())
+    {
+        link(*previousHash, storedBlocks.front()->blockHash);
+    }
+
+    for (size_t i = 0; i + 1 < storedBlocks.size(); i++)
+    {
+        link(storedBlocks[i]->blockHash, storedBlocks[i + 1]->blockHash);
+    }
+
+    return storedBlocks;
+}
+
+void SharedBlockDownloader::removeBranch(const Crypto::Hash &blockHash)
+{
+    std::optional<Crypto::Hash> hash = blockHash;
+
+    while (hash)
+    {
+        const Crypto::Hash current = *hash;
+
+        const auto next = m_nextBlock.find(current);
+
+        if (next != m_nextBlock.end())
+        {
+            hash = next->second;
+            m_nextBlock.erase(next);
+        }
+        else
+        {
+            hash = std::nullopt;
+        }
+
+        removeBlock(current);
+    }
+}
+
+void SharedBlockDownloader::removeBlock(const Crypto::Hash &blockHash)
+{
+    const auto it = m_blocks.find(blockHash);
+
+    if (it == m_blocks.end())
+    {
+        return;
+    }
+
+    const auto [begin, end] = m_blockHeights.equal_range(it->second->blockHeight);
+
+    for (auto height = begin; height != end; height++)
+    {
+        if (height->second == blockHash)
+        {
+            m_blockHeights.erase(height);
+            break;
+        }
+    }
+
+    m_memoryUsage -= std::min(m_memoryUsage, it->second->memoryUsage());
+
+    m_blocks.erase(it);
+    m_nextBlock.erase(blockHash);
+}
+
+void SharedBlockDownloader::evictBlocks()
+{
+    std::optional<uint64_t> minHeight;
+
+    {
+        std::scoped_lock lock(m_mutex);
+
+        for (const auto &[scanner, subscriber] : m_subscribers)
+        {
+            if (subscriber.height && (!minHeight || *subscriber.height < *minHeight))
+            {
+                minHeight = subscriber.height;
+            }
+        }
+    }
+
+    /* Every scanner has got past these. Keep the blocks they are at, so we
+       can find the blocks following on from them. */
+    while (minHeight && !m_blockHeights.empty() && m_blockHeights.begin()->first < *minHeight)
+    {
+        const Crypto::Hash hash = m_blockHeights.begin()->second;
+        removeBlock(hash);
+    }
+
+    while (m_memoryUsage > WalletConfig::blockStoreMemoryLimit && !m_blockHeights.empty())
+    {
+        const Crypto::Hash hash = m_blockHeights.begin()->second;
+        removeBlock(hash);
+    }
+}
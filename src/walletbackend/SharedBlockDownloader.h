@@ -0,0 +1,207 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <WalletTypes.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <nigel/Nigel.h>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utilities/ThreadPool.h>
+#include <vector>
+
+/* A downloaded block, shared between every wallet scanning it */
+typedef std::shared_ptr<const WalletTypes::WalletBlockInfo> SharedBlock;
+
+/* How far a wallet has synced, so the blocks following on can be found */
+struct ScanPosition
+{
+    /* Hashes of the most recently processed blocks, newest first */
+    std::vector<Crypto::Hash> recentBlockHashes;
+
+    /* Infrequent checkpoints, for resolving deep forks */
+    std::vector<Crypto::Hash> blockCheckpoints;
+
+    /* The newest block processed, if any */
+    std::optional<WalletTypes::TopBlock> topBlock;
+
+    uint64_t startHeight = 0;
+
+    uint64_t startTimestamp = 0;
+};
+
+/* A wallet being handed blocks by a SharedBlockDownloader */
+class BlockScanner
+{
+  public:
+    virtual ~BlockScanner() = default;
+
+    /* Gets how far the wallet has synced. Not called while it is scanning. */
+    virtual ScanPosition getScanPosition() const = 0;
+
+    /* Scans blocks following on from the scan position, using the pool. Must
+       not wait for the pool. Calls done once the blocks are processed, or
+       with false if they could not be and should be retried later. */
+    virtual void scanBlocks(
+        const std::vector<SharedBlock> &blocks,
+        Utilities::ThreadPool<bool> &pool,
+        std::function<void(const bool success)> done) = 0;
+
+    /* Called on the pool when the daemon has no more blocks for the wallet */
+    virtual void synced(const std::optional<WalletTypes::TopBlock> &topBlock) = 0;
+};
+
+/* Downloads blocks for every wallet in the process using the same daemon
+   connection. Each block is fetched and decoded once, then handed to every
+   wallet that needs it, which scans it for its own transactions on a shared
+   thread pool. Blocks are linked to the block preceding them, so a wallet is
+   only handed blocks that follow on from the last block it processed. */
+class SharedBlockDownloader
+{
+  public:
+    /* Constructor */
+    SharedBlockDownloader(const std::shared_ptr<Nigel> daemon, const std::shared_ptr<Utilities::ThreadPool<bool>> pool);
+
+    /* Delete the copy constructor */
+    SharedBlockDownloader(const SharedBlockDownloader &) = delete;
+
+    /* Delete the assignment operator */
+    SharedBlockDownloader &operator=(const SharedBlockDownloader &) = delete;
+
+    /* Destructor */
+    ~SharedBlockDownloader();
+
+    /////////////////////////////
+    /* Public member functions */
+    /////////////////////////////
+
+    /* Starts handing blocks to the scanner */
+    void subscribe(BlockScanner *scanner);
+
+    /* Stops handing blocks to the scanner, waiting for any it is scanning */
+    void unsubscribe(BlockScanner *scanner);
+
+  private:
+    struct Subscriber
+    {
+        /* Scanning blocks, or being looked at by the download thread */
+        bool busy = false;
+
+        /* Don't hand the scanner anything before this */
+        std::chrono::steady_clock::time_point retryAt;
+
+        /* Height of the last block the scanner processed, if known */
+        std::optional<uint64_t> height;
+    };
+
+    //////////////////////////////
+    /* Private member functions */
+    //////////////////////////////
+
+    /* Hands blocks to the scanners, downloading them as needed */
+    void downloader();
+
+    /* Marks the scanners that are ready for more blocks as busy, and
+       returns them */
+    std::vector<BlockScanner *> takeReadyScanners();
+
+    /* Lets the scanner be handed blocks again after the given delay */
+    void releaseScanner(BlockScanner *scanner, const std::chrono::steady_clock::duration retryAfter);
+
+    /* Hands the blocks to the scanner, releasing it once it's done */
+    void scan(BlockScanner *scanner, const std::vector<SharedBlock> &blocks);
+
+    /* Fetches the blocks following on from the position, and hands them to
+       the scanners, which are all at that position. Returns the blocks. */
+    std::vector<SharedBlock> fetchBlocks(const ScanPosition &position, const std::vector<BlockScanner *> &scanners);
+
+    /* Downloads the blocks following on from the newest position we know
+       of, so they are ready before the scanners ask. Returns whether any
+       were downloaded. */
+    bool prefetchBlocks();
+
+    /* Moves the newest position on, if the blocks are past it */
+    void advanceHead(const ScanPosition &position, const std::vector<SharedBlock> &blocks);
+
+    /* Whether the daemon said it had nothing after this block recently */
+    bool polledRecently(const Crypto::Hash &blockHash) const;
+
+    /* Gets up to blockCount stored blocks following on from the block with
+       the given hash. May be empty. */
+    std::vector<SharedBlock> getBlocksAfter(const Crypto::Hash &blockHash, const size_t blockCount) const;
+
+    /* Stores a contiguous range of blocks returned by the daemon. If known,
+       previousHash is the hash of the block directly preceding the first
+       block. */
+    std::vector<SharedBlock> storeBlocks(
+        const std::optional<Crypto::Hash> &previousHash,
+        std::vector<WalletTypes::WalletBlockInfo> &&blocks);
+
+    /* Removes the block, and the blocks following on from it */
+    void removeBranch(const Crypto::Hash &blockHash);
+
+    /* Removes a single block */
+    void removeBlock(const Crypto::Hash &blockHash);
+
+    /* Removes blocks every scanner has passed, then the lowest blocks until
+       we're under the memory limit */
+    void evictBlocks();
+
+    //////////////////////////////
+    /* Private member variables */
+    //////////////////////////////
+
+    /* The daemon connection */
+    std::shared_ptr<Nigel> m_daemon;
+
+    /* The pool the scanners process blocks on */
+    std::shared_ptr<Utilities::ThreadPool<bool>> m_pool;
+
+    /* Block hash -> block. Only used by the download thread. */
+    std::unordered_map<Crypto::Hash, SharedBlock> m_blocks;
+
+    /* Block hash -> hash of the block following it */
+    std::unordered_map<Crypto::Hash, Crypto::Hash> m_nextBlock;
+
+    /* Block height -> hash of the stored blocks, for eviction */
+    std::multimap<uint64_t, Crypto::Hash> m_blockHeights;
+
+    /* Approximate memory used by the stored blocks */
+    size_t m_memoryUsage = 0;
+
+    /* Block hash -> when the daemon last had no blocks following it */
+    std::unordered_map<Crypto::Hash, std::chrono::steady_clock::time_point> m_polledAt;
+
+    /* The newest position we have downloaded blocks up to */
+    std::optional<ScanPosition> m_head;
+
+    /* The wallets we are handing blocks to */
+    std::unordered_map<BlockScanner *, Subscriber> m_subscribers;
+
+    /* Guards m_subscribers and m_haveWorkFlag */
+    std::mutex m_mutex;
+
+    /* Notified when a scanner subscribes or finishes scanning */
+    std::condition_variable m_haveWork;
+
+    /* Set alongside notifying m_haveWork */
+    bool m_haveWorkFlag = false;
+
+    /* Notified when a scanner stops being busy */
+    std::condition_variable m_scannerReleased;
+
+    /* Should we stop downloading */
+    std::atomic<bool> m_shouldStop = false;
+
+    /* Thread that performs the actual downloading of blocks */
+    std::thread m_downloadThread;
+};
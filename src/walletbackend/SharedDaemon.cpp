@@ -0,0 +1,130 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+///////////////////////////////////////
+#include <walletbackend/SharedDaemon.h>
+///////////////////////////////////////
+
+#include <algorithm>
+#include <config/Config.h>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    struct SharedConnection
+    {
+        std::string daemonHost;
+
+        uint16_t daemonPort;
+
+        bool daemonSSL;
+
+        /* Weak, so the connection is closed when the last wallet using it
+           is closed */
+        std::weak_ptr<Nigel> daemon;
+
+        /* Weak, so downloading stops when no wallet is left syncing */
+        std::weak_ptr<SharedBlockDownloader> blockDownloader;
+    };
+
+    std::mutex connectionsMutex;
+
+    std::vector<SharedConnection> connections;
+
+    /* Weak, so the threads are stopped once no wallet is left syncing */
+    std::weak_ptr<Utilities::ThreadPool<bool>> syncPool;
+
+    /* Drop any connections no longer in use by any wallet. Must hold the lock. */
+    void removeExpiredConnections()
+    {
+        connections.erase(
+            std::remove_if(
+                connections.begin(),
+                connections.end(),
+                [](const auto &connection) { return connection.daemon.expired(); }),
+            connections.end());
+    }
+} // namespace
+
+namespace SharedDaemon
+{
+    std::shared_ptr<Nigel> getDaemon(const std::string daemonHost, const uint16_t daemonPort, const bool daemonSSL)
+    {
+        if (!Config::config.wallet.shareDaemonConnections)
+        {
+            return std::make_shared<Nigel>(daemonHost, daemonPort, daemonSSL);
+        }
+
+        std::scoped_lock lock(connectionsMutex);
+
+        removeExpiredConnections();
+
+        for (const auto &connection : connections)
+        {
+            if (connection.daemonHost == daemonHost && connection.daemonPort == daemonPort
+                && connection.daemonSSL == daemonSSL)
+            {
+                if (const auto daemon = connection.daemon.lock())
+                {
+                    return daemon;
+                }
+            }
+        }
+
+        const auto daemon = std::make_shared<Nigel>(daemonHost, daemonPort, daemonSSL);
+
+        connections.push_back({daemonHost, daemonPort, daemonSSL, daemon, {}});
+
+        return daemon;
+    }
+
+    bool isShared(const std::shared_ptr<Nigel> &daemon)
+    {
+        std::scoped_lock lock(connectionsMutex);
+
+        return std::any_of(connections.begin(), connections.end(), [&daemon](const auto &connection) {
+            return connection.daemon.lock() == daemon;
+        });
+    }
+
+    std::shared_ptr<SharedBlockDownloader>
+        getBlockDownloader(const std::shared_ptr<Nigel> &daemon, const unsigned int threadCount)
+    {
+        if (!Config::config.wallet.shareDaemonConnections || Config::config.wallet.daemonSideScanning)
+        {
+            return nullptr;
+        }
+
+        std::scoped_lock lock(connectionsMutex);
+
+        for (auto &connection : connections)
+        {
+            if (connection.daemon.lock() != daemon)
+            {
+                continue;
+            }
+
+            auto blockDownloader = connection.blockDownloader.lock();
+
+            if (!blockDownloader)
+            {
+                auto pool = syncPool.lock();
+
+                if (!pool)
+                {
+                    pool = std::make_shared<Utilities::ThreadPool<bool>>(threadCount);
+                    syncPool = pool;
+                }
+
+                blockDownloader = std::make_shared<SharedBlockDownloader>(daemon, pool);
+                connection.blockDownloader = blockDownloader;
+            }
+
+            return blockDownloader;
+        }
+
+        return nullptr;
+    }
+} // namespace SharedDaemon
@@ -0,0 +1,33 @@
+// Copyright (c) 2018-2020, The WrkzCoin developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <memory>
+#include <nigel/Nigel.h>
+#include <string>
+#include <walletbackend/SharedBlockDownloader.h>
+
+namespace SharedDaemon
+{
+    /* Gets a daemon connection for the given host and port. When
+       Config::config.wallet.shareDaemonConnections is set, every wallet in the
+       process using the same daemon gets the same connection, and the blocks
+       downloaded through it are shared with the other wallets. Otherwise, a
+       new connection is returned each time. */
+    std::shared_ptr<Nigel> getDaemon(const std::string daemonHost, const uint16_t daemonPort, const bool daemonSSL);
+
+    /* Whether the connection was returned by getDaemon to be shared with
+       other wallets */
+    bool isShared(const std::shared_ptr<Nigel> &daemon);
+
+    /* Gets the block downloader of a shared daemon connection, which every
+       wallet using the connection is synced through, scanning blocks on a
+       thread pool shared by every wallet in the process. The pool is started
+       with threadCount threads by the first wallet to ask for it. Returns
+       nullptr if the connection is not shared, or the daemon scans blocks
+       for each wallet. */
+    std::shared_ptr<SharedBlockDownloader>
+        getBlockDownloader(const std::shared_ptr<Nigel> &daemon, const unsigned int threadCount);
+} // namespace SharedDaemon
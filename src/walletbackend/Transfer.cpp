@@ -18,7 +18,11 @@
 #include <utilities/Mixins.h>
 #include <utilities/Utilities.h>
 #include <walletbackend/WalletBackend.h>
+#include <chrono>
 #include <ctime> // time_t
+#include <future>
+#include <thread>
+#include <unordered_set>
 
 namespace SendTransaction
 {
@@ -100,6 +104,19 @@ namespace SendTransaction
             ? CryptoNote::parameters::FUSION_FEE_V1
             : 0;
 
+        /* Fetch the ring participants for all our inputs up front. If we have
+           to drop some inputs to fit in a fusion transaction, we can drop
+           their ring participants too, rather than asking the daemon again. */
+        const auto [mixinError, allInputsAndFakes] = prepareRingParticipants(ourInputs, mixin, daemon);
+
+        if (mixinError)
+        {
+            return {mixinError, Crypto::Hash()};
+        }
+
+        const size_t extraSize = getTransactionExtraSize(
+            paymentID, extraData, isTransactionPoWRequired(fee, daemon->networkBlockCount()));
+
         while (true)
         {
             /* Not got enough unspent inputs for a fusion tx - we're fully optimized. */
@@ -183,19 +200,22 @@ namespace SendTransaction
                 + unlock_blocks
                 + CryptoNote::parameters::MINIMUM_UNLOCK_TIME_BLOCKS;
 
-            WalletTypes::TransactionResult txResult =
-                makeTransaction(mixin, daemon, ourInputs, paymentID, destinations, subWallets, unlockTime, extraData);
-
-            tx = txResult.transaction;
-            transactionOutputs = txResult.outputs;
-            txKeyPair = txResult.txKeyPair;
+            std::unordered_set<Crypto::KeyImage> keyImages;
 
-            if (txResult.error)
+            for (const auto &input : ourInputs)
             {
-                return {txResult.error, Crypto::Hash()};
+                keyImages.insert(input.input.keyImage);
             }
 
-            const uint64_t txSize = toBinaryArray(tx).size();
+            std::vector<WalletTypes::ObscuredInput> inputsAndFakes;
+
+            std::copy_if(
+                allInputsAndFakes.begin(),
+                allInputsAndFakes.end(),
+                std::back_inserter(inputsAndFakes),
+                [&keyImages](const auto &input) { return keyImages.find(input.keyImage) != keyImages.end(); });
+
+            const uint64_t txSize = getTransactionSize(inputsAndFakes, destinations, unlockTime, extraSize);
 
             /* Transaction is too large, remove an input and try again */
             if (txSize > CryptoNote::parameters::FUSION_TX_MAX_SIZE)
@@ -210,6 +230,18 @@ namespace SendTransaction
                 continue;
             }
 
+            WalletTypes::TransactionResult txResult =
+                makeTransaction(inputsAndFakes, daemon, paymentID, destinations, subWallets, unlockTime, extraData);
+
+            tx = txResult.transaction;
+            transactionOutputs = txResult.outputs;
+            txKeyPair = txResult.txKeyPair;
+
+            if (txResult.error)
+            {
+                return {txResult.error, Crypto::Hash()};
+            }
+
             break;
         }
 
@@ -671,6 +703,19 @@ namespace SendTransaction
         const std::vector<uint8_t> extraData,
         const bool sendAll)
     {
+        /* Fetch the ring participants once - they don't depend on the fee, and
+           it's a round trip to the daemon */
+        const auto [mixinError, inputsAndFakes] = prepareRingParticipants(ourInputs, mixin, daemon);
+
+        if (mixinError)
+        {
+            WalletTypes::TransactionResult txResult;
+            txResult.error = mixinError;
+            return { true, txResult, sumOfInputs - amountIncludingFee, 0 };
+        }
+
+        const uint64_t height = daemon->networkBlockCount();
+
         while (true)
         {
             const uint64_t changeRequired = sumOfInputs - amountIncludingFee;
@@ -678,22 +723,20 @@ namespace SendTransaction
             /* Need to recalculate destinations since amount of change, err, changed! */
             const auto destinations = setupDestinations(addressesAndAmounts, changeRequired, changeAddress);
 
-            WalletTypes::TransactionResult txResult = makeTransaction(
-                mixin,
-                daemon,
-                ourInputs,
-                paymentID,
+            const bool transactionPoWRequired = isTransactionPoWRequired(amountIncludingFee - amountPreFee, height);
+
+            /* Work out the size the transaction will be, rather than signing
+               it to find out. We only sign once we've settled on the fee. */
+            const size_t actualTxSize = getTransactionSize(
+                inputsAndFakes,
                 destinations,
-                subWallets,
                 unlockTime,
-                extraData
+                getTransactionExtraSize(paymentID, extraData, transactionPoWRequired)
             );
 
-            const size_t actualTxSize = toBinaryArray(txResult.transaction).size();
-
             const uint64_t actualFee = Utilities::getTransactionFee(
                 actualTxSize,
-                daemon->networkBlockCount(),
+                height,
                 feePerByte
             );
 
@@ -703,6 +746,16 @@ namespace SendTransaction
              * transaction. */
             if (amountIncludingFee - amountPreFee >= actualFee)
             {
+                const WalletTypes::TransactionResult txResult = makeTransaction(
+                    inputsAndFakes,
+                    daemon,
+                    paymentID,
+                    destinations,
+                    subWallets,
+                    unlockTime,
+                    extraData
+                );
+
                 return { true, txResult, changeRequired, 0 };
             }
 
@@ -720,15 +773,15 @@ namespace SendTransaction
              * go select some more then try again. */
             if (amountPreFee + actualFee > sumOfInputs)
             {
-                return { false, txResult, changeRequired, amountPreFee + actualFee };
+                return { false, WalletTypes::TransactionResult(), changeRequired, amountPreFee + actualFee };
             }
 
-            /* Our fee was too low. Lets try making the transaction again,
-             * this time using the actual fee calculated. Note that this still
-             * may fail, since we are possibly adding more outputs, and so have
-             * a large transaction size. If we keep increasing the fee and keep
-             * failing, eventually we'll hit a point where we either succeed
-             * or we need to gather more inputs. */
+            /* Our fee was too low. Lets try again, this time using the actual
+             * fee calculated. Note that this still may fail, since we are
+             * possibly adding more outputs, and so have a large transaction
+             * size. If we keep increasing the fee and keep failing, eventually
+             * we'll hit a point where we either succeed or we need to gather
+             * more inputs. */
             amountIncludingFee = amountPreFee + actualFee;
         }
 
@@ -1225,62 +1278,71 @@ namespace SendTransaction
     {
         /* Hash the transaction prefix (Prefix is just a subset of transaction, so
            we can just do a cast here) */
-        Crypto::Hash txPrefixHash = getTransactionHash(static_cast<CryptoNote::TransactionPrefix>(tx));
+        const Crypto::Hash txPrefixHash = getTransactionHash(static_cast<CryptoNote::TransactionPrefix>(tx));
 
-        size_t i = 0;
+        tx.signatures.resize(inputsAndFakes.size());
 
-        /* Add the transaction signatures */
-        for (const auto &input : inputsAndFakes)
-        {
-            std::vector<Crypto::PublicKey> publicKeys;
-
-            /* Add all the fake outs public keys to a vector */
-            for (const auto output : input.outputs)
+        /* Generates and verifies the signatures for the inputs in [start, end) */
+        const auto signInputs = [&](const size_t start, const size_t end) {
+            for (size_t i = start; i < end; i++)
             {
-                publicKeys.push_back(output.key);
-            }
+                const auto &input = inputsAndFakes[i];
 
-            /* Generate the ring signatures - note - modifying the transaction
-               post signature generation will invalidate the signatures. */
-            const auto [success, signatures] = Crypto::crypto_ops::generateRingSignatures(
-                txPrefixHash,
-                boost::get<CryptoNote::KeyInput>(tx.inputs[i]).keyImage,
-                publicKeys,
-                tmpSecretKeys[i],
-                input.realOutput);
+                std::vector<Crypto::PublicKey> publicKeys;
 
-            if (!success)
-            {
-                return {FAILED_TO_CREATE_RING_SIGNATURE, tx};
+                /* Add all the fake outs public keys to a vector */
+                for (const auto &output : input.outputs)
+                {
+                    publicKeys.push_back(output.key);
+                }
+
+                const Crypto::KeyImage keyImage = boost::get<CryptoNote::KeyInput>(tx.inputs[i]).keyImage;
+
+                /* Generate the ring signatures - note - modifying the transaction
+                   post signature generation will invalidate the signatures. */
+                const auto [success, signatures] = Crypto::crypto_ops::generateRingSignatures(
+                    txPrefixHash,
+                    keyImage,
+                    publicKeys,
+                    tmpSecretKeys[i],
+                    input.realOutput);
+
+                if (!success || !Crypto::crypto_ops::checkRingSignature(txPrefixHash, keyImage, publicKeys, signatures))
+                {
+                    return false;
+                }
+
+                /* Add the signatures to the transaction */
+                tx.signatures[i] = signatures;
             }
 
-            /* Add the signatures to the transaction */
-            tx.signatures.push_back(signatures);
+            return true;
+        };
 
-            i++;
-        }
+        /* Each input is signed independently, so split them across our cores */
+        const size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
 
-        i = 0;
+        const size_t chunkSize = (inputsAndFakes.size() + threadCount - 1) / threadCount;
 
-        for (const auto &input : inputsAndFakes)
+        std::vector<std::future<bool>> results;
+
+        for (size_t start = 0; start < inputsAndFakes.size(); start += chunkSize)
         {
-            std::vector<Crypto::PublicKey> publicKeys;
+            const size_t end = std::min(start + chunkSize, inputsAndFakes.size());
 
-            for (const auto &output : input.outputs)
-            {
-                publicKeys.push_back(output.key);
-            }
+            results.push_back(std::async(std::launch::async, signInputs, start, end));
+        }
 
-            if (!Crypto::crypto_ops::checkRingSignature(
-                    txPrefixHash,
-                    boost::get<CryptoNote::KeyInput>(tx.inputs[i]).keyImage,
-                    publicKeys,
-                    tx.signatures[i]))
-            {
-                return {FAILED_TO_CREATE_RING_SIGNATURE, tx};
-            }
+        bool success = true;
 
-            i++;
+        for (auto &result : results)
+        {
+            success = result.get() && success;
+        }
+
+        if (!success)
+        {
+            return {FAILED_TO_CREATE_RING_SIGNATURE, tx};
         }
 
         return {SUCCESS, tx};
@@ -1380,14 +1442,27 @@ namespace SendTransaction
         /* Mix our inputs with fake ones from the network to hide who we are */
         const auto [mixinError, inputsAndFakes] = prepareRingParticipants(ourInputs, mixin, daemon);
 
-        WalletTypes::TransactionResult result;
-
         if (mixinError)
         {
+            WalletTypes::TransactionResult result;
             result.error = mixinError;
             return result;
         }
 
+        return makeTransaction(inputsAndFakes, daemon, paymentID, destinations, subWallets, unlockTime, extraData);
+    }
+
+    WalletTypes::TransactionResult makeTransaction(
+        const std::vector<WalletTypes::ObscuredInput> &inputsAndFakes,
+        const std::shared_ptr<Nigel> daemon,
+        const std::string paymentID,
+        const std::vector<WalletTypes::TransactionDestination> destinations,
+        const std::shared_ptr<SubWallets> subWallets,
+        const uint64_t unlockTime,
+        const std::vector<uint8_t> extraData)
+    {
+        WalletTypes::TransactionResult result;
+
         /* Setup the transaction inputs */
         const auto [inputError, transactionInputs, tmpSecretKeys] =
             setupInputs(inputsAndFakes, subWallets->getPrivateViewKey());
@@ -1401,6 +1476,85 @@ namespace SendTransaction
         /* Setup the transaction outputs */
         std::tie(result.outputs, result.txKeyPair) = setupOutputs(destinations);
 
+        const std::vector<uint8_t> extra = makeTransactionExtra(paymentID, extraData, result.txKeyPair.publicKey);
+
+        CryptoNote::Transaction setupTX;
+
+        setupTX.version = CryptoNote::CURRENT_TRANSACTION_VERSION;
+
+        setupTX.unlockTime = unlockTime;
+
+        /* Convert from key inputs to the boost uglyness */
+        setupTX.inputs = keyInputToTransactionInput(transactionInputs);
+
+        /* We can't really remove boost from here yet and simplify our data types
+           since we take a hash of the transaction prefix. Once we've got this
+           working, maybe we can work some magic. TODO */
+        setupTX.outputs = keyOutputToTransactionOutput(result.outputs);
+
+        if (setupTX.outputs.size() > CryptoNote::parameters::NORMAL_TX_MAX_OUTPUT_COUNT_V1)
+        {
+            result.error = OUTPUT_DECOMPOSITION;
+
+            return result;
+        }
+
+        /* Generate the transaction proof of work, this comes before the ring
+         * signature generation, as ring signatures take the transaction prefix
+         * hash. Generating it afterwards would change the hash, and thus invalidate
+         * the sigs. */
+
+        Logger::logger.log(
+            "Tx PoW preparing",
+            Logger::DEBUG,
+            { Logger::TRANSACTIONS }
+        );
+
+        try
+        {
+            /* get time start and end for Tx PoW Log */
+            time_t time_begin, time_end; // time_t is a datatype to store time values.
+
+            time (&time_begin); // note time before execution
+
+            if (isTransactionPoWRequired(sumTransactionFee(setupTX), daemon->networkBlockCount()))
+            {
+                setupTX.extra = generateTransactionPoWHeight(setupTX, extra, daemon->networkBlockCount());
+            }
+            else
+            {
+                /* If fee passes */
+                setupTX.extra = extra;
+            }
+
+            time (&time_end); // note time after execution
+
+            const double difference = difftime (time_end, time_begin);
+
+            Logger::logger.log(
+                "Tx PoW took " + std::to_string(difference) + " second(s)",
+                Logger::DEBUG,
+                { Logger::TRANSACTIONS }
+            );
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << "Unhandled exception caught: " << e.what() << "\n..." << std::endl;
+        }
+
+        /* Fill in the transaction signatures */
+        /* NOTE: Do not modify the transaction after this, or the ring signatures
+           will be invalidated */
+        std::tie(result.error, result.transaction) = generateRingSignatures(setupTX, inputsAndFakes, tmpSecretKeys);
+
+        return result;
+    }
+
+    std::vector<uint8_t> makeTransactionExtra(
+        const std::string paymentID,
+        const std::vector<uint8_t> &extraData,
+        const Crypto::PublicKey &txPublicKey)
+    {
         std::vector<uint8_t> extraNonce;
 
         if (paymentID != "")
@@ -1451,88 +1605,83 @@ namespace SendTransaction
         /* Add the pub key identifier to extra */
         extra.push_back(Constants::TX_EXTRA_PUBKEY_IDENTIFIER);
 
-        const auto pubKey = result.txKeyPair.publicKey;
-
         /* Append the pub key to extra */
-        std::copy(std::begin(pubKey.data), std::end(pubKey.data), std::back_inserter(extra));
-
-        CryptoNote::Transaction setupTX;
+        std::copy(std::begin(txPublicKey.data), std::end(txPublicKey.data), std::back_inserter(extra));
 
-        setupTX.version = CryptoNote::CURRENT_TRANSACTION_VERSION;
+        return extra;
+    }
 
-        setupTX.unlockTime = unlockTime;
+    size_t getTransactionExtraSize(
+        const std::string paymentID,
+        const std::vector<uint8_t> &extraData,
+        const bool transactionPoWRequired)
+    {
+        /* The size of extra doesn't depend on the transaction key itself */
+        size_t size = makeTransactionExtra(paymentID, extraData, Crypto::PublicKey()).size();
 
-        /* Convert from key inputs to the boost uglyness */
-        setupTX.inputs = keyInputToTransactionInput(transactionInputs);
+        if (transactionPoWRequired)
+        {
+            /* Nonce identifier, followed by the nonce, see generateTransactionPoWHeight() */
+            size += sizeof(uint8_t) + sizeof(uint64_t);
+        }
 
-        /* We can't really remove boost from here yet and simplify our data types
-           since we take a hash of the transaction prefix. Once we've got this
-           working, maybe we can work some magic. TODO */
-        setupTX.outputs = keyOutputToTransactionOutput(result.outputs);
+        return size;
+    }
 
-        if (setupTX.outputs.size() > CryptoNote::parameters::NORMAL_TX_MAX_OUTPUT_COUNT_V1)
-        {
-            result.error = OUTPUT_DECOMPOSITION;
+    bool isTransactionPoWRequired(const uint64_t fee, const uint64_t height)
+    {
+        return height < CryptoNote::parameters::TRANSACTION_POW_PASS_WITH_FEE_HEIGHT
+            || fee < CryptoNote::parameters::TRANSACTION_POW_PASS_WITH_FEE;
+    }
 
-            return result;
-        }
+    size_t getTransactionSize(
+        const std::vector<WalletTypes::ObscuredInput> &inputsAndFakes,
+        const std::vector<WalletTypes::TransactionDestination> &destinations,
+        const uint64_t unlockTime,
+        const size_t extraSize)
+    {
+        const size_t TAG_SIZE = sizeof(uint8_t);
+        const size_t KEY_IMAGE_SIZE = sizeof(Crypto::KeyImage);
+        const size_t OUTPUT_KEY_SIZE = sizeof(Crypto::PublicKey);
+        const size_t SIGNATURE_SIZE = sizeof(Crypto::Signature);
 
-        /* Generate the transaction proof of work, this comes before the ring
-         * signature generation, as ring signatures take the transaction prefix
-         * hash. Generating it afterwards would change the hash, and thus invalidate
-         * the sigs. */
+        size_t size = Tools::getVarintSize(CryptoNote::CURRENT_TRANSACTION_VERSION)
+                    + Tools::getVarintSize(unlockTime);
 
-        Logger::logger.log(
-            "Tx PoW preparing",
-            Logger::DEBUG,
-            { Logger::TRANSACTIONS }
-        );
+        size += Tools::getVarintSize(inputsAndFakes.size());
 
-        try
+        for (const auto &input : inputsAndFakes)
         {
-            /* get time start and end for Tx PoW Log */
-            time_t time_begin, time_end; // time_t is a datatype to store time values.
+            size += TAG_SIZE + Tools::getVarintSize(input.amount) + Tools::getVarintSize(input.outputs.size())
+                  + KEY_IMAGE_SIZE;
 
-            time (&time_begin); // note time before execution
+            /* The ring members are stored relative to the previous one, see
+               setupInputs() */
+            uint32_t previousIndex = 0;
 
-            if (daemon->networkBlockCount() < CryptoNote::parameters::TRANSACTION_POW_PASS_WITH_FEE_HEIGHT)
-            {
-                setupTX.extra = generateTransactionPoWHeight(setupTX, extra, daemon->networkBlockCount());
-            } else
+            for (const auto &output : input.outputs)
             {
-                const uint64_t actualFee = sumTransactionFee(setupTX);
+                const uint32_t index = static_cast<uint32_t>(output.index);
 
-                if (actualFee >= CryptoNote::parameters::TRANSACTION_POW_PASS_WITH_FEE)
-                {
-                    /* If fee passes */
-                    setupTX.extra = extra;
-                } else
-                {
-                    setupTX.extra = generateTransactionPoWHeight(setupTX, extra, daemon->networkBlockCount());
-                }
+                size += Tools::getVarintSize(index - previousIndex);
+
+                previousIndex = index;
             }
 
-            time (&time_end); // note time after execution
+            /* One signature per ring member */
+            size += input.outputs.size() * SIGNATURE_SIZE;
+        }
 
-            const double difference = difftime (time_end, time_begin);
+        size += Tools::getVarintSize(destinations.size());
 
-            Logger::logger.log(
-                "Tx PoW took " + std::to_string(difference) + " second(s)",
-                Logger::DEBUG,
-                { Logger::TRANSACTIONS }
-            );
-        }
-        catch (const std::exception &e)
+        for (const auto &destination : destinations)
         {
-            std::cout << "Unhandled exception caught: " << e.what() << "\n..." << std::endl;
+            size += Tools::getVarintSize(destination.amount) + TAG_SIZE + OUTPUT_KEY_SIZE;
         }
 
-        /* Fill in the transaction signatures */
-        /* NOTE: Do not modify the transaction after this, or the ring signatures
-           will be invalidated */
-        std::tie(result.error, result.transaction) = generateRingSignatures(setupTX, inputsAndFakes, tmpSecretKeys);
+        size += Tools::getVarintSize(extraSize) + extraSize;
 
-        return result;
+        return size;
     }
 
     bool verifyAmounts(const CryptoNote::Transaction tx)
@@ -1628,90 +1777,81 @@ namespace SendTransaction
         }
     }
 
-    void generateTransactionPowWorker(
-        std::vector<uint8_t> &finalExtra,
-        const int threadCount,
-        uint64_t nonce,
-        std::atomic<bool> &shouldStop,
-        CryptoNote::Transaction tx,
+    uint64_t getTransactionPoWDifficulty(
+        const CryptoNote::Transaction &tx,
         const uint64_t height)
     {
-        /* Make a thread local copy */
-        auto extra = finalExtra;
+        const uint64_t actualFee = sumTransactionFee(tx);
 
-        /* Get a pointer to the start of where we want to insert our nonce */
-        const auto noncePosition = &extra[extra.size() - 8];
+        const bool isFusion = actualFee == 0 || (actualFee == CryptoNote::parameters::FUSION_FEE_V1 && height >= CryptoNote::parameters::FUSION_FEE_V1_HEIGHT
+            && height < CryptoNote::parameters::FUSION_ZERO_FEE_V2_HEIGHT);
 
-        while (true)
-        {
-            if (shouldStop)
-            {
-                return;
-            }
+        uint64_t diff = CryptoNote::parameters::TRANSACTION_POW_DIFFICULTY_DYN_V1;
 
-            /* Copy in the nonce */
-            std::memcpy(noncePosition, &nonce, sizeof(nonce));
+        const uint64_t txInputSize = tx.inputs.size();
 
-            Crypto::Hash hash;
+        const uint64_t txOutputSize = tx.outputs.size();
 
-            tx.extra = extra;
+        if (height >= CryptoNote::parameters::TRANSACTION_POW_HEIGHT && 
+        height < CryptoNote::parameters::TRANSACTION_POW_HEIGHT_DYN_V1)
+        {
+            diff = isFusion ? CryptoNote::parameters::FUSION_TRANSACTION_POW_DIFFICULTY : CryptoNote::parameters::TRANSACTION_POW_DIFFICULTY;
+        } else if (height >= CryptoNote::parameters::TRANSACTION_POW_HEIGHT_DYN_V1)
+        {
+            diff = isFusion ? CryptoNote::parameters::FUSION_TRANSACTION_POW_DIFFICULTY_V2 : 
+            (CryptoNote::parameters::TRANSACTION_POW_DIFFICULTY_DYN_V1 
+            + (txInputSize + txOutputSize * CryptoNote::parameters::MULTIPLIER_TRANSACTION_POW_DIFFICULTY_FACTORED_OUT_V1) 
+            * CryptoNote::parameters::MULTIPLIER_TRANSACTION_POW_DIFFICULTY_PER_IO_V1);
+        }
 
-            std::vector<uint8_t> data = toBinaryArray(static_cast<CryptoNote::TransactionPrefix>(tx));
+        return diff;
+    }
 
-            Crypto::cn_upx(data.data(), data.size(), hash);
+    void generateTransactionPowWorker(
+        std::vector<uint8_t> data,
+        const size_t nonceOffset,
+        const uint64_t diff,
+        const int threadCount,
+        uint64_t nonce,
+        std::atomic<bool> &shouldStop,
+        uint64_t &foundNonce,
+        std::atomic<uint64_t> &hashCount)
+    {
+        /* Get a pointer to where the nonce lives in our thread local copy of
+           the serialized prefix. Nothing else changes between attempts, so we
+           just patch these 8 bytes and rehash the same buffer. */
+        uint8_t *noncePosition = data.data() + nonceOffset;
 
-            const uint64_t actualFee = sumTransactionFee(tx);
+        uint64_t hashes = 0;
 
-            const bool isFusion = actualFee == 0 || (actualFee == CryptoNote::parameters::FUSION_FEE_V1 && height >= CryptoNote::parameters::FUSION_FEE_V1_HEIGHT
-                && height < CryptoNote::parameters::FUSION_ZERO_FEE_V2_HEIGHT);
+        Crypto::Hash hash;
 
-            uint64_t diff = CryptoNote::parameters::TRANSACTION_POW_DIFFICULTY_DYN_V1;
-            
-            uint64_t txInputSize = 0;
-            try
-            {
-                txInputSize = tx.inputs.size();
-            }
-            catch (const std::exception &e)
-            {
-            }
+        while (!shouldStop.load(std::memory_order_relaxed))
+        {
+            /* Copy in the nonce */
+            std::memcpy(noncePosition, &nonce, sizeof(nonce));
 
-            uint64_t txOutputSize = 0;
-            try
-            {
-                txOutputSize = tx.outputs.size();
-            }
-            catch (const std::exception &e)
-            {
-            }
+            Crypto::cn_upx(data.data(), data.size(), hash);
 
-            if (height >= CryptoNote::parameters::TRANSACTION_POW_HEIGHT && 
-            height < CryptoNote::parameters::TRANSACTION_POW_HEIGHT_DYN_V1)
-            {
-                diff = isFusion ? CryptoNote::parameters::FUSION_TRANSACTION_POW_DIFFICULTY : CryptoNote::parameters::TRANSACTION_POW_DIFFICULTY;
-            } else if (height >= CryptoNote::parameters::TRANSACTION_POW_HEIGHT_DYN_V1)
-            {
-                diff = isFusion ? CryptoNote::parameters::FUSION_TRANSACTION_POW_DIFFICULTY_V2 : 
-                (CryptoNote::parameters::TRANSACTION_POW_DIFFICULTY_DYN_V1 
-                + (txInputSize + txOutputSize * CryptoNote::parameters::MULTIPLIER_TRANSACTION_POW_DIFFICULTY_FACTORED_OUT_V1) 
-                * CryptoNote::parameters::MULTIPLIER_TRANSACTION_POW_DIFFICULTY_PER_IO_V1);
-            }
+            hashes++;
 
             if (CryptoNote::check_hash(hash, diff))
             {
-                Logger::logger.log(
-                    "Making Tx PoW with difficulty " + std::to_string(diff),
-                    Logger::DEBUG,
-                    { Logger::TRANSACTIONS }
-                );
-                finalExtra = extra;
-                shouldStop = true;
+                bool expected = false;
 
-                return;
+                /* Only the first thread to find a valid nonce gets to store it */
+                if (shouldStop.compare_exchange_strong(expected, true))
+                {
+                    foundNonce = nonce;
+                }
+
+                break;
             }
 
             nonce += threadCount;
         }
+
+        hashCount += hashes;
     }
 
     std::vector<uint8_t> generateTransactionPoWHeight(
@@ -1725,24 +1865,49 @@ namespace SendTransaction
         /* Add extra room for the nonce */
         extra.resize(extra.size() + 8);
 
+        /* Fee, fusion status and input/output counts don't depend on the
+           nonce, so work the difficulty out once up front */
+        const uint64_t diff = getTransactionPoWDifficulty(tx, height);
+
+        tx.extra = extra;
+
+        /* Serialize the prefix once. Extra is the last field of the prefix,
+           and the nonce is the last thing in extra, so the nonce occupies
+           the final 8 bytes of the blob. */
+        const std::vector<uint8_t> data = toBinaryArray(static_cast<CryptoNote::TransactionPrefix>(tx));
+
+        const size_t nonceOffset = data.size() - sizeof(uint64_t);
+
         std::vector<std::thread> threads;
 
         const int threadCount = std::max(1u, std::thread::hardware_concurrency());
 
         std::atomic<bool> shouldStop = false;
 
-        const std::shared_ptr<Nigel> daemon;
+        std::atomic<uint64_t> hashCount = 0;
+
+        uint64_t foundNonce = 0;
+
+        Logger::logger.log(
+            "Making Tx PoW with difficulty " + std::to_string(diff),
+            Logger::DEBUG,
+            { Logger::TRANSACTIONS }
+        );
+
+        const auto startTime = std::chrono::steady_clock::now();
 
         for (int i = 0; i < threadCount; i++)
         {
             threads.push_back(std::thread(
                 generateTransactionPowWorker,
-                std::ref(extra),
+                data,
+                nonceOffset,
+                diff,
                 threadCount,
                 i,
                 std::ref(shouldStop),
-                tx,
-                height
+                std::ref(foundNonce),
+                std::ref(hashCount)
             ));
         }
 
@@ -1751,6 +1916,23 @@ namespace SendTransaction
             thread.join();
         }
 
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime
+        ).count();
+
+        const uint64_t hashes = hashCount.load();
+
+        Logger::logger.log(
+            "Tx PoW found after " + std::to_string(hashes) + " hashes in "
+            + std::to_string(elapsed) + "ms ("
+            + std::to_string(elapsed > 0 ? hashes * 1000 / elapsed : hashes) + " H/s, "
+            + std::to_string(threadCount) + " threads)",
+            Logger::DEBUG,
+            { Logger::TRANSACTIONS }
+        );
+
+        std::memcpy(&extra[extra.size() - sizeof(uint64_t)], &foundNonce, sizeof(foundNonce));
+
         return extra;
     }
 } // namespace SendTransaction
@@ -103,6 +103,40 @@ namespace SendTransaction
         const uint64_t unlockTime,
         const std::vector<uint8_t> extraData);
 
+    /* Makes and signs the transaction, using ring participants we have
+       already fetched */
+    WalletTypes::TransactionResult makeTransaction(
+        const std::vector<WalletTypes::ObscuredInput> &inputsAndFakes,
+        const std::shared_ptr<Nigel> daemon,
+        const std::string paymentID,
+        const std::vector<WalletTypes::TransactionDestination> destinations,
+        const std::shared_ptr<SubWallets> subWallets,
+        const uint64_t unlockTime,
+        const std::vector<uint8_t> extraData);
+
+    /* Builds the transaction extra, minus the transaction proof of work */
+    std::vector<uint8_t> makeTransactionExtra(
+        const std::string paymentID,
+        const std::vector<uint8_t> &extraData,
+        const Crypto::PublicKey &txPublicKey);
+
+    /* Gets the size of the transaction extra makeTransaction() will create */
+    size_t getTransactionExtraSize(
+        const std::string paymentID,
+        const std::vector<uint8_t> &extraData,
+        const bool transactionPoWRequired);
+
+    /* Whether a transaction with this fee needs a proof of work attached */
+    bool isTransactionPoWRequired(const uint64_t fee, const uint64_t height);
+
+    /* Gets the exact serialized size of the transaction these inputs and
+       destinations would make, without having to create or sign it */
+    size_t getTransactionSize(
+        const std::vector<WalletTypes::ObscuredInput> &inputsAndFakes,
+        const std::vector<WalletTypes::TransactionDestination> &destinations,
+        const uint64_t unlockTime,
+        const size_t extraSize);
+
     std::tuple<Error, Crypto::Hash>
         relayTransaction(const CryptoNote::Transaction tx, const std::shared_ptr<Nigel> daemon);
 
@@ -155,6 +189,11 @@ namespace SendTransaction
         const uint64_t height,
         const CryptoNote::Transaction tx);
 
+    /* The tx PoW difficulty the transaction must meet at the given height */
+    uint64_t getTransactionPoWDifficulty(
+        const CryptoNote::Transaction &tx,
+        const uint64_t height);
+
     std::vector<uint8_t> generateTransactionPoWHeight(
         CryptoNote::Transaction tx,
         std::vector<uint8_t> extra,
@@ -34,6 +34,7 @@
 #include <utilities/Addresses.h>
 #include <utilities/Utilities.h>
 #include <walletbackend/Constants.h>
+#include <walletbackend/SharedDaemon.h>
 #include <walletbackend/Transfer.h>
 
 using namespace rapidjson;
@@ -134,7 +135,7 @@ WalletBackend::WalletBackend(
 
     m_filename(filename),
     m_password(password),
-    m_daemon(std::make_shared<Nigel>(daemonHost, daemonPort, daemonSSL)),
+    m_daemon(SharedDaemon::getDaemon(daemonHost, daemonPort, daemonSSL)),
     m_syncThreadCount(syncThreadCount)
 {
     /* Generate the address from the two private keys */
@@ -159,7 +160,7 @@ WalletBackend::WalletBackend(
 
     m_filename(filename),
     m_password(password),
-    m_daemon(std::make_shared<Nigel>(daemonHost, daemonPort, daemonSSL)),
+    m_daemon(SharedDaemon::getDaemon(daemonHost, daemonPort, daemonSSL)),
     m_syncThreadCount(syncThreadCount)
 {
     bool newWallet = false;
@@ -1189,32 +1190,28 @@ WalletTypes::WalletStatus WalletBackend::getStatus() const
 
 /* Returns transactions in the range [startHeight, endHeight - 1] - so if
    we give 1, 100, it will return transactions from block 1 to block 99 */
-std::vector<WalletTypes::Transaction>
-    WalletBackend::getTransactionsRange(const uint64_t startHeight, const uint64_t endHeight) const
+std::vector<WalletTypes::Transaction> WalletBackend::getTransactionsRange(
+    const uint64_t startHeight,
+    const uint64_t endHeight,
+    const std::optional<Crypto::PublicKey> publicSpendKey) const
 {
-    std::vector<WalletTypes::Transaction> result;
+    return m_subWallets->getTransactionsRange(startHeight, endHeight, publicSpendKey);
+}
 
-    try {
-        const auto transactions = getTransactions();
+std::optional<WalletTypes::Transaction> WalletBackend::getTransaction(const Crypto::Hash &hash) const
+{
+    return m_subWallets->getTransaction(hash);
+}
 
-        if (!transactions.empty())
-        {
-            std::copy_if(
-                transactions.begin(),
-                transactions.end(),
-                std::back_inserter(result),
-                [&startHeight, &endHeight](const auto tx) {
-                    return tx.blockHeight >= startHeight && tx.blockHeight < endHeight;
-                });
-
-            return result;
-        } else
-        {
-            return std::vector<WalletTypes::Transaction> {};
-        }
-    } catch (const std::exception &e)
-    {
-    }
+std::tuple<Error, std::vector<WalletTypes::Transaction>, std::optional<Crypto::Hash>>
+    WalletBackend::getTransactionsPage(
+        const uint64_t startHeight,
+        const uint64_t endHeight,
+        const std::optional<Crypto::PublicKey> publicSpendKey,
+        const std::optional<Crypto::Hash> cursor,
+        const uint64_t limit) const
+{
+    return m_subWallets->getTransactionsPage(startHeight, endHeight, publicSpendKey, cursor, limit);
 }
 
 std::tuple<uint64_t, std::string> WalletBackend::getNodeFee() const
@@ -1230,8 +1227,18 @@ std::tuple<std::string, uint16_t, bool> WalletBackend::getNodeAddress() const
 void WalletBackend::swapNode(std::string daemonHost, uint16_t daemonPort, bool daemonSSL)
 {
     m_syncRAIIWrapper->pauseSynchronizerToRunFunction([&, this]() {
-        /* Swap and init the node */
-        m_daemon->swapNode(daemonHost, daemonPort, daemonSSL);
+        /* The connection is used by other wallets too, so switch to a
+           connection to the new daemon rather than changing it under them */
+        if (SharedDaemon::isShared(m_daemon))
+        {
+            m_daemon = SharedDaemon::getDaemon(daemonHost, daemonPort, daemonSSL);
+            m_daemon->init();
+        }
+        else
+        {
+            /* Swap and init the node */
+            m_daemon->swapNode(daemonHost, daemonPort, daemonSSL);
+        }
 
         /* Give the synchronizer the new daemon */
         m_walletSynchronizer->swapNode(m_daemon);
@@ -1334,7 +1341,7 @@ Error WalletBackend::fromJSON(
     m_password = password;
     m_syncThreadCount = syncThreadCount;
 
-    m_daemon = std::make_shared<Nigel>(daemonHost, daemonPort, daemonSSL);
+    m_daemon = SharedDaemon::getDaemon(daemonHost, daemonPort, daemonSSL);
 
     init();
 
@@ -246,8 +246,23 @@ class WalletBackend
 
     /* Returns transactions in the range [startHeight, endHeight - 1] - so if
        we give 1, 100, it will return transactions from block 1 to block 99 */
-    std::vector<WalletTypes::Transaction>
-        getTransactionsRange(const uint64_t startHeight, const uint64_t endHeight) const;
+    std::vector<WalletTypes::Transaction> getTransactionsRange(
+        const uint64_t startHeight,
+        const uint64_t endHeight,
+        const std::optional<Crypto::PublicKey> publicSpendKey = std::nullopt) const;
+
+    /* Gets the transaction with the given hash, if it exists */
+    std::optional<WalletTypes::Transaction> getTransaction(const Crypto::Hash &hash) const;
+
+    /* Returns up to limit transactions in the range [startHeight, endHeight - 1],
+       starting after the transaction hash given as the cursor. Also returns
+       the cursor for the next page, if there is one. */
+    std::tuple<Error, std::vector<WalletTypes::Transaction>, std::optional<Crypto::Hash>> getTransactionsPage(
+        const uint64_t startHeight,
+        const uint64_t endHeight,
+        const std::optional<Crypto::PublicKey> publicSpendKey,
+        const std::optional<Crypto::Hash> cursor,
+        const uint64_t limit) const;
 
     /* Get the node fee and address ({0, ""} if empty) */
     std::tuple<uint64_t, std::string> getNodeFee() const;
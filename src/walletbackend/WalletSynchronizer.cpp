@@ -6,6 +6,7 @@
 #include <walletbackend/WalletSynchronizer.h>
 /////////////////////////////////////////////
 
+#include <algorithm>
 #include <common/StringTools.h>
 #include <config/Config.h>
 #include <config/WalletConfig.h>
@@ -17,6 +18,7 @@
 #include <utilities/ThreadSafeQueue.h>
 #include <utilities/Utilities.h>
 #include <walletbackend/Constants.h>
+#include <walletbackend/SharedDaemon.h>
 
 ///////////////////////////////////
 /* CONSTRUCTORS / DECONSTRUCTORS */
@@ -111,7 +113,7 @@ WalletSynchronizer::~WalletSynchronizer()
 
 void WalletSynchronizer::mainLoop()
 {
-    auto lastCheckedLockedTransactions = std::chrono::system_clock::now();
+    m_lastCheckedLockedTransactions = std::chrono::system_clock::now();
 
     while (!m_shouldStop)
     {
@@ -167,15 +169,7 @@ void WalletSynchronizer::mainLoop()
         /* If we're synced, check any transactions that may be in the pool */
         if (getCurrentScanHeight() >= m_daemon->localDaemonBlockCount() && !m_shouldStop)
         {
-            const auto now = std::chrono::system_clock::now();
-            const auto timeDiff = now - lastCheckedLockedTransactions;
-
-            /* Not a viewwallet and haven't checked transactions in last 15 secs */
-            if (!m_subWallets->isViewWallet() && timeDiff > std::chrono::seconds(15))
-            {
-                checkLockedTransactions();
-                lastCheckedLockedTransactions = now;
-            }
+            checkLockedTransactionsPeriodically();
 
             Utilities::sleepUnlessStopping(std::chrono::seconds(5), m_shouldStop);
         }
@@ -230,56 +224,14 @@ void WalletSynchronizer::blockProcessingThread()
         {
             for (const auto &[block, arrivalIndex] : chunk)
             {
-                Logger::logger.log(
-                    "Processing block " + std::to_string(block.blockHeight), Logger::DEBUG, {Logger::SYNC});
-
-                auto ourInputs = processBlockOutputs(block);
+                const auto ourInputs = processBlock(block, true);
 
-                std::unordered_map<Crypto::Hash, std::vector<uint64_t>> globalIndexes;
-
-                for (auto &[publicKey, input] : ourInputs)
+                if (!ourInputs)
                 {
-                    if (!m_subWallets->isViewWallet() && !input.globalOutputIndex)
-                    {
-                        if (globalIndexes.empty())
-                        {
-                            globalIndexes = getGlobalIndexes(block.blockHeight);
-                        }
-
-                        auto it = globalIndexes.find(input.parentTransactionHash);
-
-                        /* Daemon returns indexes for hashes in a range. If we don't
-                           find our hash, either the chain has forked, or the daemon
-                           is faulty. Print a warning message, then return so we
-                           can fetch new blocks, in the likely case the daemon has
-                           forked.
-
-                           Also need to check there are enough indexes for the one we want */
-                        while (it == globalIndexes.end() || it->second.size() <= input.transactionIndex)
-                        {
-                            if (m_shouldStop)
-                            {
-                                return;
-                            }
-
-                            Logger::logger.log(
-                                "Warning: Failed to get correct global indexes from daemon."
-                                "\nThe daemon may have gone offline or the chain may have just forked.",
-                                Logger::FATAL,
-                                {Logger::SYNC, Logger::DAEMON});
-
-                            std::this_thread::sleep_for(std::chrono::seconds(5));
-
-                            globalIndexes = getGlobalIndexes(block.blockHeight);
-
-                            it = globalIndexes.find(input.parentTransactionHash);
-                        }
-
-                        input.globalOutputIndex = it->second[input.transactionIndex];
-                    }
+                    return;
                 }
 
-                processedBlocks.push_back({block, ourInputs, arrivalIndex});
+                processedBlocks.push_back({block, *ourInputs, arrivalIndex});
             }
 
             chunk = m_blockProcessingQueue.front_n_and_remove(chunkSize);
@@ -302,6 +254,167 @@ void WalletSynchronizer::blockProcessingThread()
     }
 }
 
+std::optional<BlockInputsAndOwners> WalletSynchronizer::processBlock(
+    const WalletTypes::WalletBlockInfo &block,
+    const bool waitForGlobalIndexes) const
+{
+    Logger::logger.log("Processing block " + std::to_string(block.blockHeight), Logger::DEBUG, {Logger::SYNC});
+
+    auto ourInputs = processBlockOutputs(block);
+
+    std::unordered_map<Crypto::Hash, std::vector<uint64_t>> globalIndexes;
+
+    for (auto &[publicKey, input] : ourInputs)
+    {
+        if (!m_subWallets->isViewWallet() && !input.globalOutputIndex)
+        {
+            if (globalIndexes.empty())
+            {
+                globalIndexes = getGlobalIndexes(block.blockHeight);
+            }
+
+            auto it = globalIndexes.find(input.parentTransactionHash);
+
+            /* Daemon returns indexes for hashes in a range. If we don't
+               find our hash, either the chain has forked, or the daemon
+               is faulty. Print a warning message, then return so we
+               can fetch new blocks, in the likely case the daemon has
+               forked.
+
+               Also need to check there are enough indexes for the one we want */
+            while (it == globalIndexes.end() || it->second.size() <= input.transactionIndex)
+            {
+                if (m_shouldStop)
+                {
+                    return std::nullopt;
+                }
+
+                Logger::logger.log(
+                    "Warning: Failed to get correct global indexes from daemon."
+                    "\nThe daemon may have gone offline or the chain may have just forked.",
+                    Logger::FATAL,
+                    {Logger::SYNC, Logger::DAEMON});
+
+                /* Don't hold up a pool shared with other wallets, the
+                   caller will hand us the block again later */
+                if (!waitForGlobalIndexes)
+                {
+                    return std::nullopt;
+                }
+
+                std::this_thread::sleep_for(std::chrono::seconds(5));
+
+                globalIndexes = getGlobalIndexes(block.blockHeight);
+
+                it = globalIndexes.find(input.parentTransactionHash);
+            }
+
+            input.globalOutputIndex = it->second[input.transactionIndex];
+        }
+    }
+
+    return ourInputs;
+}
+
+ScanPosition WalletSynchronizer::getScanPosition() const
+{
+    return m_blockDownloader.getScanPosition();
+}
+
+void WalletSynchronizer::scanBlocks(
+    const std::vector<SharedBlock> &blocks,
+    Utilities::ThreadPool<bool> &pool,
+    std::function<void(const bool success)> done)
+{
+    m_blockDownloader.convertSyncTimestampToHeight(blocks.front()->blockHeight);
+
+    struct ScanJob
+    {
+        std::vector<SharedBlock> blocks;
+
+        std::vector<std::optional<BlockInputsAndOwners>> results;
+
+        std::atomic<size_t> remainingChunks;
+
+        std::atomic<bool> failed = false;
+
+        std::function<void(const bool success)> done;
+    };
+
+    auto job = std::make_shared<ScanJob>();
+
+    job->blocks = blocks;
+    job->results.resize(blocks.size());
+    job->done = std::move(done);
+
+    /* A couple of jobs per pool thread, as with the dedicated threads */
+    const size_t chunkSize = std::max<size_t>(1, blocks.size() / pool.threadCount() / 2);
+
+    job->remainingChunks = (blocks.size() + chunkSize - 1) / chunkSize;
+
+    for (size_t begin = 0; begin < blocks.size(); begin += chunkSize)
+    {
+        const size_t end = std::min(begin + chunkSize, blocks.size());
+
+        /* The pool is shared with other wallets, so don't wait on it. The
+           last chunk to finish completes the blocks. */
+        pool.addJob([this, job, begin, end] {
+            for (size_t i = begin; i < end && !job->failed; i++)
+            {
+                job->results[i] = processBlock(*job->blocks[i], false);
+
+                if (!job->results[i])
+                {
+                    job->failed = true;
+                }
+            }
+
+            if (--job->remainingChunks != 0)
+            {
+                return true;
+            }
+
+            if (job->failed)
+            {
+                job->done(false);
+                return true;
+            }
+
+            /* Blocks are handled in the order they were fetched, which the
+               downloader relies on to handle forks */
+            for (size_t i = 0; i < job->blocks.size(); i++)
+            {
+                if (m_shouldStop)
+                {
+                    job->done(false);
+                    return true;
+                }
+
+                completeBlockProcessing(*job->blocks[i], *job->results[i]);
+            }
+
+            job->done(true);
+
+            return true;
+        });
+    }
+}
+
+void WalletSynchronizer::synced(const std::optional<WalletTypes::TopBlock> &topBlock)
+{
+    /* Store the top block so sync status displays correctly if we are not
+       scanning coinbase tx only blocks */
+    if (topBlock)
+    {
+        m_blockDownloader.storeProcessedBlock(topBlock->height, topBlock->hash);
+    }
+
+    if (!m_shouldStop)
+    {
+        checkLockedTransactionsPeriodically();
+    }
+}
+
 std::vector<std::tuple<Crypto::PublicKey, WalletTypes::TransactionInput>>
     WalletSynchronizer::processBlockOutputs(const WalletTypes::WalletBlockInfo &block) const
 {
@@ -390,7 +503,14 @@ void WalletSynchronizer::completeBlockProcessing(
     /* Make sure to do this at the end, once the transactions are fully
        processed! Otherwise, we could miss a transaction depending upon
        when we save */
-    m_blockDownloader.dropBlock(block.blockHeight, block.blockHash);
+    if (m_sharedBlockDownloader)
+    {
+        m_blockDownloader.storeProcessedBlock(block.blockHeight, block.blockHash);
+    }
+    else
+    {
+        m_blockDownloader.dropBlock(block.blockHeight, block.blockHash);
+    }
 
     if (block.blockHeight >= m_daemon->networkBlockCount())
     {
@@ -438,6 +558,12 @@ std::optional<WalletTypes::Transaction> WalletSynchronizer::processCoinbaseTrans
     const WalletTypes::WalletBlockInfo &block,
     const std::vector<std::tuple<Crypto::PublicKey, WalletTypes::TransactionInput>> &inputs) const
 {
+    /* Daemon side scanning leaves out coinbase transactions that aren't ours */
+    if (!block.coinbaseTransaction)
+    {
+        return std::nullopt;
+    }
+
     const auto tx = *(block.coinbaseTransaction);
 
     std::unordered_map<Crypto::PublicKey, int64_t> transfers;
@@ -543,53 +669,45 @@ std::vector<std::tuple<Crypto::PublicKey, WalletTypes::TransactionInput>> Wallet
 {
     std::vector<std::tuple<Crypto::PublicKey, WalletTypes::TransactionInput>> inputs;
 
-    Crypto::KeyDerivation derivation;
-
-    Crypto::generate_key_derivation(rawTX.transactionPublicKey, m_privateViewKey, derivation);
-
-    const std::vector<Crypto::PublicKey> spendKeys = m_subWallets->m_publicSpendKeys;
-
-    uint64_t outputIndex = 0;
+    const auto ownedOutputs = Utilities::findOwnedOutputs(rawTX, m_privateViewKey, m_subWallets->m_publicSpendKeys);
 
-    for (const auto &output : rawTX.keyOutputs)
+    if (ownedOutputs.empty())
     {
-        Crypto::PublicKey derivedSpendKey;
-
-        Crypto::underive_public_key(derivation, outputIndex, output.key, derivedSpendKey);
-
-        /* See if the derived spend key matches any of our spend keys */
-        const auto ourSpendKey = std::find(spendKeys.begin(), spendKeys.end(), derivedSpendKey);
+        return inputs;
+    }
 
-        /* If it does, the transaction belongs to us */
-        if (ourSpendKey != spendKeys.end())
-        {
-            /* We need to fill in the key image of the transaction input -
-               we'll let the subwallet do this since we need the private spend
-               key. We use the key images to detect outgoing transactions,
-               and we use the transaction inputs to make transactions ourself */
-            const auto [keyImage, privateEphemeral]
-                = m_subWallets->getTxInputKeyImage(derivedSpendKey, derivation, outputIndex);
-
-            const uint64_t spendHeight = 0;
-
-            const WalletTypes::TransactionInput input({
-                keyImage,
-                output.amount,
-                blockHeight,
-                rawTX.transactionPublicKey,
-                outputIndex,
-                output.globalOutputIndex,
-                output.key,
-                spendHeight,
-                rawTX.unlockTime,
-                rawTX.hash,
-                privateEphemeral
-            });
+    Crypto::KeyDerivation derivation;
 
-            inputs.emplace_back(derivedSpendKey, input);
-        }
+    Crypto::generate_key_derivation(rawTX.transactionPublicKey, m_privateViewKey, derivation);
 
-        outputIndex++;
+    for (const auto &[outputIndex, derivedSpendKey] : ownedOutputs)
+    {
+        const auto &output = rawTX.keyOutputs[outputIndex];
+
+        /* We need to fill in the key image of the transaction input -
+           we'll let the subwallet do this since we need the private spend
+           key. We use the key images to detect outgoing transactions,
+           and we use the transaction inputs to make transactions ourself */
+        const auto [keyImage, privateEphemeral]
+            = m_subWallets->getTxInputKeyImage(derivedSpendKey, derivation, outputIndex);
+
+        const uint64_t spendHeight = 0;
+
+        const WalletTypes::TransactionInput input({
+            keyImage,
+            output.amount,
+            blockHeight,
+            rawTX.transactionPublicKey,
+            outputIndex,
+            output.globalOutputIndex,
+            output.key,
+            spendHeight,
+            rawTX.unlockTime,
+            rawTX.hash,
+            privateEphemeral
+        });
+
+        inputs.emplace_back(derivedSpendKey, input);
     }
 
     return inputs;
@@ -663,6 +781,19 @@ void WalletSynchronizer::checkLockedTransactions()
     }
 }
 
+void WalletSynchronizer::checkLockedTransactionsPeriodically()
+{
+    const auto now = std::chrono::system_clock::now();
+    const auto timeDiff = now - m_lastCheckedLockedTransactions;
+
+    /* Not a viewwallet and haven't checked transactions in last 15 secs */
+    if (!m_subWallets->isViewWallet() && timeDiff > std::chrono::seconds(15))
+    {
+        checkLockedTransactions();
+        m_lastCheckedLockedTransactions = now;
+    }
+}
+
 /* Launch the worker thread in the background. It's safest to do this in a
    seperate function, so everything in the constructor gets initialized,
    and if we do any inheritance, things don't go awry. */
@@ -678,6 +809,17 @@ void WalletSynchronizer::start()
         throw std::runtime_error("Daemon has not been initialized!");
     }
 
+    /* Have the downloader shared by every wallet using our daemon hand us
+       blocks, if there is one, rather than starting our own threads */
+    m_sharedBlockDownloader = SharedDaemon::getBlockDownloader(m_daemon, m_threadCount);
+
+    if (m_sharedBlockDownloader)
+    {
+        m_lastCheckedLockedTransactions = std::chrono::system_clock::now();
+        m_sharedBlockDownloader->subscribe(this);
+        return;
+    }
+
     m_blockDownloader.start();
     m_blockProcessingQueue.start();
     m_processedBlocks.start();
@@ -699,6 +841,13 @@ void WalletSynchronizer::stop()
     /* Tell the threads to stop */
     m_shouldStop = true;
 
+    /* Waits for any blocks we are scanning on the shared pool */
+    if (m_sharedBlockDownloader)
+    {
+        m_sharedBlockDownloader->unsubscribe(this);
+        m_sharedBlockDownloader = nullptr;
+    }
+
     /* Tell the block downloader to stop and wait for it */
     m_blockDownloader.stop();
     m_blockProcessingQueue.stop();
@@ -771,6 +920,7 @@ uint64_t WalletSynchronizer::getCurrentScanHeight() const
 void WalletSynchronizer::swapNode(const std::shared_ptr<Nigel> daemon)
 {
     m_daemon = daemon;
+    m_blockDownloader.initializeAfterLoad(daemon);
 }
 
 void WalletSynchronizer::fromJSON(const JSONObject &j)
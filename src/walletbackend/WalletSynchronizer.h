@@ -8,10 +8,12 @@
 #include <memory>
 #include <nigel/Nigel.h>
 #include <subwallets/SubWallets.h>
+#include <utilities/ThreadPool.h>
 #include <utilities/ThreadSafeDeque.h>
 #include <utilities/ThreadSafePriorityQueue.h>
 #include <walletbackend/BlockDownloader.h>
 #include <walletbackend/EventHandler.h>
+#include <walletbackend/SharedBlockDownloader.h>
 #include <walletbackend/SynchronizationStatus.h>
 
 typedef std::vector<std::tuple<Crypto::PublicKey, WalletTypes::TransactionInput>> BlockInputsAndOwners;
@@ -45,7 +47,7 @@ class OrderByArrivalIndex
     }
 };
 
-class WalletSynchronizer
+class WalletSynchronizer : public BlockScanner
 {
   public:
     //////////////////
@@ -108,6 +110,16 @@ class WalletSynchronizer
 
     void setSubWallets(const std::shared_ptr<SubWallets> subWallets);
 
+    /* Used by the SharedBlockDownloader, when daemon connections are shared */
+    ScanPosition getScanPosition() const override;
+
+    void scanBlocks(
+        const std::vector<SharedBlock> &blocks,
+        Utilities::ThreadPool<bool> &pool,
+        std::function<void(const bool success)> done) override;
+
+    void synced(const std::optional<WalletTypes::TopBlock> &topBlock) override;
+
   private:
     //////////////////////////////
     /* Private member functions */
@@ -117,6 +129,12 @@ class WalletSynchronizer
 
     void blockProcessingThread();
 
+    /* Finds our inputs in the block, with their global indexes. Returns
+       nothing if we were stopped first, or if we couldn't get the global
+       indexes and were told not to wait and retry. */
+    std::optional<BlockInputsAndOwners>
+        processBlock(const WalletTypes::WalletBlockInfo &block, const bool waitForGlobalIndexes) const;
+
     std::vector<std::tuple<Crypto::PublicKey, WalletTypes::TransactionInput>>
         processBlockOutputs(const WalletTypes::WalletBlockInfo &block) const;
 
@@ -147,6 +165,9 @@ class WalletSynchronizer
 
     void checkLockedTransactions();
 
+    /* Checks the locked transactions, if it's been a while */
+    void checkLockedTransactionsPeriodically();
+
     //////////////////////////////
     /* Private member variables */
     //////////////////////////////
@@ -201,4 +222,11 @@ class WalletSynchronizer
 
     /* Stores thread ids of the block output processing threads */
     std::vector<std::thread> m_syncThreads;
+
+    /* Hands us blocks instead of m_blockDownloader and the sync threads
+       when daemon connections are shared. Only set while running. */
+    std::shared_ptr<SharedBlockDownloader> m_sharedBlockDownloader;
+
+    /* When we last checked if our locked transactions are still in the pool */
+    std::chrono::system_clock::time_point m_lastCheckedLockedTransactions;
 };
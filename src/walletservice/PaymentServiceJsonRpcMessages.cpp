@@ -156,6 +156,23 @@ namespace PaymentService
         serializer(lockedAmount, "lockedAmount");
     }
 
+    void AddressBalanceRpcInfo::serialize(CryptoNote::ISerializer &serializer)
+    {
+        serializer(address, "address");
+        serializer(availableBalance, "availableBalance");
+        serializer(lockedAmount, "lockedAmount");
+    }
+
+    void GetBalances::Request::serialize(CryptoNote::ISerializer &serializer)
+    {
+        serializer(addresses, "addresses");
+    }
+
+    void GetBalances::Response::serialize(CryptoNote::ISerializer &serializer)
+    {
+        serializer(balances, "balances");
+    }
+
     void GetBlockHashes::Request::serialize(CryptoNote::ISerializer &serializer)
     {
         bool r = serializer(firstBlockIndex, "firstBlockIndex");
@@ -235,6 +252,19 @@ namespace PaymentService
         serializer(transaction, "transaction");
     }
 
+    void GetTransactionsByHashes::Request::serialize(CryptoNote::ISerializer &serializer)
+    {
+        if (!serializer(transactionHashes, "transactionHashes"))
+        {
+            throw RequestSerializationError();
+        }
+    }
+
+    void GetTransactionsByHashes::Response::serialize(CryptoNote::ISerializer &serializer)
+    {
+        serializer(transactions, "transactions");
+    }
+
     void TransactionsInBlockRpcInfo::serialize(CryptoNote::ISerializer &serializer)
     {
         serializer(blockHash, "blockHash");
@@ -241,6 +241,35 @@ namespace PaymentService
         };
     };
 
+    struct AddressBalanceRpcInfo
+    {
+        std::string address;
+
+        uint64_t availableBalance;
+
+        uint64_t lockedAmount;
+
+        void serialize(CryptoNote::ISerializer &serializer);
+    };
+
+    struct GetBalances
+    {
+        struct Request
+        {
+            /* Every address in the wallet if empty */
+            std::vector<std::string> addresses;
+
+            void serialize(CryptoNote::ISerializer &serializer);
+        };
+
+        struct Response
+        {
+            std::vector<AddressBalanceRpcInfo> balances;
+
+            void serialize(CryptoNote::ISerializer &serializer);
+        };
+    };
+
     struct GetBlockHashes
     {
         struct Request
@@ -349,6 +378,24 @@ namespace PaymentService
         };
     };
 
+    struct GetTransactionsByHashes
+    {
+        struct Request
+        {
+            std::vector<std::string> transactionHashes;
+
+            void serialize(CryptoNote::ISerializer &serializer);
+        };
+
+        struct Response
+        {
+            /* In the same order as the hashes asked for */
+            std::vector<TransactionRpcInfo> transactions;
+
+            void serialize(CryptoNote::ISerializer &serializer);
+        };
+    };
+
     struct TransactionsInBlockRpcInfo
     {
         std::string blockHash;
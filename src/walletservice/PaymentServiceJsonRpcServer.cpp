@@ -11,11 +11,23 @@
 #include "WalletService.h"
 #include "crypto/hash.h"
 #include "rpc/JsonRpc.h"
-#include "serialization/JsonInputValueSerializer.h"
-#include "serialization/JsonOutputStreamSerializer.h"
 
 #include <CryptoTypes.h>
 #include <functional>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+namespace
+{
+    /* For logging a request we couldn't handle */
+    std::string toString(const rapidjson::Value &value)
+    {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        value.Accept(writer);
+        return std::string(buffer.GetString(), buffer.GetSize());
+    }
+} // namespace
 
 namespace PaymentService
 {
@@ -70,6 +82,10 @@ namespace PaymentService
             "getBalance",
             jsonHandler<GetBalance::Request, GetBalance::Response>(std::bind(
                 &PaymentServiceJsonRpcServer::handleGetBalance, this, std::placeholders::_1, std::placeholders::_2)));
+        handlers.emplace(
+            "getBalances",
+            jsonHandler<GetBalances::Request, GetBalances::Response>(std::bind(
+                &PaymentServiceJsonRpcServer::handleGetBalances, this, std::placeholders::_1, std::placeholders::_2)));
         handlers.emplace(
             "getBlockHashes",
             jsonHandler<GetBlockHashes::Request, GetBlockHashes::Response>(std::bind(
@@ -105,6 +121,13 @@ namespace PaymentService
                 this,
                 std::placeholders::_1,
                 std::placeholders::_2)));
+        handlers.emplace(
+            "getTransactionsByHashes",
+            jsonHandler<GetTransactionsByHashes::Request, GetTransactionsByHashes::Response>(std::bind(
+                &PaymentServiceJsonRpcServer::handleGetTransactionsByHashes,
+                this,
+                std::placeholders::_1,
+                std::placeholders::_2)));
         handlers.emplace(
             "sendTransaction",
             jsonHandler<SendTransaction::Request, SendTransaction::Response>(std::bind(
@@ -176,75 +199,68 @@ namespace PaymentService
                 &PaymentServiceJsonRpcServer::handleNodeFeeInfo, this, std::placeholders::_1, std::placeholders::_2)));
     }
 
-    void PaymentServiceJsonRpcServer::processJsonRpcRequest(const Common::JsonValue &req, Common::JsonValue &resp)
+    void PaymentServiceJsonRpcServer::processJsonRpcRequest(const rapidjson::Value &req, CryptoNote::JsonWriter &resp)
     {
-        try
+        if (!config.serviceConfig.legacySecurity)
         {
-            prepareJsonResponse(req, resp);
+            const auto password = req.FindMember("password");
 
-            if (!config.serviceConfig.legacySecurity)
+            if (password == req.MemberEnd() || !password->value.IsString())
             {
-                std::string clientPassword;
-                if (!req.contains("password"))
-                {
-                    makeInvalidPasswordResponse(resp);
-                    return;
-                }
-                if (!req("password").isString())
-                {
-                    makeInvalidPasswordResponse(resp);
-                    return;
-                }
-                clientPassword = req("password").getString();
-
-                std::vector<uint8_t> rawData(clientPassword.begin(), clientPassword.end());
-                Crypto::Hash hashedPassword = Crypto::Hash();
-                cn_slow_hash_v0(rawData.data(), rawData.size(), hashedPassword);
-                if (hashedPassword != config.rpcSecret)
-                {
-                    makeInvalidPasswordResponse(resp);
-                    return;
-                }
-            }
-
-            if (!req.contains("method"))
-            {
-                logger(Logging::WARNING) << "Field \"method\" is not found in json request: " << req;
-                makeGenericErrorReponse(resp, "Invalid Request", -3600);
+                makeInvalidPasswordResponse(resp);
                 return;
             }
 
-            if (!req("method").isString())
+            const std::string clientPassword(password->value.GetString(), password->value.GetStringLength());
+
+            std::vector<uint8_t> rawData(clientPassword.begin(), clientPassword.end());
+            Crypto::Hash hashedPassword = Crypto::Hash();
+            cn_slow_hash_v0(rawData.data(), rawData.size(), hashedPassword);
+            if (hashedPassword != config.rpcSecret)
             {
-                logger(Logging::WARNING) << "Field \"method\" is not a string type: " << req;
-                makeGenericErrorReponse(resp, "Invalid Request", -3600);
+                makeInvalidPasswordResponse(resp);
                 return;
             }
+        }
 
-            std::string method = req("method").getString();
+        const auto method = req.FindMember("method");
 
-            auto it = handlers.find(method);
-            if (it == handlers.end())
-            {
-                logger(Logging::WARNING) << "Requested method not found: " << method;
-                makeMethodNotFoundResponse(resp);
-                return;
-            }
+        if (method == req.MemberEnd())
+        {
+            logger(Logging::WARNING) << "Field \"method\" is not found in json request: " << toString(req);
+            makeGenericErrorReponse(resp, "Invalid Request", -3600);
+            return;
+        }
 
-            logger(Logging::DEBUGGING) << method << " request came";
+        if (!method->value.IsString())
+        {
+            logger(Logging::WARNING) << "Field \"method\" is not a string type: " << toString(req);
+            makeGenericErrorReponse(resp, "Invalid Request", -3600);
+            return;
+        }
 
-            Common::JsonValue params(Common::JsonValue::OBJECT);
-            if (req.contains("params"))
-            {
-                params = req("params");
-            }
+        const std::string methodName(method->value.GetString(), method->value.GetStringLength());
+
+        auto it = handlers.find(methodName);
+        if (it == handlers.end())
+        {
+            logger(Logging::WARNING) << "Requested method not found: " << methodName;
+            makeMethodNotFoundResponse(resp);
+            return;
+        }
+
+        logger(Logging::DEBUGGING) << methodName << " request came";
 
-            it->second(params, resp);
+        const auto params = req.FindMember("params");
+
+        if (params != req.MemberEnd())
+        {
+            it->second(params->value, resp);
         }
-        catch (std::exception &e)
+        else
         {
-            logger(Logging::WARNING) << "Error occurred while processing JsonRpc request: " << e.what();
-            makeGenericErrorReponse(resp, e.what());
+            const rapidjson::Value emptyParams(rapidjson::kObjectType);
+            it->second(emptyParams, resp);
         }
     }
 
@@ -321,6 +337,13 @@ namespace PaymentService
         }
     }
 
+    std::error_code PaymentServiceJsonRpcServer::handleGetBalances(
+        const GetBalances::Request &request,
+        GetBalances::Response &response)
+    {
+        return service.getBalances(request.addresses, response.balances);
+    }
+
     std::error_code PaymentServiceJsonRpcServer::handleGetBlockHashes(
         const GetBlockHashes::Request &request,
         GetBlockHashes::Response &response)
@@ -374,6 +397,13 @@ namespace PaymentService
         return service.getTransaction(request.transactionHash, response.transaction);
     }
 
+    std::error_code PaymentServiceJsonRpcServer::handleGetTransactionsByHashes(
+        const GetTransactionsByHashes::Request &request,
+        GetTransactionsByHashes::Response &response)
+    {
+        return service.getTransactionsByHashes(request.transactionHashes, response.transactions);
+    }
+
     std::error_code PaymentServiceJsonRpcServer::handleSendTransaction(
         SendTransaction::Request &request,
         SendTransaction::Response &response)
@@ -8,10 +8,9 @@
 #pragma once
 
 #include "PaymentServiceJsonRpcMessages.h"
-#include "common/JsonValue.h"
 #include "jsonrpcserver/JsonRpcServer.h"
-#include "serialization/JsonInputValueSerializer.h"
-#include "serialization/JsonOutputStreamSerializer.h"
+#include "serialization/RapidJsonInputSerializer.h"
+#include "serialization/RapidJsonOutputSerializer.h"
 
 #include <unordered_map>
 
@@ -32,27 +31,27 @@ namespace PaymentService
         PaymentServiceJsonRpcServer(const PaymentServiceJsonRpcServer &) = delete;
 
       protected:
-        virtual void processJsonRpcRequest(const Common::JsonValue &req, Common::JsonValue &resp) override;
+        virtual void processJsonRpcRequest(const rapidjson::Value &req, CryptoNote::JsonWriter &resp) override;
 
       private:
         WalletService &service;
 
         Logging::LoggerRef logger;
 
-        typedef std::function<void(const Common::JsonValue &jsonRpcParams, Common::JsonValue &jsonResponse)>
+        typedef std::function<void(const rapidjson::Value &jsonRpcParams, CryptoNote::JsonWriter &jsonResponse)>
             HandlerFunction;
 
         template<typename RequestType, typename ResponseType, typename RequestHandler>
         HandlerFunction jsonHandler(RequestHandler handler)
         {
-            return [handler, this](const Common::JsonValue &jsonRpcParams, Common::JsonValue &jsonResponse) mutable {
+            return [handler,
+                    this](const rapidjson::Value &jsonRpcParams, CryptoNote::JsonWriter &jsonResponse) mutable {
                 RequestType request;
                 ResponseType response;
 
                 try
                 {
-                    CryptoNote::JsonInputValueSerializer inputSerializer(
-                        const_cast<Common::JsonValue &>(jsonRpcParams));
+                    CryptoNote::RapidJsonInputSerializer inputSerializer(jsonRpcParams);
                     SerializeRequest(request, inputSerializer);
                 }
                 catch (std::exception &)
@@ -68,26 +67,30 @@ namespace PaymentService
                     return;
                 }
 
-                CryptoNote::JsonOutputStreamSerializer outputSerializer;
+                jsonResponse.Key("result");
+                jsonResponse.StartObject();
+
+                CryptoNote::RapidJsonOutputSerializer outputSerializer(jsonResponse);
                 serialize(response, outputSerializer);
-                fillJsonResponse(outputSerializer.getValue(), jsonResponse);
+
+                jsonResponse.EndObject();
             };
         }
 
         template<typename RequestType>
-        void SerializeRequest(RequestType &request, CryptoNote::JsonInputValueSerializer &inputSerializer)
+        void SerializeRequest(RequestType &request, CryptoNote::RapidJsonInputSerializer &inputSerializer)
         {
             serialize(request, inputSerializer);
         }
 
-        void SerializeRequest(SendTransaction::Request &request, CryptoNote::JsonInputValueSerializer &inputSerializer)
+        void SerializeRequest(SendTransaction::Request &request, CryptoNote::RapidJsonInputSerializer &inputSerializer)
         {
             request.serialize(inputSerializer, service);
         }
 
         void SerializeRequest(
             CreateDelayedTransaction::Request &request,
-            CryptoNote::JsonInputValueSerializer &inputSerializer)
+            CryptoNote::RapidJsonInputSerializer &inputSerializer)
         {
             request.serialize(inputSerializer, service);
         }
@@ -111,6 +114,8 @@ namespace PaymentService
 
         std::error_code handleGetBalance(const GetBalance::Request &request, GetBalance::Response &response);
 
+        std::error_code handleGetBalances(const GetBalances::Request &request, GetBalances::Response &response);
+
         std::error_code
             handleGetBlockHashes(const GetBlockHashes::Request &request, GetBlockHashes::Response &response);
 
@@ -128,6 +133,10 @@ namespace PaymentService
         std::error_code
             handleGetTransaction(const GetTransaction::Request &request, GetTransaction::Response &response);
 
+        std::error_code handleGetTransactionsByHashes(
+            const GetTransactionsByHashes::Request &request,
+            GetTransactionsByHashes::Response &response);
+
         std::error_code handleSendTransaction(SendTransaction::Request &request, SendTransaction::Response &response);
 
         std::error_code handleCreateDelayedTransaction(
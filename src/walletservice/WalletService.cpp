@@ -943,6 +943,53 @@ namespace PaymentService
         return std::error_code();
     }
 
+    std::error_code WalletService::getBalances(
+        const std::vector<std::string> &addresses,
+        std::vector<AddressBalanceRpcInfo> &balances)
+    {
+        try
+        {
+            /* Taken once for every address, rather than once per address */
+            System::EventLock lk(readyEvent);
+
+            std::vector<std::string> allAddresses;
+
+            if (addresses.empty())
+            {
+                allAddresses.reserve(wallet.getAddressCount());
+
+                for (size_t i = 0; i < wallet.getAddressCount(); ++i)
+                {
+                    allAddresses.push_back(wallet.getAddress(i));
+                }
+            }
+
+            const std::vector<std::string> &wanted = addresses.empty() ? allAddresses : addresses;
+
+            logger(Logging::DEBUGGING) << "Getting balances for " << wanted.size() << " addresses";
+
+            balances.clear();
+            balances.reserve(wanted.size());
+
+            for (const auto &address : wanted)
+            {
+                AddressBalanceRpcInfo balance;
+                balance.address = address;
+                balance.availableBalance = wallet.getActualBalance(address);
+                balance.lockedAmount = wallet.getPendingBalance(address);
+
+                balances.push_back(std::move(balance));
+            }
+        }
+        catch (std::system_error &x)
+        {
+            logger(Logging::WARNING, Logging::BRIGHT_YELLOW) << "Error while getting balances: " << x.what();
+            return x.code();
+        }
+
+        return std::error_code();
+    }
+
     std::error_code WalletService::getBlockHashes(
         uint32_t firstBlockIndex,
         uint32_t blockCount,
@@ -1195,6 +1242,47 @@ namespace PaymentService
         return std::error_code();
     }
 
+    std::error_code WalletService::getTransactionsByHashes(
+        const std::vector<std::string> &transactionHashes,
+        std::vector<TransactionRpcInfo> &transactions)
+    {
+        try
+        {
+            System::EventLock lk(readyEvent);
+
+            transactions.clear();
+            transactions.reserve(transactionHashes.size());
+
+            for (const auto &transactionHash : transactionHashes)
+            {
+                Crypto::Hash hash = parseHash(transactionHash, logger);
+
+                CryptoNote::WalletTransactionWithTransfers transactionWithTransfers = wallet.getTransaction(hash);
+
+                if (transactionWithTransfers.transaction.state == CryptoNote::WalletTransactionState::DELETED)
+                {
+                    logger(Logging::WARNING, Logging::BRIGHT_YELLOW)
+                        << "Transaction " << transactionHash << " is deleted";
+                    return make_error_code(CryptoNote::error::OBJECT_NOT_FOUND);
+                }
+
+                transactions.push_back(convertTransactionWithTransfersToTransactionRpcInfo(transactionWithTransfers));
+            }
+        }
+        catch (std::system_error &x)
+        {
+            logger(Logging::WARNING, Logging::BRIGHT_YELLOW) << "Error while getting transactions: " << x.what();
+            return x.code();
+        }
+        catch (std::exception &x)
+        {
+            logger(Logging::WARNING, Logging::BRIGHT_YELLOW) << "Error while getting transactions: " << x.what();
+            return make_error_code(CryptoNote::error::INTERNAL_WALLET_ERROR);
+        }
+
+        return std::error_code();
+    }
+
     std::error_code WalletService::getAddresses(std::vector<std::string> &addresses)
     {
         try
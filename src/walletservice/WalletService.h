@@ -104,6 +104,10 @@ namespace PaymentService
 
         std::error_code getBalance(uint64_t &availableBalance, uint64_t &lockedAmount);
 
+        /* The balance of each address, or of every address if none are given */
+        std::error_code
+            getBalances(const std::vector<std::string> &addresses, std::vector<AddressBalanceRpcInfo> &balances);
+
         std::error_code
             getBlockHashes(uint32_t firstBlockIndex, uint32_t blockCount, std::vector<std::string> &blockHashes);
 
@@ -141,6 +145,10 @@ namespace PaymentService
 
         std::error_code getTransaction(const std::string &transactionHash, TransactionRpcInfo &transaction);
 
+        std::error_code getTransactionsByHashes(
+            const std::vector<std::string> &transactionHashes,
+            std::vector<TransactionRpcInfo> &transactions);
+
         std::error_code getAddresses(std::vector<std::string> &addresses);
 
         std::error_code sendTransaction(